@@ -0,0 +1,159 @@
+#include "binary_log.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <ctime>
+#include <functional>
+#include <thread>
+#endif
+
+namespace {
+
+template<typename T>
+void AppendRaw(std::string& out, T value) {
+    char buf[sizeof(T)];
+    std::memcpy(buf, &value, sizeof(T));
+    out.append(buf, sizeof(T));
+}
+
+#ifdef _WIN32
+
+int32_t GetUtcOffsetMinutes() {
+    TIME_ZONE_INFORMATION tzi = {};
+    DWORD state = GetTimeZoneInformation(&tzi);
+    LONG bias = tzi.Bias;
+    if (state == TIME_ZONE_ID_DAYLIGHT) {
+        bias += tzi.DaylightBias;
+    } else if (state == TIME_ZONE_ID_STANDARD) {
+        bias += tzi.StandardBias;
+    }
+    return static_cast<int32_t>(-bias);
+}
+
+uint32_t CurrentThreadId() {
+    return static_cast<uint32_t>(GetCurrentThreadId());
+}
+
+#else
+
+int32_t GetUtcOffsetMinutes() {
+    std::time_t now = std::time(nullptr);
+    std::tm local = {};
+    localtime_r(&now, &local);
+    return static_cast<int32_t>(local.tm_gmtoff / 60);
+}
+
+// No small numeric thread ID in the standard library; a stable hash will do
+uint32_t CurrentThreadId() {
+    return static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+}
+
+#endif
+
+} // namespace
+
+BinaryLogWriter::BinaryLogWriter() {
+}
+
+BinaryLogWriter::~BinaryLogWriter() {
+    Close();
+}
+
+bool BinaryLogWriter::Open(const std::wstring& path, const LogRotationPolicy& policy) {
+    if (m_writer.IsOpen()) {
+        return true;
+    }
+
+    // Every session and every rotated file starts with this header; the
+    // decoder accepts concatenated sessions. Records stay relative to it.
+    auto wallNow = std::chrono::system_clock::now();
+    m_startTime = std::chrono::steady_clock::now();
+    int64_t wallMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+        wallNow.time_since_epoch()).count();
+
+    std::string header;
+    header.append(BinaryLogFormat::kMagic, sizeof(BinaryLogFormat::kMagic));
+    AppendRaw<uint16_t>(header, BinaryLogFormat::kVersion);
+    AppendRaw<uint16_t>(header, 0);
+    AppendRaw<int64_t>(header, wallMicros);
+    AppendRaw<int32_t>(header, GetUtcOffsetMinutes());
+    AppendRaw<int32_t>(header, 0);
+
+    // Zero bytes are valid record data, so a crash tail is kept and skipped by the decoder
+    return m_writer.Open(path, policy, header, false);
+}
+
+void BinaryLogWriter::Close() {
+    m_writer.Close();
+}
+
+void BinaryLogWriter::EncodeArg(std::string& out, const std::string& value) {
+    out.push_back(static_cast<char>(BinaryLogFormat::ArgTag::Str));
+    AppendRaw<uint32_t>(out, static_cast<uint32_t>(value.size()));
+    out.append(value);
+}
+
+void BinaryLogWriter::EncodeArg(std::string& out, const char* value) {
+    const char* text = value ? value : "";
+    size_t length = std::strlen(text);
+    out.push_back(static_cast<char>(BinaryLogFormat::ArgTag::Str));
+    AppendRaw<uint32_t>(out, static_cast<uint32_t>(length));
+    out.append(text, length);
+}
+
+void BinaryLogWriter::EncodeArg(std::string& out, const std::wstring& value) {
+    // Raw UTF-16 code units; the decoder transcodes
+    out.push_back(static_cast<char>(BinaryLogFormat::ArgTag::WStr));
+#ifdef _WIN32
+    AppendRaw<uint32_t>(out, static_cast<uint32_t>(value.size()));
+    out.append(reinterpret_cast<const char*>(value.data()), value.size() * sizeof(wchar_t));
+#else
+    // wchar_t is UTF-32 here: write the UTF-16 the format specifies, then
+    // fill in the unit count
+    size_t countAt = out.size();
+    AppendRaw<uint32_t>(out, 0);
+    uint32_t units = 0;
+    for (wchar_t wc : value) {
+        uint32_t c = static_cast<uint32_t>(wc);
+        if (c >= 0x10000 && c <= 0x10FFFF) {
+            c -= 0x10000;
+            AppendRaw<uint16_t>(out, static_cast<uint16_t>(0xD800 | (c >> 10)));
+            AppendRaw<uint16_t>(out, static_cast<uint16_t>(0xDC00 | (c & 0x3FF)));
+            units += 2;
+        } else {
+            AppendRaw<uint16_t>(out, static_cast<uint16_t>(c <= 0xFFFF ? c : 0xFFFD));
+            units += 1;
+        }
+    }
+    std::memcpy(&out[countAt], &units, sizeof(units));
+#endif
+}
+
+void BinaryLogWriter::EncodeArg(std::string& out, const wchar_t* value) {
+    EncodeArg(out, std::wstring(value ? value : L""));
+}
+
+void BinaryLogWriter::EncodeArg(std::string& out, bool value) {
+    out.push_back(static_cast<char>(BinaryLogFormat::ArgTag::Bool));
+    out.push_back(value ? 1 : 0);
+}
+
+void BinaryLogWriter::Commit(LogEventId id, LogLevel level, uint8_t argCount, std::string& record) {
+    uint64_t elapsedNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_startTime).count());
+    uint32_t threadId = CurrentThreadId();
+    uint16_t rawId = static_cast<uint16_t>(id);
+
+    char* header = &record[0];
+    std::memcpy(header, &rawId, 2);
+    header[2] = static_cast<char>(level);
+    header[3] = static_cast<char>(argCount);
+    std::memcpy(header + 4, &threadId, 4);
+    std::memcpy(header + 8, &elapsedNs, 8);
+
+    m_writer.Append(record);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "log_events.h"
+#include "log_writer.h"
+#include <string>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+
+// Writer for the binary structured log (debug.bin).
+//
+// A record is the static event ID plus the raw arguments - no formatting,
+// no UTF-16 -> UTF-8 conversion. Callers encode into thread-local scratch
+// and hand the record to an AsyncLogWriter, whose background thread writes
+// and rotates the file. Render with tools/log_decoder.
+class BinaryLogWriter {
+public:
+    BinaryLogWriter();
+    ~BinaryLogWriter();
+
+    // Disable copy
+    BinaryLogWriter(const BinaryLogWriter&) = delete;
+    BinaryLogWriter& operator=(const BinaryLogWriter&) = delete;
+
+    // Open (append to) the log file and start the writer thread
+    bool Open(const std::wstring& path, const LogRotationPolicy& policy = LogRotationPolicy());
+
+    // Flush pending records and stop the writer thread
+    void Close();
+
+    bool IsOpen() const { return m_writer.IsOpen(); }
+
+    // Encode and queue one record
+    template<typename... Args>
+    void Append(LogEventId id, LogLevel level, const Args&... args);
+
+private:
+    // Argument encoders - one per supported argument type
+    static void EncodeArg(std::string& out, const std::string& value);
+    static void EncodeArg(std::string& out, const char* value);
+    static void EncodeArg(std::string& out, const std::wstring& value);
+    static void EncodeArg(std::string& out, const wchar_t* value);
+    static void EncodeArg(std::string& out, bool value);
+
+    template<typename T>
+    static std::enable_if_t<std::is_integral_v<T>> EncodeArg(std::string& out, T value) {
+        if constexpr (std::is_signed_v<T>) {
+            EncodeScalar(out, BinaryLogFormat::ArgTag::I64, static_cast<int64_t>(value));
+        } else {
+            EncodeScalar(out, BinaryLogFormat::ArgTag::U64, static_cast<uint64_t>(value));
+        }
+    }
+
+    template<typename T>
+    static std::enable_if_t<std::is_floating_point_v<T>> EncodeArg(std::string& out, T value) {
+        EncodeScalar(out, BinaryLogFormat::ArgTag::F64, static_cast<double>(value));
+    }
+
+    template<typename T>
+    static std::enable_if_t<std::is_enum_v<T>> EncodeArg(std::string& out, T value) {
+        EncodeArg(out, static_cast<std::underlying_type_t<T>>(value));
+    }
+
+    template<typename T>
+    static void EncodeScalar(std::string& out, BinaryLogFormat::ArgTag tag, T value) {
+        char buf[1 + sizeof(T)];
+        buf[0] = static_cast<char>(tag);
+        std::memcpy(buf + 1, &value, sizeof(T));
+        out.append(buf, sizeof(buf));
+    }
+
+    // Fill in the record header reserved at the front of record and queue it
+    void Commit(LogEventId id, LogLevel level, uint8_t argCount, std::string& record);
+
+    AsyncLogWriter m_writer;
+    std::chrono::steady_clock::time_point m_startTime;  // Matches the header's wall clock
+};
+
+template<typename... Args>
+void BinaryLogWriter::Append(LogEventId id, LogLevel level, const Args&... args) {
+    if (!m_writer.IsOpen()) return;
+
+    // Reused per thread, so steady-state encoding does not allocate
+    thread_local std::string scratch;
+    scratch.assign(BinaryLogFormat::kRecordHeaderSize, '\0');
+    (EncodeArg(scratch, args), ...);
+
+    Commit(id, level, static_cast<uint8_t>(sizeof...(Args)), scratch);
+}
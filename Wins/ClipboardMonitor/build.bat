@@ -42,14 +42,19 @@ echo Compiling ClipboardMonitor...
 
 if not exist bin mkdir bin
 
-cl.exe /EHsc /std:c++17 /W4 /O2 /DUNICODE /D_UNICODE /utf-8 ^
+cl.exe /EHsc /std:c++20 /W4 /O2 /DUNICODE /D_UNICODE /utf-8 ^
     /Fe:bin\GlimpseMe.exe ^
-    main.cpp clipboard_monitor.cpp storage.cpp floating_window.cpp ^
-    context\async_executor.cpp context\context_manager.cpp ^
+    main.cpp clipboard_monitor.cpp storage.cpp floating_window.cpp binary_log.cpp log_writer.cpp ^
+    context\async_executor.cpp context\timer_queue.cpp context\latency_histogram.cpp context\executor_metrics.cpp ^
+    context\context_cache.cpp context\adaptive_timeout.cpp context\circuit_breaker.cpp ^
+    context\context_provider.cpp context\win_event_foreground_source.cpp context\context_manager.cpp ^
     context\adapters\browser_adapter.cpp context\adapters\wechat_adapter.cpp ^
-    context\adapters\vscode_adapter.cpp context\adapters\notion_adapter.cpp ^
+    context\adapters\vscode_adapter.cpp context\adapters\notion_adapter.cpp context\adapters\generic_adapter.cpp ^
+    context\adapters\element_scans.cpp ^
     context\utils\ui_automation_helper.cpp context\utils\html_parser.cpp ^
-    /link user32.lib gdi32.lib shell32.lib ole32.lib oleaut32.lib shlwapi.lib oleacc.lib uiautomationcore.lib ^
+    context\utils\json_reader.cpp context\utils\title_rules.cpp context\utils\accessible_tree.cpp ^
+    context\utils\accessible_search.cpp context\utils\element_path_cache.cpp ^
+    /link user32.lib gdi32.lib shell32.lib ole32.lib oleaut32.lib shlwapi.lib oleacc.lib uiautomationcore.lib version.lib ^
     /SUBSYSTEM:WINDOWS
 
 if %ERRORLEVEL% EQU 0 (
@@ -2,6 +2,7 @@
 #include "utils.h"
 #include "debug_log.h"
 #include "context/context_manager.h"
+#include "context/foreground_source.h"
 #include <psapi.h>
 #include <shellapi.h>
 #include <oleacc.h>
@@ -17,6 +18,8 @@ ClipboardMonitor::ClipboardMonitor()
     , m_running(false)
     , m_callback(nullptr)
     , m_lastSequenceNumber(0)
+    , m_interactiveUntil(0)
+    , m_lastEntryId(0)
 {
 }
 
@@ -82,6 +85,9 @@ void ClipboardMonitor::Run() {
 }
 
 void ClipboardMonitor::Stop() {
+    if (m_foregroundSource) {
+        m_foregroundSource->Stop();
+    }
     if (m_hwnd) {
         RemoveClipboardFormatListener(m_hwnd);
         DestroyWindow(m_hwnd);
@@ -95,6 +101,27 @@ void ClipboardMonitor::SetCallback(ClipboardChangeCallback callback) {
     m_callback = callback;
 }
 
+bool ClipboardMonitor::SetForegroundSource(std::unique_ptr<IForegroundSource> source) {
+    if (m_foregroundSource) {
+        m_foregroundSource->Stop();
+    }
+    m_foregroundSource = std::move(source);
+    if (!m_foregroundSource) {
+        return true;
+    }
+    return m_foregroundSource->Start([this](HWND hwnd) { OnForegroundChanged(hwnd); });
+}
+
+void ClipboardMonitor::OnForegroundChanged(HWND hwnd) {
+    if (!m_contextManager) {
+        return;
+    }
+
+    SourceInfo source;
+    GetSourceInfo(hwnd, source);
+    m_contextManager->Prefetch(source);
+}
+
 LRESULT CALLBACK ClipboardMonitor::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
     ClipboardMonitor* monitor = nullptr;
     
@@ -113,12 +140,12 @@ LRESULT CALLBACK ClipboardMonitor::WindowProc(HWND hwnd, UINT uMsg, WPARAM wPara
         case WM_CLIPBOARDUPDATE:
             // Don't process immediately - post a message to ourselves
             // This allows the source app to finish its clipboard operation
-            DEBUG_LOG(">>> WM_CLIPBOARDUPDATE - posting deferred message");
+            LOG_TRACE(">>> WM_CLIPBOARDUPDATE - posting deferred message");
             PostMessage(hwnd, WM_DEFERRED_CLIPBOARD, 0, 0);
             return 0;
             
         case WM_USER + 100:  // WM_DEFERRED_CLIPBOARD
-            DEBUG_LOG(">>> WM_DEFERRED_CLIPBOARD - now processing");
+            LOG_TRACE(">>> WM_DEFERRED_CLIPBOARD - now processing");
             if (monitor) {
                 monitor->OnClipboardUpdate();
             }
@@ -143,59 +170,74 @@ void ClipboardMonitor::OnClipboardUpdate() {
     // Check if clipboard actually changed
     DWORD currentSequence = GetClipboardSequenceNumber();
     if (currentSequence == m_lastSequenceNumber) {
-        DEBUG_LOG("Sequence unchanged, skipping");
+        LOG_TRACE("Sequence unchanged, skipping");
         return;
     }
     
-    std::ostringstream oss;
-    oss << "Seq: " << m_lastSequenceNumber << " -> " << currentSequence;
-    DEBUG_LOG(oss.str());
+    LOG_EVENT(SequenceChanged, m_lastSequenceNumber, currentSequence);
     m_lastSequenceNumber = currentSequence;
     
     ClipboardEntry entry;
+    entry.id = ++m_lastEntryId;
     entry.timestamp = Utils::GetTimestamp();
     
     // Get source info first (before opening clipboard)
     GetSourceInfo(entry.source);
-    DEBUG_LOG("Source: " + Utils::WideToUtf8(entry.source.processName) + " | " + Utils::WideToUtf8(entry.source.windowTitle));
+    LOG_EVENT(SourceInfo, entry.source.processName, entry.source.windowTitle);
     
     // Get clipboard content
     if (GetClipboardContent(entry)) {
         // Try to get browser URL (deprecated, kept for backward compatibility)
         entry.contextUrl = TryGetBrowserUrl(entry.source.windowHandle, entry.source.processName);
 
-        DEBUG_LOG("OK: " + entry.contentType + " | " + Utils::WideToUtf8(entry.contentPreview.substr(0, 50)));
+        LOG_EVENT(ClipboardContent, entry.contentType, entry.contentPreview.substr(0, 50));
 
-        // Get context asynchronously if ContextManager is available
+        // Publish at once, with whatever the window title tells us
         if (m_contextManager) {
-            m_contextManager->GetContextAsync(
-                entry.source,
-                [this, entry](std::shared_ptr<ContextData> contextData) mutable {
-                    // Attach context data
-                    if (contextData) {
-                        entry.contextData = contextData;
+            entry.contextData = m_contextManager->GetQuickContext(entry.source);
+        }
+        if (m_callback) {
+            m_callback(entry);
+        }
 
-                        std::ostringstream oss;
-                        oss << "Context: " << contextData->adapterType
-                            << ", success=" << (contextData->success ? "true" : "false")
-                            << ", time=" << contextData->fetchTimeMs << "ms";
-                        DEBUG_LOG(oss.str());
-                    }
+        // Then get the full context asynchronously and publish the entry again
+        // (a complete context, e.g. the generic one, has nothing to follow)
+        bool complete = entry.contextData && !entry.contextData->partial;
+        if (m_contextManager && !complete) {
+            // Hook and clipboard messages share this thread, so no locking
+            bool interactive = m_interactiveUntil != 0 &&
+                               static_cast<LONG>(m_interactiveUntil - GetTickCount()) > 0;
+            m_interactiveUntil = 0;
 
-                    // Call the callback with context data attached
-                    if (m_callback) {
-                        m_callback(entry);
-                    }
-                }
-            );
-        } else {
-            // No context manager - call callback directly
-            if (m_callback) {
-                m_callback(entry);
-            }
+            Spawn(CaptureContext(std::move(entry),
+                                 interactive ? TaskPriority::Interactive : TaskPriority::Normal));
         }
     } else {
-        DEBUG_LOG("FAILED: GetClipboardContent returned false");
+        LOG_WARN("FAILED: GetClipboardContent returned false");
+    }
+}
+
+CoTask<void> ClipboardMonitor::CaptureContext(ClipboardEntry entry, TaskPriority priority) {
+    std::shared_ptr<const ContextData> contextData =
+        co_await m_contextManager->GetContext(entry.source, priority);
+
+    // No adapter (and no generic one): the entry was already published as it is
+    if (!contextData) {
+        co_return;
+    }
+
+    LOG_EVENT(ContextAttached, contextData->adapterType,
+              contextData->success, contextData->fetchTimeMs);
+
+    // A failed fetch does not replace a usable quick context
+    if (!contextData->success && entry.contextData && entry.contextData->success) {
+        co_return;
+    }
+    entry.contextData = contextData;
+
+    // Publish again with the full context attached (same entry id)
+    if (m_callback) {
+        m_callback(entry);
     }
 }
 
@@ -209,9 +251,7 @@ bool ClipboardMonitor::GetClipboardContent(ClipboardEntry& entry) {
         if (OpenClipboard(m_hwnd)) {
             clipboardOpened = true;
             if (attempt > 0) {
-                std::ostringstream oss;
-                oss << "Clipboard opened after " << attempt << "ms";
-                DEBUG_LOG(oss.str());
+                LOG_EVENT(ClipboardOpened, attempt);
             }
             break;
         }
@@ -220,16 +260,13 @@ bool ClipboardMonitor::GetClipboardContent(ClipboardEntry& entry) {
     
     if (!clipboardOpened) {
         DWORD err = GetLastError();
-        std::ostringstream oss;
-        oss << "Failed to open clipboard after " << MAX_RETRIES << " retries, error: " << err;
-        DEBUG_LOG(oss.str());
+        LOG_WARN("Failed to open clipboard after {} retries, error: {}", MAX_RETRIES, err);
         return false;
     }
     
-    // First, log all available formats
-    {
+    // First, log all available formats (enumeration only runs when tracing)
+    if (LOG_ENABLED(GetLogEventLevel(LogEventId::ClipboardFormats))) {
         std::ostringstream oss;
-        oss << "Available formats: ";
         UINT format = 0;
         int count = 0;
         while ((format = EnumClipboardFormats(format)) != 0) {
@@ -242,8 +279,7 @@ bool ClipboardMonitor::GetClipboardContent(ClipboardEntry& entry) {
             oss << " ";
             count++;
         }
-        oss << "(total: " << count << ")";
-        DEBUG_LOG(oss.str());
+        LOG_EVENT(ClipboardFormats, oss.str(), count);
     }
     
     bool success = false;
@@ -372,7 +408,11 @@ bool ClipboardMonitor::GetClipboardContent(ClipboardEntry& entry) {
 
 void ClipboardMonitor::GetSourceInfo(SourceInfo& info) {
     // Get foreground window
-    info.windowHandle = GetForegroundWindow();
+    GetSourceInfo(GetForegroundWindow(), info);
+}
+
+void ClipboardMonitor::GetSourceInfo(HWND hwnd, SourceInfo& info) {
+    info.windowHandle = hwnd;
     
     if (!info.windowHandle) {
         info.processName = L"Unknown";
@@ -8,19 +8,14 @@
 #include <string>
 #include <functional>
 #include <memory>
+#include <cstdint>
+#include "context/coroutine.h"
+#include "source_info.h"
 
 // Forward declarations
 struct ContextData;
 class ContextManager;
-
-// Information about the source application
-struct SourceInfo {
-    std::wstring processName;      // e.g., "chrome.exe"
-    std::wstring processPath;      // Full path to executable
-    std::wstring windowTitle;      // Window title (context)
-    DWORD processId = 0;           // Process ID
-    HWND windowHandle = nullptr;   // Window handle
-};
+class IForegroundSource;
 
 // User annotation data
 struct Annotation {
@@ -32,18 +27,22 @@ struct Annotation {
 
 // Clipboard entry data
 struct ClipboardEntry {
+    uint64_t id = 0;               // Capture sequence number (a context patch keeps it)
     std::string timestamp;         // ISO 8601 timestamp
     std::string contentType;       // "text", "image", "files", etc.
     std::wstring content;          // Actual content (for text)
     std::wstring contentPreview;   // Truncated preview
     SourceInfo source;             // Source application info
     std::wstring contextUrl;       // URL if available (deprecated, kept for backward compatibility)
-    std::shared_ptr<ContextData> contextData;  // Extended context information
+    std::shared_ptr<const ContextData> contextData;  // Extended context information (shared, immutable)
     Annotation annotation;         // User annotation (optional)
     std::wstring fullContext;      // Full page content if "select all" was checked
 };
 
 // Callback type for clipboard changes
+// Called as soon as an entry is captured (with the quick context, if any),
+// then again with the same entry id when the full context arrives, possibly
+// on a worker thread; the second call replaces the first
 using ClipboardChangeCallback = std::function<void(const ClipboardEntry&)>;
 
 class ClipboardMonitor {
@@ -71,18 +70,39 @@ public:
         m_contextManager = manager;
     }
 
+    // Fetch context for the next clipboard update (within ~1s) ahead of
+    // regular captures; called from the keyboard hook on Ctrl+C+C only
+    void MarkNextCaptureInteractive() { m_interactiveUntil = GetTickCount() + 1000; }
+
+    // Prefetch context for each window the source reports as newly in front
+    // (see ContextManager::Prefetch); call on the thread that runs Run(),
+    // after SetContextManager
+    // Returns: false if the source could not be started
+    bool SetForegroundSource(std::unique_ptr<IForegroundSource> source);
+
 private:
     // Window procedure
     static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
     
     // Handle clipboard update
     void OnClipboardUpdate();
+
+    // Fetch the full context for an already published entry, attach it and
+    // pass the entry to the callback again; one coroutine per clipboard
+    // event, resumed on a worker
+    CoTask<void> CaptureContext(ClipboardEntry entry, TaskPriority priority);
     
     // Get current clipboard content
     bool GetClipboardContent(ClipboardEntry& entry);
     
-    // Get source application info
+    // Foreground window changed: prefetch its context
+    void OnForegroundChanged(HWND hwnd);
+
+    // Get source application info (of the foreground window)
     void GetSourceInfo(SourceInfo& info);
+
+    // Get source application info of a window
+    void GetSourceInfo(HWND hwnd, SourceInfo& info);
     
     // Get process name from PID
     std::wstring GetProcessName(DWORD pid);
@@ -99,7 +119,10 @@ private:
     bool m_running;
     ClipboardChangeCallback m_callback;
     DWORD m_lastSequenceNumber;  // To detect actual changes
+    DWORD m_interactiveUntil;    // Tick count until which a capture is interactive
+    uint64_t m_lastEntryId;      // Id of the last captured entry
     std::shared_ptr<ContextManager> m_contextManager;  // Context manager for async context retrieval
+    std::unique_ptr<IForegroundSource> m_foregroundSource;  // Focus changes that trigger prefetches
 
     static const wchar_t* WINDOW_CLASS_NAME;
 };
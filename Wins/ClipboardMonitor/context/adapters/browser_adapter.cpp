@@ -1,13 +1,104 @@
 #include "browser_adapter.h"
 #include "../../utils.h"
 #include "../../debug_log.h"
+#include "../utils/json_reader.h"
+#include "../utils/title_rules.h"
+#include "element_scans.h"
 #include <windows.h>
 #include <chrono>
+#include <fstream>
+#include <iterator>
 #include <sstream>
 
+namespace {
+
+// Explicitly supported browsers (lowercase)
+const wchar_t* const kSupportedBrowsers[] = {
+    // Mainstream browsers
+    L"chrome.exe",
+    L"msedge.exe",
+    L"firefox.exe",
+    L"opera.exe",
+    L"brave.exe",
+    L"vivaldi.exe",
+    L"chromium.exe",
+    L"iexplore.exe",     // Internet Explorer (legacy)
+
+    // AI-powered browsers
+    L"comet.exe",        // Perplexity browser
+    L"atlas.exe",        // ChatGPT browser
+    L"arc.exe",          // Arc browser
+
+    // Chinese browsers (Chromium-based)
+    L"360se.exe",        // 360 Secure Browser
+    L"360chrome.exe",    // 360 Chrome
+    L"qqbrowser.exe",    // QQ Browser
+    L"sogouexplorer.exe", // Sogou Browser
+    L"liebao.exe",       // Liebao Browser
+    L"2345explorer.exe", // 2345 Browser
+    L"maxthon.exe",      // Maxthon Browser
+
+    // Developer browsers
+    L"electron.exe",     // Electron-based apps
+    L"browser.exe",      // Generic browser name
+    L"webbrowser.exe"    // Generic web browser
+};
+
+// browser_context.json older than this belongs to an earlier copy
+const int kExtensionMaxAgeMs = 3000;
+
+// How long to wait for the extension's file to catch up with the clipboard
+const int kExtensionWaitMs = 200;
+const int kExtensionPollMs = 20;
+
+// Age of a file's last write, in milliseconds
+long long GetFileAgeMs(const FILETIME& lastWrite) {
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+
+    ULARGE_INTEGER nowTime;
+    nowTime.LowPart = now.dwLowDateTime;
+    nowTime.HighPart = now.dwHighDateTime;
+    ULARGE_INTEGER writeTime;
+    writeTime.LowPart = lastWrite.dwLowDateTime;
+    writeTime.HighPart = lastWrite.dwHighDateTime;
+
+    // FILETIME counts 100ns intervals
+    return (static_cast<long long>(nowTime.QuadPart) -
+            static_cast<long long>(writeTime.QuadPart)) / 10000;
+}
+
+} // namespace
+
 BrowserAdapter::BrowserAdapter(int timeout)
     : m_timeout(timeout)
 {
+    m_providers.push_back(std::make_shared<ContextProvider>("cf_html", 0.6,
+        [this](const SourceInfo& source, const CancellationToken& token, ContextFields& fields) {
+            (void)source;
+            (void)token;
+            std::wstring sourceUrl = GetUrlFromClipboard();
+            if (!sourceUrl.empty()) {
+                LOG_DEBUG("BrowserAdapter: Got SourceURL from CF_HTML: {}", sourceUrl);
+                fields["url"] = sourceUrl;
+                fields["source_url"] = sourceUrl;
+            }
+        }, true));
+
+    m_providers.push_back(std::make_shared<ContextProvider>("extension", 0.9,
+        [this](const SourceInfo& source, const CancellationToken& token, ContextFields& fields) {
+            ReadExtensionContext(source, token, fields);
+        }, true));
+
+    m_providers.push_back(std::make_shared<ContextProvider>("address_bar", 0.8,
+        [this](const SourceInfo& source, const CancellationToken& token, ContextFields& fields) {
+            std::wstring addressBarUrl = GetUrlFromAddressBar(source.windowHandle, source.processName, token);
+            if (!addressBarUrl.empty()) {
+                LOG_DEBUG("BrowserAdapter: Got URL from address bar: {}", addressBarUrl);
+                fields["url"] = addressBarUrl;
+                fields["address_bar_url"] = addressBarUrl;
+            }
+        }));
 }
 
 bool BrowserAdapter::CanHandle(const std::wstring& processName,
@@ -19,65 +110,45 @@ bool BrowserAdapter::CanHandle(const std::wstring& processName,
     return IsSupportedBrowser(lowerProcessName);
 }
 
-std::shared_ptr<ContextData> BrowserAdapter::GetContext(const SourceInfo& source)
+std::vector<std::wstring> BrowserAdapter::GetProcessNames() const
 {
-    auto startTime = std::chrono::high_resolution_clock::now();
+    return std::vector<std::wstring>(std::begin(kSupportedBrowsers), std::end(kSupportedBrowsers));
+}
 
-    // Create context object
-    auto context = std::make_shared<BrowserContext>();
-    context->adapterType = "browser";
-    context->success = false;
+std::shared_ptr<ContextData> BrowserAdapter::GetContext(const SourceInfo& source,
+                                                        const CancellationToken& token)
+{
+    auto startTime = std::chrono::high_resolution_clock::now();
 
+    std::shared_ptr<ContextData> context;
     try {
-        // Method 1: Try to get URL from CF_HTML in clipboard (fast, fallback)
-        std::wstring sourceUrl = GetUrlFromClipboard();
-        if (!sourceUrl.empty()) {
-            context->sourceUrl = sourceUrl;
-            DEBUG_LOG("BrowserAdapter: Got SourceURL from CF_HTML: " + Utils::WideToUtf8(sourceUrl));
-        }
-
-        // Method 2: Try to get URL from address bar via UI Automation (primary, accurate)
-        std::wstring addressBarUrl = GetUrlFromAddressBar(source.windowHandle, source.processName);
-        if (!addressBarUrl.empty()) {
-            context->addressBarUrl = addressBarUrl;
-            DEBUG_LOG("BrowserAdapter: Got URL from address bar: " + Utils::WideToUtf8(addressBarUrl));
-        }
-
-        // Prioritize address bar URL over CF_HTML URL
-        if (!context->addressBarUrl.empty()) {
-            context->url = context->addressBarUrl;
-        } else if (!context->sourceUrl.empty()) {
-            context->url = context->sourceUrl;
-            DEBUG_LOG("BrowserAdapter: Using CF_HTML URL as fallback");
-        }
-
-        // Extract page title from window title
-        if (!source.windowTitle.empty()) {
-            context->pageTitle = ExtractPageTitle(source.windowTitle, source.processName);
-            context->title = context->pageTitle;
+        // One provider at a time; stops at the first URL
+        ContextMerge merge(GetRequiredFields(), m_providers.size());
+        for (const auto& provider : m_providers) {
+            ContextFields fields;
+            if (!token.IsCancelled()) {
+                provider->Provide(source, token, fields);
+            }
+            if (merge.Add(*provider, std::move(fields))) {
+                break;
+            }
         }
 
-        // Check if we got any URL
-        if (!context->url.empty()) {
-            context->success = true;
-
-            // Add metadata
-            context->metadata[L"browser_type"] = source.processName;
-            context->metadata[L"has_address_bar_url"] = context->addressBarUrl.empty() ? L"false" : L"true";
-            context->metadata[L"has_source_url"] = context->sourceUrl.empty() ? L"false" : L"true";
-        } else {
-            context->error = L"Failed to extract URL from both CF_HTML and address bar";
-            DEBUG_LOG("BrowserAdapter: Failed to get URL from any source");
+        context = BuildContext(source, merge);
+        if (!context->success && token.IsCancelled()) {
+            context->error = L"Cancelled";
+            LOG_DEBUG("BrowserAdapter: Cancelled before finding a URL");
         }
-
     } catch (const std::exception& ex) {
+        context = std::make_shared<BrowserContext>();
         context->success = false;
         context->error = L"Exception: " + Utils::Utf8ToWide(ex.what());
-        DEBUG_LOG("BrowserAdapter: Exception: " + std::string(ex.what()));
+        LOG_ERROR("BrowserAdapter: Exception: {}", ex.what());
     } catch (...) {
+        context = std::make_shared<BrowserContext>();
         context->success = false;
         context->error = L"Unknown exception";
-        DEBUG_LOG("BrowserAdapter: Unknown exception");
+        LOG_ERROR("BrowserAdapter: Unknown exception");
     }
 
     // Calculate fetch time
@@ -86,19 +157,72 @@ std::shared_ptr<ContextData> BrowserAdapter::GetContext(const SourceInfo& source
         std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count()
     );
 
-    DEBUG_LOG("BrowserAdapter: Completed in " + std::to_string(context->fetchTimeMs) + "ms, success=" +
-              (context->success ? "true" : "false"));
+    LOG_EVENT(AdapterCompleted, "BrowserAdapter", context->fetchTimeMs, context->success);
 
     return context;
 }
 
+std::shared_ptr<ContextData> BrowserAdapter::BuildContext(const SourceInfo& source,
+                                                          const ContextMerge& merge)
+{
+    auto context = std::make_shared<BrowserContext>();
+    context->url = merge.Get("url");
+    context->sourceUrl = merge.Get("source_url");
+    context->addressBarUrl = merge.Get("address_bar_url");
+
+    // Page title from the extension, else from the window title
+    context->pageTitle = merge.Get("page_title");
+    if (context->pageTitle.empty() && !source.windowTitle.empty()) {
+        context->pageTitle = ExtractPageTitle(source.windowTitle, source.processName);
+    }
+    context->title = context->pageTitle;
+
+    // Check if we got any URL
+    if (!context->url.empty()) {
+        context->success = true;
+
+        // Add metadata
+        context->metadata[L"browser_type"] = source.processName;
+        context->metadata[L"has_address_bar_url"] = context->addressBarUrl.empty() ? L"false" : L"true";
+        context->metadata[L"has_source_url"] = context->sourceUrl.empty() ? L"false" : L"true";
+        context->metadata[L"url_source"] = Utils::Utf8ToWide(merge.GetSource("url"));
+
+        std::wstring description = merge.Get("description");
+        if (!description.empty()) {
+            context->metadata[L"description"] = description;
+        }
+    } else {
+        context->success = false;
+        context->error = L"Failed to extract URL from CF_HTML, extension and address bar";
+        LOG_WARN("BrowserAdapter: Failed to get URL from any source");
+    }
+
+    return context;
+}
+
+std::shared_ptr<ContextData> BrowserAdapter::GetQuickContext(const SourceInfo& source)
+{
+    auto context = std::make_shared<BrowserContext>();
+    if (!source.windowTitle.empty()) {
+        context->pageTitle = ExtractPageTitle(source.windowTitle, source.processName);
+        context->title = context->pageTitle;
+    }
+
+    // A title is enough to show where the copy came from; the URL follows
+    context->success = !context->title.empty();
+    if (context->success) {
+        context->metadata[L"browser_type"] = source.processName;
+    }
+    return context;
+}
+
 std::wstring BrowserAdapter::GetUrlFromClipboard()
 {
     std::wstring result;
 
     // Open clipboard
     if (!OpenClipboard(nullptr)) {
-        DEBUG_LOG("BrowserAdapter: Failed to open clipboard for CF_HTML");
+        LOG_WARN("BrowserAdapter: Failed to open clipboard for CF_HTML");
         return result;
     }
 
@@ -106,7 +230,7 @@ std::wstring BrowserAdapter::GetUrlFromClipboard()
     UINT htmlFormat = RegisterClipboardFormatW(L"HTML Format");
     if (htmlFormat == 0) {
         CloseClipboard();
-        DEBUG_LOG("BrowserAdapter: Failed to register CF_HTML format");
+        LOG_WARN("BrowserAdapter: Failed to register CF_HTML format");
         return result;
     }
 
@@ -121,7 +245,7 @@ std::wstring BrowserAdapter::GetUrlFromClipboard()
     HANDLE hData = GetClipboardData(htmlFormat);
     if (hData == nullptr) {
         CloseClipboard();
-        DEBUG_LOG("BrowserAdapter: Failed to get CF_HTML data");
+        LOG_WARN("BrowserAdapter: Failed to get CF_HTML data");
         return result;
     }
 
@@ -135,7 +259,7 @@ std::wstring BrowserAdapter::GetUrlFromClipboard()
                 result = htmlData.sourceUrl;
             }
         } catch (...) {
-            DEBUG_LOG("BrowserAdapter: Exception while parsing CF_HTML");
+            LOG_ERROR("BrowserAdapter: Exception while parsing CF_HTML");
         }
 
         GlobalUnlock(hData);
@@ -145,173 +269,132 @@ std::wstring BrowserAdapter::GetUrlFromClipboard()
     return result;
 }
 
-std::wstring BrowserAdapter::GetUrlFromAddressBar(HWND hwnd, const std::wstring& processName)
+std::wstring BrowserAdapter::GetUrlFromAddressBar(HWND hwnd, const std::wstring& processName,
+                                                  const CancellationToken& token)
 {
     std::wstring result;
 
     if (hwnd == nullptr) {
-        DEBUG_LOG("BrowserAdapter: Invalid HWND for UI Automation");
+        LOG_WARN("BrowserAdapter: Invalid HWND for UI Automation");
         return result;
     }
 
     try {
         // Create UI Automation helper (initializes COM in this thread)
-        UIAutomationHelper uiHelper;
+        UIAutomationHelper uiHelper(token);
         if (!uiHelper.Initialize()) {
-            DEBUG_LOG("BrowserAdapter: Failed to initialize UI Automation");
+            LOG_WARN("BrowserAdapter: Failed to initialize UI Automation");
             return result;
         }
 
-        // Strategy: Try multiple approaches to find address bar
-
-        // Approach 1: Try browser-specific Automation ID
-        std::wstring automationId = GetAddressBarAutomationId(processName);
-        if (!automationId.empty()) {
-            IUIAutomationElement* element = uiHelper.FindElementByAutomationId(hwnd, automationId);
-            if (element) {
-                result = uiHelper.GetElementValue(element);
-                element->Release();
-
-                if (!result.empty()) {
-                    DEBUG_LOG("BrowserAdapter: Found address bar by Automation ID: " + Utils::WideToUtf8(automationId));
-                    return result;
-                }
-            }
-        }
-
-        // Approach 2: Search for Edit control (Chrome, Edge use Edit for address bar)
-        IUIAutomationElement* element = uiHelper.FindElementByControlType(hwnd, L"Edit");
-        if (element) {
-            result = uiHelper.GetElementValue(element);
-            element->Release();
-
+        // Automation ID, then Edit, then ComboBox (element_scans.h)
+        AccessibleElementPtr window = uiHelper.GetWindowElement(hwnd);
+        if (window) {
+            result = BrowserScan::FindAddressBarUrl(*window, GetAddressBarAutomationId(processName),
+                                                    uiHelper.GetToken());
             if (!result.empty()) {
-                // Validate that this looks like a URL (basic heuristic)
-                if (result.find(L"://") != std::wstring::npos ||
-                    result.find(L"www.") != std::wstring::npos ||
-                    result.find(L"http") != std::wstring::npos) {
-                    DEBUG_LOG("BrowserAdapter: Found address bar by Edit control type");
-                    return result;
-                }
+                LOG_DEBUG("BrowserAdapter: Found address bar: {}", result);
+                return result;
             }
         }
 
-        // Approach 3: Search for ComboBox (some browsers use ComboBox for address bar)
-        element = uiHelper.FindElementByControlType(hwnd, L"ComboBox");
-        if (element) {
-            result = uiHelper.GetElementValue(element);
-            element->Release();
-
-            if (!result.empty()) {
-                // Validate URL pattern
-                if (result.find(L"://") != std::wstring::npos ||
-                    result.find(L"www.") != std::wstring::npos ||
-                    result.find(L"http") != std::wstring::npos) {
-                    DEBUG_LOG("BrowserAdapter: Found address bar by ComboBox control type");
-                    return result;
-                }
-            }
+        if (!uiHelper.IsCancelled()) {
+            LOG_WARN("BrowserAdapter: Could not find address bar using any approach");
         }
 
-        DEBUG_LOG("BrowserAdapter: Could not find address bar using any approach");
-
     } catch (const std::exception& ex) {
-        DEBUG_LOG("BrowserAdapter: Exception in GetUrlFromAddressBar: " + std::string(ex.what()));
+        LOG_ERROR("BrowserAdapter: Exception in GetUrlFromAddressBar: {}", ex.what());
     } catch (...) {
-        DEBUG_LOG("BrowserAdapter: Unknown exception in GetUrlFromAddressBar");
+        LOG_ERROR("BrowserAdapter: Unknown exception in GetUrlFromAddressBar");
     }
 
     return result;
 }
 
-std::wstring BrowserAdapter::ExtractPageTitle(const std::wstring& windowTitle,
-                                              const std::wstring& processName)
+void BrowserAdapter::ReadExtensionContext(const SourceInfo& source, const CancellationToken& token,
+                                          ContextFields& fields)
 {
-    if (windowTitle.empty()) {
-        return windowTitle;
-    }
+    std::wstring path = Utils::GetAppDataPath() + L"\\browser_context.json";
+    std::wstring pageTitle = ExtractPageTitle(source.windowTitle, source.processName);
+    auto waitUntil = std::chrono::steady_clock::now() + std::chrono::milliseconds(kExtensionWaitMs);
+
+    while (true) {
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &attributes)) {
+            return;   // Extension (native host) not installed
+        }
 
-    std::wstring lowerProcessName = Utils::ToLower(processName);
+        // Fresh and for this tab; a failed parse may be a file mid-write
+        if (GetFileAgeMs(attributes.ftLastWriteTime) <= kExtensionMaxAgeMs) {
+            ContextFields parsed;
+            if (ParseExtensionContext(path, pageTitle, parsed)) {
+                LOG_DEBUG("BrowserAdapter: Got context from browser extension");
+                fields = std::move(parsed);
+                return;
+            }
+        }
 
-    // Browser-specific title patterns:
-    // Most browsers use: "Page Title - Browser Name"
-    std::vector<std::wstring> suffixes = {
-        // Mainstream browsers
-        L" - Google Chrome",
-        L" - Microsoft Edge",
-        L" - Mozilla Firefox",
-        L" - Opera",
-        L" - Brave",
-        L" - Vivaldi",
-        L" - Chromium",
-
-        // AI-powered browsers
-        L" - Comet",         // Perplexity
-        L" - Atlas",         // ChatGPT browser
-        L" - Arc",
-
-        // Chinese browsers (English names)
-        L" - 360 Secure Browser",
-        L" - 360 Chrome",
-        L" - QQ Browser",
-        L" - Sogou Browser",
-        L" - Liebao Browser",
-        L" - 2345 Browser",
-        L" - Maxthon",
-
-        // Generic patterns
-        L" - Browser",
-        L" - Web Browser"
-    };
-
-    // Try to remove browser suffix
-    for (const auto& suffix : suffixes) {
-        size_t pos = windowTitle.rfind(suffix);
-        if (pos != std::wstring::npos) {
-            // Found suffix, extract title before it
-            return windowTitle.substr(0, pos);
+        if (token.IsCancelled() || std::chrono::steady_clock::now() >= waitUntil) {
+            return;
         }
+        Sleep(kExtensionPollMs);
+    }
+}
+
+bool BrowserAdapter::ParseExtensionContext(const std::wstring& path, const std::wstring& pageTitle,
+                                           ContextFields& fields)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    JsonValue root;
+    if (!JsonReader::Parse(text, root)) {
+        return false;
+    }
+
+    // content.js sends {timestamp, page, selection, visibleContext};
+    // background.js adds tabId, tabUrl, tabTitle, windowId, incognito.
+    // Only page-level fields are taken: the context is cached per tab, and
+    // the selection is the copied text itself.
+    const JsonValue* page = root.Find("page");
+    std::string url = root.GetString("tabUrl", page ? page->GetString("url") : std::string());
+    std::string title = root.GetString("tabTitle", page ? page->GetString("title") : std::string());
+    if (url.empty()) {
+        return false;
+    }
+
+    // Written for a copy in another tab or window
+    std::wstring tabTitle = Utils::Utf8ToWide(title);
+    if (!pageTitle.empty() && !tabTitle.empty() && tabTitle != pageTitle) {
+        return false;
     }
 
-    // If no pattern matched, return original title
-    return windowTitle;
+    fields["url"] = Utils::Utf8ToWide(url);
+    fields["page_title"] = tabTitle;
+    if (page) {
+        std::string description = page->GetString("description", page->GetString("ogDescription"));
+        fields["description"] = Utils::Utf8ToWide(description);
+    }
+    return true;
+}
+
+std::wstring BrowserAdapter::ExtractPageTitle(const std::wstring& windowTitle,
+                                              const std::wstring& processName)
+{
+    (void)processName;  // Suffixes are the same for every browser
+
+    // "Page Title - Browser Name"; the browser suffixes are title rules
+    // (utils/title_rules.h), matched in one pass. No match: whole title.
+    return TitleRules::Instance().Parse("browser", windowTitle).Get("page_title");
 }
 
 bool BrowserAdapter::IsSupportedBrowser(const std::wstring& processName)
 {
-    // List of explicitly supported browsers (lowercase)
-    std::vector<std::wstring> supportedBrowsers = {
-        // Mainstream browsers
-        L"chrome.exe",
-        L"msedge.exe",
-        L"firefox.exe",
-        L"opera.exe",
-        L"brave.exe",
-        L"vivaldi.exe",
-        L"chromium.exe",
-        L"iexplore.exe",     // Internet Explorer (legacy)
-
-        // AI-powered browsers
-        L"comet.exe",        // Perplexity browser
-        L"atlas.exe",        // ChatGPT browser
-        L"arc.exe",          // Arc browser
-
-        // Chinese browsers (Chromium-based)
-        L"360se.exe",        // 360 Secure Browser
-        L"360chrome.exe",    // 360 Chrome
-        L"qqbrowser.exe",    // QQ Browser
-        L"sogouexplorer.exe", // Sogou Browser
-        L"liebao.exe",       // Liebao Browser
-        L"2345explorer.exe", // 2345 Browser
-        L"maxthon.exe",      // Maxthon Browser
-
-        // Developer browsers
-        L"electron.exe",     // Electron-based apps
-        L"browser.exe",      // Generic browser name
-        L"webbrowser.exe"    // Generic web browser
-    };
-
-    for (const auto& browser : supportedBrowsers) {
+
+    for (const wchar_t* browser : kSupportedBrowsers) {
         if (processName == browser) {
             return true;
         }
@@ -323,7 +406,7 @@ bool BrowserAdapter::IsSupportedBrowser(const std::wstring& processName)
         processName.find(L"chrome") != std::wstring::npos ||
         processName.find(L"web") != std::wstring::npos ||
         processName.find(L"edge") != std::wstring::npos) {
-        DEBUG_LOG("BrowserAdapter: Heuristic match for potential browser: " + Utils::WideToUtf8(processName));
+        LOG_DEBUG("BrowserAdapter: Heuristic match for potential browser: {}", processName);
         return true;
     }
 
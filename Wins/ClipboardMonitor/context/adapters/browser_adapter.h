@@ -11,13 +11,16 @@
  * Captures context when copying from web browsers.
  * Supports: Chrome, Edge, Firefox, Opera, Brave, Vivaldi
  *
- * Two-method approach:
- * 1. Primary: UI Automation to get address bar URL (accurate, current page)
- * 2. Fallback: Parse CF_HTML from clipboard to get SourceURL (may be stale)
+ * Three independent sources, run concurrently by ContextManager as
+ * providers (see GetProviders); the first URL found completes the fetch:
+ * 1. "extension": browser_context.json written by the browser extension's
+ *    native host (URL, title, description; most reliable when present)
+ * 2. "address_bar": UI Automation on the address bar (accurate, slowest)
+ * 3. "cf_html": SourceURL in the clipboard's CF_HTML (fast, HTML copies only)
  *
  * Phase 1 Features (Current):
- * - URL extraction (address bar or CF_HTML)
- * - Page title extraction (window title or CF_HTML)
+ * - URL extraction (extension, address bar or CF_HTML)
+ * - Page title extraction (window title or extension)
  * - Performance metrics (fetch time)
  *
  * Phase 2 Features (Future - requires browser extension):
@@ -57,20 +60,68 @@ public:
     bool CanHandle(const std::wstring& processName,
                   const std::wstring& windowTitle) override;
 
+    /**
+     * @brief Get process names handled by this adapter
+     *
+     * Explicitly supported browsers; other names go through the
+     * "browser"/"chrome"/"web"/"edge" heuristic in CanHandle.
+     *
+     * @return Lowercase process names (e.g., L"chrome.exe")
+     */
+    std::vector<std::wstring> GetProcessNames() const override;
+
     /**
      * @brief Get browser context
      *
-     * Execution flow:
-     * 1. Try to get URL from CF_HTML in clipboard (fast, may be stale)
-     * 2. Try to get URL from address bar via UI Automation (accurate, current)
-     * 3. Prioritize address bar URL over CF_HTML URL
-     * 4. Extract page title from window title or CF_HTML
-     * 5. Record fetch time for performance monitoring
+     * Runs the providers one after the other, cheapest first, and stops
+     * at the first URL. ContextManager runs them concurrently instead.
      *
      * @param source Source information (HWND, process name, window title)
+     * @param token Cancelled on timeout; address bar search stops early
      * @return BrowserContext with URL and title, or error on failure
      */
-    std::shared_ptr<ContextData> GetContext(const SourceInfo& source) override;
+    std::shared_ptr<ContextData> GetContext(const SourceInfo& source,
+                                            const CancellationToken& token) override;
+
+    /**
+     * @brief Get the title-only context
+     *
+     * Page title from the window title; no URL (that needs CF_HTML or
+     * the address bar).
+     *
+     * @param source Source information (window title, process name)
+     * @return Partial BrowserContext
+     */
+    std::shared_ptr<ContextData> GetQuickContext(const SourceInfo& source) override;
+
+    /**
+     * @brief Get the context providers
+     *
+     * Confidence decides which URL is kept when several report one:
+     * extension (0.9) over address bar (0.8) over CF_HTML (0.6). The
+     * extension and CF_HTML describe the copy itself, so prefetches on a
+     * focus change run only the address bar.
+     *
+     * @return The "cf_html", "extension" and "address_bar" providers
+     */
+    std::vector<std::shared_ptr<ContextProvider>> GetProviders() override { return m_providers; }
+
+    /**
+     * @brief Get the fields that complete a fetch
+     *
+     * @return {"url"}
+     */
+    std::vector<std::string> GetRequiredFields() const override { return {"url"}; }
+
+    /**
+     * @brief Build the browser context from merged provider fields
+     *
+     * @param source Source information (window title for the page title)
+     * @param merge Merged fields; "url_source" metadata names the winner
+     * @return BrowserContext, failed if no provider found a URL
+     */
+    std::shared_ptr<ContextData> BuildContext(const SourceInfo& source,
+                                              const ContextMerge& merge) override;
 
     /**
      * @brief Get adapter timeout
@@ -79,6 +130,15 @@ public:
      */
     int GetTimeout() const override { return m_timeout; }
 
+    /**
+     * @brief Get cache policy
+     *
+     * The tab URL and title only change with the window title (a new key).
+     *
+     * @return 10s fresh, served stale for another 60s, 32 windows
+     */
+    ContextCachePolicy GetCachePolicy() const override { return {10000, 60000, 32}; }
+
     /**
      * @brief Get adapter name
      *
@@ -122,9 +182,37 @@ private:
      *
      * @param hwnd Window handle of the browser
      * @param processName Process name (for browser-specific logic)
+     * @param token Cancellation token of the current fetch
      * @return Current URL from address bar, or empty if not found
      */
-    std::wstring GetUrlFromAddressBar(HWND hwnd, const std::wstring& processName);
+    std::wstring GetUrlFromAddressBar(HWND hwnd, const std::wstring& processName,
+                                      const CancellationToken& token);
+
+    /**
+     * @brief Read the browser extension's context for this copy
+     *
+     * The native host rewrites browser_context.json on every copy in a
+     * page, usually a little after the clipboard update, so the file is
+     * polled briefly. It is used only if it was written in the last few
+     * seconds and its tab title matches the window's page title.
+     *
+     * @param source Source information (window title, process name)
+     * @param token Cancellation token of the current fetch
+     * @param fields Output: url, page_title, description
+     */
+    void ReadExtensionContext(const SourceInfo& source, const CancellationToken& token,
+                              ContextFields& fields);
+
+    /**
+     * @brief Parse browser_context.json
+     *
+     * @param path File path
+     * @param pageTitle Expected page title (empty: do not check)
+     * @param fields Output: fields from the file
+     * @return true if the file parsed, matched and has a URL
+     */
+    bool ParseExtensionContext(const std::wstring& path, const std::wstring& pageTitle,
+                               ContextFields& fields);
 
     /**
      * @brief Extract page title from window title
@@ -164,4 +252,5 @@ private:
     std::wstring GetAddressBarAutomationId(const std::wstring& processName);
 
     int m_timeout;  // Timeout in milliseconds
+    std::vector<std::shared_ptr<ContextProvider>> m_providers;  // Cheapest first
 };
@@ -0,0 +1,329 @@
+#include "element_scans.h"
+#include "../utils/accessible_search.h"
+#include <algorithm>
+
+namespace {
+
+// Strip heights at 100% scaling; AccessibleSearch widens them on tall windows
+constexpr long kHeaderHeight = 64;       // WeChat chat header
+constexpr long kStatusBarHeight = 48;    // VS Code status bar
+
+// Text elements in the top or bottom strip of the window, found by a
+// budgeted search; the whole window if it reports no bounds
+AccessibleSearchOptions TextsInStrip(IAccessibleElement& window, bool top, long height) {
+    AccessibleSearchOptions options;
+    options.query.controlType = AccessibleControlType::Text;
+    const AccessibleRect& bounds = window.GetProperties().rect;
+    if (bounds.Width() > 0 && bounds.Height() > 0) {
+        options.hasRegion = true;
+        options.region = top ? AccessibleSearch::TopStrip(bounds, height)
+                             : AccessibleSearch::BottomStrip(bounds, height);
+    }
+    return options;
+}
+
+// What the scans look for
+bool IsChatName(const AccessibleProperties& properties) {
+    // Chat names are short; skip the app's own labels (U+5FAE U+4FE1 = 微信)
+    const std::wstring& text = properties.name;
+    return text.length() > 1 && text.length() < 100 &&
+           text.find(L"WeChat") == std::wstring::npos &&
+           text.find(L"\u5FAE\u4FE1") == std::wstring::npos;
+}
+
+// Checked again on every path cache hit of the message list
+bool IsWideList(const AccessibleProperties& properties) {
+    return properties.rect.Width() > 200;
+}
+
+bool IsPathText(const AccessibleProperties& properties) {
+    const std::wstring& text = properties.name;
+    bool pathLike = text.find(L":\\") != std::wstring::npos ||   // Windows absolute path
+                    text.find(L'/') != std::wstring::npos ||     // Unix path
+                    text.find(L'\\') != std::wstring::npos;      // Windows path
+    // Very long text is probably not a path
+    return pathLike && text.length() < 300;
+}
+
+bool IsCursorText(const AccessibleProperties& properties) {
+    int line = 0;
+    int column = 0;
+    return VSCodeScan::ParseCursorPosition(properties.name, line, column);
+}
+
+// Message list heuristic (see WeChatScan::FindMessageList)
+AccessibleElementPtr SelectMessageList(IAccessibleElement& window, const CancellationToken& token,
+                                       std::vector<AccessibleElementPtr>& items) {
+    // One call: every list with its bounds and its items (with theirs)
+    AccessibleQuery query;
+    query.controlType = AccessibleControlType::List;
+    std::vector<AccessibleElementPtr> lists =
+        window.FindAll(AccessibleScope::Descendants, query, AccessibleCache::Children);
+    size_t candidates = std::min<size_t>(lists.size(), 10);
+
+    // Not the first list (conversations), wide, with the most items
+    AccessibleElementPtr best;
+    std::vector<AccessibleElementPtr> bestItems;
+    for (size_t i = 1; i < candidates && !token.IsCancelled(); i++) {
+        if (!IsWideList(lists[i]->GetProperties())) {
+            continue;
+        }
+        std::vector<AccessibleElementPtr> children = lists[i]->GetChildren();   // Cached
+        if (children.size() > bestItems.size()) {
+            best = lists[i];
+            bestItems = std::move(children);
+        }
+    }
+
+    // Else the rightmost wide list
+    if (!best && lists.size() > 1) {
+        long maxLeft = 0;
+        for (size_t i = 0; i < candidates && !token.IsCancelled(); i++) {
+            const AccessibleProperties& properties = lists[i]->GetProperties();
+            if (properties.rect.left > maxLeft && IsWideList(properties)) {
+                maxLeft = properties.rect.left;
+                best = lists[i];
+            }
+        }
+        if (best && !token.IsCancelled()) {
+            bestItems = best->GetChildren();
+        }
+    }
+
+    items = std::move(bestItems);
+    return best;
+}
+
+// First Text element of the strip passing the check. Not through the path
+// cache: the strip search takes two calls, about what walking a path
+// to the element would
+AccessibleElementPtr FindStripText(IAccessibleElement& window, bool top, long height,
+                                   bool (*check)(const AccessibleProperties&),
+                                   const CancellationToken& token) {
+    AccessibleSearchOptions options = TextsInStrip(window, top, height);
+    options.predicate = check;
+    return AccessibleSearch::FindFirst(window, options, token);
+}
+
+// Names of the elements of a control type, in tree order (one call)
+template <typename Visitor>
+void ForEachName(IAccessibleElement& window, int controlType,
+                 const CancellationToken& token, Visitor visit) {
+    AccessibleQuery query;
+    query.controlType = controlType;
+    std::vector<AccessibleElementPtr> elements =
+        window.FindAll(AccessibleScope::Descendants, query, AccessibleCache::Properties);
+
+    for (size_t i = 0; i < elements.size() && !token.IsCancelled(); i++) {
+        if (!visit(elements[i]->GetProperties().name)) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// Browser
+// ============================================================================
+
+std::wstring BrowserScan::FindAddressBarUrl(IAccessibleElement& window, const std::wstring& automationId,
+                                            const CancellationToken& token) {
+    // Approach 1: browser-specific Automation ID
+    if (!automationId.empty() && !token.IsCancelled()) {
+        AccessibleQuery query;
+        query.automationId = automationId;
+        AccessibleElementPtr element =
+            window.FindFirst(AccessibleScope::Descendants, query, AccessibleCache::None);
+        if (element) {
+            std::wstring value = element->GetValue();
+            if (!value.empty()) {
+                return value;
+            }
+        }
+    }
+
+    // Approach 2: Edit (Chrome, Edge); approach 3: ComboBox (some others)
+    for (int controlType : {AccessibleControlType::Edit, AccessibleControlType::ComboBox}) {
+        if (token.IsCancelled()) {
+            break;
+        }
+        AccessibleQuery query;
+        query.controlType = controlType;
+        AccessibleElementPtr element =
+            window.FindFirst(AccessibleScope::Descendants, query, AccessibleCache::None);
+        if (!element) {
+            continue;
+        }
+        std::wstring value = element->GetValue();
+        if (value.find(L"://") != std::wstring::npos ||
+            value.find(L"www.") != std::wstring::npos ||
+            value.find(L"http") != std::wstring::npos) {
+            return value;
+        }
+    }
+    return L"";
+}
+
+// ============================================================================
+// WeChat
+// ============================================================================
+
+std::wstring WeChatScan::FindChatName(IAccessibleElement& window, const CancellationToken& token) {
+    AccessibleElementPtr element = FindStripText(window, true, kHeaderHeight, IsChatName, token);
+    return element ? element->GetProperties().name : L"";
+}
+
+AccessibleElementPtr WeChatScan::FindMessageList(IAccessibleElement& window,
+                                                 const CancellationToken& token,
+                                                 std::vector<AccessibleElementPtr>* items,
+                                                 const ElementPathScope& paths) {
+    if (token.IsCancelled()) {
+        return nullptr;
+    }
+
+    // The heuristic runs once per window; later copies follow the remembered path
+    std::vector<AccessibleElementPtr> listItems;
+    bool searched = false;
+    AccessibleElementPtr list = paths.Find(window, "wechat.message_list", IsWideList, [&]() {
+        searched = true;
+        return SelectMessageList(window, token, listItems);
+    }, token);
+
+    if (items) {
+        if (list && !searched && !token.IsCancelled()) {
+            listItems = list->GetChildren();
+        }
+        *items = std::move(listItems);
+    }
+    return list;
+}
+
+std::vector<std::wstring> WeChatScan::FindRecentMessages(IAccessibleElement& window, int count,
+                                                         const CancellationToken& token,
+                                                         const ElementPathScope& paths) {
+    std::vector<std::wstring> messages;
+    if (count <= 0) {
+        return messages;
+    }
+
+    std::vector<AccessibleElementPtr> items;
+    if (!FindMessageList(window, token, &items, paths)) {
+        return messages;
+    }
+
+    // Last N items are the most recent messages
+    size_t start = items.size() > static_cast<size_t>(count) ? items.size() - count : 0;
+    for (size_t i = start; i < items.size() && !token.IsCancelled(); i++) {
+        std::wstring text = ExtractMessageText(*items[i], token);
+        if (!text.empty()) {
+            messages.push_back(text);
+        }
+    }
+    return messages;
+}
+
+std::wstring WeChatScan::ExtractMessageText(IAccessibleElement& message,
+                                            const CancellationToken& token) {
+    // The item's name usually is the message text
+    const std::wstring& name = message.GetProperties().name;
+    if (!name.empty()) {
+        return name;
+    }
+
+    // Else the first few descendants' names
+    std::vector<AccessibleElementPtr> parts =
+        message.FindAll(AccessibleScope::Descendants, AccessibleQuery(), AccessibleCache::Properties);
+    std::wstring combined;
+    size_t count = std::min<size_t>(parts.size(), 5);
+    for (size_t i = 0; i < count && !token.IsCancelled(); i++) {
+        const std::wstring& text = parts[i]->GetProperties().name;
+        if (!text.empty()) {
+            if (!combined.empty()) {
+                combined += L" ";
+            }
+            combined += text;
+        }
+    }
+    return combined;
+}
+
+// ============================================================================
+// VS Code
+// ============================================================================
+
+std::wstring VSCodeScan::FindFilePath(IAccessibleElement& window, const CancellationToken& token) {
+    AccessibleElementPtr element = FindStripText(window, false, kStatusBarHeight, IsPathText, token);
+    return element ? element->GetProperties().name : L"";
+}
+
+void VSCodeScan::FindCursorPosition(IAccessibleElement& window, const CancellationToken& token,
+                                    int& lineNumber, int& columnNumber) {
+    lineNumber = 0;
+    columnNumber = 0;
+
+    AccessibleElementPtr element = FindStripText(window, false, kStatusBarHeight, IsCursorText, token);
+    if (element) {
+        ParseCursorPosition(element->GetProperties().name, lineNumber, columnNumber);
+    }
+}
+
+bool VSCodeScan::ParseCursorPosition(const std::wstring& text, int& lineNumber, int& columnNumber) {
+    size_t lnPos = text.find(L"Ln ");
+    size_t colPos = text.find(L"Col ");
+    if (lnPos == std::wstring::npos || colPos == std::wstring::npos) {
+        return false;
+    }
+
+    try {
+        // "Ln 42, Col 15"
+        size_t lnStart = lnPos + 3;
+        size_t lnEnd = text.find(L',', lnStart);
+        if (lnEnd != std::wstring::npos) {
+            lineNumber = std::stoi(text.substr(lnStart, lnEnd - lnStart));
+        }
+
+        size_t colStart = colPos + 4;
+        size_t colEnd = text.find_first_not_of(L"0123456789", colStart);
+        columnNumber = std::stoi(text.substr(colStart, colEnd - colStart));
+    } catch (...) {
+        // Keep what parsed; the element was still the cursor position
+    }
+    return true;
+}
+
+// ============================================================================
+// Notion
+// ============================================================================
+
+std::vector<std::wstring> NotionScan::FindBreadcrumbs(IAccessibleElement& window,
+                                                      const CancellationToken& token) {
+    std::vector<std::wstring> breadcrumbs;
+    if (token.IsCancelled()) {
+        return breadcrumbs;
+    }
+
+    ForEachName(window, AccessibleControlType::Hyperlink, token, [&](const std::wstring& text) {
+        // Skip navigation, accessibility skip links and plain URLs
+        if (!text.empty() && text.length() < 100 &&
+            text != L"Back" && text != L"Forward" &&
+            text != L"Share" && text != L"Updates" &&
+            text != L"Skip to content" &&
+            text.find(L"http") == std::wstring::npos) {
+            breadcrumbs.push_back(text);
+        }
+        return breadcrumbs.size() < 10;
+    });
+
+    // Some layouts render the path as buttons instead
+    if (breadcrumbs.empty() && !token.IsCancelled()) {
+        ForEachName(window, AccessibleControlType::Button, token, [&](const std::wstring& text) {
+            if (!text.empty() && text.length() < 100 &&
+                (text.find(L'>') != std::wstring::npos || text.find(L'/') != std::wstring::npos)) {
+                breadcrumbs.push_back(text);
+            }
+            return breadcrumbs.size() < 10;
+        });
+    }
+    return breadcrumbs;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "../cancellation_token.h"
+#include "../utils/accessible_tree.h"
+#include "../utils/element_path_cache.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Element scans of the browser adapter (address bar)
+ *
+ * Tree heuristics only, over the IAccessibleElement interface: the adapter
+ * runs them on the live window (UIAutomationHelper::GetWindowElement), and
+ * tools/tree_bench on recorded or synthetic trees. Free of Windows headers.
+ *
+ * Searches fetch the properties they read in the same call
+ * (AccessibleCache), so a scan costs a few calls whatever the tree size.
+ * WeChatScan::FindMessageList takes an ElementPathScope: it looks the list
+ * up through the window's remembered path first and searches only when it
+ * no longer fits. The strip searches do not, as following a path costs
+ * about as many calls as they do.
+ * Every scan stops once the token is cancelled and returns what it has.
+ */
+class BrowserScan {
+public:
+    /**
+     * @brief Find the URL in the address bar
+     *
+     * The value of the element with the browser's address bar Automation ID;
+     * else of the first Edit, then the first ComboBox, if it looks like a URL.
+     *
+     * @param window Browser window
+     * @param automationId Address bar Automation ID, or empty if the browser has none
+     * @param token Cancellation token of the fetch
+     * @return URL, or empty if not found
+     */
+    static std::wstring FindAddressBarUrl(IAccessibleElement& window, const std::wstring& automationId,
+                                          const CancellationToken& token);
+};
+
+/**
+ * @brief Element scans of the WeChat adapter
+ */
+class WeChatScan {
+public:
+    /**
+     * @brief Find the current chat name
+     *
+     * The first Text element in the top strip of the window (the chat
+     * header) that looks like a name: 2-99 characters, not the app's own
+     * "WeChat" / "微信" labels. Budgeted search (AccessibleSearch).
+     *
+     * @param window WeChat main window
+     * @param token Cancellation token of the fetch
+     * @return Chat name, or empty if none found
+     */
+    static std::wstring FindChatName(IAccessibleElement& window, const CancellationToken& token);
+
+    /**
+     * @brief Find the message list
+     *
+     * The left List is the conversation list; the message area is the List
+     * (among the first ten, not the first) wider than 200 px with the most
+     * items, else the rightmost List wider than 200 px. One call: the lists
+     * come with their bounds and items. With a path cache this runs once
+     * per window; later lookups follow the path and read the items.
+     *
+     * @param window WeChat main window
+     * @param token Cancellation token of the fetch
+     * @param items Output (optional): the list's items
+     * @param paths Path cache of the window (optional)
+     * @return Message list, or nullptr if none found
+     */
+    static AccessibleElementPtr FindMessageList(IAccessibleElement& window,
+                                                const CancellationToken& token,
+                                                std::vector<AccessibleElementPtr>* items = nullptr,
+                                                const ElementPathScope& paths = ElementPathScope());
+
+    /**
+     * @brief Get the most recent messages
+     *
+     * @param window WeChat main window
+     * @param count Number of messages (the last items of the message list)
+     * @param token Cancellation token of the fetch
+     * @param paths Path cache of the window (optional)
+     * @return Message texts, oldest first (may be fewer than count)
+     */
+    static std::vector<std::wstring> FindRecentMessages(IAccessibleElement& window, int count,
+                                                        const CancellationToken& token,
+                                                        const ElementPathScope& paths = ElementPathScope());
+
+    /**
+     * @brief Get the text of one message item
+     *
+     * Its name, else the names of its first five descendants joined by spaces.
+     *
+     * @param message Message list item
+     * @param token Cancellation token of the fetch
+     * @return Message text, or empty
+     */
+    static std::wstring ExtractMessageText(IAccessibleElement& message,
+                                           const CancellationToken& token);
+};
+
+/**
+ * @brief Element scans of the VS Code adapter (status bar)
+ */
+class VSCodeScan {
+public:
+    /**
+     * @brief Find a file path shown in the window
+     *
+     * The first Text element in the status bar (bottom strip of the
+     * window) containing ":\", "/" or "\" and shorter than 300 characters.
+     * Budgeted search (AccessibleSearch).
+     *
+     * @param window VS Code window
+     * @param token Cancellation token of the fetch
+     * @return Path text, or empty if none found
+     */
+    static std::wstring FindFilePath(IAccessibleElement& window, const CancellationToken& token);
+
+    /**
+     * @brief Find the cursor position ("Ln 42, Col 15")
+     *
+     * The first status bar Text element that parses as one.
+     *
+     * @param window VS Code window
+     * @param token Cancellation token of the fetch
+     * @param lineNumber Output: line number (0 if not found)
+     * @param columnNumber Output: column number (0 if not found)
+     */
+    static void FindCursorPosition(IAccessibleElement& window, const CancellationToken& token,
+                                   int& lineNumber, int& columnNumber);
+
+    /**
+     * @brief Parse "Ln X, Col Y" status text
+     *
+     * @return true if text is a cursor position
+     */
+    static bool ParseCursorPosition(const std::wstring& text, int& lineNumber, int& columnNumber);
+};
+
+/**
+ * @brief Element scans of the Notion adapter
+ */
+class NotionScan {
+public:
+    /**
+     * @brief Find the breadcrumb items (workspace > ... > page)
+     *
+     * Up to ten Hyperlink names that are not navigation or skip links;
+     * failing that, Button names containing ">" or "/".
+     *
+     * @param window Notion window
+     * @param token Cancellation token of the fetch
+     * @return Breadcrumb items in order
+     */
+    static std::vector<std::wstring> FindBreadcrumbs(IAccessibleElement& window,
+                                                     const CancellationToken& token);
+};
@@ -0,0 +1,192 @@
+#include "generic_adapter.h"
+#include "../../utils.h"
+#include "../../debug_log.h"
+#include "../utils/title_rules.h"
+#include <windows.h>
+#include <chrono>
+#include <cwctype>
+
+// Link version information library
+#pragma comment(lib, "version.lib")
+
+namespace {
+
+bool IsDrivePath(const std::wstring& text) {
+    return text.size() >= 3 && std::iswalpha(text[0]) && text[1] == L':' &&
+           (text[2] == L'\\' || text[2] == L'/');
+}
+
+bool IsRootedPath(const std::wstring& text) {
+    return IsDrivePath(text) || text.compare(0, 2, L"\\\\") == 0;
+}
+
+// "C:\Users\me\Downloads" -> "Downloads"; a bare root stays as it is
+std::wstring LastComponent(const std::wstring& path) {
+    size_t end = path.find_last_not_of(L"\\/");
+    if (end == std::wstring::npos) {
+        return path;
+    }
+    size_t start = path.find_last_of(L"\\/", end);
+    start = (start == std::wstring::npos) ? 0 : start + 1;
+    std::wstring name = path.substr(start, end - start + 1);
+    return name.back() == L':' ? path : name;
+}
+
+} // namespace
+
+bool GenericAdapter::CanHandle(const std::wstring& processName,
+                               const std::wstring& windowTitle)
+{
+    (void)processName;
+    (void)windowTitle;
+    return true;
+}
+
+std::shared_ptr<ContextData> GenericAdapter::GetContext(const SourceInfo& source,
+                                                        const CancellationToken& token)
+{
+    (void)token;  // Nothing blocks
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    auto context = std::make_shared<GenericContext>();
+
+    // "Document - App" and similar, in one pass (utils/title_rules.h)
+    TitleFields parsed = TitleRules::Instance().Parse("generic", source.windowTitle);
+    std::wstring document = parsed.Get("document");
+    std::wstring exeAppName = GetAppName(source.processPath, source.processName);
+    context->appName = parsed.Get("app");
+    if (context->appName.empty()) {
+        context->appName = exeAppName;
+    }
+
+    // A title that only names the app ("Calculator") names no document
+    std::wstring lowerDocument = Utils::ToLower(document);
+    if (lowerDocument != Utils::ToLower(context->appName) && lowerDocument != Utils::ToLower(exeAppName)) {
+        context->documentName = document;
+    }
+
+    FindPaths(context->documentName, context->paths, context->url);
+    if (IsRootedPath(context->documentName)) {
+        // Explorer with full paths in the title bar, "Save As" targets, ...
+        context->documentName = LastComponent(context->documentName);
+    }
+
+    context->title = context->documentName.empty() ? source.windowTitle : context->documentName;
+    context->success = !context->title.empty() || !context->appName.empty();
+    if (context->success) {
+        context->metadata[L"app"] = context->appName;
+        if (parsed.modified) {
+            context->metadata[L"is_modified"] = L"true";
+        }
+    } else {
+        context->error = L"No window title or process name";
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - startTime);
+    context->fetchTimeMs = static_cast<int>(elapsed.count());
+    return context;
+}
+
+std::wstring GenericAdapter::GetAppName(const std::wstring& processPath,
+                                        const std::wstring& processName)
+{
+    const std::wstring& key = processPath.empty() ? processName : processPath;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_appNames.find(key);
+    if (it != m_appNames.end()) {
+        return it->second;
+    }
+
+    std::wstring appName = processPath.empty() ? std::wstring() : ReadFileDescription(processPath);
+    if (appName.empty()) {
+        appName = processName;
+        if (appName.size() > 4 && Utils::ToLower(appName.substr(appName.size() - 4)) == L".exe") {
+            appName.resize(appName.size() - 4);
+        }
+    }
+
+    LOG_DEBUG("GenericAdapter: App name for {}: {}", key, appName);
+    m_appNames.emplace(key, appName);
+    return appName;
+}
+
+std::wstring GenericAdapter::ReadFileDescription(const std::wstring& processPath)
+{
+    DWORD handle = 0;
+    DWORD size = GetFileVersionInfoSizeW(processPath.c_str(), &handle);
+    if (size == 0) {
+        return L"";
+    }
+
+    std::vector<BYTE> data(size);
+    if (!GetFileVersionInfoW(processPath.c_str(), 0, size, data.data())) {
+        return L"";
+    }
+
+    // First language/code page the resource declares
+    struct LangCodePage {
+        WORD language;
+        WORD codePage;
+    };
+    LangCodePage* translations = nullptr;
+    UINT length = 0;
+    if (!VerQueryValueW(data.data(), L"\\VarFileInfo\\Translation",
+                        reinterpret_cast<void**>(&translations), &length) ||
+        length < sizeof(LangCodePage)) {
+        return L"";
+    }
+
+    wchar_t query[64];
+    swprintf_s(query, L"\\StringFileInfo\\%04x%04x\\FileDescription",
+               translations[0].language, translations[0].codePage);
+
+    wchar_t* description = nullptr;
+    UINT chars = 0;
+    if (!VerQueryValueW(data.data(), query, reinterpret_cast<void**>(&description), &chars) ||
+        chars == 0 || !description) {
+        return L"";
+    }
+
+    std::wstring result(description);
+    size_t end = result.find_last_not_of(L" \t\r\n");
+    return end == std::wstring::npos ? std::wstring() : result.substr(0, end + 1);
+}
+
+void GenericAdapter::FindPaths(const std::wstring& text, std::vector<std::wstring>& paths,
+                               std::wstring& url)
+{
+    // A whole part that is a path may contain spaces
+    if (IsRootedPath(text)) {
+        paths.push_back(text);
+        return;
+    }
+
+    const wchar_t* delimiters = L" \t\"'()[]<>";
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t start = text.find_first_not_of(delimiters, pos);
+        if (start == std::wstring::npos) {
+            break;
+        }
+        size_t end = text.find_first_of(delimiters, start);
+        if (end == std::wstring::npos) {
+            end = text.size();
+        }
+        pos = end;
+
+        std::wstring token = text.substr(start, end - start);
+        size_t last = token.find_last_not_of(L",;.");
+        token.resize(last == std::wstring::npos ? 0 : last + 1);
+
+        if (token.find(L"://") != std::wstring::npos) {
+            if (url.empty()) {
+                url = token;
+            }
+        } else if (IsRootedPath(token) || token.compare(0, 2, L"~/") == 0 ||
+                   token.compare(0, 2, L"~\\") == 0) {
+            paths.push_back(token);
+        }
+    }
+}
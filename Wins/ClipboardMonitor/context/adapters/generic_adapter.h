@@ -0,0 +1,110 @@
+#pragma once
+
+#include "../context_adapter.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * @brief Generic Context Adapter
+ *
+ * Structured context for every process the other adapters do not handle
+ * (Explorer, Notepad, Office, ...), from the window title and the
+ * executable alone: no UI Automation, no executor hop.
+ *
+ * Not registered like the others (CanHandle accepts everything); set it
+ * with ContextManager::SetGenericAdapter. It runs synchronously on the
+ * clipboard thread and its context is complete, so no second publish
+ * follows.
+ *
+ * Features:
+ * - Document and app name from the "generic" title rules
+ *   ("Document - App", "Document — App", "Document | App")
+ * - App name from the executable's FileDescription when the title has none
+ * - Path-like tokens (C:\..., \\server\share, ~/...) and URLs in the title
+ */
+class GenericAdapter : public IContextAdapter {
+public:
+    /**
+     * @brief Constructor
+     */
+    GenericAdapter() = default;
+
+    /**
+     * @brief Destructor
+     */
+    ~GenericAdapter() override = default;
+
+    /**
+     * @brief Check if this adapter can handle the given process
+     *
+     * @return Always true: this is the fallback for any process
+     */
+    bool CanHandle(const std::wstring& processName,
+                  const std::wstring& windowTitle) override;
+
+    /**
+     * @brief Get generic context
+     *
+     * Title parsing plus one cached executable lookup per process path;
+     * cheap enough for the clipboard thread.
+     *
+     * @param source Source information (process path, window title)
+     * @param token Not used: nothing to cancel
+     * @return GenericContext with document name, app name and paths
+     */
+    std::shared_ptr<ContextData> GetContext(const SourceInfo& source,
+                                            const CancellationToken& token) override;
+
+    /**
+     * @brief Get adapter timeout
+     *
+     * @return 0: runs synchronously
+     */
+    int GetTimeout() const override { return 0; }
+
+    /**
+     * @brief Get adapter name
+     *
+     * @return L"GenericAdapter"
+     */
+    std::wstring GetAdapterName() const override { return L"GenericAdapter"; }
+
+private:
+    /**
+     * @brief Get the application name of an executable
+     *
+     * FileDescription from the version resource (e.g. "Windows Explorer"),
+     * else the file name without ".exe". Read once per path.
+     *
+     * @param processPath Full executable path
+     * @param processName Executable name (fallback)
+     * @return Application name
+     */
+    std::wstring GetAppName(const std::wstring& processPath, const std::wstring& processName);
+
+    /**
+     * @brief Read FileDescription from an executable's version resource
+     *
+     * @param processPath Full executable path
+     * @return Description, or empty if there is none
+     */
+    static std::wstring ReadFileDescription(const std::wstring& processPath);
+
+    /**
+     * @brief Collect path-like tokens and the first URL from a title
+     *
+     * A title part that starts with a drive ("C:\") or UNC prefix is taken
+     * whole (paths contain spaces); otherwise whitespace-separated tokens
+     * starting with "\\", "~/" or a drive, and "scheme://" URLs.
+     *
+     * @param text Title text
+     * @param paths Output: path-like tokens, in order
+     * @param url Output: first URL, if any
+     */
+    static void FindPaths(const std::wstring& text, std::vector<std::wstring>& paths,
+                          std::wstring& url);
+
+    std::mutex m_mutex;
+    std::unordered_map<std::wstring, std::wstring> m_appNames;  // Process path -> app name
+};
@@ -1,6 +1,8 @@
 #include "notion_adapter.h"
 #include "../../utils.h"
 #include "../../debug_log.h"
+#include "../utils/title_rules.h"
+#include "element_scans.h"
 #include <windows.h>
 #include <chrono>
 #include <sstream>
@@ -21,7 +23,13 @@ bool NotionAdapter::CanHandle(const std::wstring& processName,
     return lowerProcessName == L"notion.exe";
 }
 
-std::shared_ptr<ContextData> NotionAdapter::GetContext(const SourceInfo& source)
+std::vector<std::wstring> NotionAdapter::GetProcessNames() const
+{
+    return {L"notion.exe"};
+}
+
+std::shared_ptr<ContextData> NotionAdapter::GetContext(const SourceInfo& source,
+                                                       const CancellationToken& token)
 {
     auto startTime = std::chrono::high_resolution_clock::now();
 
@@ -35,17 +43,17 @@ std::shared_ptr<ContextData> NotionAdapter::GetContext(const SourceInfo& source)
         std::wstring pageTitle = ParsePageTitle(source.windowTitle);
         if (!pageTitle.empty()) {
             context->title = pageTitle;
-            DEBUG_LOG("NotionAdapter: Got page title: " + Utils::WideToUtf8(pageTitle));
+            LOG_DEBUG("NotionAdapter: Got page title: {}", pageTitle);
         }
 
         // Initialize UI Automation
-        UIAutomationHelper uiHelper;
+        UIAutomationHelper uiHelper(token);
         if (uiHelper.Initialize()) {
             // Get breadcrumbs
             std::vector<std::wstring> breadcrumbs = GetBreadcrumbs(source.windowHandle, uiHelper);
             if (!breadcrumbs.empty()) {
                 context->breadcrumbs = breadcrumbs;
-                DEBUG_LOG("NotionAdapter: Got " + std::to_string(breadcrumbs.size()) + " breadcrumb(s)");
+                LOG_DEBUG("NotionAdapter: Got {} breadcrumb(s)", breadcrumbs.size());
 
                 // Extract workspace from first breadcrumb if available
                 if (!breadcrumbs.empty()) {
@@ -57,7 +65,7 @@ std::shared_ptr<ContextData> NotionAdapter::GetContext(const SourceInfo& source)
             std::string pageType = DeterminePageType(source.windowTitle, uiHelper, source.windowHandle);
             if (!pageType.empty()) {
                 context->pageType = Utils::Utf8ToWide(pageType);
-                DEBUG_LOG("NotionAdapter: Page type: " + pageType);
+                LOG_DEBUG("NotionAdapter: Page type: {}", pageType);
             }
 
             // Construct pseudo URL
@@ -65,11 +73,11 @@ std::shared_ptr<ContextData> NotionAdapter::GetContext(const SourceInfo& source)
             if (!pseudoUrl.empty()) {
                 context->url = pseudoUrl;
                 context->pagePath = pseudoUrl;
-                DEBUG_LOG("NotionAdapter: Constructed URL: " + Utils::WideToUtf8(pseudoUrl));
+                LOG_DEBUG("NotionAdapter: Constructed URL: {}", pseudoUrl);
             }
 
         } else {
-            DEBUG_LOG("NotionAdapter: Failed to initialize UI Automation");
+            LOG_WARN("NotionAdapter: Failed to initialize UI Automation");
         }
 
         // Mark as successful if we got at least page title
@@ -83,17 +91,17 @@ std::shared_ptr<ContextData> NotionAdapter::GetContext(const SourceInfo& source)
             }
         } else {
             context->error = L"Failed to extract page information from window title";
-            DEBUG_LOG("NotionAdapter: Failed to get page title from window title");
+            LOG_WARN("NotionAdapter: Failed to get page title from window title");
         }
 
     } catch (const std::exception& ex) {
         context->success = false;
         context->error = L"Exception: " + Utils::Utf8ToWide(ex.what());
-        DEBUG_LOG("NotionAdapter: Exception: " + std::string(ex.what()));
+        LOG_ERROR("NotionAdapter: Exception: {}", ex.what());
     } catch (...) {
         context->success = false;
         context->error = L"Unknown exception";
-        DEBUG_LOG("NotionAdapter: Unknown exception");
+        LOG_ERROR("NotionAdapter: Unknown exception");
     }
 
     // Calculate fetch time
@@ -102,9 +110,19 @@ std::shared_ptr<ContextData> NotionAdapter::GetContext(const SourceInfo& source)
         std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count()
     );
 
-    DEBUG_LOG("NotionAdapter: Completed in " + std::to_string(context->fetchTimeMs) + "ms, success=" +
-              (context->success ? "true" : "false"));
+    LOG_EVENT(AdapterCompleted, "NotionAdapter", context->fetchTimeMs, context->success);
+
+    return context;
+}
 
+std::shared_ptr<ContextData> NotionAdapter::GetQuickContext(const SourceInfo& source)
+{
+    auto context = std::make_shared<NotionContext>();
+    context->title = ParsePageTitle(source.windowTitle);
+    context->success = !context->title.empty();
+    if (context->success) {
+        context->metadata[L"app"] = L"Notion";
+    }
     return context;
 }
 
@@ -112,137 +130,26 @@ std::wstring NotionAdapter::ParsePageTitle(const std::wstring& windowTitle)
 {
     // Window title format: "Page Title - Notion"
     // Also handles: "Database Name - Notion"
-
-    if (windowTitle.empty()) {
-        return L"";
-    }
-
-    std::wstring title = windowTitle;
-
-    // Find " - Notion" suffix
-    size_t suffixPos = title.rfind(L" - Notion");
-    if (suffixPos != std::wstring::npos) {
-        title = title.substr(0, suffixPos);
-    }
-
-    // Trim whitespace
-    size_t start = title.find_first_not_of(L" \t\r\n");
-    size_t end = title.find_last_not_of(L" \t\r\n");
-
-    if (start != std::wstring::npos && end != std::wstring::npos) {
-        return title.substr(start, end - start + 1);
-    }
-
-    return title;
+    return TitleRules::Instance().Parse("notion", windowTitle).Get("page_title");
 }
 
 std::vector<std::wstring> NotionAdapter::GetBreadcrumbs(HWND hwnd, UIAutomationHelper& uiHelper)
 {
     std::vector<std::wstring> breadcrumbs;
 
-    if (hwnd == nullptr) {
+    if (hwnd == nullptr || uiHelper.IsCancelled()) {
         return breadcrumbs;
     }
 
     try {
         // Notion displays breadcrumbs as Hyperlink or Button elements near the top
-        // Strategy: Find all Hyperlink and Button elements, filter by position
-
-        IUIAutomation* automation = uiHelper.GetAutomation();
-        if (!automation) {
-            return breadcrumbs;
-        }
-
-        IUIAutomationElement* rootElement = nullptr;
-        HRESULT hr = automation->ElementFromHandle(hwnd, &rootElement);
-        if (FAILED(hr) || !rootElement) {
-            return breadcrumbs;
+        AccessibleElementPtr window = uiHelper.GetWindowElement(hwnd);
+        if (window) {
+            breadcrumbs = NotionScan::FindBreadcrumbs(*window, uiHelper.GetToken());
         }
 
-        // Look for Hyperlink elements (common for breadcrumbs)
-        VARIANT var;
-        var.vt = VT_I4;
-        var.lVal = UIA_HyperlinkControlTypeId;
-
-        IUIAutomationCondition* condition = nullptr;
-        hr = automation->CreatePropertyCondition(UIA_ControlTypePropertyId, var, &condition);
-
-        if (SUCCEEDED(hr) && condition) {
-            IUIAutomationElementArray* foundElements = nullptr;
-            hr = rootElement->FindAll(TreeScope_Descendants, condition, &foundElements);
-
-            if (SUCCEEDED(hr) && foundElements) {
-                int length = 0;
-                foundElements->get_Length(&length);
-
-                // Collect hyperlinks (likely breadcrumbs)
-                for (int i = 0; i < length && breadcrumbs.size() < 10; i++) {
-                    IUIAutomationElement* element = nullptr;
-                    hr = foundElements->GetElement(i, &element);
-
-                    if (SUCCEEDED(hr) && element) {
-                        std::wstring text = uiHelper.GetElementText(element);
-                        element->Release();
-
-                        // Filter out empty or very long text (probably not a breadcrumb)
-                        if (!text.empty() && text.length() < 100) {
-                            // Filter out common UI elements and accessibility elements
-                            if (text != L"Back" && text != L"Forward" &&
-                                text != L"Share" && text != L"Updates" &&
-                                text != L"Skip to content" &&  // Accessibility skip link
-                                text.find(L"http") == std::wstring::npos) {
-                                breadcrumbs.push_back(text);
-                            }
-                        }
-                    }
-                }
-
-                foundElements->Release();
-            }
-            condition->Release();
-        }
-
-        // Also try Button elements if we didn't find enough breadcrumbs
-        if (breadcrumbs.empty()) {
-            var.lVal = UIA_ButtonControlTypeId;
-            hr = automation->CreatePropertyCondition(UIA_ControlTypePropertyId, var, &condition);
-
-            if (SUCCEEDED(hr) && condition) {
-                IUIAutomationElementArray* foundElements = nullptr;
-                hr = rootElement->FindAll(TreeScope_Descendants, condition, &foundElements);
-
-                if (SUCCEEDED(hr) && foundElements) {
-                    int length = 0;
-                    foundElements->get_Length(&length);
-
-                    for (int i = 0; i < length && breadcrumbs.size() < 10; i++) {
-                        IUIAutomationElement* element = nullptr;
-                        hr = foundElements->GetElement(i, &element);
-
-                        if (SUCCEEDED(hr) && element) {
-                            std::wstring text = uiHelper.GetElementText(element);
-                            element->Release();
-
-                            if (!text.empty() && text.length() < 100) {
-                                // Look for breadcrumb-like buttons
-                                if (text.find(L">") != std::wstring::npos ||
-                                    text.find(L"/") != std::wstring::npos) {
-                                    breadcrumbs.push_back(text);
-                                }
-                            }
-                        }
-                    }
-
-                    foundElements->Release();
-                }
-                condition->Release();
-            }
-        }
-
-        rootElement->Release();
-
     } catch (...) {
-        DEBUG_LOG("NotionAdapter: Exception in GetBreadcrumbs");
+        LOG_ERROR("NotionAdapter: Exception in GetBreadcrumbs");
     }
 
     return breadcrumbs;
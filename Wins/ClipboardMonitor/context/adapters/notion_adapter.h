@@ -50,6 +50,15 @@ public:
     bool CanHandle(const std::wstring& processName,
                   const std::wstring& windowTitle) override;
 
+    /**
+     * @brief Get process names handled by this adapter
+     *
+     * Notion desktop.
+     *
+     * @return Lowercase process names (e.g., L"notion.exe")
+     */
+    std::vector<std::wstring> GetProcessNames() const override;
+
     /**
      * @brief Get Notion context
      *
@@ -60,9 +69,21 @@ public:
      * 4. Construct pseudo URL (notion://Workspace/Page/Subpage)
      *
      * @param source Source information (HWND, process name, window title)
+     * @param token Cancelled on timeout; element searches stop early
      * @return NotionContext with page path, breadcrumbs, etc.
      */
-    std::shared_ptr<ContextData> GetContext(const SourceInfo& source) override;
+    std::shared_ptr<ContextData> GetContext(const SourceInfo& source,
+                                            const CancellationToken& token) override;
+
+    /**
+     * @brief Get the title-only context
+     *
+     * Page title from the window title; no breadcrumbs, page type or URL.
+     *
+     * @param source Source information (window title)
+     * @return Partial NotionContext
+     */
+    std::shared_ptr<ContextData> GetQuickContext(const SourceInfo& source) override;
 
     /**
      * @brief Get adapter timeout
@@ -71,6 +92,15 @@ public:
      */
     int GetTimeout() const override { return m_timeout; }
 
+    /**
+     * @brief Get cache policy
+     *
+     * Breadcrumbs and page type only change with the window title.
+     *
+     * @return 15s fresh, served stale for another 60s, 16 windows
+     */
+    ContextCachePolicy GetCachePolicy() const override { return {15000, 60000, 16}; }
+
     /**
      * @brief Get adapter name
      *
@@ -95,8 +125,8 @@ private:
      * Notion displays breadcrumbs showing the page hierarchy:
      * Workspace > Parent Page > Current Page
      *
-     * Strategy:
-     * - Look for Hyperlink or Button elements near the top
+     * Strategy (NotionScan::FindBreadcrumbs):
+     * - Look for Hyperlink elements, else breadcrumb-like Button elements
      * - These typically represent breadcrumb items
      * - Collect them in order to build page path
      *
@@ -1,11 +1,26 @@
 #include "vscode_adapter.h"
 #include "../../utils.h"
 #include "../../debug_log.h"
+#include "../utils/title_rules.h"
+#include "element_scans.h"
 #include <windows.h>
 #include <chrono>
 #include <sstream>
 #include <regex>
 
+namespace {
+
+// VS Code-based editors (lowercase)
+const wchar_t* const kEditorProcesses[] = {
+    L"code.exe",
+    L"cursor.exe",
+    L"code-insiders.exe",
+    L"vscodium.exe",
+    L"antigravity.exe"   // Claude Code
+};
+
+} // namespace
+
 // Language mapping: extension -> language name
 const std::map<std::wstring, std::string> VSCodeAdapter::s_languageMap = {
     // Programming languages
@@ -70,14 +85,21 @@ bool VSCodeAdapter::CanHandle(const std::wstring& processName,
     std::wstring lowerProcessName = Utils::ToLower(processName);
 
     // Support multiple VS Code-based editors
-    return lowerProcessName == L"code.exe" ||
-           lowerProcessName == L"cursor.exe" ||
-           lowerProcessName == L"code-insiders.exe" ||
-           lowerProcessName == L"vscodium.exe" ||
-           lowerProcessName == L"antigravity.exe";  // Claude Code
+    for (const wchar_t* editor : kEditorProcesses) {
+        if (lowerProcessName == editor) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::wstring> VSCodeAdapter::GetProcessNames() const
+{
+    return std::vector<std::wstring>(std::begin(kEditorProcesses), std::end(kEditorProcesses));
 }
 
-std::shared_ptr<ContextData> VSCodeAdapter::GetContext(const SourceInfo& source)
+std::shared_ptr<ContextData> VSCodeAdapter::GetContext(const SourceInfo& source,
+                                                       const CancellationToken& token)
 {
     auto startTime = std::chrono::high_resolution_clock::now();
 
@@ -87,41 +109,18 @@ std::shared_ptr<ContextData> VSCodeAdapter::GetContext(const SourceInfo& source)
     context->success = false;
 
     try {
-        // Parse window title
-        std::wstring fileName, projectName;
-        bool isModified = false;
-        ParseWindowTitle(source.windowTitle, fileName, projectName, isModified);
-
-        if (!fileName.empty()) {
-            context->fileName = fileName;
-            context->title = fileName;
-            DEBUG_LOG("VSCodeAdapter: Got file name: " + Utils::WideToUtf8(fileName));
-        }
-
-        if (!projectName.empty()) {
-            context->projectName = projectName;
-            DEBUG_LOG("VSCodeAdapter: Got project name: " + Utils::WideToUtf8(projectName));
-        }
-
-        context->isModified = isModified;
-
-        // Infer language from file extension
-        if (!fileName.empty()) {
-            context->language = InferLanguage(fileName);
-            if (!context->language.empty()) {
-                DEBUG_LOG("VSCodeAdapter: Inferred language: " + context->language);
-            }
-        }
+        // File name, project, modified flag and language from the window title
+        ApplyWindowTitle(source, *context);
 
         // Try to get file path and cursor position from status bar via UI Automation
-        UIAutomationHelper uiHelper;
+        UIAutomationHelper uiHelper(token);
         if (uiHelper.Initialize()) {
             // Get file path
             std::wstring filePath = GetFilePathFromStatusBar(source.windowHandle, uiHelper);
             if (!filePath.empty()) {
                 context->filePath = filePath;
                 context->url = L"vscode://file/" + filePath;  // Construct pseudo URL
-                DEBUG_LOG("VSCodeAdapter: Got file path: " + Utils::WideToUtf8(filePath));
+                LOG_DEBUG("VSCodeAdapter: Got file path: {}", filePath);
             }
 
             // Get cursor position
@@ -130,36 +129,28 @@ std::shared_ptr<ContextData> VSCodeAdapter::GetContext(const SourceInfo& source)
             if (lineNumber > 0) {
                 context->lineNumber = lineNumber;
                 context->columnNumber = columnNumber;
-                DEBUG_LOG("VSCodeAdapter: Cursor at Ln " + std::to_string(lineNumber) +
-                         ", Col " + std::to_string(columnNumber));
+                LOG_DEBUG("VSCodeAdapter: Cursor at Ln {}, Col {}", lineNumber, columnNumber);
             }
         } else {
-            DEBUG_LOG("VSCodeAdapter: Failed to initialize UI Automation");
+            LOG_WARN("VSCodeAdapter: Failed to initialize UI Automation");
         }
 
         // Mark as successful if we got at least file name
         if (!context->fileName.empty()) {
             context->success = true;
-
-            // Add metadata
-            context->metadata[L"editor"] = Utils::Utf8ToWide(Utils::WideToUtf8(source.processName));
-            context->metadata[L"is_modified"] = isModified ? L"true" : L"false";
-            if (!context->language.empty()) {
-                context->metadata[L"language"] = Utils::Utf8ToWide(context->language);
-            }
         } else {
             context->error = L"Failed to extract file information from window title";
-            DEBUG_LOG("VSCodeAdapter: Failed to get file name from window title");
+            LOG_WARN("VSCodeAdapter: Failed to get file name from window title");
         }
 
     } catch (const std::exception& ex) {
         context->success = false;
         context->error = L"Exception: " + Utils::Utf8ToWide(ex.what());
-        DEBUG_LOG("VSCodeAdapter: Exception: " + std::string(ex.what()));
+        LOG_ERROR("VSCodeAdapter: Exception: {}", ex.what());
     } catch (...) {
         context->success = false;
         context->error = L"Unknown exception";
-        DEBUG_LOG("VSCodeAdapter: Unknown exception");
+        LOG_ERROR("VSCodeAdapter: Unknown exception");
     }
 
     // Calculate fetch time
@@ -168,155 +159,87 @@ std::shared_ptr<ContextData> VSCodeAdapter::GetContext(const SourceInfo& source)
         std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count()
     );
 
-    DEBUG_LOG("VSCodeAdapter: Completed in " + std::to_string(context->fetchTimeMs) + "ms, success=" +
-              (context->success ? "true" : "false"));
+    LOG_EVENT(AdapterCompleted, "VSCodeAdapter", context->fetchTimeMs, context->success);
 
     return context;
 }
 
-void VSCodeAdapter::ParseWindowTitle(const std::wstring& windowTitle,
-                                    std::wstring& fileName,
-                                    std::wstring& projectName,
-                                    bool& isModified)
+std::shared_ptr<ContextData> VSCodeAdapter::GetQuickContext(const SourceInfo& source)
 {
-    // Window title format:
-    // VS Code: "● filename.ext - Project Name - Visual Studio Code" (modified)
-    // VS Code: "filename.ext - Project Name - Visual Studio Code" (saved)
-    // VS Code: "● filename.ext - Visual Studio Code" (no project)
-    // Antigravity: "ProjectName - Antigravity - filename.ext" (different format!)
+    auto context = std::make_shared<VSCodeContext>();
+    ApplyWindowTitle(source, *context);
+    context->success = !context->fileName.empty();
+    return context;
+}
+
+void VSCodeAdapter::ApplyWindowTitle(const SourceInfo& source, VSCodeContext& context)
+{
+    std::wstring fileName, projectName;
+    bool isModified = false;
+    ParseWindowTitle(source.windowTitle, fileName, projectName, isModified);
 
-    fileName.clear();
-    projectName.clear();
-    isModified = false;
+    if (!projectName.empty()) {
+        context.projectName = projectName;
+        LOG_DEBUG("VSCodeAdapter: Got project name: {}", projectName);
+    }
 
-    if (windowTitle.empty()) {
+    context.isModified = isModified;
+    if (fileName.empty()) {
         return;
     }
 
-    std::wstring title = windowTitle;
+    context.fileName = fileName;
+    context.title = fileName;
+    LOG_DEBUG("VSCodeAdapter: Got file name: {}", fileName);
 
-    // Check for modification indicator (bullet character U+25CF)
-    if (title.length() > 0 && title[0] == L'\u25CF') {
-        isModified = true;
-        // Remove bullet and space prefix
-        if (title.length() > 2 && title[1] == L' ') {
-            title = title.substr(2);
-        } else {
-            title = title.substr(1);
-        }
+    // Infer language from file extension
+    context.language = InferLanguage(fileName);
+    if (!context.language.empty()) {
+        LOG_DEBUG("VSCodeAdapter: Inferred language: {}", context.language);
     }
 
-    // Special handling for Antigravity (Claude Code)
-    // Format: "ProjectName - Antigravity - filename.ext"
-    size_t antigravityPos = title.find(L" - Antigravity - ");
-    if (antigravityPos != std::wstring::npos) {
-        projectName = title.substr(0, antigravityPos);
-        fileName = title.substr(antigravityPos + 17);  // Skip " - Antigravity - "
-        DEBUG_LOG("VSCodeAdapter: Antigravity format detected - project: " + 
-                  Utils::WideToUtf8(projectName) + ", file: " + Utils::WideToUtf8(fileName));
-        return;
+    // Add metadata
+    context.metadata[L"editor"] = Utils::Utf8ToWide(Utils::WideToUtf8(source.processName));
+    context.metadata[L"is_modified"] = isModified ? L"true" : L"false";
+    if (!context.language.empty()) {
+        context.metadata[L"language"] = Utils::Utf8ToWide(context.language);
     }
+}
 
-    // Standard VS Code format: "filename.ext - ProjectName - EditorName"
-    // Find " - Visual Studio Code" or " - Cursor" suffix
-    std::vector<std::wstring> suffixes = {
-        L" - Visual Studio Code",
-        L" - Cursor",
-        L" - VSCodium",
-        L" - Code - Insiders",
-        L" - Antigravity"  // Fallback for simpler Antigravity titles
-    };
-
-    size_t suffixPos = std::wstring::npos;
-    for (const auto& suffix : suffixes) {
-        suffixPos = title.rfind(suffix);
-        if (suffixPos != std::wstring::npos) {
-            title = title.substr(0, suffixPos);
-            break;
-        }
-    }
+void VSCodeAdapter::ParseWindowTitle(const std::wstring& windowTitle,
+                                    std::wstring& fileName,
+                                    std::wstring& projectName,
+                                    bool& isModified)
+{
+    // Window title format:
+    // VS Code: "● filename.ext - Project Name - Visual Studio Code" (modified)
+    // VS Code: "filename.ext - Project Name - Visual Studio Code" (saved)
+    // VS Code: "● filename.ext - Visual Studio Code" (no project)
+    // Antigravity: "ProjectName - Antigravity - filename.ext" (different format!)
 
-    // Now title is like: "filename.ext - Project Name" or "filename.ext"
-    size_t dashPos = title.find(L" - ");
-    if (dashPos != std::wstring::npos) {
-        fileName = title.substr(0, dashPos);
-        projectName = title.substr(dashPos + 3);  // Skip " - "
-    } else {
-        fileName = title;
-    }
+    // Layouts (markers, editor suffixes, the Antigravity variant) are
+    // title rules; see utils/title_rules.h
+    TitleFields parsed = TitleRules::Instance().Parse("vscode", windowTitle);
+    fileName = parsed.Get("file");
+    projectName = parsed.Get("project");
+    isModified = parsed.modified;
 }
 
 std::wstring VSCodeAdapter::GetFilePathFromStatusBar(HWND hwnd, UIAutomationHelper& uiHelper)
 {
-    if (hwnd == nullptr) {
+    if (hwnd == nullptr || uiHelper.IsCancelled()) {
         return L"";
     }
 
     try {
         // VS Code's status bar typically contains file path information
-        // Strategy: Look for Text elements that might contain a file path
-
-        IUIAutomation* automation = uiHelper.GetAutomation();
-        if (!automation) {
-            return L"";
-        }
-
-        IUIAutomationElement* rootElement = nullptr;
-        HRESULT hr = automation->ElementFromHandle(hwnd, &rootElement);
-        if (FAILED(hr) || !rootElement) {
-            return L"";
-        }
-
-        // Look for Text elements
-        VARIANT var;
-        var.vt = VT_I4;
-        var.lVal = UIA_TextControlTypeId;
-
-        IUIAutomationCondition* condition = nullptr;
-        hr = automation->CreatePropertyCondition(UIA_ControlTypePropertyId, var, &condition);
-
-        if (SUCCEEDED(hr) && condition) {
-            IUIAutomationElementArray* foundElements = nullptr;
-            hr = rootElement->FindAll(TreeScope_Descendants, condition, &foundElements);
-
-            if (SUCCEEDED(hr) && foundElements) {
-                int length = 0;
-                foundElements->get_Length(&length);
-
-                // Look for elements containing file paths (with : or / or \)
-                for (int i = 0; i < length; i++) {
-                    IUIAutomationElement* element = nullptr;
-                    hr = foundElements->GetElement(i, &element);
-
-                    if (SUCCEEDED(hr) && element) {
-                        std::wstring text = uiHelper.GetElementText(element);
-                        element->Release();
-
-                        // Check if text looks like a file path
-                        if (text.find(L":\\") != std::wstring::npos ||  // Windows absolute path
-                            text.find(L"/") != std::wstring::npos ||   // Unix path
-                            text.find(L"\\") != std::wstring::npos) {  // Windows path
-
-                            // Filter out very long text (probably not a path)
-                            if (text.length() < 300) {
-                                foundElements->Release();
-                                condition->Release();
-                                rootElement->Release();
-                                return text;
-                            }
-                        }
-                    }
-                }
-
-                foundElements->Release();
-            }
-            condition->Release();
+        AccessibleElementPtr window = uiHelper.GetWindowElement(hwnd);
+        if (window) {
+            return VSCodeScan::FindFilePath(*window, uiHelper.GetToken());
         }
 
-        rootElement->Release();
-
     } catch (...) {
-        DEBUG_LOG("VSCodeAdapter: Exception in GetFilePathFromStatusBar");
+        LOG_ERROR("VSCodeAdapter: Exception in GetFilePathFromStatusBar");
     }
 
     return L"";
@@ -330,96 +253,19 @@ void VSCodeAdapter::GetCursorPosition(HWND hwnd,
     lineNumber = 0;
     columnNumber = 0;
 
-    if (hwnd == nullptr) {
+    if (hwnd == nullptr || uiHelper.IsCancelled()) {
         return;
     }
 
     try {
         // VS Code status bar shows cursor position as "Ln X, Col Y"
-        // Look for Text elements containing this pattern
-
-        IUIAutomation* automation = uiHelper.GetAutomation();
-        if (!automation) {
-            return;
-        }
-
-        IUIAutomationElement* rootElement = nullptr;
-        HRESULT hr = automation->ElementFromHandle(hwnd, &rootElement);
-        if (FAILED(hr) || !rootElement) {
-            return;
+        AccessibleElementPtr window = uiHelper.GetWindowElement(hwnd);
+        if (window) {
+            VSCodeScan::FindCursorPosition(*window, uiHelper.GetToken(), lineNumber, columnNumber);
         }
 
-        // Look for Text elements
-        VARIANT var;
-        var.vt = VT_I4;
-        var.lVal = UIA_TextControlTypeId;
-
-        IUIAutomationCondition* condition = nullptr;
-        hr = automation->CreatePropertyCondition(UIA_ControlTypePropertyId, var, &condition);
-
-        if (SUCCEEDED(hr) && condition) {
-            IUIAutomationElementArray* foundElements = nullptr;
-            hr = rootElement->FindAll(TreeScope_Descendants, condition, &foundElements);
-
-            if (SUCCEEDED(hr) && foundElements) {
-                int length = 0;
-                foundElements->get_Length(&length);
-
-                // Look for "Ln X, Col Y" pattern
-                for (int i = 0; i < length; i++) {
-                    IUIAutomationElement* element = nullptr;
-                    hr = foundElements->GetElement(i, &element);
-
-                    if (SUCCEEDED(hr) && element) {
-                        std::wstring text = uiHelper.GetElementText(element);
-                        element->Release();
-
-                        // Check if text matches "Ln X, Col Y" pattern
-                        if (text.find(L"Ln ") != std::wstring::npos &&
-                            text.find(L"Col ") != std::wstring::npos) {
-
-                            // Parse line and column numbers
-                            size_t lnPos = text.find(L"Ln ");
-                            size_t colPos = text.find(L"Col ");
-
-                            if (lnPos != std::wstring::npos && colPos != std::wstring::npos) {
-                                try {
-                                    // Extract line number
-                                    size_t lnStart = lnPos + 3;  // Skip "Ln "
-                                    size_t lnEnd = text.find(L",", lnStart);
-                                    if (lnEnd != std::wstring::npos) {
-                                        std::wstring lnStr = text.substr(lnStart, lnEnd - lnStart);
-                                        lineNumber = std::stoi(lnStr);
-                                    }
-
-                                    // Extract column number
-                                    size_t colStart = colPos + 4;  // Skip "Col "
-                                    size_t colEnd = text.find_first_not_of(L"0123456789", colStart);
-                                    std::wstring colStr = text.substr(colStart, colEnd - colStart);
-                                    columnNumber = std::stoi(colStr);
-
-                                } catch (...) {
-                                    // Ignore parsing errors
-                                }
-
-                                foundElements->Release();
-                                condition->Release();
-                                rootElement->Release();
-                                return;
-                            }
-                        }
-                    }
-                }
-
-                foundElements->Release();
-            }
-            condition->Release();
-        }
-
-        rootElement->Release();
-
     } catch (...) {
-        DEBUG_LOG("VSCodeAdapter: Exception in GetCursorPosition");
+        LOG_ERROR("VSCodeAdapter: Exception in GetCursorPosition");
     }
 }
 
@@ -52,6 +52,15 @@ public:
     bool CanHandle(const std::wstring& processName,
                   const std::wstring& windowTitle) override;
 
+    /**
+     * @brief Get process names handled by this adapter
+     *
+     * VS Code and its forks (Cursor, Insiders, VSCodium, Antigravity).
+     *
+     * @return Lowercase process names (e.g., L"code.exe")
+     */
+    std::vector<std::wstring> GetProcessNames() const override;
+
     /**
      * @brief Get VS Code context
      *
@@ -63,9 +72,22 @@ public:
      * 5. Detect if file is modified
      *
      * @param source Source information (HWND, process name, window title)
+     * @param token Cancelled on timeout; element searches stop early
      * @return VSCodeContext with file path, line number, language, etc.
      */
-    std::shared_ptr<ContextData> GetContext(const SourceInfo& source) override;
+    std::shared_ptr<ContextData> GetContext(const SourceInfo& source,
+                                            const CancellationToken& token) override;
+
+    /**
+     * @brief Get the title-only context
+     *
+     * File name, project name, language and modified flag; no file path
+     * or cursor position.
+     *
+     * @param source Source information (window title)
+     * @return Partial VSCodeContext
+     */
+    std::shared_ptr<ContextData> GetQuickContext(const SourceInfo& source) override;
 
     /**
      * @brief Get adapter timeout
@@ -74,6 +96,15 @@ public:
      */
     int GetTimeout() const override { return m_timeout; }
 
+    /**
+     * @brief Get cache policy
+     *
+     * Cursor position moves between copies, so results go stale quickly.
+     *
+     * @return 1.5s fresh, served stale for another 10s, 16 windows
+     */
+    ContextCachePolicy GetCachePolicy() const override { return {1500, 10000, 16}; }
+
     /**
      * @brief Get adapter name
      *
@@ -99,13 +130,22 @@ private:
                          std::wstring& projectName,
                          bool& isModified);
 
+    /**
+     * @brief Fill the fields derivable from the window title
+     *
+     * File name, project name, modified flag, inferred language and the
+     * matching metadata.
+     *
+     * @param source Source information (window title, process name)
+     * @param context Output: context to fill
+     */
+    void ApplyWindowTitle(const SourceInfo& source, VSCodeContext& context);
+
     /**
      * @brief Get file path from status bar via UI Automation
      *
-     * Strategy:
-     * - Find status bar element (usually at bottom)
-     * - Look for Text elements containing file path
-     * - Status bar often shows full path or relative path
+     * The first path-like Text element (VSCodeScan::FindFilePath); the
+     * status bar often shows the full or relative path.
      *
      * @param hwnd VS Code window handle
      * @param uiHelper UI Automation helper
@@ -116,7 +156,7 @@ private:
     /**
      * @brief Get cursor position from status bar
      *
-     * Status bar typically shows: "Ln 42, Col 15"
+     * Status bar typically shows: "Ln 42, Col 15" (VSCodeScan::FindCursorPosition)
      *
      * @param hwnd VS Code window handle
      * @param uiHelper UI Automation helper
@@ -1,6 +1,8 @@
 #include "wechat_adapter.h"
 #include "../../utils.h"
 #include "../../debug_log.h"
+#include "../utils/title_rules.h"
+#include "element_scans.h"
 #include <windows.h>
 #include <chrono>
 #include <sstream>
@@ -21,7 +23,13 @@ bool WeChatAdapter::CanHandle(const std::wstring& processName,
     return lowerProcessName == L"wechat.exe";
 }
 
-std::shared_ptr<ContextData> WeChatAdapter::GetContext(const SourceInfo& source)
+std::vector<std::wstring> WeChatAdapter::GetProcessNames() const
+{
+    return {L"wechat.exe"};
+}
+
+std::shared_ptr<ContextData> WeChatAdapter::GetContext(const SourceInfo& source,
+                                                       const CancellationToken& token)
 {
     auto startTime = std::chrono::high_resolution_clock::now();
 
@@ -32,10 +40,10 @@ std::shared_ptr<ContextData> WeChatAdapter::GetContext(const SourceInfo& source)
 
     try {
         // Initialize UI Automation
-        UIAutomationHelper uiHelper;
+        UIAutomationHelper uiHelper(token);
         if (!uiHelper.Initialize()) {
             context->error = L"Failed to initialize UI Automation";
-            DEBUG_LOG("WeChatAdapter: Failed to initialize UI Automation");
+            LOG_WARN("WeChatAdapter: Failed to initialize UI Automation");
             return context;
         }
 
@@ -44,21 +52,21 @@ std::shared_ptr<ContextData> WeChatAdapter::GetContext(const SourceInfo& source)
         if (!chatName.empty()) {
             context->contactName = chatName;
             context->title = chatName;
-            DEBUG_LOG("WeChatAdapter: Got chat name: " + Utils::WideToUtf8(chatName));
+            LOG_DEBUG("WeChatAdapter: Got chat name: {}", chatName);
         }
 
         // Determine chat type
         if (!chatName.empty()) {
             context->chatType = DetermineChatType(chatName);
-            DEBUG_LOG("WeChatAdapter: Chat type: " + Utils::WideToUtf8(context->chatType));
+            LOG_DEBUG("WeChatAdapter: Chat type: {}", context->chatType);
         }
 
-        // Get recent messages
+        // Get recent messages (returns early if the fetch has timed out)
         std::vector<std::wstring> messages = GetRecentMessages(source.windowHandle, uiHelper, m_messageCount);
         if (!messages.empty()) {
             context->recentMessages = messages;
             context->messageCount = static_cast<int>(messages.size());
-            DEBUG_LOG("WeChatAdapter: Got " + std::to_string(messages.size()) + " messages");
+            LOG_DEBUG("WeChatAdapter: Got {} messages", messages.size());
         }
 
         // Mark as successful if we got at least chat name
@@ -68,19 +76,22 @@ std::shared_ptr<ContextData> WeChatAdapter::GetContext(const SourceInfo& source)
             // Add metadata
             context->metadata[L"message_count"] = std::to_wstring(context->messageCount);
             context->metadata[L"chat_type"] = context->chatType;
+        } else if (token.IsCancelled()) {
+            context->error = L"Cancelled";
+            LOG_DEBUG("WeChatAdapter: Cancelled before finding the chat name");
         } else {
             context->error = L"Failed to extract chat information";
-            DEBUG_LOG("WeChatAdapter: Failed to get chat name");
+            LOG_WARN("WeChatAdapter: Failed to get chat name");
         }
 
     } catch (const std::exception& ex) {
         context->success = false;
         context->error = L"Exception: " + Utils::Utf8ToWide(ex.what());
-        DEBUG_LOG("WeChatAdapter: Exception: " + std::string(ex.what()));
+        LOG_ERROR("WeChatAdapter: Exception: {}", ex.what());
     } catch (...) {
         context->success = false;
         context->error = L"Unknown exception";
-        DEBUG_LOG("WeChatAdapter: Unknown exception");
+        LOG_ERROR("WeChatAdapter: Unknown exception");
     }
 
     // Calculate fetch time
@@ -89,8 +100,7 @@ std::shared_ptr<ContextData> WeChatAdapter::GetContext(const SourceInfo& source)
         std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count()
     );
 
-    DEBUG_LOG("WeChatAdapter: Completed in " + std::to_string(context->fetchTimeMs) + "ms, success=" +
-              (context->success ? "true" : "false"));
+    LOG_EVENT(AdapterCompleted, "WeChatAdapter", context->fetchTimeMs, context->success);
 
     return context;
 }
@@ -98,93 +108,34 @@ std::shared_ptr<ContextData> WeChatAdapter::GetContext(const SourceInfo& source)
 std::wstring WeChatAdapter::GetChatName(HWND hwnd, UIAutomationHelper& uiHelper)
 {
     if (hwnd == nullptr) {
-        DEBUG_LOG("WeChatAdapter: Invalid HWND");
+        LOG_WARN("WeChatAdapter: Invalid HWND");
         return L"";
     }
 
     try {
-        // Strategy 1: Try to find a Text or Static element near the top
-        // WeChat usually displays the chat name in a prominent position
-
-        // Get the root element
-        IUIAutomation* automation = uiHelper.GetAutomation();
-        if (!automation) {
-            return L"";
-        }
-
-        IUIAutomationElement* rootElement = nullptr;
-        HRESULT hr = automation->ElementFromHandle(hwnd, &rootElement);
-        if (FAILED(hr) || !rootElement) {
-            return L"";
-        }
-
-        // Try to find Text or Static elements
-        IUIAutomationCondition* condition = nullptr;
-        VARIANT var;
-        var.vt = VT_I4;
-        var.lVal = UIA_TextControlTypeId;  // Try Text controls
-
-        hr = automation->CreatePropertyCondition(UIA_ControlTypePropertyId, var, &condition);
-        if (SUCCEEDED(hr) && condition) {
-            IUIAutomationElementArray* foundElements = nullptr;
-            hr = rootElement->FindAll(TreeScope_Descendants, condition, &foundElements);
-
-            if (SUCCEEDED(hr) && foundElements) {
-                int length = 0;
-                foundElements->get_Length(&length);
-
-                // Get first few text elements and check which one looks like a chat name
-                for (int i = 0; i < (length < 10 ? length : 10); i++) {
-                    IUIAutomationElement* element = nullptr;
-                    hr = foundElements->GetElement(i, &element);
-
-                    if (SUCCEEDED(hr) && element) {
-                        std::wstring text = uiHelper.GetElementText(element);
-                        element->Release();
-
-                        // Filter out empty text and common UI strings
-                        if (!text.empty() &&
-                            text.length() > 1 &&
-                            text.length() < 100 &&  // Chat names are usually not too long
-                            text.find(L"WeChat") == std::wstring::npos &&
-                            text.find(L"微信") == std::wstring::npos) {
-
-                            foundElements->Release();
-                            condition->Release();
-                            rootElement->Release();
-                            return text;
-                        }
-                    }
-                }
-
-                foundElements->Release();
+        // Strategy 1: the name-like Text element of the chat header (element_scans.h)
+        AccessibleElementPtr window = uiHelper.GetWindowElement(hwnd);
+        if (window) {
+            std::wstring chatName = WeChatScan::FindChatName(*window, uiHelper.GetToken());
+            if (!chatName.empty()) {
+                return chatName;
             }
-            condition->Release();
         }
 
         // Strategy 2: Try window title as fallback
-        // Sometimes the chat name appears in the window title
-        rootElement->Release();
-
         // Window title might be like "ChatName - WeChat"
         wchar_t titleBuffer[256] = {0};
         GetWindowTextW(hwnd, titleBuffer, 256);
         std::wstring windowTitle(titleBuffer);
 
-        if (!windowTitle.empty() && windowTitle != L"微信" && windowTitle != L"WeChat") {
-            // Remove " - 微信" or " - WeChat" suffix
-            size_t pos = windowTitle.find(L" - 微信");
-            if (pos == std::wstring::npos) {
-                pos = windowTitle.find(L" - WeChat");
-            }
-            if (pos != std::wstring::npos) {
-                return windowTitle.substr(0, pos);
-            }
-            return windowTitle;
+        // Strips " - 微信" / " - WeChat"; the main window title gives nothing
+        std::wstring chatName = TitleRules::Instance().Parse("wechat", windowTitle).Get("chat");
+        if (!chatName.empty()) {
+            return chatName;
         }
 
     } catch (...) {
-        DEBUG_LOG("WeChatAdapter: Exception in GetChatName");
+        LOG_ERROR("WeChatAdapter: Exception in GetChatName");
     }
 
     return L"";
@@ -222,260 +173,24 @@ std::vector<std::wstring> WeChatAdapter::GetRecentMessages(HWND hwnd,
 {
     std::vector<std::wstring> messages;
 
-    if (hwnd == nullptr || count <= 0) {
+    if (hwnd == nullptr || count <= 0 || uiHelper.IsCancelled()) {
         return messages;
     }
 
     try {
-        // Get the root element
-        IUIAutomation* automation = uiHelper.GetAutomation();
-        if (!automation) {
-            return messages;
+        // WeChat's message list structure varies by version: the left List
+        // is the conversation list, the right (wider) one the message area.
+        // WeChatScan::FindMessageList picks it once per window and
+        // remembers where it is; see element_scans.h.
+        AccessibleElementPtr window = uiHelper.GetWindowElement(hwnd);
+        if (window) {
+            messages = WeChatScan::FindRecentMessages(*window, count, uiHelper.GetToken(),
+                                                      UIAutomationHelper::GetPathScope(hwnd));
         }
 
-        IUIAutomationElement* rootElement = nullptr;
-        HRESULT hr = automation->ElementFromHandle(hwnd, &rootElement);
-        if (FAILED(hr) || !rootElement) {
-            return messages;
-        }
-
-        // WeChat's message list structure varies by version
-        // The left side is the conversation list, the right side (larger) is the message area
-        // Strategy: Find all List elements and pick the one that's likely the message area
-        //   - The message area is usually the second List (index >= 1)
-        //   - Or the one with more children (messages vs conversations)
-        //   - Or the one positioned more to the right
-
-        VARIANT var;
-        var.vt = VT_I4;
-        var.lVal = UIA_ListControlTypeId;
-
-        IUIAutomationCondition* condition = nullptr;
-        hr = automation->CreatePropertyCondition(UIA_ControlTypePropertyId, var, &condition);
-
-        if (SUCCEEDED(hr) && condition) {
-            IUIAutomationElementArray* foundElements = nullptr;
-            hr = rootElement->FindAll(TreeScope_Descendants, condition, &foundElements);
-
-            if (SUCCEEDED(hr) && foundElements) {
-                int length = 0;
-                foundElements->get_Length(&length);
-                DEBUG_LOG("WeChatAdapter: Found " + std::to_string(length) + " List elements");
-
-                // Find the best candidate for message list
-                // Heuristic: Skip the first List (usually conversation list)
-                // and find the List with the most children or largest bounding rect
-                IUIAutomationElement* messageListElement = nullptr;
-                int maxChildCount = 0;
-                int bestListIndex = -1;
-
-                for (int i = 0; i < length && i < 10; i++) {
-                    IUIAutomationElement* listElement = nullptr;
-                    hr = foundElements->GetElement(i, &listElement);
-
-                    if (SUCCEEDED(hr) && listElement) {
-                        // Get bounding rectangle to determine position
-                        RECT rect = {0};
-                        hr = listElement->get_CurrentBoundingRectangle(&rect);
-                        int width = rect.right - rect.left;
-                        int xPos = rect.left;
-
-                        // Get child count as another heuristic
-                        IUIAutomationCondition* trueCondition = nullptr;
-                        automation->CreateTrueCondition(&trueCondition);
-                        if (trueCondition) {
-                            IUIAutomationElementArray* children = nullptr;
-                            hr = listElement->FindAll(TreeScope_Children, trueCondition, &children);
-                            int childCount = 0;
-                            if (SUCCEEDED(hr) && children) {
-                                children->get_Length(&childCount);
-                                children->Release();
-                            }
-                            trueCondition->Release();
-
-                            DEBUG_LOG("WeChatAdapter: List[" + std::to_string(i) + "] x=" + 
-                                      std::to_string(xPos) + " width=" + std::to_string(width) +
-                                      " children=" + std::to_string(childCount));
-
-                            // The message list is typically:
-                            // - Not the first list (index > 0)
-                            // - Has a reasonable width (> 200 pixels)
-                            // - Positioned more to the right (xPos > some threshold)
-                            // 
-                            // For WeChat, the conversation list is on the left (~300px wide)
-                            // and the message area is on the right (much wider, x > 300)
-                            
-                            // Strategy: Prefer lists that are NOT the first one, and have children
-                            // If first list is skipped and we find one with children, use it
-                            if (i > 0 && childCount > 0 && width > 200) {
-                                // This is likely the message list
-                                if (childCount > maxChildCount) {
-                                    maxChildCount = childCount;
-                                    bestListIndex = i;
-                                    if (messageListElement) {
-                                        messageListElement->Release();
-                                    }
-                                    messageListElement = listElement;
-                                    listElement = nullptr;  // Prevent release below
-                                }
-                            }
-                        }
-
-                        if (listElement) {
-                            listElement->Release();
-                        }
-                    }
-                }
-
-                // If no good candidate found, try using position-based heuristic
-                // The rightmost list is usually the message area
-                if (!messageListElement && length > 1) {
-                    int maxXPos = 0;
-                    for (int i = 0; i < length && i < 10; i++) {
-                        IUIAutomationElement* listElement = nullptr;
-                        hr = foundElements->GetElement(i, &listElement);
-
-                        if (SUCCEEDED(hr) && listElement) {
-                            RECT rect = {0};
-                            hr = listElement->get_CurrentBoundingRectangle(&rect);
-                            int xPos = rect.left;
-                            int width = rect.right - rect.left;
-
-                            // Prefer rightmost list with reasonable width
-                            if (xPos > maxXPos && width > 200) {
-                                maxXPos = xPos;
-                                bestListIndex = i;
-                                if (messageListElement) {
-                                    messageListElement->Release();
-                                }
-                                messageListElement = listElement;
-                                listElement = nullptr;
-                            }
-
-                            if (listElement) {
-                                listElement->Release();
-                            }
-                        }
-                    }
-                }
-
-                DEBUG_LOG("WeChatAdapter: Selected list index " + std::to_string(bestListIndex) +
-                          " with " + std::to_string(maxChildCount) + " children");
-
-                // Extract messages from the selected list
-                if (messageListElement) {
-                    IUIAutomationCondition* trueCondition = nullptr;
-                    automation->CreateTrueCondition(&trueCondition);
-
-                    if (trueCondition) {
-                        IUIAutomationElementArray* messageElements = nullptr;
-                        hr = messageListElement->FindAll(TreeScope_Children, trueCondition, &messageElements);
-
-                        if (SUCCEEDED(hr) && messageElements) {
-                            int messageCount = 0;
-                            messageElements->get_Length(&messageCount);
-
-                            // Get last N messages (most recent)
-                            int startIndex = (messageCount - count > 0 ? messageCount - count : 0);
-                            for (int i = startIndex; i < messageCount; i++) {
-                                IUIAutomationElement* msgElement = nullptr;
-                                hr = messageElements->GetElement(i, &msgElement);
-
-                                if (SUCCEEDED(hr) && msgElement) {
-                                    std::wstring messageText = ExtractMessageText(msgElement, uiHelper);
-                                    if (!messageText.empty()) {
-                                        messages.push_back(messageText);
-                                    }
-                                    msgElement->Release();
-                                }
-                            }
-
-                            messageElements->Release();
-                        }
-                        trueCondition->Release();
-                    }
-
-                    messageListElement->Release();
-                }
-
-                foundElements->Release();
-            }
-            condition->Release();
-        }
-
-        rootElement->Release();
-
     } catch (...) {
-        DEBUG_LOG("WeChatAdapter: Exception in GetRecentMessages");
+        LOG_ERROR("WeChatAdapter: Exception in GetRecentMessages");
     }
 
     return messages;
 }
-
-std::wstring WeChatAdapter::ExtractMessageText(IUIAutomationElement* element,
-                                              UIAutomationHelper& uiHelper)
-{
-    if (!element) {
-        return L"";
-    }
-
-    try {
-        // Try to get the element's name (which often contains the message text)
-        std::wstring text = uiHelper.GetElementText(element);
-        if (!text.empty()) {
-            return text;
-        }
-
-        // If direct text is empty, try to find Text elements within
-        IUIAutomation* automation = uiHelper.GetAutomation();
-        if (!automation) {
-            return L"";
-        }
-
-        IUIAutomationCondition* trueCondition = nullptr;
-        automation->CreateTrueCondition(&trueCondition);
-
-        if (trueCondition) {
-            IUIAutomationElementArray* childElements = nullptr;
-            HRESULT hr = element->FindAll(TreeScope_Descendants, trueCondition, &childElements);
-
-            if (SUCCEEDED(hr) && childElements) {
-                int length = 0;
-                childElements->get_Length(&length);
-
-                std::wstring combinedText;
-                for (int i = 0; i < (length < 5 ? length : 5); i++) {  // Check first few children
-                    IUIAutomationElement* child = nullptr;
-                    hr = childElements->GetElement(i, &child);
-
-                    if (SUCCEEDED(hr) && child) {
-                        std::wstring childText = uiHelper.GetElementText(child);
-                        if (!childText.empty()) {
-                            if (!combinedText.empty()) {
-                                combinedText += L" ";
-                            }
-                            combinedText += childText;
-                        }
-                        child->Release();
-                    }
-                }
-
-                childElements->Release();
-                trueCondition->Release();
-
-                if (!combinedText.empty()) {
-                    return combinedText;
-                }
-            }
-
-            if (trueCondition) {
-                trueCondition->Release();
-            }
-        }
-
-    } catch (...) {
-        DEBUG_LOG("WeChatAdapter: Exception in ExtractMessageText");
-    }
-
-    return L"";
-}
@@ -50,6 +50,15 @@ public:
     bool CanHandle(const std::wstring& processName,
                   const std::wstring& windowTitle) override;
 
+    /**
+     * @brief Get process names handled by this adapter
+     *
+     * WeChat desktop.
+     *
+     * @return Lowercase process names (e.g., L"wechat.exe")
+     */
+    std::vector<std::wstring> GetProcessNames() const override;
+
     /**
      * @brief Get WeChat chat context
      *
@@ -61,9 +70,11 @@ public:
      * 5. Extract sender and content for each message
      *
      * @param source Source information (HWND, process name, window title)
+     * @param token Cancelled on timeout; element searches stop early
      * @return WeChatContext with chat info and recent messages
      */
-    std::shared_ptr<ContextData> GetContext(const SourceInfo& source) override;
+    std::shared_ptr<ContextData> GetContext(const SourceInfo& source,
+                                            const CancellationToken& token) override;
 
     /**
      * @brief Get adapter timeout
@@ -72,6 +83,15 @@ public:
      */
     int GetTimeout() const override { return m_timeout; }
 
+    /**
+     * @brief Get cache policy
+     *
+     * New messages arrive without a title change, so results go stale quickly.
+     *
+     * @return 3s fresh, served stale for another 15s, 16 chats
+     */
+    ContextCachePolicy GetCachePolicy() const override { return {3000, 15000, 16}; }
+
     /**
      * @brief Get adapter name
      *
@@ -84,9 +104,8 @@ private:
      * @brief Get current chat contact/group name
      *
      * Strategy:
-     * - Find top-level Static Text elements in main window
-     * - The chat name is usually the first significant text element
-     * - Filter out system UI text (buttons, tabs, etc.)
+     * - The first name-like Text element of the window (WeChatScan::FindChatName)
+     * - Else the window title ("ChatName - WeChat")
      *
      * @param hwnd WeChat main window handle
      * @param uiHelper UI Automation helper
@@ -111,11 +130,10 @@ private:
     /**
      * @brief Get recent messages from message list
      *
-     * Strategy:
-     * 1. Find message list container (scrollable area)
-     * 2. Traverse child elements to find message items
-     * 3. Extract sender name and message content
-     * 4. Return most recent N messages
+     * Strategy (WeChatScan::FindRecentMessages):
+     * 1. Pick the message list among the window's List elements
+     * 2. Take its last N items
+     * 3. Read each item's text (its name, or its first descendants' names)
      *
      * Note: WeChat's message list structure is complex and may vary
      * between versions. This implementation tries common patterns.
@@ -129,16 +147,6 @@ private:
                                                 UIAutomationHelper& uiHelper,
                                                 int count);
 
-    /**
-     * @brief Extract message text from a message element
-     *
-     * @param element Message UI element
-     * @param uiHelper UI Automation helper
-     * @return Message text, or empty if extraction failed
-     */
-    std::wstring ExtractMessageText(IUIAutomationElement* element,
-                                    UIAutomationHelper& uiHelper);
-
     int m_timeout;       // Timeout in milliseconds
     int m_messageCount;  // Number of recent messages to capture
 };
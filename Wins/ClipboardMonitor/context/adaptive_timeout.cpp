@@ -0,0 +1,98 @@
+#include "adaptive_timeout.h"
+#include "context_adapter.h"
+#include "../debug_log.h"
+#include "../utils.h"
+#include <algorithm>
+#include <cmath>
+
+void AdaptiveTimeout::SetPolicy(const AdaptiveTimeoutPolicy& policy) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_policy = policy;
+    m_policy.percentile = std::clamp(m_policy.percentile, 0.0, 1.0);
+    m_policy.ceilingMs = std::max(m_policy.ceilingMs, m_policy.floorMs);
+    m_policy.minSamples = std::clamp<size_t>(m_policy.minSamples, 1, kWindow);
+}
+
+void AdaptiveTimeout::Record(const IContextAdapter* adapter, const std::wstring& processName,
+                             int elapsedMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Series& series = m_series[adapter];
+    if (series.name.empty()) {
+        series.name = Utils::WideToUtf8(adapter->GetAdapterName());
+    }
+
+    Add(series.all, elapsedMs);
+
+    Window& window = series.processes[Utils::ToLower(processName)];
+    int previous = window.timeoutMs;
+    Add(window, elapsedMs);
+
+    // Only report real moves, not sample-to-sample jitter
+    if (window.timeoutMs != 0 && std::abs(window.timeoutMs - previous) * 10 > previous) {
+        LOG_DEBUG("Adaptive timeout {} ({}): {}ms -> {}ms (p={}ms over {} fetches)",
+                  series.name, processName, previous, window.timeoutMs,
+                  window.percentileMs, window.count);
+    }
+}
+
+void AdaptiveTimeout::Add(Window& window, int elapsedMs) {
+    window.samples[window.next] = std::max(elapsedMs, 0);
+    window.next = (window.next + 1) % kWindow;
+    window.count = std::min(window.count + 1, kWindow);
+
+    if (window.count < m_policy.minSamples) {
+        return;
+    }
+
+    // Nearest-rank percentile of a copy (at most kWindow values)
+    int sorted[kWindow];
+    std::copy(window.samples, window.samples + window.count, sorted);
+    size_t rank = static_cast<size_t>(std::ceil(m_policy.percentile * window.count));
+    size_t index = rank > 0 ? rank - 1 : 0;
+    std::nth_element(sorted, sorted + index, sorted + window.count);
+
+    window.percentileMs = sorted[index];
+    int timeout = static_cast<int>(window.percentileMs * m_policy.headroom);
+    window.timeoutMs = std::clamp(timeout, m_policy.floorMs, m_policy.ceilingMs);
+}
+
+int AdaptiveTimeout::GetTimeout(const IContextAdapter* adapter, const std::wstring& processName,
+                                int configuredMs) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto series = m_series.find(adapter);
+    if (series == m_series.end()) {
+        return configuredMs;
+    }
+
+    auto process = series->second.processes.find(Utils::ToLower(processName));
+    if (process != series->second.processes.end() && process->second.timeoutMs > 0) {
+        return process->second.timeoutMs;
+    }
+    if (series->second.all.timeoutMs > 0) {
+        return series->second.all.timeoutMs;
+    }
+    return configuredMs;
+}
+
+std::vector<AdaptiveTimeout::Snapshot> AdaptiveTimeout::GetSnapshot() const {
+    std::vector<Snapshot> rows;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& series : m_series) {
+        auto addRow = [&](const std::string& process, const Window& window) {
+            Snapshot row;
+            row.adapter = series.second.name;
+            row.process = process;
+            row.samples = window.count;
+            row.percentileMs = window.percentileMs;
+            row.timeoutMs = window.timeoutMs;
+            rows.push_back(std::move(row));
+        };
+
+        addRow(std::string(), series.second.all);
+        for (const auto& process : series.second.processes) {
+            addRow(Utils::WideToUtf8(process.first), process.second);
+        }
+    }
+    return rows;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class IContextAdapter;
+
+// How effective timeouts are derived from observed fetch times
+struct AdaptiveTimeoutPolicy {
+    double percentile = 0.95;   // Of the recent fetch times
+    double headroom = 1.5;      // Multiplier on that percentile
+    int floorMs = 150;
+    int ceilingMs = 5000;
+    size_t minSamples = 8;      // Below this the configured timeout is used
+};
+
+// Per-adapter and per-process timeouts from a rolling latency window.
+//
+// A fixed timeout is either too long for an adapter that is stuck (every
+// copy ties up a worker for seconds) or too short for one that is simply
+// slow (WeChat routinely takes 1-2s). Each fetch's end-to-end time is
+// recorded in a window of the last kWindow samples, per adapter and per
+// process; the timeout is percentile * headroom of that window, clamped to
+// [floorMs, ceilingMs]. A fetch cut off by its timeout is recorded at the
+// timeout, so frequent timeouts raise the percentile and the next timeout
+// with it, up to the ceiling.
+class AdaptiveTimeout {
+public:
+    static constexpr size_t kWindow = 64;
+
+    struct Snapshot {
+        std::string adapter;
+        std::string process;      // Empty for the adapter-wide window
+        size_t samples = 0;
+        int percentileMs = 0;
+        int timeoutMs = 0;        // 0 while below minSamples
+    };
+
+    AdaptiveTimeout() = default;
+
+    // Disable copy
+    AdaptiveTimeout(const AdaptiveTimeout&) = delete;
+    AdaptiveTimeout& operator=(const AdaptiveTimeout&) = delete;
+
+    void SetPolicy(const AdaptiveTimeoutPolicy& policy);
+
+    // Record one fetch (successful or timed out; fast failures say nothing
+    // about how long a fetch needs and should not be recorded)
+    void Record(const IContextAdapter* adapter, const std::wstring& processName, int elapsedMs);
+
+    // Effective timeout: from the process's window once it has enough
+    // samples, else the adapter's, else configuredMs
+    int GetTimeout(const IContextAdapter* adapter, const std::wstring& processName,
+                   int configuredMs) const;
+
+    // One row per adapter, then one per process seen with it
+    std::vector<Snapshot> GetSnapshot() const;
+
+private:
+    // Ring buffer of the last kWindow samples
+    struct Window {
+        int samples[kWindow] = {};
+        size_t count = 0;
+        size_t next = 0;
+        int percentileMs = 0;
+        int timeoutMs = 0;
+    };
+
+    struct Series {
+        std::string name;
+        Window all;
+        std::unordered_map<std::wstring, Window> processes;   // Lowercase names
+    };
+
+    // Add a sample and recompute the window's timeout
+    void Add(Window& window, int elapsedMs);
+
+    mutable std::mutex m_mutex;
+    AdaptiveTimeoutPolicy m_policy;
+    std::unordered_map<const IContextAdapter*, Series> m_series;
+};
@@ -1,9 +1,51 @@
 #include "async_executor.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Identifies the executor and deque index of the current worker thread, so
+// tasks submitted from inside a task land on that worker's own deque
+thread_local const AsyncExecutor* t_executor = nullptr;
+thread_local size_t t_workerIndex = 0;
+
+// Task currently running on this worker, for run time metrics
+struct RunningTask {
+    uint32_t tag = 0;
+    std::chrono::steady_clock::time_point start;
+    bool measured = true;
+};
+thread_local RunningTask t_running;
+
+} // namespace
+
+AsyncExecutor::AsyncExecutor(size_t threadCount, WorkerHooks hooks)
+    : m_hooks(std::move(hooks))
+    , m_nextSequence(0)
+    , m_backgroundLimit(1)
+    , m_backgroundQueued(0)
+    , m_backgroundRunning(0)
+    , m_dropped(0)
+    , m_queued(0)
+    , m_parked(0)
+    , m_running(0)
+    , m_stop(false)
+{
+    if (threadCount == 0) {
+        threadCount = DefaultThreadCount();
+    }
+
+    // Keep one worker free of background work for interactive tasks
+    m_backgroundLimit = (std::max<size_t>)(1, threadCount - 1);
+
+    // Queues must all exist before any worker starts stealing
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
 
-AsyncExecutor::AsyncExecutor(size_t threadCount) : m_stop(false) {
     // Create worker threads
     for (size_t i = 0; i < threadCount; ++i) {
-        m_workers.emplace_back([this] { WorkerThread(); });
+        m_workers.emplace_back([this, i] { WorkerThread(i); });
     }
 }
 
@@ -11,39 +53,233 @@ AsyncExecutor::~AsyncExecutor() {
     Shutdown();
 }
 
-void AsyncExecutor::WorkerThread() {
+size_t AsyncExecutor::DefaultThreadCount() {
+    size_t hardware = std::thread::hardware_concurrency();
+    return std::clamp<size_t>(hardware / 2, 2, 8);
+}
+
+void AsyncExecutor::Enqueue(Task task, const TaskOptions& options) {
+    if (!TryPost(task, options)) {
+        throw std::runtime_error("Cannot submit task on stopped executor");
+    }
+}
+
+bool AsyncExecutor::TryPost(Task& task, const TaskOptions& options) {
+    // Check m_stop and queue under m_parkMutex: a worker decides to exit under
+    // it too, so it either sees this task or we see the stop and reject
+    std::unique_lock<std::mutex> stopLock(m_parkMutex);
+    if (m_stop) {
+        return false;
+    }
+
+    bool plain = options.priority == TaskPriority::Normal &&
+                 options.deadline == Clock::time_point::max();
+
+    QueuedTask item{std::move(task), Clock::now(), options.tag};
+
+    if (plain && t_executor == this) {
+        WorkerQueue& queue = *m_queues[t_workerIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(item));
+    } else {
+        std::lock_guard<std::mutex> lock(m_scheduledMutex);
+        auto& heap = m_scheduled[static_cast<size_t>(options.priority)];
+        heap.push_back({std::move(item), options.deadline, m_nextSequence++});
+        std::push_heap(heap.begin(), heap.end(), LaterDeadline());
+        if (options.priority == TaskPriority::Background) {
+            m_backgroundQueued.fetch_add(1);
+        }
+    }
+
+    // A worker checks for tasks under m_parkMutex before waiting, so it either
+    // sees this one or is counted as parked here and woken
+    m_queued.fetch_add(1);
+    bool wake = m_parked.load() > 0;
+    stopLock.unlock();
+    if (wake) {
+        m_parkCondition.notify_one();
+    }
+    return true;
+}
+
+bool AsyncExecutor::PopLocal(size_t index, QueuedTask& task) {
+    WorkerQueue& queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = queue.tasks.pop_back();
+    return true;
+}
+
+bool AsyncExecutor::PopScheduled(TaskPriority priority, QueuedTask& task) {
+    bool background = priority == TaskPriority::Background;
+    std::vector<Task> expired;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(m_scheduledMutex);
+        auto& heap = m_scheduled[static_cast<size_t>(priority)];
+        auto now = Clock::now();
+
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), LaterDeadline());
+            ScheduledTask next = std::move(heap.back());
+            heap.pop_back();
+            if (background) {
+                m_backgroundQueued.fetch_sub(1);
+            }
+
+            if (next.deadline < now) {
+                // Nobody is waiting for the result any more
+                expired.push_back(std::move(next.item.task));
+                continue;
+            }
+
+            task = std::move(next.item);
+            found = true;
+            break;
+        }
+    }
+
+    // Destroying a dropped task breaks its promise; do it unlocked
+    if (!expired.empty()) {
+        m_queued.fetch_sub(expired.size());
+        m_dropped.fetch_add(expired.size(), std::memory_order_relaxed);
+        expired.clear();
+    }
+    return found;
+}
+
+bool AsyncExecutor::Steal(size_t index, QueuedTask& task) {
+    size_t count = m_queues.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        WorkerQueue& victim = *m_queues[(index + offset) % count];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty()) {
+            continue;  // Busy or empty - try the next worker
+        }
+        task = victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+size_t AsyncExecutor::RunnableCount() const {
+    size_t queued = m_queued.load();
+    if (m_backgroundRunning.load() >= m_backgroundLimit) {
+        size_t blocked = m_backgroundQueued.load();
+        return queued > blocked ? queued - blocked : 0;
+    }
+    return queued;
+}
+
+void AsyncExecutor::RunTask(QueuedTask& item) {
+    m_queued.fetch_sub(1);
+    m_running.fetch_add(1);
+
+    auto start = Clock::now();
+    m_metrics.RecordWait(item.tag, static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(start - item.enqueued).count()));
+
+    // Execute task outside any lock
+    t_running = {item.tag, start, false};
+    item.task();
+    item.task = nullptr;
+    EndRunMeasurement();
+
+    m_running.fetch_sub(1);
+}
+
+void AsyncExecutor::EndRunMeasurement() {
+    if (t_executor != this || t_running.measured) {
+        return;
+    }
+    t_running.measured = true;
+    m_metrics.RecordRun(t_running.tag, static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t_running.start).count()));
+}
+
+ExecutorMetrics::Snapshot AsyncExecutor::GetMetricsSnapshot() const {
+    ExecutorMetrics::Snapshot snapshot;
+    snapshot.threads = m_queues.size();
+    snapshot.queueDepth = m_queued.load();
+    snapshot.running = m_running.load();
+    snapshot.dropped = m_dropped.load(std::memory_order_relaxed);
+    snapshot.tags = m_metrics.Summarize();
+    return snapshot;
+}
+
+void AsyncExecutor::WorkerThread(size_t index) {
+    t_executor = this;
+    t_workerIndex = index;
+
+    if (m_hooks.onStart) {
+        m_hooks.onStart(index);
+    }
+
     while (true) {
-        Task task;
-        {
-            std::unique_lock<std::mutex> lock(m_queueMutex);
-            m_condition.wait(lock, [this] {
-                return m_stop || !m_tasks.empty();
-            });
-
-            if (m_stop && m_tasks.empty()) {
-                return;
+        QueuedTask task;
+        if (PopScheduled(TaskPriority::Interactive, task) || PopLocal(index, task) ||
+            PopScheduled(TaskPriority::Normal, task) || Steal(index, task)) {
+            RunTask(task);
+            continue;
+        }
+
+        // Background work only while a slot below the limit is free
+        if (m_backgroundRunning.fetch_add(1) < m_backgroundLimit) {
+            bool ran = PopScheduled(TaskPriority::Background, task);
+            if (ran) {
+                RunTask(task);
+            }
+            m_backgroundRunning.fetch_sub(1);
+
+            // A worker may have parked while this slot was taken
+            if (m_backgroundQueued.load() > 0 && m_parked.load() > 0) {
+                {
+                    std::lock_guard<std::mutex> lock(m_parkMutex);
+                }
+                m_parkCondition.notify_one();
+            }
+            if (ran) {
+                continue;
             }
+        } else {
+            m_backgroundRunning.fetch_sub(1);
+        }
+
+        // Nothing found: park until a task is queued or we are stopping
+        std::unique_lock<std::mutex> lock(m_parkMutex);
+        m_parked.fetch_add(1);
+        m_parkCondition.wait(lock, [this] {
+            return m_stop || RunnableCount() > 0;
+        });
+        m_parked.fetch_sub(1);
 
-            task = std::move(m_tasks.front());
-            m_tasks.pop();
+        // Queued background tasks are left to the workers already running them
+        if (m_stop && RunnableCount() == 0) {
+            break;
         }
+    }
 
-        // Execute task outside the lock
-        task();
+    if (m_hooks.onStop) {
+        m_hooks.onStop(index);
     }
 }
 
 void AsyncExecutor::Shutdown() {
     {
-        std::unique_lock<std::mutex> lock(m_queueMutex);
+        std::unique_lock<std::mutex> lock(m_parkMutex);
         m_stop = true;
     }
 
-    m_condition.notify_all();
+    m_parkCondition.notify_all();
 
     for (auto& worker : m_workers) {
         if (worker.joinable()) {
             worker.join();
         }
     }
+
+    // Workers have drained the queue; remaining timeouts are moot
+    m_timers.Shutdown();
 }
@@ -1,38 +1,124 @@
 #pragma once
 
+#include <coroutine>
+#include <exception>
 #include <functional>
-#include <future>
-#include <queue>
+#include <memory>
+#include <optional>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <tuple>
 #include <vector>
+#include "timer_queue.h"
+#include "task_function.h"
+#include "task_future.h"
+#include "executor_metrics.h"
 
-// Async executor with thread pool
+// Scheduling class of a task, highest first
+enum class TaskPriority {
+    Interactive = 0,   // User is waiting (Ctrl+C+C capture, annotation)
+    Normal = 1,        // Regular clipboard capture
+    Background = 2     // Maintenance; never holds every worker
+};
+
+// Scheduling options for a submitted task
+struct TaskOptions {
+    TaskPriority priority = TaskPriority::Normal;
+
+    // Run earliest-deadline-first within the class; a task still queued when
+    // its deadline passes is dropped without running (its future reports
+    // broken_promise)
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    // Metrics tag from RegisterMetricsTag (wait/run times are kept per tag)
+    uint32_t tag = ExecutorMetrics::kUntagged;
+};
+
+// Async executor with a work-stealing thread pool
+//
+// Submissions from other threads are queued per priority class and ordered
+// by deadline. Tasks submitted from a worker without options go to that
+// worker's own deque (popped LIFO for cache locality). An idle worker takes
+// work in this order: Interactive, own deque, Normal, steal the oldest task
+// from another worker, Background - and parks only when all are empty.
 class AsyncExecutor {
 public:
-    using Task = std::function<void()>;
+    using Task = TaskFunction;
+
+    // Per-worker setup and teardown, each run on the worker thread itself
+    // with its index: onStart before the first task, onStop after the last.
+    // Used to give every worker a long-lived COM apartment.
+    struct WorkerHooks {
+        std::function<void(size_t)> onStart;
+        std::function<void(size_t)> onStop;
+    };
 
     // Constructor
-    // threadCount: Number of worker threads (default: 2)
-    explicit AsyncExecutor(size_t threadCount = 2);
+    // threadCount: Number of worker threads (0 = DefaultThreadCount())
+    // hooks: Optional per-worker thread start/stop hooks
+    explicit AsyncExecutor(size_t threadCount = 0, WorkerHooks hooks = WorkerHooks());
 
     // Destructor
     ~AsyncExecutor();
 
     // Submit a task and return a future
+    // Small callables are stored inline and the future's state is pooled, so
+    // steady-state submission does not allocate
     template<typename Func, typename... Args>
     auto Submit(Func&& func, Args&&... args)
-        -> std::future<typename std::invoke_result_t<Func, Args...>>;
+        -> TaskFuture<typename std::invoke_result_t<Func, Args...>>;
+
+    // Submit a task with a priority class and deadline
+    template<typename Func>
+    auto SubmitWithOptions(const TaskOptions& options, Func&& func)
+        -> TaskFuture<typename std::invoke_result_t<Func>>;
 
     // Submit a task with timeout
     // func: Task function
-    // timeoutMs: Timeout in milliseconds
-    // onTimeout: Callback when timeout occurs
+    // timeoutMs: Timeout in milliseconds, also the task's scheduling deadline
+    //            (a task not started by then is dropped)
+    // onTimeout: Callback when timeout occurs (runs on the timer thread;
+    //            cancelled if the task finishes first)
+    // options: Priority class and metrics tag (the deadline comes from timeoutMs)
     template<typename Func>
     void SubmitWithTimeout(Func&& func, int timeoutMs,
-                          std::function<void()> onTimeout = nullptr);
+                          std::function<void()> onTimeout = nullptr,
+                          TaskOptions options = TaskOptions());
+
+    // Queue a task after a delay (e.g. periodic maintenance); the result is
+    // not observable. Dropped silently if the executor has stopped by then.
+    template<typename Func>
+    void SubmitAfter(int delayMs, const TaskOptions& options, Func&& func);
+
+    // Queue a task without a future
+    // Returns false (leaving task untouched) if the executor has stopped
+    bool TryPost(Task& task, const TaskOptions& options = TaskOptions());
+
+    // Run callback on the shared timer thread after delayMs; keep it short
+    TimerQueue::TimerId ScheduleTimer(int delayMs, TimerQueue::Callback callback) {
+        return m_timers.Schedule(std::chrono::milliseconds(delayMs), std::move(callback));
+    }
+    bool CancelTimer(TimerQueue::TimerId id) { return m_timers.Cancel(id); }
+
+    // Awaitable that runs func on a worker and resumes the awaiting
+    // coroutine there with its result:
+    //     auto value = co_await executor.Run(options, [] { return Work(); });
+    // Throws std::future_error(broken_promise) if the task was dropped past
+    // its deadline, std::runtime_error if the executor has stopped.
+    template<typename Func>
+    class RunAwaiter;
+
+    template<typename Func>
+    RunAwaiter<std::decay_t<Func>> Run(const TaskOptions& options, Func&& func);
+
+    // Awaitable that moves the awaiting coroutine onto a worker
+    struct NoWork {
+        void operator()() const {}
+    };
+    RunAwaiter<NoWork> Schedule(const TaskOptions& options = TaskOptions());
 
     // Shutdown the executor
     void Shutdown();
@@ -40,54 +126,321 @@ public:
     // Check if executor is running
     bool IsRunning() const { return !m_stop; }
 
+    // Number of worker threads
+    size_t GetThreadCount() const { return m_queues.size(); }
+
+    // Tasks queued but not yet started (cheap enough to check per request)
+    size_t GetQueueDepth() const { return m_queued.load(std::memory_order_relaxed); }
+
+    // Tasks dropped because their deadline passed while queued
+    size_t GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // Name a group of tasks for wait/run time metrics (e.g. one per adapter)
+    // Returns the same tag for the same name; kUntagged once the table is full
+    uint32_t RegisterMetricsTag(const std::string& name) { return m_metrics.RegisterTag(name); }
+
+    // Queue depth and per-tag wait/run percentiles
+    ExecutorMetrics::Snapshot GetMetricsSnapshot() const;
+
+    // Half the hardware threads, clamped to [2, 8]
+    static size_t DefaultThreadCount();
+
 private:
+    using Clock = std::chrono::steady_clock;
+
+    // A task with the bookkeeping needed for metrics
+    struct QueuedTask {
+        Task task;
+        Clock::time_point enqueued;
+        uint32_t tag = ExecutorMetrics::kUntagged;
+    };
+
+    // Growable ring buffer of tasks; keeps its capacity when drained so
+    // steady-state pushes do not allocate (std::deque frees and reallocates
+    // its blocks)
+    class TaskDeque {
+    public:
+        bool empty() const { return m_count == 0; }
+
+        void push_back(QueuedTask task) {
+            if (m_count == m_slots.size()) {
+                Grow();
+            }
+            m_slots[(m_head + m_count) % m_slots.size()] = std::move(task);
+            ++m_count;
+        }
+
+        QueuedTask pop_back() {
+            --m_count;
+            return std::move(m_slots[(m_head + m_count) % m_slots.size()]);
+        }
+
+        QueuedTask pop_front() {
+            QueuedTask task = std::move(m_slots[m_head]);
+            m_head = (m_head + 1) % m_slots.size();
+            --m_count;
+            return task;
+        }
+
+    private:
+        void Grow() {
+            std::vector<QueuedTask> slots(m_slots.empty() ? 64 : m_slots.size() * 2);
+            for (size_t i = 0; i < m_count; ++i) {
+                slots[i] = std::move(m_slots[(m_head + i) % m_slots.size()]);
+            }
+            m_slots.swap(slots);
+            m_head = 0;
+        }
+
+        std::vector<QueuedTask> m_slots;
+        size_t m_head = 0;
+        size_t m_count = 0;
+    };
+
+    // Per-worker task deque: the owner pushes/pops at the back, thieves take
+    // from the front. Each has its own lock, so workers rarely contend.
+    struct WorkerQueue {
+        std::mutex mutex;
+        TaskDeque tasks;
+    };
+
     // Worker thread function
-    void WorkerThread();
+    void WorkerThread(size_t index);
+
+    // Entry in a priority class's deadline heap
+    struct ScheduledTask {
+        QueuedTask item;
+        Clock::time_point deadline;
+        uint64_t sequence;   // FIFO among equal deadlines
+    };
+
+    // Heap order: earliest deadline on top
+    struct LaterDeadline {
+        bool operator()(const ScheduledTask& a, const ScheduledTask& b) const {
+            if (a.deadline != b.deadline) return a.deadline > b.deadline;
+            return a.sequence > b.sequence;
+        }
+    };
+
+    static constexpr size_t kPriorityCount = 3;
+
+    // Queue a task: own deque for a plain submit from a worker, else the
+    // heap of its priority class
+    void Enqueue(Task task, const TaskOptions& options = TaskOptions());
+
+    // Task sources for a worker, in the order they are tried
+    bool PopLocal(size_t index, QueuedTask& task);
+    bool PopScheduled(TaskPriority priority, QueuedTask& task);
+    bool Steal(size_t index, QueuedTask& task);
+
+    // Run a dequeued task, recording its wait and run time
+    void RunTask(QueuedTask& task);
+
+    // Record the current task's run time now rather than when it returns,
+    // so a coroutine resumed at its end is not counted against its tag
+    void EndRunMeasurement();
+
+    // Queued tasks a worker may start now (queued Background tasks do not
+    // count while the background limit is reached)
+    size_t RunnableCount() const;
 
     std::vector<std::thread> m_workers;
-    std::queue<Task> m_tasks;
-    std::mutex m_queueMutex;
-    std::condition_variable m_condition;
+    WorkerHooks m_hooks;
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+
+    // Per-class deadline heaps for submissions from non-worker threads
+    std::vector<ScheduledTask> m_scheduled[kPriorityCount];
+    std::mutex m_scheduledMutex;
+    uint64_t m_nextSequence;
+
+    // Background tasks may occupy at most this many workers at once
+    size_t m_backgroundLimit;
+    std::atomic<size_t> m_backgroundQueued;
+    std::atomic<size_t> m_backgroundRunning;
+    std::atomic<size_t> m_dropped;
+
+    // Parking for idle workers
+    std::mutex m_parkMutex;
+    std::condition_variable m_parkCondition;
+    std::atomic<size_t> m_queued;   // Tasks pushed but not yet taken
+    std::atomic<size_t> m_parked;   // Workers waiting on m_parkCondition
+    std::atomic<size_t> m_running;  // Tasks currently executing
+
+    ExecutorMetrics m_metrics;
+
     std::atomic<bool> m_stop;
+
+    // Shared timeout service for SubmitWithTimeout
+    TimerQueue m_timers;
 };
 
 // Template implementations
 
-template<typename Func, typename... Args>
-auto AsyncExecutor::Submit(Func&& func, Args&&... args)
-    -> std::future<typename std::invoke_result_t<Func, Args...>>
-{
-    using ReturnType = typename std::invoke_result_t<Func, Args...>;
+template<typename Func>
+class AsyncExecutor::RunAwaiter {
+public:
+    using ReturnType = std::invoke_result_t<Func&>;
+
+    RunAwaiter(AsyncExecutor& executor, const TaskOptions& options, Func func)
+        : m_executor(&executor), m_options(options), m_func(std::move(func)), m_rejected(false) {}
+
+    bool await_ready() const noexcept { return false; }
 
-    auto task = std::make_shared<std::packaged_task<ReturnType()>>(
-        std::bind(std::forward<Func>(func), std::forward<Args>(args)...)
-    );
+    bool await_suspend(std::coroutine_handle<> awaiting) {
+        Task task(Resumer(this, awaiting));
+        if (m_executor->TryPost(task, m_options)) {
+            // May already be resuming on a worker - don't touch *this
+            return true;
+        }
 
-    std::future<ReturnType> result = task->get_future();
+        // Executor stopped: the task's destructor must not resume us
+        m_rejected = true;
+        m_error = std::make_exception_ptr(std::runtime_error("Cannot submit task on stopped executor"));
+        return false;
+    }
 
-    {
-        std::unique_lock<std::mutex> lock(m_queueMutex);
-        if (m_stop) {
-            throw std::runtime_error("Cannot submit task on stopped executor");
+    ReturnType await_resume() {
+        if (m_error) {
+            std::rethrow_exception(m_error);
+        }
+        if constexpr (!std::is_void_v<ReturnType>) {
+            return std::move(*m_result);
         }
-        m_tasks.emplace([task]() { (*task)(); });
     }
 
-    m_condition.notify_one();
+private:
+    // Queued task: runs func, then resumes the coroutine. If the executor
+    // drops it unrun, its destructor resumes with broken_promise instead.
+    class Resumer {
+    public:
+        Resumer(RunAwaiter* awaiter, std::coroutine_handle<> awaiting)
+            : m_awaiter(awaiter), m_awaiting(awaiting) {}
+        Resumer(Resumer&& other) noexcept
+            : m_awaiter(std::exchange(other.m_awaiter, nullptr)), m_awaiting(other.m_awaiting) {}
+        Resumer(const Resumer&) = delete;
+        Resumer& operator=(const Resumer&) = delete;
+        Resumer& operator=(Resumer&&) = delete;
+
+        ~Resumer() {
+            RunAwaiter* awaiter = std::exchange(m_awaiter, nullptr);
+            if (awaiter && !awaiter->m_rejected) {
+                awaiter->m_error = std::make_exception_ptr(
+                    std::future_error(std::future_errc::broken_promise));
+                m_awaiting.resume();
+            }
+        }
+
+        void operator()() {
+            RunAwaiter* awaiter = std::exchange(m_awaiter, nullptr);
+            try {
+                if constexpr (std::is_void_v<ReturnType>) {
+                    awaiter->m_func();
+                } else {
+                    awaiter->m_result.emplace(awaiter->m_func());
+                }
+            } catch (...) {
+                awaiter->m_error = std::current_exception();
+            }
+            awaiter->m_executor->EndRunMeasurement();
+            m_awaiting.resume();
+        }
+
+    private:
+        RunAwaiter* m_awaiter;
+        std::coroutine_handle<> m_awaiting;
+    };
+
+    using Stored = std::conditional_t<std::is_void_v<ReturnType>, bool, ReturnType>;
+
+    AsyncExecutor* m_executor;
+    TaskOptions m_options;
+    Func m_func;
+    std::optional<Stored> m_result;
+    std::exception_ptr m_error;
+    bool m_rejected;
+};
+
+template<typename Func, typename... Args>
+auto AsyncExecutor::Submit(Func&& func, Args&&... args)
+    -> TaskFuture<typename std::invoke_result_t<Func, Args...>>
+{
+    if constexpr (sizeof...(Args) == 0) {
+        return SubmitWithOptions(TaskOptions(), std::forward<Func>(func));
+    } else {
+        // Bound arguments are passed as lvalues, as std::bind did
+        return SubmitWithOptions(TaskOptions(),
+            [func = std::forward<Func>(func),
+             args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                return std::apply(func, args);
+            });
+    }
+}
+
+template<typename Func>
+auto AsyncExecutor::SubmitWithOptions(const TaskOptions& options, Func&& func)
+    -> TaskFuture<typename std::invoke_result_t<Func>>
+{
+    using ReturnType = typename std::invoke_result_t<Func>;
+
+    TaskPromise<ReturnType> promise;
+    TaskFuture<ReturnType> result = promise.GetFuture();
+
+    // A dropped task destroys the promise unset, which reports broken_promise
+    Enqueue([promise = std::move(promise), func = std::forward<Func>(func)]() mutable {
+        promise.SetFrom(func);
+    }, options);
     return result;
 }
 
 template<typename Func>
 void AsyncExecutor::SubmitWithTimeout(Func&& func, int timeoutMs,
-                                     std::function<void()> onTimeout)
+                                     std::function<void()> onTimeout,
+                                     TaskOptions options)
 {
-    auto future = Submit(std::forward<Func>(func));
+    options.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
 
-    // Wait for future with timeout in a detached thread
-    std::thread([future = std::move(future), timeoutMs, onTimeout]() mutable {
-        auto status = future.wait_for(std::chrono::milliseconds(timeoutMs));
-        if (status == std::future_status::timeout && onTimeout) {
-            onTimeout();
-        }
-    }).detach();
+    if (!onTimeout) {
+        SubmitWithOptions(options, std::forward<Func>(func));
+        return;
+    }
+
+    // Arm the timeout first so a fast task cannot finish before it exists
+    TimerQueue::TimerId timer = m_timers.Schedule(std::chrono::milliseconds(timeoutMs), std::move(onTimeout));
+
+    try {
+        SubmitWithOptions(options, [this, timer, func = std::forward<Func>(func)]() mutable {
+            try {
+                func();
+            } catch (...) {
+                m_timers.Cancel(timer);
+                throw;
+            }
+            m_timers.Cancel(timer);
+        });
+    } catch (...) {
+        m_timers.Cancel(timer);
+        throw;
+    }
+}
+
+template<typename Func>
+void AsyncExecutor::SubmitAfter(int delayMs, const TaskOptions& options, Func&& func)
+{
+    m_timers.Schedule(std::chrono::milliseconds(delayMs),
+        [this, options, func = std::forward<Func>(func)]() mutable {
+            if (!m_stop) {
+                SubmitWithOptions(options, std::move(func));
+            }
+        });
+}
+
+template<typename Func>
+AsyncExecutor::RunAwaiter<std::decay_t<Func>> AsyncExecutor::Run(const TaskOptions& options, Func&& func)
+{
+    return RunAwaiter<std::decay_t<Func>>(*this, options, std::forward<Func>(func));
+}
+
+inline AsyncExecutor::RunAwaiter<AsyncExecutor::NoWork> AsyncExecutor::Schedule(const TaskOptions& options)
+{
+    return Run(options, NoWork());
 }
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+// Cooperative cancellation for a context fetch.
+//
+// ContextManager creates one token per fetch with the adapter's deadline and
+// cancels it when the timeout fires. Adapters and UIAutomationHelper poll
+// IsCancelled() between UI Automation tree operations and return early, so a
+// timed-out fetch frees its worker instead of running to completion.
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Token that is only cancelled explicitly
+    CancellationToken() : m_cancelled(false), m_hasDeadline(false) {}
+
+    // Token that also counts as cancelled once the deadline has passed
+    explicit CancellationToken(Clock::time_point deadline)
+        : m_cancelled(false), m_hasDeadline(true), m_deadline(deadline) {}
+
+    // Disable copy (shared by reference between the task and its timeout)
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    // Request cancellation; safe to call from any thread
+    void Cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+
+    // Cheap enough to call inside element loops
+    bool IsCancelled() const {
+        if (m_cancelled.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        return m_hasDeadline && Clock::now() >= m_deadline;
+    }
+
+    // Token that is never cancelled, for callers without a deadline
+    static const CancellationToken& None() {
+        static const CancellationToken token;
+        return token;
+    }
+
+private:
+    std::atomic<bool> m_cancelled;
+    bool m_hasDeadline;
+    Clock::time_point m_deadline;
+};
@@ -0,0 +1,122 @@
+#include "circuit_breaker.h"
+#include "../debug_log.h"
+#include <algorithm>
+
+CircuitBreaker::CircuitBreaker(std::string name, const CircuitBreakerPolicy& policy)
+    : m_name(std::move(name))
+    , m_policy(policy)
+    , m_state(State::Closed)
+    , m_next(0)
+    , m_count(0)
+    , m_failures(0)
+    , m_probe(kNotProbe)
+    , m_lastTicket(kNotProbe)
+    , m_rejected(0)
+    , m_opened(0)
+{
+    m_policy.window = std::max<size_t>(m_policy.window, 1);
+    m_policy.minRequests = std::clamp<size_t>(m_policy.minRequests, 1, m_policy.window);
+    m_outcomes.assign(m_policy.window, false);
+}
+
+bool CircuitBreaker::Allow(Ticket& ticket) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ticket = kNotProbe;
+    switch (m_state) {
+        case State::Closed:
+            return true;
+
+        case State::Open:
+            if (Clock::now() - m_openedAt < std::chrono::milliseconds(m_policy.openMs)) {
+                ++m_rejected;
+                return false;
+            }
+            TransitionTo(State::HalfOpen);
+            break;
+
+        case State::HalfOpen:
+            if (m_probe != kNotProbe) {
+                ++m_rejected;
+                return false;
+            }
+            break;
+    }
+    m_probe = ++m_lastTicket;
+    ticket = m_probe;
+    return true;
+}
+
+void CircuitBreaker::Record(Ticket ticket, bool success) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state == State::HalfOpen) {
+        if (ticket == kNotProbe || ticket != m_probe) {
+            return;   // Started before the breaker opened, or a released probe
+        }
+        m_probe = kNotProbe;
+        TransitionTo(success ? State::Closed : State::Open);
+        return;
+    }
+    if (m_state == State::Open || ticket != kNotProbe) {
+        return;   // Started before the breaker opened, or an earlier probe
+    }
+
+    bool failure = !success;
+    if (m_count == m_policy.window) {
+        m_failures -= m_outcomes[m_next] ? 1 : 0;
+    } else {
+        ++m_count;
+    }
+    m_outcomes[m_next] = failure;
+    m_failures += failure ? 1 : 0;
+    m_next = (m_next + 1) % m_policy.window;
+
+    if (m_count >= m_policy.minRequests &&
+        m_failures >= m_policy.failureRate * static_cast<double>(m_count)) {
+        TransitionTo(State::Open);
+    }
+}
+
+void CircuitBreaker::Release(Ticket ticket) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ticket != kNotProbe && ticket == m_probe) {
+        m_probe = kNotProbe;
+    }
+}
+
+void CircuitBreaker::TransitionTo(State state) {
+    LOG_EVENT(CircuitBreakerState, m_name, GetStateName(m_state), GetStateName(state),
+              m_failures, m_count);
+
+    m_state = state;
+    if (state == State::Open) {
+        m_openedAt = Clock::now();
+        ++m_opened;
+    } else if (state == State::Closed) {
+        // Start over: the failures that opened it are history
+        std::fill(m_outcomes.begin(), m_outcomes.end(), false);
+        m_next = 0;
+        m_count = 0;
+        m_failures = 0;
+    }
+}
+
+CircuitBreaker::Stats CircuitBreaker::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.name = m_name;
+    stats.state = m_state;
+    stats.requests = m_count;
+    stats.failures = m_failures;
+    stats.rejected = m_rejected;
+    stats.opened = m_opened;
+    return stats;
+}
+
+const char* CircuitBreaker::GetStateName(State state) {
+    switch (state) {
+        case State::Closed:   return "closed";
+        case State::Open:     return "open";
+        case State::HalfOpen: return "half_open";
+        default:              return "-";
+    }
+}
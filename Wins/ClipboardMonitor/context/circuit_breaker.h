@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// When a breaker opens and how long it stays open
+struct CircuitBreakerPolicy {
+    size_t window = 20;           // Outcomes of the last N fetches
+    size_t minRequests = 6;       // Needed in the window before it can open
+    double failureRate = 0.6;     // Share of errors and timeouts that opens it
+    int openMs = 30000;           // Refuse fetches this long, then probe
+};
+
+// Circuit breaker for one adapter (closed / open / half-open).
+//
+// An adapter whose fetches keep failing or timing out (e.g. after a UI
+// change its tree walk no longer understands) would otherwise queue a
+// doomed traversal for every copy. Closed: fetches run and their outcomes
+// fill a rolling window; once failureRate of at least minRequests outcomes
+// are failures it opens. Open: fetches are refused for openMs. Half-open:
+// a single probe is let through; its success closes the breaker, its
+// failure opens it again. The probe is identified by the ticket Allow()
+// hands out, so a slow fetch from before the breaker opened cannot end
+// the half-open state in its place.
+class CircuitBreaker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Issued by Allow() and passed back to Record() or Release()
+    using Ticket = uint64_t;
+    static constexpr Ticket kNotProbe = 0;   // An ordinary closed-state fetch
+
+    enum class State {
+        Closed,
+        Open,
+        HalfOpen
+    };
+
+    struct Stats {
+        std::string name;
+        State state = State::Closed;
+        size_t requests = 0;      // Outcomes in the window
+        size_t failures = 0;      // Failures among them
+        uint64_t rejected = 0;    // Fetches refused while open
+        uint64_t opened = 0;      // Times it has opened
+    };
+
+    explicit CircuitBreaker(std::string name,
+                            const CircuitBreakerPolicy& policy = CircuitBreakerPolicy());
+
+    // Disable copy
+    CircuitBreaker(const CircuitBreaker&) = delete;
+    CircuitBreaker& operator=(const CircuitBreaker&) = delete;
+
+    // Whether a fetch may run now. ticket: kNotProbe, or in half-open state
+    // the probe's ticket, which must be followed by Record() or Release()
+    bool Allow(Ticket& ticket);
+
+    // Outcome of a fetch (timeouts count as failures). In half-open state
+    // only the outstanding probe's outcome counts; others are ignored.
+    void Record(Ticket ticket, bool success);
+
+    // The allowed fetch did not run (e.g. it joined one already in flight,
+    // whose outcome is not the probe's): the next Allow() may probe
+    void Release(Ticket ticket);
+
+    Stats GetStats() const;
+
+    static const char* GetStateName(State state);
+
+private:
+    // Caller holds m_mutex
+    void TransitionTo(State state);
+
+    std::string m_name;
+    CircuitBreakerPolicy m_policy;
+
+    mutable std::mutex m_mutex;
+    State m_state;
+    std::vector<bool> m_outcomes;     // Ring buffer, true = failure
+    size_t m_next;
+    size_t m_count;
+    size_t m_failures;
+    Clock::time_point m_openedAt;
+    Ticket m_probe;                   // Outstanding half-open probe, or kNotProbe
+    Ticket m_lastTicket;
+    uint64_t m_rejected;
+    uint64_t m_opened;
+};
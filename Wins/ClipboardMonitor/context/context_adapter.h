@@ -5,9 +5,13 @@
 #endif
 
 #include "context_data.h"
-#include "../clipboard_monitor.h"
+#include "cancellation_token.h"
+#include "context_cache.h"
+#include "context_provider.h"
+#include "../source_info.h"
 #include <memory>
 #include <string>
+#include <vector>
 #include <algorithm>  // for std::transform
 #include <cwctype>    // for std::towlower
 
@@ -22,15 +26,56 @@ public:
     virtual bool CanHandle(const std::wstring& processName,
                           const std::wstring& windowTitle = L"") = 0;
 
+    // Exact process names (lowercase) this adapter handles
+    // ContextManager indexes them at registration so most lookups skip
+    // CanHandle; CanHandle remains the fallback for any other name
+    virtual std::vector<std::wstring> GetProcessNames() const { return {}; }
+
     // Get context information
     // source: Source application information
+    // token: Cancelled when the fetch times out; check it between UI
+    //        Automation calls and return early (partial data is fine)
     // Returns: Pointer to context data (nullptr if failed)
-    virtual std::shared_ptr<ContextData> GetContext(const SourceInfo& source) = 0;
+    virtual std::shared_ptr<ContextData> GetContext(const SourceInfo& source,
+                                                    const CancellationToken& token) = 0;
+
+    // Get the part of the context available without UI Automation (e.g.
+    // parsed from the window title)
+    // Runs synchronously on the clipboard thread before GetContext, so it
+    // must not block; the entry is published with it at once
+    // Returns: Context marked partial (nullptr if the adapter has no cheap phase)
+    virtual std::shared_ptr<ContextData> GetQuickContext(const SourceInfo& source) {
+        (void)source;
+        return nullptr;
+    }
+
+    // Get independent sources for the context (e.g. CF_HTML, the browser
+    // extension, UI Automation)
+    // Non-empty: ContextManager runs them concurrently instead of GetContext,
+    // stops the rest once GetRequiredFields() are filled and hands the merged
+    // fields to BuildContext. Called once, at registration.
+    virtual std::vector<std::shared_ptr<ContextProvider>> GetProviders() { return {}; }
+
+    // Fields whose arrival completes a provider fetch (empty: wait for all)
+    virtual std::vector<std::string> GetRequiredFields() const { return {}; }
+
+    // Build the context from merged provider fields
+    // Returns: Pointer to context data (nullptr if failed)
+    virtual std::shared_ptr<ContextData> BuildContext(const SourceInfo& source,
+                                                      const ContextMerge& merge) {
+        (void)source;
+        (void)merge;
+        return nullptr;
+    }
 
     // Get timeout in milliseconds for this adapter
     // Returns: Timeout value (default 100ms)
     virtual int GetTimeout() const { return 100; }
 
+    // Get how long results may be reused for the same window
+    // Returns: Cache policy (default: not cached)
+    virtual ContextCachePolicy GetCachePolicy() const { return ContextCachePolicy(); }
+
     // Get adapter name for logging
     virtual std::wstring GetAdapterName() const = 0;
 
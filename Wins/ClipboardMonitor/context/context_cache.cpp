@@ -0,0 +1,163 @@
+#include "context_cache.h"
+#include "context_data.h"
+#include "../source_info.h"
+#include <functional>
+#include <string>
+
+ContextCache::ContextCache()
+    : m_hits(0)
+    , m_staleHits(0)
+    , m_misses(0)
+    , m_refreshes(0)
+    , m_evictions(0)
+{
+}
+
+ContextCache::Key ContextCache::MakeKey(const SourceInfo& source) {
+    Key key;
+    key.window = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(source.windowHandle));
+    key.processId = static_cast<uint32_t>(source.processId);
+    key.titleHash = std::hash<std::wstring>()(source.windowTitle);
+    return key;
+}
+
+size_t ContextCache::KeyHash::operator()(const Key& key) const {
+    uint64_t hash = key.titleHash;
+    hash ^= key.window + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    hash ^= key.processId + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return static_cast<size_t>(hash);
+}
+
+void ContextCache::SetPolicy(const IContextAdapter* adapter, const ContextCachePolicy& policy) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (policy.ttlMs <= 0 || policy.maxEntries == 0) {
+        m_partitions.erase(adapter);
+        return;
+    }
+
+    Partition& partition = m_partitions[adapter];
+    partition.policy = policy;
+    while (partition.entries.size() > policy.maxEntries) {
+        partition.index.erase(partition.entries.back().key);
+        partition.entries.pop_back();
+    }
+}
+
+ContextCache::Partition* ContextCache::FindPartition(const IContextAdapter* adapter) {
+    auto it = m_partitions.find(adapter);
+    return it != m_partitions.end() ? &it->second : nullptr;
+}
+
+ContextCache::Lookup ContextCache::Find(const IContextAdapter* adapter, const Key& key) {
+    Lookup result;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Partition* partition = FindPartition(adapter);
+    if (!partition) {
+        return result;  // Caching disabled for this adapter
+    }
+
+    auto it = partition->index.find(key);
+    if (it == partition->index.end()) {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    Entry& entry = *it->second;
+    auto age = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - entry.fetched);
+    result.ageMs = static_cast<int>(age.count());
+
+    if (result.ageMs > partition->policy.ttlMs + partition->policy.maxStaleMs) {
+        // Too old to serve
+        partition->entries.erase(it->second);
+        partition->index.erase(it);
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    // Move to front (most recently used)
+    partition->entries.splice(partition->entries.begin(), partition->entries, it->second);
+
+    result.data = entry.data;
+    if (result.ageMs <= partition->policy.ttlMs) {
+        result.state = State::Fresh;
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    result.state = State::Stale;
+    m_staleHits.fetch_add(1, std::memory_order_relaxed);
+    if (!entry.refreshing) {
+        entry.refreshing = true;
+        result.refresh = true;
+        m_refreshes.fetch_add(1, std::memory_order_relaxed);
+    }
+    return result;
+}
+
+bool ContextCache::IsFresh(const IContextAdapter* adapter, const Key& key) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto partition = m_partitions.find(adapter);
+    if (partition == m_partitions.end()) {
+        return false;
+    }
+
+    auto it = partition->second.index.find(key);
+    if (it == partition->second.index.end()) {
+        return false;
+    }
+    auto age = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - it->second->fetched);
+    return age.count() <= partition->second.policy.ttlMs;
+}
+
+void ContextCache::Store(const IContextAdapter* adapter, const Key& key,
+                         std::shared_ptr<const ContextData> data) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Partition* partition = FindPartition(adapter);
+    if (!partition) {
+        return;
+    }
+
+    if (!data || !data->success) {
+        // Failed or timed out: keep the stale entry, let a later hit retry
+        auto it = partition->index.find(key);
+        if (it != partition->index.end()) {
+            it->second->refreshing = false;
+        }
+        return;
+    }
+
+    auto it = partition->index.find(key);
+    if (it != partition->index.end()) {
+        Entry& entry = *it->second;
+        entry.data = std::move(data);
+        entry.fetched = Clock::now();
+        entry.refreshing = false;
+        partition->entries.splice(partition->entries.begin(), partition->entries, it->second);
+        return;
+    }
+
+    partition->entries.push_front(Entry{key, std::move(data), Clock::now(), false});
+    partition->index[key] = partition->entries.begin();
+
+    while (partition->entries.size() > partition->policy.maxEntries) {
+        partition->index.erase(partition->entries.back().key);
+        partition->entries.pop_back();
+        m_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+ContextCache::Stats ContextCache::GetStats() const {
+    Stats stats;
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+    stats.staleHits = m_staleHits.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+    stats.refreshes = m_refreshes.load(std::memory_order_relaxed);
+    stats.evictions = m_evictions.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& partition : m_partitions) {
+        stats.entries += partition.second.entries.size();
+    }
+    return stats;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+struct ContextData;
+struct SourceInfo;
+class IContextAdapter;
+
+// Caching policy of one adapter
+struct ContextCachePolicy {
+    int ttlMs = 0;            // Fresh for this long after a fetch; 0 disables caching
+    int maxStaleMs = 0;       // Then still served (and refreshed) for this long
+    size_t maxEntries = 16;   // LRU bound on cached windows
+};
+
+// TTL cache of fetched contexts, keyed by window identity.
+//
+// Copying several snippets from the same tab, file or chat would re-run the
+// same UI Automation walk each time; a hit returns the earlier result
+// instead. An entry is fresh for ttlMs, then stale for up to maxStaleMs: a
+// stale hit is still returned, and the first caller to see it is asked to
+// refresh it in the background. Each adapter has its own policy and LRU
+// partition. Only successful contexts are stored; they are shared and
+// immutable.
+class ContextCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Window identity: a title change (new tab, file or chat) is a new key
+    struct Key {
+        uint64_t window = 0;      // HWND value
+        uint32_t processId = 0;
+        uint64_t titleHash = 0;
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    enum class State {
+        Miss,
+        Fresh,
+        Stale
+    };
+
+    struct Lookup {
+        State state = State::Miss;
+        std::shared_ptr<const ContextData> data;
+        int ageMs = 0;
+        bool refresh = false;     // Stale and nobody refreshing yet: caller should
+    };
+
+    struct Stats {
+        uint64_t hits = 0;        // Fresh hits
+        uint64_t staleHits = 0;   // Stale hits (served while refreshing)
+        uint64_t misses = 0;      // Including entries too old to serve
+        uint64_t refreshes = 0;   // Background refreshes started
+        uint64_t evictions = 0;   // Dropped by the LRU bound
+        size_t entries = 0;
+    };
+
+    ContextCache();
+
+    // Disable copy
+    ContextCache(const ContextCache&) = delete;
+    ContextCache& operator=(const ContextCache&) = delete;
+
+    static Key MakeKey(const SourceInfo& source);
+
+    // Set an adapter's policy (a zero ttlMs disables caching for it)
+    void SetPolicy(const IContextAdapter* adapter, const ContextCachePolicy& policy);
+
+    // Look up a window; a stale hit with refresh set must be followed by a
+    // Store() for the same key once the refresh is done
+    Lookup Find(const IContextAdapter* adapter, const Key& key);
+
+    // Whether the window has a fresh entry; unlike Find, not counted as a
+    // lookup and does not touch the LRU order (prefetch checks)
+    bool IsFresh(const IContextAdapter* adapter, const Key& key) const;
+
+    // Cache a fetched context. A failed one is not cached; it only ends a
+    // pending refresh, and the stale entry is served until it expires.
+    void Store(const IContextAdapter* adapter, const Key& key,
+               std::shared_ptr<const ContextData> data);
+
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        Key key;
+        std::shared_ptr<const ContextData> data;
+        Clock::time_point fetched;
+        bool refreshing = false;
+    };
+
+    // Most recently used first
+    struct Partition {
+        ContextCachePolicy policy;
+        std::list<Entry> entries;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    };
+
+    Partition* FindPartition(const IContextAdapter* adapter);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<const IContextAdapter*, Partition> m_partitions;
+
+    std::atomic<uint64_t> m_hits;
+    std::atomic<uint64_t> m_staleHits;
+    std::atomic<uint64_t> m_misses;
+    std::atomic<uint64_t> m_refreshes;
+    std::atomic<uint64_t> m_evictions;
+};
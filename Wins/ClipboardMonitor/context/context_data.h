@@ -1,10 +1,5 @@
 #pragma once
 
-#ifndef WIN32_LEAN_AND_MEAN
-#define WIN32_LEAN_AND_MEAN
-#endif
-
-#include <windows.h>
 #include <string>
 #include <map>
 #include <vector>
@@ -12,7 +7,7 @@
 
 // Base context data structure
 struct ContextData {
-    std::string adapterType;      // "browser", "wechat", "vscode", "notion"
+    std::string adapterType;      // "browser", "wechat", "vscode", "notion", "generic"
 
     // Common fields
     std::wstring url;             // URL, file path, or pseudo-URL
@@ -24,6 +19,7 @@ struct ContextData {
     // Performance metrics
     int fetchTimeMs = 0;          // Time taken to fetch context
     bool success = false;         // Whether context was successfully retrieved
+    bool partial = false;         // Quick (title-only) context; the full one may follow
     std::wstring error;           // Error message if failed
 
     virtual ~ContextData() = default;
@@ -95,3 +91,14 @@ struct NotionContext : public ContextData {
         adapterType = "notion";
     }
 };
+
+// Any other app: what the window title and executable tell
+struct GenericContext : public ContextData {
+    std::wstring documentName;        // Document, folder or page (from the title)
+    std::wstring appName;             // Application name (title or executable)
+    std::vector<std::wstring> paths;  // Path-like tokens in the title
+
+    GenericContext() {
+        adapterType = "generic";
+    }
+};
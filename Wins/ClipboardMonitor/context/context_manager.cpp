@@ -1,15 +1,38 @@
 #include "context_manager.h"
-#include "../clipboard_monitor.h"
+#include "../source_info.h"
 #include "../debug_log.h"
 #include "../utils.h"
+#include <filesystem>
+#include <fstream>
 #include <sstream>
-#include <atomic>
 
-ContextManager::ContextManager(size_t threadPoolSize)
-    : m_defaultTimeout(100)
+namespace {
+
+// Prefetched windows remembered for hit accounting; older ones count as wasted
+const size_t kMaxPendingPrefetches = 32;
+
+std::shared_ptr<ContextData> MakeErrorContext(const std::wstring& error) {
+    auto contextData = std::make_shared<ContextData>();
+    contextData->success = false;
+    contextData->error = error;
+    return contextData;
+}
+
+} // namespace
+
+ContextManager::ContextManager(size_t threadPoolSize, AsyncExecutor::WorkerHooks workerHooks)
+    : m_coalesced(0)
+    , m_maxQueueDepth(8)
+    , m_prefetchGeneration(0)
+    , m_prefetchIssued(0)
+    , m_prefetchHits(0)
+    , m_prefetchSkipped(0)
+    , m_shed(0)
+    , m_metricsIntervalMs(0)
+    , m_defaultTimeout(100)
     , m_initialized(false)
 {
-    m_executor = std::make_unique<AsyncExecutor>(threadPoolSize);
+    m_executor = std::make_unique<AsyncExecutor>(threadPoolSize, std::move(workerHooks));
 }
 
 ContextManager::~ContextManager() {
@@ -23,12 +46,11 @@ bool ContextManager::Initialize() {
         return true;
     }
 
-    // Initialize COM for async executor threads
-    // Note: Each worker thread will need to initialize COM separately
-    // This is handled in the adapters themselves
+    // COM for the worker threads is set up by the worker hooks passed to
+    // the constructor (see main.cpp), once per thread
 
     m_initialized = true;
-    DEBUG_LOG("ContextManager initialized");
+    LOG_INFO("ContextManager initialized ({} worker threads)", m_executor->GetThreadCount());
     return true;
 }
 
@@ -38,99 +60,632 @@ void ContextManager::RegisterAdapter(std::shared_ptr<IContextAdapter> adapter) {
     }
 
     m_adapters.push_back(adapter);
+    {
+        std::lock_guard<std::mutex> lock(m_dispatchMutex);
+        for (const auto& name : adapter->GetProcessNames()) {
+            m_processNames.emplace(Utils::ToLower(name), adapter);   // First registered wins
+        }
+        m_dispatch.clear();
+    }
+    m_adapterTags[adapter.get()] =
+        m_executor->RegisterMetricsTag(Utils::WideToUtf8(adapter->GetAdapterName()));
+    m_cache.SetPolicy(adapter.get(), adapter->GetCachePolicy());
+    m_providers[adapter.get()] = adapter->GetProviders();
+    m_breakers[adapter.get()] = std::make_unique<CircuitBreaker>(
+        Utils::WideToUtf8(adapter->GetAdapterName()), m_breakerPolicy);
 
-    std::wstring msg = L"Registered adapter: " + adapter->GetAdapterName();
-    DEBUG_LOG(Utils::WideToUtf8(msg));
+    LOG_INFO("Registered adapter: {}", adapter->GetAdapterName());
 }
 
-void ContextManager::GetContextAsync(const SourceInfo& source, ContextCallback callback) {
+CoTask<std::shared_ptr<const ContextData>> ContextManager::GetContext(SourceInfo source,
+                                                                      TaskPriority priority) {
     if (!m_initialized) {
-        DEBUG_LOG("ContextManager not initialized");
-        if (callback) {
-            callback(nullptr);
+        LOG_WARN("ContextManager not initialized");
+        co_return nullptr;
+    }
+
+    // Find matching adapter; anything else gets the generic context inline
+    auto adapter = FindAdapter(source.processName, source.windowTitle);
+    if (!adapter) {
+        co_return RunGenericContext(source);
+    }
+
+    // Same window as a recent fetch: reuse it
+    ContextCache::Key key = ContextCache::MakeKey(source);
+    int timeout = GetAdapterTimeout(*adapter, source);
+    ContextCache::Lookup cached = m_cache.Find(adapter.get(), key);
+    if (cached.data) {
+        bool fresh = cached.state == ContextCache::State::Fresh;
+        LOG_EVENT(ContextCacheHit, fresh ? "fresh" : "stale", cached.data->adapterType, cached.ageMs);
+        if (TakePrefetched(key)) {
+            m_prefetchHits.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (cached.refresh) {
+            CircuitBreaker::Ticket ticket = CircuitBreaker::kNotProbe;
+            if (!ShouldShed(TaskPriority::Background) && FindBreaker(*adapter)->Allow(ticket)) {
+                // Stored in the cache by the producer; nobody waits for it here
+                JoinFetch(adapter, source, key, ticket, timeout, TaskPriority::Background);
+            } else {
+                m_cache.Store(adapter.get(), key, nullptr);   // Not now; a later hit retries
+            }
         }
+        co_return cached.data;
+    }
+
+    // Pool backed up, or the adapter keeps failing: title-only context
+    if (ShouldShed(priority)) {
+        m_shed.fetch_add(1, std::memory_order_relaxed);
+        LOG_EVENT(ContextShed, adapter->GetAdapterName(), "executor busy");
+        co_return GetFallbackContext(*adapter, source, L"executor_busy");
+    }
+    CircuitBreaker::Ticket ticket = CircuitBreaker::kNotProbe;
+    if (!FindBreaker(*adapter)->Allow(ticket)) {
+        LOG_EVENT(ContextShed, adapter->GetAdapterName(), "circuit open");
+        co_return GetFallbackContext(*adapter, source, L"circuit_open");
+    }
+
+    // Same window as a fetch still running (e.g. the two copies of a
+    // Ctrl+C+C, or a prefetch): wait for that one, with our own timeout
+    bool prefetched = TakePrefetched(key);
+    bool joined = false;
+    std::shared_ptr<SharedContext> shared = JoinFetch(adapter, source, key, ticket, timeout, priority, false, &joined);
+    if (prefetched && joined) {
+        m_prefetchHits.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::optional<std::shared_ptr<const ContextData>> result =
+        co_await WithTimeout(*m_executor, shared->Wait(), timeout, priority);
+
+    if (!result) {
+        LOG_EVENT(ContextTimeout);
+        co_return MakeErrorContext(L"Timeout");
+    }
+    co_return std::move(*result);
+}
+
+void ContextManager::Prefetch(const SourceInfo& source) {
+    // Every focus change, prefetched or not, supersedes the pending one
+    uint64_t generation = m_prefetchGeneration.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (!m_initialized || m_prefetchPolicy.dwellMs < 0) {
         return;
     }
 
-    // Find matching adapter
     auto adapter = FindAdapter(source.processName, source.windowTitle);
-    if (!adapter) {
-        // No adapter found - call callback with nullptr
-        if (callback) {
-            callback(nullptr);
+    if (!adapter || !CanPrefetch(*adapter)) {
+        return;
+    }
+
+    TaskOptions options;
+    options.priority = TaskPriority::Background;
+    m_executor->SubmitAfter(m_prefetchPolicy.dwellMs, options, [this, adapter, source, generation]() {
+        RunPrefetch(adapter, source, generation);
+    });
+}
+
+void ContextManager::RunPrefetch(std::shared_ptr<IContextAdapter> adapter, const SourceInfo& source,
+                                 uint64_t generation) {
+    ContextCache::Key key = ContextCache::MakeKey(source);
+
+    const char* skip = nullptr;
+    if (generation != m_prefetchGeneration.load(std::memory_order_relaxed)) {
+        skip = "focus moved on";
+    } else if (m_cache.IsFresh(adapter.get(), key)) {
+        skip = "already cached";
+    } else if (m_executor->GetQueueDepth() > 0) {
+        skip = "executor busy";   // Prefetches only use idle workers
+    } else {
+        std::lock_guard<std::mutex> lock(m_inFlightMutex);
+        if (m_inFlight.find(key) != m_inFlight.end()) {
+            skip = "in flight";
         }
+    }
+    if (!skip) {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(m_prefetchMutex);
+        if (now - m_lastPrefetch < std::chrono::milliseconds(m_prefetchPolicy.minIntervalMs)) {
+            skip = "rate limited";
+        } else {
+            m_lastPrefetch = now;
+        }
+    }
+    CircuitBreaker::Ticket ticket = CircuitBreaker::kNotProbe;
+    if (!skip && !FindBreaker(*adapter)->Allow(ticket)) {
+        skip = "circuit open";
+    }
+
+    if (skip) {
+        m_prefetchSkipped.fetch_add(1, std::memory_order_relaxed);
+        LOG_EVENT(ContextPrefetch, adapter->GetAdapterName(), skip);
         return;
     }
 
-    // Get timeout for this adapter
-    int timeout = adapter->GetTimeout();
-    if (timeout <= 0) {
-        timeout = m_defaultTimeout;
+    {
+        std::lock_guard<std::mutex> lock(m_prefetchMutex);
+        m_prefetched.push_back(key);
+        if (m_prefetched.size() > kMaxPendingPrefetches) {
+            m_prefetched.pop_front();
+        }
     }
+    m_prefetchIssued.fetch_add(1, std::memory_order_relaxed);
+    LOG_EVENT(ContextPrefetch, adapter->GetAdapterName(), "started");
 
-    // Use shared atomic flag to ensure callback is called only once
-    auto callbackCalled = std::make_shared<std::atomic<bool>>(false);
+    // Stored in the cache by the producer; a copy joins it if still running
+    JoinFetch(adapter, source, key, ticket, GetAdapterTimeout(*adapter, source), TaskPriority::Background, true);
+}
 
-    // Submit async task
-    m_executor->SubmitWithTimeout(
-        [adapter, source, callback, callbackCalled]() {
-            std::shared_ptr<ContextData> contextData = nullptr;
+bool ContextManager::CanPrefetch(const IContextAdapter& adapter) const {
+    if (adapter.GetCachePolicy().ttlMs <= 0) {
+        return false;   // Nowhere to keep the result
+    }
 
-            try {
-                contextData = adapter->GetContext(source);
-            } catch (const std::exception& e) {
-                std::ostringstream oss;
-                oss << "Adapter exception: " << e.what();
-                DEBUG_LOG(oss.str());
+    auto providers = m_providers.find(&adapter);
+    if (providers == m_providers.end() || providers->second.empty()) {
+        return true;    // GetContext only reads the window
+    }
+    for (const auto& provider : providers->second) {
+        if (!provider->IsCopyBound()) {
+            return true;
+        }
+    }
+    return false;
+}
 
-                // Create error context
-                contextData = std::make_shared<ContextData>();
-                contextData->success = false;
-                contextData->error = L"Exception: " +
-                    std::wstring(e.what(), e.what() + strlen(e.what()));
-            } catch (...) {
-                DEBUG_LOG("Adapter unknown exception");
+bool ContextManager::TakePrefetched(const ContextCache::Key& key) {
+    std::lock_guard<std::mutex> lock(m_prefetchMutex);
+    for (auto it = m_prefetched.begin(); it != m_prefetched.end(); ++it) {
+        if (*it == key) {
+            m_prefetched.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
 
-                contextData = std::make_shared<ContextData>();
-                contextData->success = false;
-                contextData->error = L"Unknown exception";
-            }
+ContextManager::PrefetchStats ContextManager::GetPrefetchStats() const {
+    PrefetchStats stats;
+    stats.issued = m_prefetchIssued.load(std::memory_order_relaxed);
+    stats.hits = m_prefetchHits.load(std::memory_order_relaxed);
+    stats.skipped = m_prefetchSkipped.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(m_prefetchMutex);
+        stats.pending = m_prefetched.size();
+    }
+    uint64_t resolved = stats.issued > stats.pending ? stats.issued - stats.pending : 0;
+    stats.wasted = resolved > stats.hits ? resolved - stats.hits : 0;
+    return stats;
+}
 
-            // Call callback with result only if not already called
-            bool expected = false;
-            if (callbackCalled->compare_exchange_strong(expected, true)) {
-                if (callback) {
-                    callback(contextData);
-                }
-            }
-        },
-        timeout,
-        [callback, callbackCalled]() {
-            // Timeout callback - only call if task hasn't completed yet
-            bool expected = false;
-            if (callbackCalled->compare_exchange_strong(expected, true)) {
-                DEBUG_LOG("Context fetch timeout");
-
-                auto timeoutContext = std::make_shared<ContextData>();
-                timeoutContext->success = false;
-                timeoutContext->error = L"Timeout";
-
-                if (callback) {
-                    callback(timeoutContext);
-                }
+std::shared_ptr<const ContextData> ContextManager::GetQuickContext(const SourceInfo& source) {
+    if (!m_initialized) {
+        return nullptr;
+    }
+
+    auto adapter = FindAdapter(source.processName, source.windowTitle);
+    auto startTime = std::chrono::steady_clock::now();
+    std::shared_ptr<ContextData> contextData =
+        adapter ? RunQuickContext(*adapter, source) : RunGenericContext(source);
+    if (!contextData) {
+        return nullptr;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime);
+    LOG_EVENT(ContextQuick, contextData->adapterType, contextData->success, elapsed.count());
+    return contextData;
+}
+
+std::shared_ptr<ContextData> ContextManager::RunQuickContext(IContextAdapter& adapter,
+                                                             const SourceInfo& source) {
+    std::shared_ptr<ContextData> contextData;
+    try {
+        contextData = adapter.GetQuickContext(source);
+    } catch (const std::exception& e) {
+        LOG_ERROR("Adapter quick context exception: {}", e.what());
+        return nullptr;
+    }
+    if (contextData) {
+        contextData->partial = true;
+    }
+    return contextData;
+}
+
+std::shared_ptr<ContextData> ContextManager::RunGenericContext(const SourceInfo& source) {
+    if (!m_genericAdapter) {
+        return nullptr;
+    }
+
+    try {
+        // Nothing to cancel: the generic adapter does not block
+        return m_genericAdapter->GetContext(source, CancellationToken::None());
+    } catch (const std::exception& e) {
+        LOG_ERROR("Generic adapter exception: {}", e.what());
+        return nullptr;
+    }
+}
+
+std::shared_ptr<const ContextData> ContextManager::GetFallbackContext(IContextAdapter& adapter,
+                                                                      const SourceInfo& source,
+                                                                      const std::wstring& reason) {
+    std::shared_ptr<ContextData> contextData = RunQuickContext(adapter, source);
+    if (!contextData) {
+        return MakeErrorContext(L"Skipped: " + reason);
+    }
+    contextData->SetMetadata(L"deep_skipped", reason);
+    return contextData;
+}
+
+bool ContextManager::ShouldShed(TaskPriority priority) const {
+    // Interactive captures (the user is about to annotate) are never shed
+    return m_maxQueueDepth > 0 && priority != TaskPriority::Interactive &&
+           m_executor->GetQueueDepth() >= m_maxQueueDepth;
+}
+
+CircuitBreaker* ContextManager::FindBreaker(const IContextAdapter& adapter) const {
+    auto it = m_breakers.find(&adapter);
+    return it != m_breakers.end() ? it->second.get() : nullptr;
+}
+
+std::shared_ptr<ContextManager::SharedContext> ContextManager::JoinFetch(
+    std::shared_ptr<IContextAdapter> adapter,
+    const SourceInfo& source,
+    const ContextCache::Key& key,
+    CircuitBreaker::Ticket ticket,
+    int timeoutMs,
+    TaskPriority priority,
+    bool speculative,
+    bool* joined)
+{
+    std::shared_ptr<SharedContext> result;
+    {
+        std::lock_guard<std::mutex> lock(m_inFlightMutex);
+        auto it = m_inFlight.find(key);
+        if (joined) {
+            *joined = it != m_inFlight.end();
+        }
+        if (it != m_inFlight.end()) {
+            m_coalesced.fetch_add(1, std::memory_order_relaxed);
+            // Its outcome is recorded by the fetch's own producer
+            FindBreaker(*adapter)->Release(ticket);
+            return it->second;
+        }
+        result = std::make_shared<SharedContext>(*m_executor);
+        m_inFlight.emplace(key, result);
+    }
+
+    // Outside the lock: a fetch that cannot be queued completes inline
+    Spawn(RunFetch(std::move(adapter), source, key, ticket, timeoutMs, priority, speculative, result));
+    return result;
+}
+
+CoTask<void> ContextManager::RunFetch(std::shared_ptr<IContextAdapter> adapter,
+                                      SourceInfo source,
+                                      ContextCache::Key key,
+                                      CircuitBreaker::Ticket ticket,
+                                      int timeoutMs,
+                                      TaskPriority priority,
+                                      bool speculative,
+                                      std::shared_ptr<SharedContext> result) {
+    std::shared_ptr<const ContextData> contextData =
+        co_await FetchContext(adapter, source, timeoutMs, priority, speculative);
+
+    FindBreaker(*adapter)->Record(ticket, contextData && contextData->success);
+
+    // Cache before leaving the in-flight map, so a new request finds one or the other
+    m_cache.Store(adapter.get(), key, contextData);
+    {
+        std::lock_guard<std::mutex> lock(m_inFlightMutex);
+        auto it = m_inFlight.find(key);
+        if (it != m_inFlight.end() && it->second == result) {
+            m_inFlight.erase(it);
+        }
+    }
+    result->Set(std::move(contextData));
+}
+
+CoTask<std::shared_ptr<const ContextData>> ContextManager::FetchContext(std::shared_ptr<IContextAdapter> adapter,
+                                                                        SourceInfo source,
+                                                                        int timeoutMs,
+                                                                        TaskPriority priority,
+                                                                        bool speculative) {
+    // Cancelled at the deadline so the adapter stops walking the UI tree
+    // and frees its worker, even after every waiter has given up
+    auto deadline = CancellationToken::Clock::now() + std::chrono::milliseconds(timeoutMs);
+    auto token = std::make_shared<CancellationToken>(deadline);
+
+    TaskOptions options;
+    options.priority = priority;
+    options.deadline = deadline;
+    auto tag = m_adapterTags.find(adapter.get());
+    options.tag = tag != m_adapterTags.end() ? tag->second : ExecutorMetrics::kUntagged;
+
+    auto fetch = [adapter, source, token]() -> std::shared_ptr<const ContextData> {
+        // Deadline passed before the adapter started
+        if (token->IsCancelled()) {
+            return MakeErrorContext(L"Timeout");
+        }
+
+        try {
+            return adapter->GetContext(source, *token);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Adapter exception: {}", e.what());
+
+            return MakeErrorContext(L"Exception: " +
+                std::wstring(e.what(), e.what() + strlen(e.what())));
+        } catch (...) {
+            LOG_ERROR("Adapter unknown exception");
+
+            return MakeErrorContext(L"Unknown exception");
+        }
+    };
+
+    auto startTime = std::chrono::steady_clock::now();
+    std::shared_ptr<const ContextData> contextData = MakeErrorContext(L"Timeout");
+    auto registered = m_providers.find(adapter.get());
+    if (registered != m_providers.end() && !registered->second.empty()) {
+        // A prefetch runs ahead of the copy: leave out what the copy produces
+        std::vector<std::shared_ptr<ContextProvider>> providers;
+        for (const auto& provider : registered->second) {
+            if (!speculative || !provider->IsCopyBound()) {
+                providers.push_back(provider);
             }
         }
-    );
+        if (!providers.empty()) {
+            contextData = co_await FetchFromProviders(adapter, source, std::move(providers), token, options);
+        }
+    } else {
+        try {
+            contextData = co_await m_executor->Run(options, std::move(fetch));
+        } catch (const std::exception& e) {
+            // Dropped past its deadline, or the executor is shutting down
+            LOG_WARN("Context task not run: {}", e.what());
+        }
+    }
+
+    // Successful and cut-off fetches tell how long this adapter needs;
+    // fast failures do not
+    if ((contextData && contextData->success) || token->IsCancelled()) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime);
+        m_timeouts.Record(adapter.get(), source.processName, static_cast<int>(elapsed.count()));
+    }
+    co_return contextData;
+}
+
+CoTask<std::shared_ptr<const ContextData>> ContextManager::FetchFromProviders(
+    std::shared_ptr<IContextAdapter> adapter,
+    SourceInfo source,
+    std::vector<std::shared_ptr<ContextProvider>> providers,
+    std::shared_ptr<CancellationToken> token,
+    TaskOptions options)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    auto merge = std::make_shared<ContextMerge>(adapter->GetRequiredFields(), providers.size());
+    auto done = std::make_shared<SharedResult<bool>>(*m_executor);
+    for (const auto& provider : providers) {
+        Spawn(RunProvider(provider, source, token, options, merge, done));
+    }
+    co_await done->Wait();
+
+    // Required fields are in: the slower providers stop walking the UI tree
+    size_t reported = merge->GetReportedCount();
+    if (reported < providers.size()) {
+        token->Cancel();
+    }
+
+    std::shared_ptr<ContextData> contextData;
+    try {
+        contextData = adapter->BuildContext(source, *merge);
+    } catch (const std::exception& e) {
+        LOG_ERROR("Adapter exception: {}", e.what());
+    }
+    if (!contextData) {
+        co_return MakeErrorContext(merge->HasRequired() ? L"Failed to build context" : L"Timeout");
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime);
+    contextData->fetchTimeMs = static_cast<int>(elapsed.count());
+    contextData->SetMetadata(L"providers_reported",
+                             std::to_wstring(reported) + L"/" + std::to_wstring(providers.size()));
+    LOG_EVENT(AdapterCompleted, adapter->GetAdapterName(), contextData->fetchTimeMs, contextData->success);
+    co_return contextData;
+}
+
+CoTask<void> ContextManager::RunProvider(std::shared_ptr<ContextProvider> provider,
+                                         SourceInfo source,
+                                         std::shared_ptr<CancellationToken> token,
+                                         TaskOptions options,
+                                         std::shared_ptr<ContextMerge> merge,
+                                         std::shared_ptr<SharedResult<bool>> done) {
+    auto provide = [provider, source, token]() -> ContextFields {
+        ContextFields fields;
+        // Completed or timed out before this provider started
+        if (token->IsCancelled()) {
+            return fields;
+        }
+
+        try {
+            provider->Provide(source, *token, fields);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Provider {} exception: {}", provider->GetName(), e.what());
+            fields.clear();
+        } catch (...) {
+            LOG_ERROR("Provider {} unknown exception", provider->GetName());
+            fields.clear();
+        }
+        return fields;
+    };
+
+    ContextFields fields;
+    try {
+        fields = co_await m_executor->Run(options, std::move(provide));
+    } catch (const std::exception& e) {
+        // Dropped past its deadline, or the executor is shutting down
+        LOG_WARN("Provider task not run: {}", e.what());
+    }
+
+    // Reports even when empty, so the last provider always completes the merge
+    if (merge->Add(*provider, std::move(fields))) {
+        done->Set(true);
+    }
+}
+
+std::vector<CircuitBreaker::Stats> ContextManager::GetBreakerStats() const {
+    std::vector<CircuitBreaker::Stats> stats;
+    for (const auto& adapter : m_adapters) {
+        stats.push_back(FindBreaker(*adapter)->GetStats());
+    }
+    return stats;
+}
+
+int ContextManager::GetAdapterTimeout(const IContextAdapter& adapter, const SourceInfo& source) const {
+    int configured = adapter.GetTimeout();
+    if (configured <= 0) {
+        configured = m_defaultTimeout;
+    }
+    return m_timeouts.GetTimeout(&adapter, source.processName, configured);
+}
+
+void ContextManager::StartMetricsDump(const std::wstring& path, int intervalMs) {
+    if (intervalMs <= 0) {
+        return;
+    }
+
+    m_metricsPath = path;
+    m_metricsIntervalMs = intervalMs;
+    ScheduleMetricsDump();
+}
+
+void ContextManager::ScheduleMetricsDump() {
+    TaskOptions options;
+    options.priority = TaskPriority::Background;
+
+    m_executor->SubmitAfter(m_metricsIntervalMs, options, [this]() {
+        if (!WriteMetrics()) {
+            LOG_WARN("Failed to write metrics file");
+        }
+        ScheduleMetricsDump();
+    });
+}
+
+bool ContextManager::WriteMetrics() const {
+    ExecutorMetrics::Snapshot snapshot = m_executor->GetMetricsSnapshot();
+
+    auto writeLatency = [](std::ostream& out, const char* name, const LatencyHistogram::Summary& summary) {
+        out << "      \"" << name << "\": { \"p50\": " << summary.p50Us / 1000.0
+            << ", \"p90\": " << summary.p90Us / 1000.0
+            << ", \"p99\": " << summary.p99Us / 1000.0
+            << ", \"max\": " << summary.maxUs / 1000.0
+            << ", \"mean\": " << summary.meanUs / 1000.0 << " }";
+    };
+
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"generated\": \"" << Utils::GetTimestamp() << "\",\n";
+    json << "  \"threads\": " << snapshot.threads << ",\n";
+    json << "  \"queue_depth\": " << snapshot.queueDepth << ",\n";
+    json << "  \"running\": " << snapshot.running << ",\n";
+    json << "  \"dropped\": " << snapshot.dropped << ",\n";
+
+    ContextCache::Stats cache = m_cache.GetStats();
+    json << "  \"context_cache\": { \"hits\": " << cache.hits
+         << ", \"stale_hits\": " << cache.staleHits
+         << ", \"misses\": " << cache.misses
+         << ", \"refreshes\": " << cache.refreshes
+         << ", \"evictions\": " << cache.evictions
+         << ", \"entries\": " << cache.entries << " },\n";
+    json << "  \"coalesced_fetches\": " << GetCoalescedFetches() << ",\n";
+    json << "  \"shed\": " << GetShedCount() << ",\n";
+
+    // hit_rate: share of cached-adapter lookups a prefetch served;
+    // wasted_ratio: share of settled prefetches no copy used
+    PrefetchStats prefetch = GetPrefetchStats();
+    uint64_t lookups = cache.hits + cache.staleHits + cache.misses;
+    uint64_t settled = prefetch.hits + prefetch.wasted;
+    json << "  \"prefetch\": { \"issued\": " << prefetch.issued
+         << ", \"hits\": " << prefetch.hits
+         << ", \"wasted\": " << prefetch.wasted
+         << ", \"pending\": " << prefetch.pending
+         << ", \"skipped\": " << prefetch.skipped
+         << ", \"hit_rate\": " << (lookups ? static_cast<double>(prefetch.hits) / lookups : 0.0)
+         << ", \"wasted_ratio\": " << (settled ? static_cast<double>(prefetch.wasted) / settled : 0.0)
+         << " },\n";
+
+    std::vector<CircuitBreaker::Stats> breakers = GetBreakerStats();
+    json << "  \"breakers\": [";
+    for (size_t i = 0; i < breakers.size(); ++i) {
+        const auto& breaker = breakers[i];
+        json << (i == 0 ? "\n" : ",\n");
+        json << "    { \"adapter\": \"" << Utils::EscapeJson(breaker.name) << "\""
+             << ", \"state\": \"" << CircuitBreaker::GetStateName(breaker.state) << "\""
+             << ", \"requests\": " << breaker.requests
+             << ", \"failures\": " << breaker.failures
+             << ", \"rejected\": " << breaker.rejected
+             << ", \"opened\": " << breaker.opened << " }";
+    }
+    json << (breakers.empty() ? "],\n" : "\n  ],\n");
+
+    std::vector<AdaptiveTimeout::Snapshot> timeouts = m_timeouts.GetSnapshot();
+    json << "  \"timeouts\": [";
+    for (size_t i = 0; i < timeouts.size(); ++i) {
+        const auto& row = timeouts[i];
+        json << (i == 0 ? "\n" : ",\n");
+        json << "    { \"adapter\": \"" << Utils::EscapeJson(row.adapter) << "\"";
+        if (!row.process.empty()) {
+            json << ", \"process\": \"" << Utils::EscapeJson(row.process) << "\"";
+        }
+        json << ", \"samples\": " << row.samples
+             << ", \"percentile_ms\": " << row.percentileMs
+             << ", \"timeout_ms\": " << row.timeoutMs << " }";
+    }
+    json << (timeouts.empty() ? "],\n" : "\n  ],\n");
+    json << "  \"tasks\": [";
+    for (size_t i = 0; i < snapshot.tags.size(); ++i) {
+        const auto& tag = snapshot.tags[i];
+        json << (i == 0 ? "\n" : ",\n");
+        json << "    {\n";
+        json << "      \"tag\": \"" << Utils::EscapeJson(tag.name) << "\",\n";
+        json << "      \"count\": " << tag.wait.count << ",\n";
+        writeLatency(json, "wait_ms", tag.wait);
+        json << ",\n";
+        writeLatency(json, "run_ms", tag.run);
+        json << "\n    }";
+    }
+    json << (snapshot.tags.empty() ? "]\n" : "\n  ]\n");
+    json << "}\n";
+
+    std::ofstream file(std::filesystem::path(m_metricsPath), std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << json.str();
+    return file.good();
 }
 
 std::shared_ptr<IContextAdapter> ContextManager::FindAdapter(
     const std::wstring& processName,
     const std::wstring& windowTitle)
 {
-    for (auto& adapter : m_adapters) {
-        if (adapter->CanHandle(processName, windowTitle)) {
-            return adapter;
+    std::lock_guard<std::mutex> lock(m_dispatchMutex);
+
+    auto memo = m_dispatch.find(processName);
+    if (memo != m_dispatch.end()) {
+        return memo->second;
+    }
+
+    // First time for this name: declared names, then the adapters' heuristics
+    std::shared_ptr<IContextAdapter> match;
+    auto exact = m_processNames.find(Utils::ToLower(processName));
+    if (exact != m_processNames.end()) {
+        match = exact->second;
+    } else {
+        for (auto& adapter : m_adapters) {
+            if (adapter->CanHandle(processName, windowTitle)) {
+                match = adapter;
+                break;
+            }
         }
     }
-    return nullptr;
+
+    m_dispatch.emplace(processName, match);
+    return match;
 }
@@ -6,21 +6,39 @@
 
 #include "context_adapter.h"
 #include "async_executor.h"
+#include "coroutine.h"
+#include "context_cache.h"
+#include "adaptive_timeout.h"
+#include "circuit_breaker.h"
 #include <memory>
 #include <vector>
 #include <functional>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <deque>
 
 // Forward declaration
 struct SourceInfo;
 struct ContextData;
 
+// How foreground changes turn into prefetches
+struct PrefetchPolicy {
+    int dwellMs = 200;          // Window must stay in front this long; negative disables
+    int minIntervalMs = 500;    // At most one prefetch started per interval
+};
+
 // Context manager - coordinates all context adapters
 class ContextManager {
 public:
-    using ContextCallback = std::function<void(std::shared_ptr<ContextData>)>;
-
     // Constructor
-    explicit ContextManager(size_t threadPoolSize = 2);
+    // threadPoolSize: Worker threads (0 = AsyncExecutor::DefaultThreadCount())
+    // workerHooks: Run on each worker thread at start/exit (e.g. per-thread
+    //              COM + UI Automation setup for the adapters)
+    explicit ContextManager(size_t threadPoolSize = 0,
+                            AsyncExecutor::WorkerHooks workerHooks = AsyncExecutor::WorkerHooks());
 
     // Destructor
     ~ContextManager();
@@ -33,10 +51,58 @@ public:
     // adapter: Shared pointer to adapter instance
     void RegisterAdapter(std::shared_ptr<IContextAdapter> adapter);
 
-    // Get context asynchronously
+    // Set the adapter for processes no registered adapter handles
+    // adapter: Called synchronously on the caller's thread (no executor,
+    //          cache or breaker), so it must not block; its context is
+    //          complete, not partial. Set before the first GetContext.
+    void SetGenericAdapter(std::shared_ptr<IContextAdapter> adapter) { m_genericAdapter = std::move(adapter); }
+
+    // Get context asynchronously: co_await GetContext(source)
+    // source: Source application information
+    // priority: Scheduling class (Interactive for hotkey-driven captures)
+    // Returns: Context data, a failed context on timeout/error, or nullptr
+    //          when no adapter matches and no generic adapter is set (with
+    //          one, its context is built inline). A cache hit (same window, within the
+    //          adapter's cache policy) returns at once, refreshing a stale
+    //          entry in the background. Otherwise the adapter runs on a
+    //          worker and the awaiting coroutine resumes on a worker too;
+    //          concurrent requests for the same window share one run.
+    //          Adapters with providers run them concurrently instead; the
+    //          first to fill the required fields completes the fetch.
+    //          While the executor is backed up or the adapter's circuit
+    //          breaker is open, the title-only context is returned instead.
+    CoTask<std::shared_ptr<const ContextData>> GetContext(SourceInfo source,
+                                                          TaskPriority priority = TaskPriority::Normal);
+
+    // Warm the cache for a window that just came to the foreground
+    // source: The new foreground window
+    // Once it has stayed in front for the policy's dwell time, and if the
+    // executor is idle, its context is fetched at Background priority and
+    // cached, so a copy from it usually hits. Copy-bound providers (see
+    // ContextProvider) are skipped. Never blocks the caller.
+    void Prefetch(const SourceInfo& source);
+
+    struct PrefetchStats {
+        uint64_t issued = 0;      // Prefetches started
+        uint64_t hits = 0;        // Copies served by a prefetched result
+        uint64_t wasted = 0;      // Prefetches no copy used
+        uint64_t skipped = 0;     // Focus changes not prefetched (moved on, warm, busy, rate limit)
+        size_t pending = 0;       // Prefetched windows not copied from yet
+    };
+
+    PrefetchStats GetPrefetchStats() const;
+
+    // Set the prefetch dwell time and rate limit
+    void SetPrefetchPolicy(const PrefetchPolicy& policy) { m_prefetchPolicy = policy; }
+
+    // Get the quick (title-only) context synchronously
     // source: Source application information
-    // callback: Callback function to receive context data
-    void GetContextAsync(const SourceInfo& source, ContextCallback callback);
+    // Returns: Partial context from the matching adapter's GetQuickContext,
+    //          or nullptr when it has no cheap phase. Meant to be published
+    //          at once, then replaced by GetContext. No matching adapter:
+    //          the generic adapter's context, complete (nothing replaces it),
+    //          or nullptr without one.
+    std::shared_ptr<const ContextData> GetQuickContext(const SourceInfo& source);
 
     // Get default timeout
     int GetDefaultTimeout() const { return m_defaultTimeout; }
@@ -44,18 +110,173 @@ public:
     // Set default timeout
     void SetDefaultTimeout(int timeoutMs) { m_defaultTimeout = timeoutMs; }
 
+    // Set how timeouts adapt to observed fetch times; the adapter's own
+    // (or the default) timeout applies until there are enough samples
+    void SetTimeoutPolicy(const AdaptiveTimeoutPolicy& policy) { m_timeouts.SetPolicy(policy); }
+
+    // Policy for the per-adapter circuit breakers; applies to adapters
+    // registered afterwards
+    void SetCircuitBreakerPolicy(const CircuitBreakerPolicy& policy) { m_breakerPolicy = policy; }
+
+    // Skip deep (UI Automation) fetches, except interactive ones, while at
+    // least this many tasks are queued on the executor; 0 disables
+    void SetLoadSheddingThreshold(size_t maxQueueDepth) { m_maxQueueDepth = maxQueueDepth; }
+
+    // Effective timeouts and the latency percentiles behind them
+    std::vector<AdaptiveTimeout::Snapshot> GetTimeouts() const { return m_timeouts.GetSnapshot(); }
+
     // Check if manager is initialized
     bool IsInitialized() const { return m_initialized; }
 
+    // Executor queue depth and per-adapter wait/run percentiles
+    ExecutorMetrics::Snapshot GetExecutorMetrics() const { return m_executor->GetMetricsSnapshot(); }
+
+    // Context cache hit/miss counters
+    ContextCache::Stats GetCacheStats() const { return m_cache.GetStats(); }
+
+    // Breaker state and window counts per adapter, in registration order
+    std::vector<CircuitBreaker::Stats> GetBreakerStats() const;
+
+    // Deep fetches skipped because the executor was backed up
+    uint64_t GetShedCount() const { return m_shed.load(std::memory_order_relaxed); }
+
+    // Requests that joined an in-flight fetch instead of starting one
+    uint64_t GetCoalescedFetches() const { return m_coalesced.load(std::memory_order_relaxed); }
+
+    // Write GetExecutorMetrics(), GetCacheStats(), GetTimeouts(),
+    // GetBreakerStats() and GetPrefetchStats() as JSON to path every
+    // intervalMs (as background work on the executor); intervalMs <= 0 disables
+    void StartMetricsDump(const std::wstring& path, int intervalMs);
+
 private:
     // Find matching adapter for a process
     // processName: Process name (e.g., "chrome.exe")
     // windowTitle: Window title for additional context
     // Returns: Pointer to matching adapter, or nullptr if none found
+    // One hash probe once a process name has been seen: exact names
+    // declared by the adapters come first, then CanHandle in registration
+    // order; the outcome (including "none") is memoized per process name
     std::shared_ptr<IContextAdapter> FindAdapter(const std::wstring& processName,
                                                  const std::wstring& windowTitle);
 
+    using SharedContext = SharedResult<std::shared_ptr<const ContextData>>;
+
+    // Attach to the in-flight fetch for this window, or start one. Callers
+    // await the result with their own timeout; the first caller's timeout
+    // bounds the adapter run itself. ticket: from the breaker's Allow();
+    // recorded by the new fetch, or released when joining one in flight.
+    // speculative: a prefetch (skips copy-bound providers). joined: set to
+    // whether a fetch was in flight.
+    std::shared_ptr<SharedContext> JoinFetch(std::shared_ptr<IContextAdapter> adapter,
+                                             const SourceInfo& source,
+                                             const ContextCache::Key& key,
+                                             CircuitBreaker::Ticket ticket,
+                                             int timeoutMs,
+                                             TaskPriority priority,
+                                             bool speculative = false,
+                                             bool* joined = nullptr);
+
+    // Producer of one in-flight fetch: run, cache, then wake the waiters
+    CoTask<void> RunFetch(std::shared_ptr<IContextAdapter> adapter,
+                          SourceInfo source,
+                          ContextCache::Key key,
+                          CircuitBreaker::Ticket ticket,
+                          int timeoutMs,
+                          TaskPriority priority,
+                          bool speculative,
+                          std::shared_ptr<SharedContext> result);
+
+    // Run the adapter on a worker; cancelled at its deadline
+    CoTask<std::shared_ptr<const ContextData>> FetchContext(std::shared_ptr<IContextAdapter> adapter,
+                                                            SourceInfo source,
+                                                            int timeoutMs,
+                                                            TaskPriority priority,
+                                                            bool speculative);
+
+    // Run the adapter's providers concurrently, one worker task each, and
+    // build the context once the required fields are in (or all have
+    // reported); the providers still running are cancelled through token
+    CoTask<std::shared_ptr<const ContextData>> FetchFromProviders(std::shared_ptr<IContextAdapter> adapter,
+                                                                  SourceInfo source,
+                                                                  std::vector<std::shared_ptr<ContextProvider>> providers,
+                                                                  std::shared_ptr<CancellationToken> token,
+                                                                  TaskOptions options);
+
+    // One provider of FetchFromProviders; the result that completes the
+    // merge sets done
+    CoTask<void> RunProvider(std::shared_ptr<ContextProvider> provider,
+                             SourceInfo source,
+                             std::shared_ptr<CancellationToken> token,
+                             TaskOptions options,
+                             std::shared_ptr<ContextMerge> merge,
+                             std::shared_ptr<SharedResult<bool>> done);
+
+    // Adapter's GetQuickContext, marked partial (nullptr if it has none or throws)
+    std::shared_ptr<ContextData> RunQuickContext(IContextAdapter& adapter, const SourceInfo& source);
+
+    // Generic adapter's context for an unmatched process (nullptr without one)
+    std::shared_ptr<ContextData> RunGenericContext(const SourceInfo& source);
+
+    // Title-only context in place of a skipped deep fetch; reason goes to
+    // the "deep_skipped" metadata (or the error, without a quick context)
+    std::shared_ptr<const ContextData> GetFallbackContext(IContextAdapter& adapter,
+                                                          const SourceInfo& source,
+                                                          const std::wstring& reason);
+
+    // Prefetch once the dwell time is over, unless focus moved on since
+    // (generation), the window is already warm or the executor is busy
+    void RunPrefetch(std::shared_ptr<IContextAdapter> adapter, const SourceInfo& source,
+                     uint64_t generation);
+
+    // Whether a prefetch can warm this adapter's cache: it caches, and has
+    // something to fetch that does not depend on the copy
+    bool CanPrefetch(const IContextAdapter& adapter) const;
+
+    // Whether a copy's fetch for this window was prefetched; forgets it
+    bool TakePrefetched(const ContextCache::Key& key);
+
+    // Whether to skip a deep fetch of this priority for load
+    bool ShouldShed(TaskPriority priority) const;
+
+    // Circuit breaker of a registered adapter
+    CircuitBreaker* FindBreaker(const IContextAdapter& adapter) const;
+
+    // Timeout of one adapter run for this source: adaptive once the process
+    // (or adapter) has enough samples, else the adapter's own or the default
+    int GetAdapterTimeout(const IContextAdapter& adapter, const SourceInfo& source) const;
+
+    // Write the current metrics snapshot to m_metricsPath
+    bool WriteMetrics() const;
+
+    // Queue the next periodic WriteMetrics
+    void ScheduleMetricsDump();
+
     std::vector<std::shared_ptr<IContextAdapter>> m_adapters;
+    std::shared_ptr<IContextAdapter> m_genericAdapter;   // Unmatched processes
+    std::unordered_map<std::wstring, std::shared_ptr<IContextAdapter>> m_processNames;  // Declared names (lowercase)
+    std::unordered_map<std::wstring, std::shared_ptr<IContextAdapter>> m_dispatch;      // Memoized lookups (as given)
+    std::mutex m_dispatchMutex;
+    std::unordered_map<const IContextAdapter*, uint32_t> m_adapterTags;  // Executor metrics tag per adapter
+    std::unordered_map<const IContextAdapter*, std::vector<std::shared_ptr<ContextProvider>>> m_providers;
+    ContextCache m_cache;
+    AdaptiveTimeout m_timeouts;
+    std::unordered_map<const IContextAdapter*, std::unique_ptr<CircuitBreaker>> m_breakers;
+    CircuitBreakerPolicy m_breakerPolicy;
+    std::unordered_map<ContextCache::Key, std::shared_ptr<SharedContext>, ContextCache::KeyHash> m_inFlight;
+    std::mutex m_inFlightMutex;
+    std::atomic<uint64_t> m_coalesced;
+    size_t m_maxQueueDepth;
+    PrefetchPolicy m_prefetchPolicy;
+    std::atomic<uint64_t> m_prefetchGeneration;     // Bumped by every foreground change
+    std::deque<ContextCache::Key> m_prefetched;     // Prefetched windows not copied from yet
+    std::chrono::steady_clock::time_point m_lastPrefetch;
+    mutable std::mutex m_prefetchMutex;
+    std::atomic<uint64_t> m_prefetchIssued;
+    std::atomic<uint64_t> m_prefetchHits;
+    std::atomic<uint64_t> m_prefetchSkipped;
+    std::atomic<uint64_t> m_shed;
+    std::wstring m_metricsPath;
+    int m_metricsIntervalMs;
     std::unique_ptr<AsyncExecutor> m_executor;
     int m_defaultTimeout;
     bool m_initialized;
@@ -0,0 +1,70 @@
+#include "context_provider.h"
+
+ContextMerge::ContextMerge(std::vector<std::string> requiredFields, size_t providerCount)
+    : m_required(std::move(requiredFields))
+    , m_pending(providerCount)
+    , m_reported(0)
+    , m_done(false)
+{
+}
+
+bool ContextMerge::Add(const ContextProvider& provider, ContextFields fields) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_done) {
+        return false;   // Completed without this provider
+    }
+
+    for (auto& field : fields) {
+        if (field.second.empty()) {
+            continue;
+        }
+        auto it = m_values.find(field.first);
+        if (it == m_values.end() || provider.GetConfidence() > it->second.confidence) {
+            Value& value = m_values[field.first];
+            value.text = std::move(field.second);
+            value.source = provider.GetName();
+            value.confidence = provider.GetConfidence();
+        }
+    }
+
+    ++m_reported;
+    if (m_pending > 0) {
+        --m_pending;
+    }
+    if (m_pending == 0 || (!m_required.empty() && HasRequiredLocked())) {
+        m_done = true;
+        return true;
+    }
+    return false;
+}
+
+std::wstring ContextMerge::Get(const std::string& field) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_values.find(field);
+    return it != m_values.end() ? it->second.text : std::wstring();
+}
+
+std::string ContextMerge::GetSource(const std::string& field) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_values.find(field);
+    return it != m_values.end() ? it->second.source : std::string();
+}
+
+bool ContextMerge::HasRequired() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return HasRequiredLocked();
+}
+
+size_t ContextMerge::GetReportedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_reported;
+}
+
+bool ContextMerge::HasRequiredLocked() const {
+    for (const auto& field : m_required) {
+        if (m_values.find(field) == m_values.end()) {
+            return false;
+        }
+    }
+    return true;
+}
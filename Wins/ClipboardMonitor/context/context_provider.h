@@ -0,0 +1,100 @@
+#pragma once
+
+#include "cancellation_token.h"
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct SourceInfo;
+
+// Named context fields from one source, e.g. {"url": ..., "page_title": ...}
+using ContextFields = std::map<std::string, std::wstring>;
+
+// One independent source of context fields for an adapter (e.g. the
+// browser's CF_HTML SourceURL, the extension's browser_context.json and the
+// UIA address bar). ContextManager runs an adapter's providers concurrently
+// on the executor and merges what they find.
+class ContextProvider {
+public:
+    // Fill the fields this source knows; leave the map empty if it has none.
+    // Runs on a worker; stop early once token is cancelled.
+    using ProvideFunction =
+        std::function<void(const SourceInfo&, const CancellationToken&, ContextFields&)>;
+
+    // confidence: 0..1; on a conflict the more confident provider's value wins
+    // copyBound: reads what the copy itself produced (the clipboard, the
+    //            extension's copy event), so prefetches ahead of a copy skip it
+    ContextProvider(std::string name, double confidence, ProvideFunction provide,
+                    bool copyBound = false)
+        : m_name(std::move(name))
+        , m_confidence(confidence)
+        , m_copyBound(copyBound)
+        , m_provide(std::move(provide)) {}
+
+    const std::string& GetName() const { return m_name; }
+    double GetConfidence() const { return m_confidence; }
+    bool IsCopyBound() const { return m_copyBound; }
+
+    void Provide(const SourceInfo& source, const CancellationToken& token, ContextFields& fields) const {
+        m_provide(source, token, fields);
+    }
+
+private:
+    std::string m_name;
+    double m_confidence;
+    bool m_copyBound;
+    ProvideFunction m_provide;
+};
+
+// Field-by-field merge of provider results, first good wins.
+//
+// Each field keeps the value of the most confident provider that has
+// reported it so far. The merge completes as soon as every required field
+// has a value (the slower providers are then cancelled, so a field's
+// latency is that of its fastest successful source), or when the last
+// provider has reported. After completion further results are ignored, so
+// the fields can be read without racing late providers.
+class ContextMerge {
+public:
+    ContextMerge(std::vector<std::string> requiredFields, size_t providerCount);
+
+    // Disable copy
+    ContextMerge(const ContextMerge&) = delete;
+    ContextMerge& operator=(const ContextMerge&) = delete;
+
+    // Merge one provider's result; safe from any thread
+    // Returns: true for exactly one call, the one that completes the merge
+    bool Add(const ContextProvider& provider, ContextFields fields);
+
+    // Merged value of a field (empty if no provider had it); read after completion
+    std::wstring Get(const std::string& field) const;
+
+    // Name of the provider the field's value came from (empty if none)
+    std::string GetSource(const std::string& field) const;
+
+    // Whether every required field has a value
+    bool HasRequired() const;
+
+    // Providers that reported before completion
+    size_t GetReportedCount() const;
+
+private:
+    struct Value {
+        std::wstring text;
+        std::string source;
+        double confidence = 0.0;
+    };
+
+    // Caller holds m_mutex
+    bool HasRequiredLocked() const;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::string> m_required;
+    size_t m_pending;
+    size_t m_reported;
+    bool m_done;
+    std::map<std::string, Value> m_values;
+};
@@ -0,0 +1,468 @@
+#pragma once
+
+#include "async_executor.h"
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Coroutine building blocks on top of AsyncExecutor.
+//
+//   CoTask<T>      Lazy coroutine result; starts when awaited
+//   Spawn(task)    Start a CoTask<void> without awaiting it
+//   WithTimeout    Await with a deadline; std::nullopt on timeout
+//   WhenAll        Await every awaitable; results in input order
+//   WhenAny        Await the first to finish; the rest run on, ignored
+//   SharedResult   One-shot result any number of coroutines can await
+//
+// Awaitables are CoTask<T> or AsyncExecutor::Run(...). A timed-out or
+// losing awaitable is not interrupted: pass it a CancellationToken and
+// cancel that once the race is decided.
+
+namespace coro_detail {
+
+struct Unit {};
+
+// Value type used to store a T (void becomes Unit)
+template<typename T>
+using Stored = std::conditional_t<std::is_void_v<T>, Unit, T>;
+
+template<typename Awaitable>
+using AwaitResult = decltype(std::declval<Awaitable&>().await_resume());
+
+template<typename T>
+class PromiseStorage {
+public:
+    template<typename U>
+    void return_value(U&& value) { m_value.emplace(std::forward<U>(value)); }
+
+    T Take() {
+        if (m_exception) std::rethrow_exception(m_exception);
+        return std::move(*m_value);
+    }
+
+protected:
+    std::optional<T> m_value;
+    std::exception_ptr m_exception;
+};
+
+template<>
+class PromiseStorage<void> {
+public:
+    void return_void() {}
+
+    void Take() {
+        if (m_exception) std::rethrow_exception(m_exception);
+    }
+
+protected:
+    std::exception_ptr m_exception;
+};
+
+// Fire-and-forget coroutine that frees its own frame when it finishes
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }   // Bodies catch everything
+    };
+};
+
+// Await an awaitable and pass its result or exception to onDone
+template<typename Awaitable, typename OnDone>
+DetachedTask RunAndReport(Awaitable awaitable, OnDone onDone) {
+    using Result = AwaitResult<Awaitable>;
+    std::optional<Stored<Result>> value;
+    std::exception_ptr error;
+    try {
+        if constexpr (std::is_void_v<Result>) {
+            co_await awaitable;
+            value.emplace();
+        } else {
+            value.emplace(co_await awaitable);
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    onDone(std::move(value), error);
+}
+
+} // namespace coro_detail
+
+template<typename T = void>
+class CoTask {
+public:
+    class promise_type : public coro_detail::PromiseStorage<T> {
+    public:
+        CoTask get_return_object() noexcept {
+            return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // Hand control straight to the awaiting coroutine (no stack growth)
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                std::coroutine_handle<> continuation = handle.promise().m_continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() noexcept { this->m_exception = std::current_exception(); }
+
+    private:
+        friend class CoTask;
+        std::coroutine_handle<> m_continuation;
+    };
+
+    CoTask() noexcept = default;
+    CoTask(CoTask&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    CoTask& operator=(CoTask&& other) noexcept {
+        if (this != &other) {
+            Destroy();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    CoTask(const CoTask&) = delete;
+    CoTask& operator=(const CoTask&) = delete;
+    ~CoTask() { Destroy(); }
+
+    // Awaiting starts the coroutine; it resumes us when it finishes
+    bool await_ready() const noexcept { return !m_handle || m_handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        m_handle.promise().m_continuation = awaiting;
+        return m_handle;
+    }
+
+    T await_resume() { return m_handle.promise().Take(); }
+
+private:
+    explicit CoTask(std::coroutine_handle<promise_type> handle) noexcept : m_handle(handle) {}
+
+    void Destroy() {
+        if (m_handle) {
+            m_handle.destroy();
+            m_handle = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+// Start a coroutine without awaiting it; it owns itself until it finishes.
+// Exceptions escaping the task are dropped - handle errors inside it.
+inline void Spawn(CoTask<void> task) {
+    coro_detail::RunAndReport(std::move(task), [](auto&&, std::exception_ptr) {});
+}
+
+// Await awaitable for at most timeoutMs. Returns the result, or std::nullopt
+// on timeout. After a timeout the coroutine resumes on a worker with
+// resumePriority rather than on the timer thread.
+template<typename Awaitable>
+CoTask<std::optional<coro_detail::Stored<coro_detail::AwaitResult<Awaitable>>>>
+WithTimeout(AsyncExecutor& executor, Awaitable awaitable, int timeoutMs,
+            TaskPriority resumePriority = TaskPriority::Normal)
+{
+    using Value = coro_detail::Stored<coro_detail::AwaitResult<Awaitable>>;
+
+    struct State {
+        std::atomic<bool> decided{false};
+        std::optional<Value> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> waiter;
+        TimerQueue::TimerId timer = TimerQueue::kInvalidTimer;
+    };
+
+    struct Race {
+        AsyncExecutor& executor;
+        Awaitable& awaitable;
+        int timeoutMs;
+        TaskPriority resumePriority;
+        std::shared_ptr<State> state;
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> awaiting) {
+            // Once the timer is armed we may be resumed at any moment and
+            // this object destroyed, so work from locals only
+            std::shared_ptr<State> shared = state;
+            AsyncExecutor& ex = executor;
+            Awaitable inner = std::move(awaitable);
+            TaskOptions options;
+            options.priority = resumePriority;
+            shared->waiter = awaiting;
+
+            // Timer first, so the awaitable finishing early can cancel it
+            shared->timer = ex.ScheduleTimer(timeoutMs, [race = shared, &ex, options]() {
+                if (race->decided.exchange(true)) {
+                    return;
+                }
+                // Resume on a worker; the timer thread must stay responsive
+                std::coroutine_handle<> waiter = race->waiter;
+                AsyncExecutor::Task resume([waiter]() { waiter.resume(); });
+                if (!ex.TryPost(resume, options)) {
+                    waiter.resume();
+                }
+            });
+
+            coro_detail::RunAndReport(std::move(inner),
+                [race = shared, &ex](std::optional<Value>&& value, std::exception_ptr error) {
+                    if (race->decided.exchange(true)) {
+                        return;   // Timed out; result discarded
+                    }
+                    ex.CancelTimer(race->timer);
+                    race->value = std::move(value);
+                    race->error = error;
+                    race->waiter.resume();
+                });
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    auto state = std::make_shared<State>();
+    // Named, not a temporary: GCC destroys aggregate temporaries in co_await twice
+    Race race{executor, awaitable, timeoutMs, resumePriority, state};
+    co_await race;
+
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+    co_return std::move(state->value);
+}
+
+// Await all awaitables concurrently; results in input order. If any throws,
+// the first exception is rethrown after all have finished.
+template<typename Awaitable>
+CoTask<std::vector<coro_detail::Stored<coro_detail::AwaitResult<Awaitable>>>>
+WhenAll(std::vector<Awaitable> awaitables)
+{
+    using Value = coro_detail::Stored<coro_detail::AwaitResult<Awaitable>>;
+
+    struct State {
+        std::atomic<size_t> remaining{0};
+        std::vector<std::optional<Value>> values;
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        std::coroutine_handle<> waiter;
+    };
+
+    struct All {
+        std::vector<Awaitable>& awaitables;
+        std::shared_ptr<State> state;
+
+        bool await_ready() const noexcept { return awaitables.empty(); }
+
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            state->waiter = awaiting;
+            state->values.resize(awaitables.size());
+
+            // One extra count held by this loop, so no awaitable can resume
+            // us while we are still starting the others
+            state->remaining.store(awaitables.size() + 1);
+            for (size_t i = 0; i < awaitables.size(); ++i) {
+                coro_detail::RunAndReport(std::move(awaitables[i]),
+                    [state = state, i](std::optional<Value>&& value, std::exception_ptr error) {
+                        if (error) {
+                            if (!state->failed.exchange(true)) {
+                                state->error = error;
+                            }
+                        } else {
+                            state->values[i] = std::move(value);
+                        }
+                        if (state->remaining.fetch_sub(1) == 1) {
+                            state->waiter.resume();
+                        }
+                    });
+            }
+            // Everything finished inline: continue without suspending
+            return state->remaining.fetch_sub(1) != 1;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    auto state = std::make_shared<State>();
+    All all{awaitables, state};
+    co_await all;
+
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+    std::vector<Value> results;
+    results.reserve(state->values.size());
+    for (auto& value : state->values) {
+        results.push_back(std::move(*value));
+    }
+    co_return results;
+}
+
+// Await the first awaitable to finish (result or exception) and return its
+// index and value. The others keep running and their results are dropped.
+template<typename Awaitable>
+CoTask<std::pair<size_t, coro_detail::Stored<coro_detail::AwaitResult<Awaitable>>>>
+WhenAny(std::vector<Awaitable> awaitables)
+{
+    using Value = coro_detail::Stored<coro_detail::AwaitResult<Awaitable>>;
+
+    if (awaitables.empty()) {
+        throw std::invalid_argument("WhenAny needs at least one awaitable");
+    }
+
+    struct State {
+        std::atomic<bool> decided{false};
+        std::atomic<int> resumeGuard{2};   // Winner + starting loop
+        size_t index = 0;
+        std::optional<Value> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> waiter;
+    };
+
+    struct Any {
+        std::vector<Awaitable>& awaitables;
+        std::shared_ptr<State> state;
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            state->waiter = awaiting;
+            for (size_t i = 0; i < awaitables.size(); ++i) {
+                coro_detail::RunAndReport(std::move(awaitables[i]),
+                    [state = state, i](std::optional<Value>&& value, std::exception_ptr error) {
+                        if (state->decided.exchange(true)) {
+                            return;
+                        }
+                        state->index = i;
+                        state->value = std::move(value);
+                        state->error = error;
+                        if (state->resumeGuard.fetch_sub(1) == 1) {
+                            state->waiter.resume();
+                        }
+                    });
+            }
+            return state->resumeGuard.fetch_sub(1) != 1;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    auto state = std::make_shared<State>();
+    Any any{awaitables, state};
+    co_await any;
+
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+    co_return std::make_pair(state->index, std::move(*state->value));
+}
+
+// One-shot result that any number of coroutines can await (for single-flight
+// work: one producer, many waiters). Set() or SetException() must be called
+// exactly once; waiters already suspended are resumed then and later ones
+// complete at once. Every waiter gets its own copy of the value. The first
+// waiter resumes on the producer's thread, the rest are posted to the
+// executor so one slow continuation does not hold up the others.
+// A waiter may give up early via WithTimeout without affecting the others.
+template<typename T>
+class SharedResult {
+    struct State {
+        std::mutex mutex;
+        bool done = false;
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::vector<std::coroutine_handle<>> waiters;
+    };
+
+public:
+    class Awaiter {
+    public:
+        explicit Awaiter(std::shared_ptr<State> state) : m_state(std::move(state)) {}
+
+        bool await_ready() const {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            return m_state->done;
+        }
+
+        bool await_suspend(std::coroutine_handle<> awaiting) {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            if (m_state->done) {
+                return false;   // Set while we were getting here
+            }
+            m_state->waiters.push_back(awaiting);
+            return true;
+        }
+
+        // The result is immutable once done, so no lock is needed
+        T await_resume() const {
+            if (m_state->error) {
+                std::rethrow_exception(m_state->error);
+            }
+            return *m_state->value;
+        }
+
+    private:
+        std::shared_ptr<State> m_state;
+    };
+
+    explicit SharedResult(AsyncExecutor& executor)
+        : m_executor(executor), m_state(std::make_shared<State>()) {}
+
+    // Disable copy
+    SharedResult(const SharedResult&) = delete;
+    SharedResult& operator=(const SharedResult&) = delete;
+
+    Awaiter Wait() const { return Awaiter(m_state); }
+
+    void Set(T value) {
+        Complete([&](State& state) { state.value.emplace(std::move(value)); });
+    }
+
+    void SetException(std::exception_ptr error) {
+        Complete([&](State& state) { state.error = error; });
+    }
+
+private:
+    template<typename Store>
+    void Complete(Store store) {
+        // A resumed waiter may release the last reference to this object
+        std::shared_ptr<State> state = m_state;
+        AsyncExecutor& executor = m_executor;
+
+        std::vector<std::coroutine_handle<>> waiters;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->done) {
+                return;
+            }
+            store(*state);
+            state->done = true;
+            waiters.swap(state->waiters);
+        }
+
+        for (size_t i = 1; i < waiters.size(); ++i) {
+            std::coroutine_handle<> waiter = waiters[i];
+            AsyncExecutor::Task resume([waiter]() { waiter.resume(); });
+            if (!executor.TryPost(resume)) {
+                waiter.resume();
+            }
+        }
+        if (!waiters.empty()) {
+            waiters[0].resume();
+        }
+    }
+
+    AsyncExecutor& m_executor;
+    std::shared_ptr<State> m_state;
+};
@@ -0,0 +1,42 @@
+#include "executor_metrics.h"
+
+ExecutorMetrics::ExecutorMetrics()
+    : m_slots(std::make_unique<TagSlot[]>(kMaxTags))
+    , m_tagCount(1)
+{
+    m_names[kUntagged] = "untagged";
+}
+
+uint32_t ExecutorMetrics::RegisterTag(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_registerMutex);
+
+    uint32_t count = m_tagCount.load(std::memory_order_relaxed);
+    for (uint32_t tag = 0; tag < count; ++tag) {
+        if (m_names[tag] == name) {
+            return tag;
+        }
+    }
+    if (count >= kMaxTags) {
+        return kUntagged;
+    }
+
+    m_names[count] = name;
+    m_tagCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+std::vector<ExecutorMetrics::TagSummary> ExecutorMetrics::Summarize() const {
+    std::vector<TagSummary> summaries;
+    uint32_t count = m_tagCount.load(std::memory_order_acquire);
+    for (uint32_t tag = 0; tag < count; ++tag) {
+        TagSummary summary;
+        summary.wait = m_slots[tag].wait.Summarize();
+        if (summary.wait.count == 0) {
+            continue;
+        }
+        summary.name = m_names[tag];
+        summary.run = m_slots[tag].run.Summarize();
+        summaries.push_back(std::move(summary));
+    }
+    return summaries;
+}
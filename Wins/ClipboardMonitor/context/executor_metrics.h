@@ -0,0 +1,66 @@
+#pragma once
+
+#include "latency_histogram.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Per-tag wait/run time histograms for AsyncExecutor.
+//
+// Wait time is enqueue -> start (time spent queued behind other work), run
+// time is start -> finish. Tags are registered up front (ContextManager uses
+// one per adapter), so recording is an array index plus lock-free histogram
+// updates; only RegisterTag takes a lock.
+class ExecutorMetrics {
+public:
+    static constexpr uint32_t kUntagged = 0;
+    static constexpr size_t kMaxTags = 16;
+
+    struct TagSummary {
+        std::string name;
+        LatencyHistogram::Summary wait;
+        LatencyHistogram::Summary run;
+    };
+
+    // Point-in-time view of an executor
+    struct Snapshot {
+        size_t threads = 0;
+        size_t queueDepth = 0;   // Tasks queued, not yet started
+        size_t running = 0;      // Tasks executing now
+        size_t dropped = 0;      // Total dropped past their deadline
+        std::vector<TagSummary> tags;   // Only tags that have recorded tasks
+    };
+
+    ExecutorMetrics();
+
+    // Disable copy
+    ExecutorMetrics(const ExecutorMetrics&) = delete;
+    ExecutorMetrics& operator=(const ExecutorMetrics&) = delete;
+
+    // Tag for a name; idempotent. Returns kUntagged when the table is full.
+    uint32_t RegisterTag(const std::string& name);
+
+    void RecordWait(uint32_t tag, uint64_t micros) { Slot(tag).wait.Record(micros); }
+    void RecordRun(uint32_t tag, uint64_t micros) { Slot(tag).run.Record(micros); }
+
+    // Summaries for every tag with at least one recorded task
+    std::vector<TagSummary> Summarize() const;
+
+private:
+    struct TagSlot {
+        LatencyHistogram wait;
+        LatencyHistogram run;
+    };
+
+    TagSlot& Slot(uint32_t tag) {
+        return m_slots[tag < m_tagCount.load(std::memory_order_acquire) ? tag : kUntagged];
+    }
+
+    std::unique_ptr<TagSlot[]> m_slots;
+    std::string m_names[kMaxTags];          // Written once, before m_tagCount publishes them
+    std::atomic<uint32_t> m_tagCount;
+    std::mutex m_registerMutex;
+};
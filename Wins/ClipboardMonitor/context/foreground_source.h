@@ -0,0 +1,47 @@
+#pragma once
+
+#include <functional>
+
+// Window handle as <windows.h> declares it, so this header (and tests that
+// drive prefetching through ManualForegroundSource) does not need it
+struct HWND__;
+typedef struct HWND__* HWND;
+
+// Source of foreground-window changes. ClipboardMonitor prefetches the
+// context of each newly focused window so a copy finds it warm; the source
+// is injectable so prefetching can be driven without a desktop.
+class IForegroundSource {
+public:
+    // Called with the new foreground window, on the thread that called Start
+    using Callback = std::function<void(HWND)>;
+
+    virtual ~IForegroundSource() = default;
+
+    // Begin delivering changes
+    // Returns: false if the source could not be set up
+    virtual bool Start(Callback callback) = 0;
+
+    // Stop delivering changes
+    virtual void Stop() = 0;
+};
+
+// Foreground changes raised by hand (tests, tools)
+class ManualForegroundSource : public IForegroundSource {
+public:
+    bool Start(Callback callback) override {
+        m_callback = std::move(callback);
+        return true;
+    }
+
+    void Stop() override { m_callback = nullptr; }
+
+    // Deliver a change synchronously, as the hook would
+    void Raise(HWND hwnd) {
+        if (m_callback) {
+            m_callback(hwnd);
+        }
+    }
+
+private:
+    Callback m_callback;
+};
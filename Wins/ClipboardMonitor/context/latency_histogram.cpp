@@ -0,0 +1,103 @@
+#include "latency_histogram.h"
+#include <algorithm>
+
+namespace {
+
+constexpr uint64_t kHalf = LatencyHistogram::kSubBuckets / 2;
+
+int HighestBit(uint64_t value) {
+    int bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() : m_sum(0), m_max(0) {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::BucketIndex(uint64_t micros) {
+    micros = (std::min)(micros, kMaxValue);
+    if (micros < kSubBuckets) {
+        return static_cast<size_t>(micros);   // Exact below kSubBuckets
+    }
+
+    // Drop low bits so the value lands in [kSubBuckets/2, kSubBuckets)
+    int shift = HighestBit(micros) - kSubBucketBits + 1;
+    uint64_t sub = micros >> shift;
+    return static_cast<size_t>(shift * kHalf + sub);
+}
+
+uint64_t LatencyHistogram::BucketLow(size_t index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    uint64_t shift = index / kHalf - 1;
+    uint64_t sub = index - shift * kHalf;
+    return sub << shift;
+}
+
+uint64_t LatencyHistogram::BucketHigh(size_t index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    uint64_t shift = index / kHalf - 1;
+    uint64_t sub = index - shift * kHalf;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t micros) {
+    m_buckets[BucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(micros, std::memory_order_relaxed);
+
+    uint64_t seen = m_max.load(std::memory_order_relaxed);
+    while (micros > seen && !m_max.compare_exchange_weak(seen, micros, std::memory_order_relaxed)) {
+    }
+}
+
+std::vector<uint64_t> LatencyHistogram::Snapshot() const {
+    std::vector<uint64_t> counts(kBucketCount);
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+LatencyHistogram::Summary LatencyHistogram::Summarize() const {
+    Summary summary;
+    std::vector<uint64_t> counts = Snapshot();
+    for (uint64_t count : counts) {
+        summary.count += count;
+    }
+    if (summary.count == 0) {
+        return summary;
+    }
+
+    summary.maxUs = static_cast<double>(m_max.load(std::memory_order_relaxed));
+    summary.meanUs = static_cast<double>(m_sum.load(std::memory_order_relaxed)) / summary.count;
+
+    // Report each percentile as the midpoint of the bucket holding its rank
+    auto percentile = [&](double fraction) {
+        uint64_t rank = static_cast<uint64_t>(fraction * summary.count + 0.5);
+        rank = (std::max<uint64_t>)(rank, 1);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                double mid = (BucketLow(i) + BucketHigh(i)) / 2.0;
+                return (std::min)(mid, summary.maxUs);
+            }
+        }
+        return summary.maxUs;
+    };
+
+    summary.p50Us = percentile(0.50);
+    summary.p90Us = percentile(0.90);
+    summary.p99Us = percentile(0.99);
+    return summary;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Lock-free latency histogram with HDR-style log-linear buckets.
+//
+// Values are microseconds, exact below kSubBuckets. Above that each
+// power-of-two range is split into kSubBuckets/2 linear buckets, so a value
+// is reported within ~3% while the whole 1us..268s range fits in 400
+// counters.
+// Record() is a couple of relaxed atomic increments and never blocks;
+// readers take a Snapshot() and compute percentiles from the copy.
+class LatencyHistogram {
+public:
+    // Percentiles and totals computed from a copy of the counters
+    struct Summary {
+        uint64_t count = 0;
+        double meanUs = 0.0;
+        double p50Us = 0.0;
+        double p90Us = 0.0;
+        double p99Us = 0.0;
+        double maxUs = 0.0;
+    };
+
+    LatencyHistogram();
+
+    // Disable copy
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // Record one value; safe from any thread
+    void Record(uint64_t micros);
+
+    // Counters copied at one point in time (not atomic across buckets)
+    std::vector<uint64_t> Snapshot() const;
+
+    // Summarize a Snapshot(); an empty histogram gives all zeros
+    Summary Summarize() const;
+
+    // Value range covered by a bucket (inclusive)
+    static uint64_t BucketLow(size_t index);
+    static uint64_t BucketHigh(size_t index);
+
+    static size_t BucketIndex(uint64_t micros);
+
+    static constexpr int kSubBucketBits = 5;
+    static constexpr uint64_t kSubBuckets = 1ULL << kSubBucketBits;
+    static constexpr int kMaxValueBits = 28;                    // Clamp at ~268s
+    static constexpr uint64_t kMaxValue = (1ULL << kMaxValueBits) - 1;
+    static constexpr size_t kBucketCount =
+        (kMaxValueBits - kSubBucketBits + 1) * (kSubBuckets / 2) + kSubBuckets / 2;
+
+private:
+    std::atomic<uint64_t> m_buckets[kBucketCount];
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+};
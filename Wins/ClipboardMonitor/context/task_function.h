@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Move-only, type-erased void() callable for executor tasks.
+//
+// Callables up to kInlineSize bytes (a few pointers or shared_ptrs) are
+// stored inline, so wrapping a typical task lambda does not allocate; larger
+// ones fall back to the heap. Unlike std::function it accepts move-only
+// captures, such as a TaskPromise.
+class TaskFunction {
+public:
+    static constexpr size_t kInlineSize = 64;
+
+    TaskFunction() noexcept : m_ops(nullptr) {}
+    TaskFunction(std::nullptr_t) noexcept : m_ops(nullptr) {}
+
+    template<typename Func,
+             typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, TaskFunction> &&
+                                         !std::is_same_v<std::decay_t<Func>, std::nullptr_t>>>
+    TaskFunction(Func&& func) : m_ops(nullptr) {
+        using Stored = std::decay_t<Func>;
+        if constexpr (FitsInline<Stored>()) {
+            ::new (static_cast<void*>(&m_storage)) Stored(std::forward<Func>(func));
+            m_ops = &InlineOps<Stored>::ops;
+        } else {
+            *reinterpret_cast<Stored**>(&m_storage) = new Stored(std::forward<Func>(func));
+            m_ops = &HeapOps<Stored>::ops;
+        }
+    }
+
+    TaskFunction(TaskFunction&& other) noexcept : m_ops(other.m_ops) {
+        if (m_ops) {
+            m_ops->move(&other.m_storage, &m_storage);
+            other.m_ops = nullptr;
+        }
+    }
+
+    TaskFunction& operator=(TaskFunction&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            if (other.m_ops) {
+                m_ops = other.m_ops;
+                m_ops->move(&other.m_storage, &m_storage);
+                other.m_ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    TaskFunction& operator=(std::nullptr_t) noexcept {
+        Reset();
+        return *this;
+    }
+
+    // Disable copy (captures may be move-only)
+    TaskFunction(const TaskFunction&) = delete;
+    TaskFunction& operator=(const TaskFunction&) = delete;
+
+    ~TaskFunction() { Reset(); }
+
+    void operator()() { m_ops->invoke(&m_storage); }
+
+    explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+    friend bool operator==(const TaskFunction& task, std::nullptr_t) noexcept { return !task; }
+    friend bool operator!=(const TaskFunction& task, std::nullptr_t) noexcept { return static_cast<bool>(task); }
+
+private:
+    using Storage = std::aligned_storage_t<kInlineSize, alignof(std::max_align_t)>;
+
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* from, void* to) noexcept;   // Leaves `from` destroyed
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template<typename Stored>
+    static constexpr bool FitsInline() {
+        // Inline objects move on every queue hand-off, so the move must not throw
+        return sizeof(Stored) <= kInlineSize &&
+               alignof(Stored) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Stored>;
+    }
+
+    template<typename Stored>
+    struct InlineOps {
+        static void Invoke(void* storage) { (*static_cast<Stored*>(storage))(); }
+        static void Move(void* from, void* to) noexcept {
+            Stored* source = static_cast<Stored*>(from);
+            ::new (to) Stored(std::move(*source));
+            source->~Stored();
+        }
+        static void Destroy(void* storage) noexcept { static_cast<Stored*>(storage)->~Stored(); }
+        static constexpr Ops ops = {&Invoke, &Move, &Destroy};
+    };
+
+    template<typename Stored>
+    struct HeapOps {
+        static Stored*& Ptr(void* storage) { return *static_cast<Stored**>(storage); }
+        static void Invoke(void* storage) { (*Ptr(storage))(); }
+        static void Move(void* from, void* to) noexcept { *static_cast<Stored**>(to) = Ptr(from); }
+        static void Destroy(void* storage) noexcept { delete Ptr(storage); }
+        static constexpr Ops ops = {&Invoke, &Move, &Destroy};
+    };
+
+    void Reset() noexcept {
+        if (m_ops) {
+            m_ops->destroy(&m_storage);
+            m_ops = nullptr;
+        }
+    }
+
+    Storage m_storage;
+    const Ops* m_ops;
+};
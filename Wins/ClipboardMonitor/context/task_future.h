@@ -0,0 +1,296 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// One-shot promise/future pair for executor results.
+//
+// Lighter than std::promise/std::future: the shared state is intrusively
+// reference counted and recycled through a per-type free list, so in steady
+// state creating a pair does not allocate. Waiters only touch the mutex and
+// condition variable when the result is not ready yet. A promise destroyed
+// without a result reports std::future_errc::broken_promise, like
+// std::promise.
+
+namespace task_detail {
+
+template<typename T>
+class FutureState {
+public:
+    using Stored = std::conditional_t<std::is_void_v<T>, bool, T>;
+
+    // Get a state with one reference for the promise and one for the future
+    static FutureState* Acquire() {
+        FreeList& list = GetFreeList();
+        FutureState* state = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(list.mutex);
+            if (list.head) {
+                state = list.head;
+                list.head = state->m_next;
+                --list.count;
+            }
+        }
+        if (!state) {
+            state = new FutureState();
+        }
+        state->m_refs.store(2, std::memory_order_relaxed);
+        return state;
+    }
+
+    void Release() {
+        if (m_refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+
+        // Last reference: reset and recycle
+        m_value.reset();
+        m_exception = nullptr;
+        m_ready.store(false, std::memory_order_relaxed);
+
+        FreeList& list = GetFreeList();
+        {
+            std::lock_guard<std::mutex> lock(list.mutex);
+            if (list.count < kMaxPooled) {
+                m_next = list.head;
+                list.head = this;
+                ++list.count;
+                return;
+            }
+        }
+        delete this;
+    }
+
+    template<typename... Args>
+    void SetValue(Args&&... args) {
+        m_value.emplace(std::forward<Args>(args)...);
+        Publish();
+    }
+
+    void SetException(std::exception_ptr exception) {
+        m_exception = std::move(exception);
+        Publish();
+    }
+
+    bool IsReady() const { return m_ready.load(std::memory_order_acquire); }
+
+    void Wait() {
+        if (IsReady()) return;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return IsReady(); });
+    }
+
+    template<typename Rep, typename Period>
+    bool WaitFor(const std::chrono::duration<Rep, Period>& timeout) {
+        if (IsReady()) return true;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_condition.wait_for(lock, timeout, [this] { return IsReady(); });
+    }
+
+    // Caller has waited; rethrows a stored exception
+    T Take() {
+        if (m_exception) {
+            std::rethrow_exception(m_exception);
+        }
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*m_value);
+        }
+    }
+
+private:
+    // States kept for reuse per result type; the rest are freed
+    static constexpr size_t kMaxPooled = 256;
+
+    struct FreeList {
+        std::mutex mutex;
+        FutureState* head = nullptr;
+        size_t count = 0;
+    };
+
+    static FreeList& GetFreeList() {
+        // Never destroyed: executors owned by globals may release states
+        // during static destruction
+        static FreeList* list = new FreeList();
+        return *list;
+    }
+
+    FutureState() : m_refs(0), m_ready(false), m_next(nullptr) {}
+
+    void Publish() {
+        {
+            // Waiters check m_ready under the mutex, so no wakeup is lost
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_ready.store(true, std::memory_order_release);
+        }
+        m_condition.notify_all();
+    }
+
+    std::atomic<uint32_t> m_refs;
+    std::atomic<bool> m_ready;
+    std::optional<Stored> m_value;
+    std::exception_ptr m_exception;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    FutureState* m_next;   // Free list link
+};
+
+} // namespace task_detail
+
+template<typename T>
+class TaskFuture {
+public:
+    TaskFuture() : m_state(nullptr) {}
+    TaskFuture(TaskFuture&& other) noexcept : m_state(std::exchange(other.m_state, nullptr)) {}
+    TaskFuture& operator=(TaskFuture&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            m_state = std::exchange(other.m_state, nullptr);
+        }
+        return *this;
+    }
+    TaskFuture(const TaskFuture&) = delete;
+    TaskFuture& operator=(const TaskFuture&) = delete;
+    ~TaskFuture() { Reset(); }
+
+    bool valid() const { return m_state != nullptr; }
+
+    // Block until the result is set
+    void wait() const { CheckState()->Wait(); }
+
+    template<typename Rep, typename Period>
+    std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+        return CheckState()->WaitFor(timeout) ? std::future_status::ready : std::future_status::timeout;
+    }
+
+    // Wait and take the result; the future is invalid afterwards
+    T get() {
+        task_detail::FutureState<T>* state = CheckState();
+        state->Wait();
+        m_state = nullptr;
+
+        struct ReleaseOnExit {
+            task_detail::FutureState<T>* state;
+            ~ReleaseOnExit() { state->Release(); }
+        } release{state};
+        return state->Take();
+    }
+
+private:
+    template<typename> friend class TaskPromise;
+    explicit TaskFuture(task_detail::FutureState<T>* state) : m_state(state) {}
+
+    task_detail::FutureState<T>* CheckState() const {
+        if (!m_state) {
+            throw std::future_error(std::future_errc::no_state);
+        }
+        return m_state;
+    }
+
+    void Reset() {
+        if (m_state) {
+            m_state->Release();
+            m_state = nullptr;
+        }
+    }
+
+    task_detail::FutureState<T>* m_state;
+};
+
+template<typename T>
+class TaskPromise {
+public:
+    TaskPromise() : m_state(task_detail::FutureState<T>::Acquire()), m_futureRetrieved(false) {}
+    TaskPromise(TaskPromise&& other) noexcept
+        : m_state(std::exchange(other.m_state, nullptr))
+        , m_futureRetrieved(other.m_futureRetrieved) {}
+    TaskPromise& operator=(TaskPromise&& other) noexcept {
+        if (this != &other) {
+            Abandon();
+            m_state = std::exchange(other.m_state, nullptr);
+            m_futureRetrieved = other.m_futureRetrieved;
+        }
+        return *this;
+    }
+    TaskPromise(const TaskPromise&) = delete;
+    TaskPromise& operator=(const TaskPromise&) = delete;
+    ~TaskPromise() { Abandon(); }
+
+    // The future shares the promise's state; it may be retrieved once
+    TaskFuture<T> GetFuture() {
+        if (!m_state || m_futureRetrieved) {
+            throw std::future_error(std::future_errc::future_already_retrieved);
+        }
+        m_futureRetrieved = true;
+        return TaskFuture<T>(m_state);
+    }
+
+    template<typename... Args>
+    void SetValue(Args&&... args) {
+        Finish()->SetValue(std::forward<Args>(args)...);
+        Detach();
+    }
+
+    void SetException(std::exception_ptr exception) {
+        Finish()->SetException(std::move(exception));
+        Detach();
+    }
+
+    // Run func and store its result or exception
+    template<typename Func>
+    void SetFrom(Func& func) {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                func();
+                SetValue(true);
+            } else {
+                SetValue(func());
+            }
+        } catch (...) {
+            SetException(std::current_exception());
+        }
+    }
+
+private:
+    task_detail::FutureState<T>* Finish() {
+        if (!m_state) {
+            throw std::future_error(std::future_errc::promise_already_satisfied);
+        }
+        if (!m_futureRetrieved) {
+            // Nobody can observe the result; the future's reference is unclaimed
+            m_futureRetrieved = true;
+            m_state->Release();
+        }
+        return m_state;
+    }
+
+    void Detach() {
+        m_state->Release();
+        m_state = nullptr;
+    }
+
+    void Abandon() {
+        if (!m_state) {
+            return;
+        }
+        if (!m_futureRetrieved) {
+            // No future to report to; drop both references
+            m_state->Release();
+            Detach();
+            return;
+        }
+        Finish()->SetException(std::make_exception_ptr(
+            std::future_error(std::future_errc::broken_promise)));
+        Detach();
+    }
+
+    task_detail::FutureState<T>* m_state;
+    bool m_futureRetrieved;
+};
@@ -0,0 +1,172 @@
+#include "timer_queue.h"
+
+namespace {
+
+// Rebuild the heap when cancelled entries outnumber live ones by this much
+constexpr size_t kCompactSlack = 64;
+
+TimerQueue::TimerId MakeTimerId(uint32_t slot, uint32_t generation) {
+    return (static_cast<uint64_t>(generation) << 32) | slot;
+}
+
+} // namespace
+
+TimerQueue::TimerQueue() : m_armed(0), m_stop(false) {
+    m_thread = std::thread([this] { TimerThread(); });
+}
+
+TimerQueue::~TimerQueue() {
+    Shutdown();
+}
+
+TimerQueue::TimerId TimerQueue::Schedule(std::chrono::milliseconds delay, Callback callback) {
+    TimerId id;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop) {
+            return kInvalidTimer;
+        }
+
+        uint32_t slot = AcquireSlot();
+        Slot& entry = m_slots[slot];
+        entry.armed = true;
+        entry.callback = std::move(callback);
+        ++m_armed;
+
+        m_heap.push({Clock::now() + delay, slot, entry.generation});
+        id = MakeTimerId(slot, entry.generation);
+    }
+
+    // Wake the timer thread in case this is the new earliest deadline
+    m_condition.notify_one();
+    return id;
+}
+
+bool TimerQueue::Cancel(TimerId id) {
+    uint32_t slot = static_cast<uint32_t>(id);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+
+    Callback discarded;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (slot >= m_slots.size() || m_slots[slot].generation != generation || !m_slots[slot].armed) {
+            return false;  // Already fired, cancelled, or never existed
+        }
+
+        discarded = ReleaseSlot(slot);
+        if (m_heap.size() > m_armed * 2 + kCompactSlack) {
+            CompactHeap();
+        }
+    }
+
+    // Callback captures are destroyed outside the lock
+    return true;
+}
+
+void TimerQueue::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop) {
+            return;
+        }
+        m_stop = true;
+    }
+
+    m_condition.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_heap = decltype(m_heap)();
+    m_slots.clear();
+    m_freeSlots.clear();
+    m_armed = 0;
+}
+
+size_t TimerQueue::PendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_armed;
+}
+
+void TimerQueue::TimerThread() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (!m_stop) {
+        if (m_heap.empty()) {
+            m_condition.wait(lock);
+            continue;
+        }
+
+        HeapEntry top = m_heap.top();
+        if (!IsLive(top)) {
+            m_heap.pop();  // Cancelled
+            continue;
+        }
+
+        if (Clock::now() < top.deadline) {
+            m_condition.wait_until(lock, top.deadline);
+            continue;
+        }
+
+        m_heap.pop();
+        Callback callback = ReleaseSlot(top.slot);
+
+        // Fire outside the lock so callbacks may schedule or cancel timers
+        lock.unlock();
+        if (callback) {
+            try {
+                callback();
+            } catch (...) {
+                // A throwing callback must not take down the timer thread
+            }
+        }
+        callback = nullptr;
+        lock.lock();
+    }
+}
+
+uint32_t TimerQueue::AcquireSlot() {
+    if (!m_freeSlots.empty()) {
+        uint32_t slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return slot;
+    }
+
+    m_slots.emplace_back();
+    return static_cast<uint32_t>(m_slots.size() - 1);
+}
+
+TimerQueue::Callback TimerQueue::ReleaseSlot(uint32_t slot) {
+    Slot& entry = m_slots[slot];
+    Callback callback = std::move(entry.callback);
+    entry.callback = nullptr;
+    entry.armed = false;
+
+    // Skip 0 on wrap-around so a TimerId is never kInvalidTimer
+    if (++entry.generation == 0) {
+        entry.generation = 1;
+    }
+
+    m_freeSlots.push_back(slot);
+    --m_armed;
+    return callback;
+}
+
+bool TimerQueue::IsLive(const HeapEntry& entry) const {
+    const Slot& slot = m_slots[entry.slot];
+    return slot.armed && slot.generation == entry.generation;
+}
+
+void TimerQueue::CompactHeap() {
+    std::vector<HeapEntry> live;
+    live.reserve(m_armed);
+    while (!m_heap.empty()) {
+        if (IsLive(m_heap.top())) {
+            live.push_back(m_heap.top());
+        }
+        m_heap.pop();
+    }
+    m_heap = decltype(m_heap)(std::greater<HeapEntry>(), std::move(live));
+}
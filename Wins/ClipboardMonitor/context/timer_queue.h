@@ -0,0 +1,80 @@
+#pragma once
+
+#include <functional>
+#include <queue>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include "task_function.h"
+
+// Single-threaded timer service: a min-heap of deadlines served by one thread.
+// Timers are identified by (slot, generation), so cancel is O(1) and a stale
+// ID can never cancel a newer timer that reused the slot. Cancelled entries
+// are dropped lazily when they reach the top of the heap.
+class TimerQueue {
+public:
+    using TimerId = uint64_t;
+    using Callback = TaskFunction;   // Move-only captures allowed
+
+    static constexpr TimerId kInvalidTimer = 0;
+
+    TimerQueue();
+    ~TimerQueue();
+
+    // Disable copy
+    TimerQueue(const TimerQueue&) = delete;
+    TimerQueue& operator=(const TimerQueue&) = delete;
+
+    // Run callback on the timer thread after delay
+    // Returns kInvalidTimer if the queue has been shut down
+    TimerId Schedule(std::chrono::milliseconds delay, Callback callback);
+
+    // Cancel a pending timer
+    // Returns true if it was cancelled before firing
+    bool Cancel(TimerId id);
+
+    // Stop the timer thread; pending timers are discarded
+    void Shutdown();
+
+    // Number of armed (not yet fired or cancelled) timers
+    size_t PendingCount() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Slot {
+        uint32_t generation = 1;   // Bumped on release; never 0, so IDs are never kInvalidTimer
+        bool armed = false;
+        Callback callback;
+    };
+
+    struct HeapEntry {
+        Clock::time_point deadline;
+        uint32_t slot;
+        uint32_t generation;
+
+        bool operator>(const HeapEntry& other) const { return deadline > other.deadline; }
+    };
+
+    // Timer thread function
+    void TimerThread();
+
+    // Slot management (caller holds m_mutex)
+    uint32_t AcquireSlot();
+    Callback ReleaseSlot(uint32_t slot);
+    bool IsLive(const HeapEntry& entry) const;
+    void CompactHeap();
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> m_heap;
+    size_t m_armed;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+    bool m_stop;
+};
@@ -0,0 +1,186 @@
+#include "accessible_search.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Placement {
+    Outside,    // Misses the region: skipped with its subtree
+    Crossing,   // Overlaps the region, or has no bounds
+    Inside      // Wholly inside the region (or there is none)
+};
+
+bool IsEmptyRect(const AccessibleRect& rect) {
+    return rect.Width() <= 0 || rect.Height() <= 0;
+}
+
+bool Intersects(const AccessibleRect& a, const AccessibleRect& b) {
+    return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+bool Contains(const AccessibleRect& outer, const AccessibleRect& inner) {
+    return inner.left >= outer.left && inner.right <= outer.right &&
+           inner.top >= outer.top && inner.bottom <= outer.bottom;
+}
+
+class Search {
+public:
+    Search(const AccessibleSearchOptions& options, const CancellationToken& token,
+           AccessibleSearchStats& stats)
+        : m_options(options)
+        , m_token(token)
+        , m_stats(stats)
+        , m_deadline(Clock::now() + std::chrono::milliseconds(options.maxTimeMs))
+        , m_maxResults(std::max<size_t>(options.maxResults, 1)) {}
+
+    std::vector<AccessibleElementPtr> Run(IAccessibleElement& root) {
+        const AccessibleProperties& properties = root.GetProperties();
+        Placement placement = Place(properties);
+        if (placement == Placement::Outside) {
+            return {};
+        }
+
+        // Expand the root in place (it is borrowed, not shared)
+        Expand(root, placement);
+
+        while (!Done()) {
+            // Subtrees inside the region first: they can be pushed down whole
+            std::deque<AccessibleElementPtr>& queue = !m_inside.empty() ? m_inside : m_crossing;
+            if (queue.empty()) {
+                break;
+            }
+            if (OutOfBudget()) {
+                break;
+            }
+            AccessibleElementPtr element = std::move(queue.front());
+            queue.pop_front();
+            Expand(*element, &queue == &m_inside ? Placement::Inside : Placement::Crossing);
+        }
+        return std::move(m_results);
+    }
+
+private:
+    void Expand(IAccessibleElement& element, Placement placement) {
+        m_stats.calls++;
+
+        // Whole subtree in the region: let the provider evaluate the conditions.
+        // Without a region that subtree is the whole app, which the provider
+        // would search regardless of maxNodes, so walk it instead
+        if (placement == Placement::Inside && m_options.hasRegion && !m_options.query.IsEmpty()) {
+            std::vector<AccessibleElementPtr> found =
+                element.FindAll(AccessibleScope::Descendants, m_options.query, AccessibleCache::Properties);
+            for (AccessibleElementPtr& candidate : found) {
+                if (Done() || OutOfBudget()) {
+                    return;
+                }
+                m_stats.nodes++;
+                const AccessibleProperties& properties = candidate->GetProperties();
+                if (Place(properties) != Placement::Outside && Matches(properties)) {
+                    m_results.push_back(std::move(candidate));
+                }
+            }
+            return;
+        }
+
+        for (AccessibleElementPtr& child : element.GetChildren()) {
+            if (Done() || OutOfBudget()) {
+                return;
+            }
+            m_stats.nodes++;
+            const AccessibleProperties& properties = child->GetProperties();
+            Placement childPlacement = Place(properties);
+            if (childPlacement == Placement::Outside) {
+                continue;
+            }
+            if (m_options.query.Matches(properties) && Matches(properties)) {
+                m_results.push_back(child);
+            }
+            (childPlacement == Placement::Inside ? m_inside : m_crossing).push_back(std::move(child));
+        }
+    }
+
+    Placement Place(const AccessibleProperties& properties) const {
+        if (!m_options.hasRegion) {
+            return Placement::Inside;
+        }
+        if (IsEmptyRect(properties.rect)) {
+            return Placement::Crossing;
+        }
+        if (!Intersects(properties.rect, m_options.region)) {
+            return Placement::Outside;
+        }
+        return Contains(m_options.region, properties.rect) ? Placement::Inside : Placement::Crossing;
+    }
+
+    // Region (for elements with bounds) and client predicate; the query is
+    // checked by the provider or by the caller
+    bool Matches(const AccessibleProperties& properties) const {
+        if (m_options.hasRegion && IsEmptyRect(properties.rect)) {
+            return false;
+        }
+        return !m_options.predicate || m_options.predicate(properties);
+    }
+
+    bool Done() const {
+        return m_results.size() >= m_maxResults;
+    }
+
+    bool OutOfBudget() {
+        if (m_stats.nodes >= m_options.maxNodes || Clock::now() >= m_deadline || m_token.IsCancelled()) {
+            m_stats.exhausted = true;
+            return true;
+        }
+        return false;
+    }
+
+    const AccessibleSearchOptions& m_options;
+    const CancellationToken& m_token;
+    AccessibleSearchStats& m_stats;
+    Clock::time_point m_deadline;
+    size_t m_maxResults;
+
+    std::deque<AccessibleElementPtr> m_inside;     // To expand, wholly inside the region
+    std::deque<AccessibleElementPtr> m_crossing;   // To expand, overlapping it
+    std::vector<AccessibleElementPtr> m_results;
+};
+
+} // namespace
+
+std::vector<AccessibleElementPtr> AccessibleSearch::FindAll(IAccessibleElement& root,
+                                                           const AccessibleSearchOptions& options,
+                                                           const CancellationToken& token,
+                                                           AccessibleSearchStats* stats) {
+    AccessibleSearchStats local;
+    AccessibleSearchStats& out = stats ? *stats : local;
+    out = AccessibleSearchStats();
+    if (token.IsCancelled()) {
+        out.exhausted = true;
+        return {};
+    }
+    return Search(options, token, out).Run(root);
+}
+
+AccessibleElementPtr AccessibleSearch::FindFirst(IAccessibleElement& root,
+                                                 const AccessibleSearchOptions& options,
+                                                 const CancellationToken& token,
+                                                 AccessibleSearchStats* stats) {
+    AccessibleSearchOptions first = options;
+    first.maxResults = 1;
+    std::vector<AccessibleElementPtr> results = FindAll(root, first, token, stats);
+    return results.empty() ? nullptr : results.front();
+}
+
+AccessibleRect AccessibleSearch::BottomStrip(const AccessibleRect& window, long minHeight) {
+    AccessibleRect strip = window;
+    strip.top = std::max(window.top, window.bottom - std::max(minHeight, window.Height() / 16));
+    return strip;
+}
+
+AccessibleRect AccessibleSearch::TopStrip(const AccessibleRect& window, long minHeight) {
+    AccessibleRect strip = window;
+    strip.bottom = std::min(window.bottom, window.top + std::max(minHeight, window.Height() / 16));
+    return strip;
+}
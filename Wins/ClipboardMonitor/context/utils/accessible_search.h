@@ -0,0 +1,103 @@
+#pragma once
+
+#include "../cancellation_token.h"
+#include "accessible_tree.h"
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief What a budgeted tree search looks for, where, and how far it may go
+ */
+struct AccessibleSearchOptions {
+    AccessibleQuery query;      // Conditions (pushed down inside the region)
+
+    // Client-side test for what conditions cannot express (substrings,
+    // parsing); empty to accept every element matching the query
+    std::function<bool(const AccessibleProperties&)> predicate;
+
+    // Region of interest (screen coordinates): only elements intersecting it
+    // match, and subtrees outside it are skipped
+    bool hasRegion = false;
+    AccessibleRect region;
+
+    size_t maxNodes = 5000;     // Elements examined before giving up
+    int maxTimeMs = 200;        // Time before giving up
+    size_t maxResults = 1;      // Stop at this many matches
+};
+
+/**
+ * @brief What a search cost
+ */
+struct AccessibleSearchStats {
+    size_t nodes = 0;           // Elements examined
+    size_t calls = 0;           // Tree operations issued (GetChildren / FindAll)
+    bool exhausted = false;     // Stopped by a budget or cancellation, not by finishing
+};
+
+/**
+ * @brief Budgeted, early-terminating search over an accessibility tree
+ *
+ * Stops at the first maxResults matches, or when maxNodes elements have
+ * been examined or maxTimeMs has passed:
+ * - Subtrees whose bounds miss the region are not expanded
+ * - With a region, a subtree wholly inside it is handed to the provider as
+ *   one FindAll with the query's conditions, if it has any, instead of
+ *   being walked; the provider examines that whole subtree, so its cost is
+ *   bounded by the region, not by maxNodes
+ * - Otherwise (always without a region) one GetChildren per expanded
+ *   element, properties included, and the conditions are checked here; the
+ *   provider examines at most maxNodes elements plus the rest of the last
+ *   sibling list fetched
+ *
+ * Order: elements wholly inside the region are expanded before those
+ * crossing its edge, each kind breadth-first; a pushed-down subtree yields
+ * its matches in the provider's tree order. So without a region matches
+ * come shallowest first; with one the first match is not necessarily the
+ * shallowest.
+ *
+ * Elements without bounds (empty rect) are expanded but only match when
+ * there is no region. Free of Windows headers; runs on any backend.
+ */
+class AccessibleSearch {
+public:
+    /**
+     * @brief Find up to maxResults matching elements
+     *
+     * @param root Element to search under (not matched itself)
+     * @param options Query, predicate, region and budgets
+     * @param token Cancellation token of the fetch
+     * @param stats Output (optional): cost of the search
+     * @return Matches, in search order (see the class comment)
+     */
+    static std::vector<AccessibleElementPtr> FindAll(IAccessibleElement& root,
+                                                     const AccessibleSearchOptions& options,
+                                                     const CancellationToken& token,
+                                                     AccessibleSearchStats* stats = nullptr);
+
+    /**
+     * @brief Find the first matching element
+     *
+     * @return Element, or nullptr if none within the budgets
+     */
+    static AccessibleElementPtr FindFirst(IAccessibleElement& root,
+                                          const AccessibleSearchOptions& options,
+                                          const CancellationToken& token,
+                                          AccessibleSearchStats* stats = nullptr);
+
+    /**
+     * @brief Bottom strip of a window (status bars)
+     *
+     * @param window Window bounds
+     * @param minHeight Strip height in pixels; 1/16 of the window if taller
+     */
+    static AccessibleRect BottomStrip(const AccessibleRect& window, long minHeight);
+
+    /**
+     * @brief Top strip of a window (title bars, chat headers)
+     *
+     * @param window Window bounds
+     * @param minHeight Strip height in pixels; 1/16 of the window if taller
+     */
+    static AccessibleRect TopStrip(const AccessibleRect& window, long minHeight);
+};
@@ -0,0 +1,496 @@
+#include "accessible_tree.h"
+#include <cwctype>
+#include <utility>
+
+namespace {
+
+struct ControlTypeName {
+    int id;
+    const wchar_t* name;
+};
+
+// Every UIA control type, in id order (UIA_ButtonControlTypeId = 50000)
+const ControlTypeName kControlTypes[] = {
+    {50000, L"Button"}, {50001, L"Calendar"}, {50002, L"CheckBox"}, {50003, L"ComboBox"},
+    {50004, L"Edit"}, {50005, L"Hyperlink"}, {50006, L"Image"}, {50007, L"ListItem"},
+    {50008, L"List"}, {50009, L"Menu"}, {50010, L"MenuBar"}, {50011, L"MenuItem"},
+    {50012, L"ProgressBar"}, {50013, L"RadioButton"}, {50014, L"ScrollBar"}, {50015, L"Slider"},
+    {50016, L"Spinner"}, {50017, L"StatusBar"}, {50018, L"Tab"}, {50019, L"TabItem"},
+    {50020, L"Text"}, {50021, L"ToolBar"}, {50022, L"ToolTip"}, {50023, L"Tree"},
+    {50024, L"TreeItem"}, {50025, L"Custom"}, {50026, L"Group"}, {50027, L"Thumb"},
+    {50028, L"DataGrid"}, {50029, L"DataItem"}, {50030, L"Document"}, {50031, L"SplitButton"},
+    {50032, L"Window"}, {50033, L"Pane"}, {50034, L"Header"}, {50035, L"HeaderItem"},
+    {50036, L"Table"}, {50037, L"TitleBar"}, {50038, L"Separator"}, {50039, L"SemanticZoom"},
+    {50040, L"AppBar"},
+};
+
+std::wstring ToLowerAscii(const std::wstring& text) {
+    std::wstring result = text;
+    for (wchar_t& c : result) {
+        c = static_cast<wchar_t>(std::towlower(c));
+    }
+    return result;
+}
+
+// JsonReader keeps strings as UTF-8; the tree uses wide strings like the
+// rest of the app. Local conversions keep this unit free of Windows headers.
+std::wstring FromUtf8(const std::string& text) {
+    std::wstring result;
+    result.reserve(text.size());
+    for (size_t i = 0; i < text.size();) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        uint32_t code = 0xFFFD;
+        size_t length = 1;
+        if (c < 0x80) {
+            code = c;
+        } else if ((c & 0xE0) == 0xC0) {
+            length = 2;
+        } else if ((c & 0xF0) == 0xE0) {
+            length = 3;
+        } else if ((c & 0xF8) == 0xF0) {
+            length = 4;
+        }
+        if (length > 1) {
+            if (i + length > text.size()) {
+                length = text.size() - i;
+            } else {
+                code = c & (0x7F >> length);
+                for (size_t k = 1; k < length; ++k) {
+                    code = (code << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3F);
+                }
+            }
+        }
+        i += length;
+
+        if (code >= 0x10000 && sizeof(wchar_t) == 2) {
+            code -= 0x10000;
+            result += static_cast<wchar_t>(0xD800 + (code >> 10));
+            result += static_cast<wchar_t>(0xDC00 + (code & 0x3FF));
+        } else {
+            result += static_cast<wchar_t>(code);
+        }
+    }
+    return result;
+}
+
+void AppendUtf8(std::string& out, uint32_t code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+// Quoted JSON string from wide text
+void AppendJsonString(std::string& out, const std::wstring& text) {
+    out += '"';
+    for (size_t i = 0; i < text.size(); ++i) {
+        uint32_t code = static_cast<uint32_t>(text[i]);
+        if (code >= 0xD800 && code <= 0xDBFF && i + 1 < text.size()) {
+            uint32_t low = static_cast<uint32_t>(text[i + 1]);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                ++i;
+            }
+        }
+        switch (code) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (code < 0x20 || (code >= 0xD800 && code <= 0xDFFF)) {
+                    // Control characters; lone surrogates cannot be UTF-8
+                    char escape[8];
+                    static const char kHex[] = "0123456789abcdef";
+                    escape[0] = '\\';
+                    escape[1] = 'u';
+                    for (int k = 0; k < 4; ++k) {
+                        escape[2 + k] = kHex[(code >> (12 - 4 * k)) & 0xF];
+                    }
+                    out.append(escape, 6);
+                } else {
+                    AppendUtf8(out, code);
+                }
+                break;
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+namespace AccessibleControlType {
+
+int FromName(const std::wstring& name) {
+    std::wstring lower = ToLowerAscii(name);
+    for (const ControlTypeName& type : kControlTypes) {
+        if (ToLowerAscii(type.name) == lower) {
+            return type.id;
+        }
+    }
+    return 0;
+}
+
+std::wstring ToName(int controlType) {
+    for (const ControlTypeName& type : kControlTypes) {
+        if (type.id == controlType) {
+            return type.name;
+        }
+    }
+    return std::to_wstring(controlType);
+}
+
+} // namespace AccessibleControlType
+
+bool AccessibleQuery::Matches(const AccessibleProperties& properties) const {
+    return (controlType == 0 || properties.controlType == controlType) &&
+           (automationId.empty() || properties.automationId == automationId) &&
+           (name.empty() || properties.name == name);
+}
+
+// ============================================================================
+// In-memory tree
+// ============================================================================
+
+struct AccessibleSnapshot::Data {
+    struct Node {
+        AccessibleProperties properties;
+        std::wstring value;
+        int parent = -1;
+        std::vector<int> children;
+    };
+
+    std::vector<Node> nodes;
+    std::string app;
+    uint64_t calls = 0;
+    uint64_t visits = 0;
+};
+
+class AccessibleSnapshot::Element : public IAccessibleElement {
+public:
+    Element(std::shared_ptr<Data> data, int index, AccessibleCache cache)
+        : m_data(std::move(data))
+        , m_index(index)
+        , m_bound(cache != AccessibleCache::None)
+        , m_childrenCached(cache == AccessibleCache::Children) {}
+
+    const AccessibleProperties& GetProperties() override {
+        if (!m_bound) {
+            m_bound = true;
+            m_data->calls++;
+            m_data->visits++;
+        }
+        return Node().properties;
+    }
+
+    std::wstring GetValue() override {
+        m_data->calls++;
+        m_data->visits++;
+        return Node().value.empty() ? Node().properties.name : Node().value;
+    }
+
+    std::vector<AccessibleElementPtr> GetChildren() override {
+        if (!m_childrenCached) {
+            m_data->calls++;
+            m_data->visits += Node().children.size();
+        }
+        std::vector<AccessibleElementPtr> children;
+        children.reserve(Node().children.size());
+        for (int child : Node().children) {
+            children.push_back(std::make_shared<Element>(m_data, child, AccessibleCache::Properties));
+        }
+        return children;
+    }
+
+    AccessibleElementPtr GetParent() override {
+        m_data->calls++;
+        m_data->visits++;
+        if (Node().parent < 0) {
+            return nullptr;
+        }
+        return std::make_shared<Element>(m_data, Node().parent, AccessibleCache::Properties);
+    }
+
+    std::vector<int> GetRuntimeId() override {
+        return {m_index};
+    }
+
+    std::vector<AccessibleElementPtr> FindAll(AccessibleScope scope, const AccessibleQuery& query,
+                                              AccessibleCache cache) override {
+        m_data->calls++;
+        std::vector<AccessibleElementPtr> results;
+        Visit(scope, [&](int index) {
+            if (query.Matches(m_data->nodes[index].properties)) {
+                results.push_back(Fetch(index, cache));
+            }
+            return true;
+        });
+        return results;
+    }
+
+    AccessibleElementPtr FindFirst(AccessibleScope scope, const AccessibleQuery& query,
+                                   AccessibleCache cache) override {
+        m_data->calls++;
+        AccessibleElementPtr result;
+        Visit(scope, [&](int index) {
+            if (query.Matches(m_data->nodes[index].properties)) {
+                result = Fetch(index, cache);
+                return false;
+            }
+            return true;
+        });
+        return result;
+    }
+
+private:
+    const Data::Node& Node() const { return m_data->nodes[m_index]; }
+
+    // Handle to a search result; cached children are examined with it
+    AccessibleElementPtr Fetch(int index, AccessibleCache cache) const {
+        if (cache == AccessibleCache::Children) {
+            m_data->visits += m_data->nodes[index].children.size();
+        }
+        return std::make_shared<Element>(m_data, index, cache);
+    }
+
+    // Elements in scope, in tree (pre-)order, until visit returns false
+    template <typename Visitor>
+    void Visit(AccessibleScope scope, Visitor visit) const {
+        if (scope == AccessibleScope::Children) {
+            for (int child : Node().children) {
+                m_data->visits++;
+                if (!visit(child)) {
+                    return;
+                }
+            }
+            return;
+        }
+
+        std::vector<int> stack(Node().children.rbegin(), Node().children.rend());
+        while (!stack.empty()) {
+            int index = stack.back();
+            stack.pop_back();
+            m_data->visits++;
+            if (!visit(index)) {
+                return;
+            }
+            const std::vector<int>& children = m_data->nodes[index].children;
+            stack.insert(stack.end(), children.rbegin(), children.rend());
+        }
+    }
+
+    std::shared_ptr<Data> m_data;
+    int m_index;
+    bool m_bound;             // Properties already fetched
+    bool m_childrenCached;    // Children came with this element
+};
+
+AccessibleSnapshot::AccessibleSnapshot()
+    : m_data(std::make_shared<Data>()) {}
+
+namespace {
+
+// Depth of the node being parsed is bounded by JsonReader::kMaxDepth
+bool ReadNode(const JsonValue& value, int parent, AccessibleSnapshot& snapshot,
+              std::string& error) {
+    if (!value.IsObject()) {
+        error = "node is not an object";
+        return false;
+    }
+
+    AccessibleProperties properties;
+    properties.name = FromUtf8(value.GetString("name"));
+    properties.automationId = FromUtf8(value.GetString("id"));
+    if (const JsonValue* type = value.Find("type")) {
+        // Name ("Text") as recorded, or a raw id for types newer than the table
+        properties.controlType = type->IsString()
+            ? AccessibleControlType::FromName(FromUtf8(type->AsString()))
+            : type->AsInt();
+        if (properties.controlType == 0) {
+            error = "unknown control type: " + type->AsString();
+            return false;
+        }
+    }
+
+    if (const JsonValue* rect = value.Find("rect")) {
+        const std::vector<JsonValue>& edges = rect->GetArray();
+        if (edges.size() != 4) {
+            error = "rect needs [left, top, right, bottom]";
+            return false;
+        }
+        properties.rect.left = static_cast<long>(edges[0].AsNumber());
+        properties.rect.top = static_cast<long>(edges[1].AsNumber());
+        properties.rect.right = static_cast<long>(edges[2].AsNumber());
+        properties.rect.bottom = static_cast<long>(edges[3].AsNumber());
+    }
+
+    int index = snapshot.AddNode(parent, properties, FromUtf8(value.GetString("value")));
+    if (const JsonValue* children = value.Find("children")) {
+        for (const JsonValue& child : children->GetArray()) {
+            if (!ReadNode(child, index, snapshot, error)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void WriteNode(IAccessibleElement& element, size_t maxNodes, size_t& written, std::string& out) {
+    const AccessibleProperties& properties = element.GetProperties();
+    written++;
+
+    // Type by name; types newer than the table by id, as ReadNode takes them
+    out += "{";
+    std::wstring typeName = AccessibleControlType::ToName(properties.controlType);
+    if (AccessibleControlType::FromName(typeName) != 0) {
+        out += "\"type\":";
+        AppendJsonString(out, typeName);
+        out += ",";
+    } else if (properties.controlType != 0) {
+        out += "\"type\":" + std::to_string(properties.controlType) + ",";
+    }
+    out += "\"rect\":[" + std::to_string(properties.rect.left) + "," +
+           std::to_string(properties.rect.top) + "," + std::to_string(properties.rect.right) +
+           "," + std::to_string(properties.rect.bottom) + "]";
+    if (!properties.name.empty()) {
+        out += ",\"name\":";
+        AppendJsonString(out, properties.name);
+    }
+    if (!properties.automationId.empty()) {
+        out += ",\"id\":";
+        AppendJsonString(out, properties.automationId);
+    }
+    if (properties.controlType == AccessibleControlType::Edit ||
+        properties.controlType == AccessibleControlType::ComboBox) {
+        std::wstring value = element.GetValue();
+        if (!value.empty() && value != properties.name) {
+            out += ",\"value\":";
+            AppendJsonString(out, value);
+        }
+    }
+
+    if (written < maxNodes) {
+        std::vector<AccessibleElementPtr> children = element.GetChildren();
+        if (!children.empty()) {
+            out += ",\"children\":[";
+            bool first = true;
+            for (const AccessibleElementPtr& child : children) {
+                if (written >= maxNodes) {
+                    break;
+                }
+                if (!first) {
+                    out += ",\n";
+                }
+                first = false;
+                WriteNode(*child, maxNodes, written, out);
+            }
+            out += "]";
+        }
+    }
+    out += "}";
+}
+
+} // namespace
+
+bool AccessibleSnapshot::Load(const std::string& text, AccessibleSnapshot& snapshot,
+                              std::string* error) {
+    JsonValue document;
+    if (!JsonReader::Parse(text, document, error)) {
+        return false;
+    }
+
+    const JsonValue* root = document.Find("root");
+    if (!root) {
+        if (error) {
+            *error = "missing \"root\"";
+        }
+        return false;
+    }
+
+    AccessibleSnapshot loaded;
+    loaded.m_data->app = document.GetString("app");
+    std::string nodeError;
+    if (!ReadNode(*root, -1, loaded, nodeError)) {
+        if (error) {
+            *error = nodeError;
+        }
+        return false;
+    }
+
+    snapshot = std::move(loaded);
+    return true;
+}
+
+std::string AccessibleSnapshot::Record(IAccessibleElement& root, const std::string& app,
+                                       size_t maxNodes) {
+    std::string out = "{\"version\":1,\"app\":";
+    AppendJsonString(out, FromUtf8(app));
+    out += ",\"title\":";
+    AppendJsonString(out, root.GetProperties().name);
+    out += ",\n\"root\":";
+
+    size_t written = 0;
+    WriteNode(root, maxNodes == 0 ? 1 : maxNodes, written, out);
+    out += "}\n";
+    return out;
+}
+
+int AccessibleSnapshot::AddNode(int parent, const AccessibleProperties& properties,
+                                const std::wstring& value) {
+    if (parent < 0) {
+        m_data->nodes.clear();
+    }
+
+    Data::Node node;
+    node.properties = properties;
+    node.value = value;
+    m_data->nodes.push_back(std::move(node));
+
+    int index = static_cast<int>(m_data->nodes.size() - 1);
+    if (parent >= 0 && parent < index) {
+        m_data->nodes[parent].children.push_back(index);
+        m_data->nodes[index].parent = parent;
+    }
+    return index;
+}
+
+AccessibleElementPtr AccessibleSnapshot::GetRoot() const {
+    if (m_data->nodes.empty()) {
+        return nullptr;
+    }
+    // Like UIAutomationHelper::GetWindowElement: the root comes with its properties
+    return std::make_shared<Element>(m_data, 0, AccessibleCache::Properties);
+}
+
+size_t AccessibleSnapshot::GetNodeCount() const {
+    return m_data->nodes.size();
+}
+
+const std::string& AccessibleSnapshot::GetApp() const {
+    return m_data->app;
+}
+
+uint64_t AccessibleSnapshot::GetCallCount() const {
+    return m_data->calls;
+}
+
+uint64_t AccessibleSnapshot::GetVisitCount() const {
+    return m_data->visits;
+}
+
+void AccessibleSnapshot::ResetCallCount() {
+    m_data->calls = 0;
+    m_data->visits = 0;
+}
@@ -0,0 +1,273 @@
+#pragma once
+
+#include "json_reader.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Screen rectangle of an element (physical pixels)
+ */
+struct AccessibleRect {
+    long left = 0;
+    long top = 0;
+    long right = 0;
+    long bottom = 0;
+
+    long Width() const { return right - left; }
+    long Height() const { return bottom - top; }
+};
+
+/**
+ * @brief Properties bound together for each element
+ *
+ * Read once per element (one provider call, or none when the element came
+ * from a batched search); adapters never query properties one by one.
+ */
+struct AccessibleProperties {
+    std::wstring name;
+    std::wstring automationId;
+    int controlType = 0;      // UI Automation control type id (see AccessibleControlType)
+    AccessibleRect rect;
+};
+
+/**
+ * @brief UI Automation control type ids, usable without Windows headers
+ *
+ * Same values as UIA_*ControlTypeId.
+ */
+namespace AccessibleControlType {
+constexpr int Button = 50000;
+constexpr int ComboBox = 50003;
+constexpr int Edit = 50004;
+constexpr int Hyperlink = 50005;
+constexpr int ListItem = 50007;
+constexpr int List = 50008;
+constexpr int StatusBar = 50017;
+constexpr int Text = 50020;
+constexpr int ToolBar = 50021;
+constexpr int Tree = 50023;
+constexpr int TreeItem = 50024;
+constexpr int Group = 50026;
+constexpr int Document = 50030;
+constexpr int Window = 50032;
+constexpr int Pane = 50033;
+
+/**
+ * @brief Control type id from its name ("Edit", "button", ...)
+ *
+ * @return Id, or 0 if unknown
+ */
+int FromName(const std::wstring& name);
+
+/**
+ * @brief Control type name ("Edit") from its id
+ *
+ * @return Name, or the id in decimal if unknown
+ */
+std::wstring ToName(int controlType);
+} // namespace AccessibleControlType
+
+/**
+ * @brief Where a search looks, relative to the element it starts from
+ */
+enum class AccessibleScope {
+    Children,
+    Descendants
+};
+
+/**
+ * @brief What a search fetches along with the elements it returns
+ *
+ * UI Automation cache requests: one cross-process call returns the
+ * elements and these, instead of one call per property read afterwards.
+ */
+enum class AccessibleCache {
+    None,           // Properties are read per element on first use
+    Properties,     // Properties of every result
+    Children        // Properties, plus each result's children with theirs
+};
+
+/**
+ * @brief Conditions a backend evaluates itself (UIA property conditions)
+ *
+ * Unset fields match anything; set fields must match exactly.
+ */
+struct AccessibleQuery {
+    int controlType = 0;
+    std::wstring automationId;
+    std::wstring name;
+
+    bool IsEmpty() const { return controlType == 0 && automationId.empty() && name.empty(); }
+    bool Matches(const AccessibleProperties& properties) const;
+};
+
+class IAccessibleElement;
+using AccessibleElementPtr = std::shared_ptr<IAccessibleElement>;
+
+/**
+ * @brief One element of an accessibility tree
+ *
+ * The narrow surface the adapters' element scans need: find, children,
+ * parent, identity, properties (including the bounding rectangle) and value. Backends: UI
+ * Automation (UIAutomationHelper::GetWindowElement) and in-memory trees
+ * (AccessibleSnapshot), so scans can be profiled and regression-tested
+ * off Windows against recorded or synthetic windows.
+ *
+ * Elements of one tree are used from one thread at a time.
+ */
+class IAccessibleElement {
+public:
+    virtual ~IAccessibleElement() = default;
+
+    /**
+     * @brief Get the element's properties
+     *
+     * Free when the element came from a search with AccessibleCache
+     * Properties or Children (or from GetChildren); else one call on first use.
+     */
+    virtual const AccessibleProperties& GetProperties() = 0;
+
+    /**
+     * @brief Get the element's value (edit controls), else its name
+     */
+    virtual std::wstring GetValue() = 0;
+
+    /**
+     * @brief Get the direct children with their properties, in order
+     *
+     * Free when this element came from a search with AccessibleCache::Children;
+     * else one call.
+     */
+    virtual std::vector<AccessibleElementPtr> GetChildren() = 0;
+
+    /**
+     * @brief Get the parent with its properties (one call)
+     *
+     * @return Parent, or nullptr at the top of the tree
+     */
+    virtual AccessibleElementPtr GetParent() = 0;
+
+    /**
+     * @brief Get the element's identity (free)
+     *
+     * Equal for two handles of the same element while it exists (UI
+     * Automation runtime ID); compare only within one tree.
+     */
+    virtual std::vector<int> GetRuntimeId() = 0;
+
+    /**
+     * @brief Find every element in scope matching a query, in tree order
+     *
+     * @param scope Children or descendants of this element
+     * @param query Provider-side conditions
+     * @param cache What to fetch along with the results (one call in all cases)
+     */
+    virtual std::vector<AccessibleElementPtr> FindAll(AccessibleScope scope,
+                                                      const AccessibleQuery& query,
+                                                      AccessibleCache cache) = 0;
+
+    /**
+     * @brief Find the first element in scope matching a query
+     *
+     * @return Element, or nullptr if none
+     */
+    virtual AccessibleElementPtr FindFirst(AccessibleScope scope, const AccessibleQuery& query,
+                                           AccessibleCache cache) = 0;
+};
+
+/**
+ * @brief In-memory accessibility tree
+ *
+ * Loaded from a recorded snapshot (JSON, see Record) or built node by node
+ * (synthetic trees). Counts the calls a UI Automation provider would have
+ * served for the same operations, so scans can be compared by round trips
+ * as well as by time:
+ * - FindAll / FindFirst / GetValue: one call each
+ * - GetChildren: one call, none if the children came with the element
+ * - GetParent: one call; GetRuntimeId (the node index): none
+ * - GetProperties: one call the first time per element handle, none if
+ *   the properties came with it (AccessibleCache)
+ * It also counts the elements the provider had to examine for them (a
+ * Descendants search walks the subtree), the cost a call count hides.
+ *
+ * Snapshot format:
+ *   { "version": 1, "app": "wechat", "title": "...",
+ *     "root": { "type": "Window", "name": "...", "id": "...",
+ *               "rect": [left, top, right, bottom], "value": "...",
+ *               "children": [ ... ] } }
+ * "type" is the control type name, or its id for types newer than
+ * AccessibleControlType's table; strings are UTF-8.
+ */
+class AccessibleSnapshot {
+public:
+    AccessibleSnapshot();
+
+    /**
+     * @brief Parse a snapshot document
+     *
+     * @param text JSON text
+     * @param snapshot Output: the tree (replaced)
+     * @param error Output (optional): what went wrong
+     * @return true if the document holds a valid tree
+     */
+    static bool Load(const std::string& text, AccessibleSnapshot& snapshot,
+                     std::string* error = nullptr);
+
+    /**
+     * @brief Serialize a tree from any backend
+     *
+     * Depth-first from root; stops descending after maxNodes elements.
+     *
+     * @param root Root element (e.g. a window from the UIA backend)
+     * @param app App tag stored in the document (e.g. "wechat")
+     * @param maxNodes Node limit
+     * @return Snapshot document (UTF-8 JSON)
+     */
+    static std::string Record(IAccessibleElement& root, const std::string& app,
+                              size_t maxNodes = 50000);
+
+    /**
+     * @brief Add a node (synthetic trees)
+     *
+     * @param parent Parent node index, or -1 for the root (replaces the tree)
+     * @param properties Node properties
+     * @param value Value pattern text (edit controls)
+     * @return Index of the new node
+     */
+    int AddNode(int parent, const AccessibleProperties& properties,
+                const std::wstring& value = std::wstring());
+
+    /**
+     * @brief Get a handle to the root element
+     *
+     * @return Root, or nullptr for an empty tree
+     */
+    AccessibleElementPtr GetRoot() const;
+
+    size_t GetNodeCount() const;
+    const std::string& GetApp() const;
+
+    /**
+     * @brief Provider calls served since the last reset
+     */
+    uint64_t GetCallCount() const;
+
+    /**
+     * @brief Elements the provider examined since the last reset
+     */
+    uint64_t GetVisitCount() const;
+
+    /**
+     * @brief Reset the call and visit counts
+     */
+    void ResetCallCount();
+
+private:
+    struct Data;
+    class Element;
+
+    std::shared_ptr<Data> m_data;
+};
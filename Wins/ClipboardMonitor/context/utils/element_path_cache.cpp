@@ -0,0 +1,169 @@
+#include "element_path_cache.h"
+#include <algorithm>
+
+namespace {
+
+// Deeper than any window the adapters read; guards against parent cycles
+constexpr size_t kMaxDepth = 64;
+
+} // namespace
+
+ElementPathCache::ElementPathCache(size_t capacity)
+    : m_capacity(std::max<size_t>(capacity, 1))
+    , m_clock(0)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+AccessibleElementPtr ElementPathCache::Find(IAccessibleElement& window, uint64_t windowKey,
+                                            const std::string& lookup, const Validator& validate,
+                                            const Search& search, const CancellationToken& token) {
+    if (token.IsCancelled()) {
+        return nullptr;
+    }
+
+    Key key(windowKey, lookup);
+    Entry entry;
+    bool known = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            entry = it->second;
+            known = true;
+        }
+    }
+
+    // Remembered path: still the same kind of element, and still what the caller wants?
+    if (known) {
+        AccessibleElementPtr element = Resolve(window, entry.path, token);
+        if (element) {
+            const AccessibleProperties& properties = element->GetProperties();
+            if (properties.controlType == entry.controlType &&
+                properties.automationId == entry.automationId &&
+                (!validate || validate(properties))) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_hits++;
+                auto it = m_entries.find(key);
+                if (it != m_entries.end()) {
+                    it->second.lastUse = ++m_clock;
+                }
+                return element;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_misses++;
+    }
+
+    AccessibleElementPtr element = search();
+    std::vector<int> path;
+    if (element && !token.IsCancelled() && PathOf(window, element, path, token)) {
+        Entry found;
+        found.path = std::move(path);
+        found.controlType = element->GetProperties().controlType;
+        found.automationId = element->GetProperties().automationId;
+        Store(key, std::move(found));
+    } else if (known) {
+        // Stale and nothing to replace it with
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.erase(key);
+    }
+    return element;
+}
+
+void ElementPathCache::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+size_t ElementPathCache::GetSize() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+uint64_t ElementPathCache::GetHitCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+uint64_t ElementPathCache::GetMissCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
+AccessibleElementPtr ElementPathCache::Resolve(IAccessibleElement& window, const std::vector<int>& path,
+                                               const CancellationToken& token) {
+    AccessibleElementPtr current;
+    IAccessibleElement* node = &window;
+    for (size_t depth = 0; depth < path.size(); depth++) {
+        if (token.IsCancelled()) {
+            return nullptr;
+        }
+
+        // Fetch children with their children: every other level is free
+        std::vector<AccessibleElementPtr> children = depth % 2 == 0
+            ? node->FindAll(AccessibleScope::Children, AccessibleQuery(), AccessibleCache::Children)
+            : node->GetChildren();
+        if (path[depth] < 0 || static_cast<size_t>(path[depth]) >= children.size()) {
+            return nullptr;
+        }
+        current = children[path[depth]];
+        node = current.get();
+    }
+    return current;
+}
+
+bool ElementPathCache::PathOf(IAccessibleElement& window, AccessibleElementPtr element,
+                              std::vector<int>& path, const CancellationToken& token) {
+    path.clear();
+    std::vector<int> rootId = window.GetRuntimeId();
+    if (rootId.empty()) {
+        return false;
+    }
+
+    std::vector<int> id = element->GetRuntimeId();
+    while (id != rootId) {
+        if (id.empty() || path.size() >= kMaxDepth || token.IsCancelled()) {
+            return false;
+        }
+
+        AccessibleElementPtr parent = element->GetParent();
+        if (!parent) {
+            return false;   // Reached the top without passing the window
+        }
+
+        std::vector<AccessibleElementPtr> siblings = parent->GetChildren();
+        auto it = std::find_if(siblings.begin(), siblings.end(), [&id](const AccessibleElementPtr& sibling) {
+            return sibling->GetRuntimeId() == id;
+        });
+        if (it == siblings.end()) {
+            return false;
+        }
+
+        path.push_back(static_cast<int>(it - siblings.begin()));
+        element = std::move(parent);
+        id = element->GetRuntimeId();
+    }
+
+    std::reverse(path.begin(), path.end());
+    return !path.empty();
+}
+
+void ElementPathCache::Store(const Key& key, Entry entry) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    entry.lastUse = ++m_clock;
+    m_entries[key] = std::move(entry);
+
+    // Drop the least recently used beyond capacity
+    while (m_entries.size() > m_capacity) {
+        auto oldest = std::min_element(m_entries.begin(), m_entries.end(),
+                                       [](const auto& a, const auto& b) {
+                                           return a.second.lastUse < b.second.lastUse;
+                                       });
+        m_entries.erase(oldest);
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "../cancellation_token.h"
+#include "accessible_tree.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Remembered element locations, per (window, lookup)
+ *
+ * The element holding a chat title, message list or status item usually
+ * sits at the same place in a window's tree from copy to copy. After a
+ * successful search the cache stores the element's child-index path from
+ * the window root, with its control type and Automation ID; the next lookup
+ * walks the path (about one call per two levels), checks those and the
+ * caller's validator on the element's properties, and only searches again
+ * when something no longer fits.
+ *
+ * A hit costs about as many calls as the path has levels / 2, so it pays
+ * where the search makes the provider walk the window (the WeChat message
+ * list), not where a budgeted strip search takes a call or two.
+ *
+ * Paths are data, not element handles, so one process-wide cache serves
+ * every worker thread (UIAutomationHelper::GetPathCache). Least recently
+ * used entries are dropped beyond the capacity; a window key reused by a
+ * new window just fails validation once.
+ *
+ * Thread Safety:
+ * - All methods lock; tree calls run outside the lock
+ */
+class ElementPathCache {
+public:
+    using Validator = std::function<bool(const AccessibleProperties&)>;
+    using Search = std::function<AccessibleElementPtr()>;
+
+    /**
+     * @brief Constructor
+     *
+     * @param capacity Maximum number of (window, lookup) entries
+     */
+    explicit ElementPathCache(size_t capacity = 256);
+
+    // Disable copy
+    ElementPathCache(const ElementPathCache&) = delete;
+    ElementPathCache& operator=(const ElementPathCache&) = delete;
+
+    /**
+     * @brief Find an element through its remembered path, else by searching
+     *
+     * @param window Window root (the element paths start from)
+     * @param windowKey Window identity (the HWND value)
+     * @param lookup What is looked up (e.g. "wechat.message_list")
+     * @param validate Check of the element's current properties (optional)
+     * @param search Full search, run on a miss; its result is remembered
+     * @param token Cancellation token of the fetch
+     * @return Element, or nullptr if neither the path nor the search found one
+     */
+    AccessibleElementPtr Find(IAccessibleElement& window, uint64_t windowKey, const std::string& lookup,
+                              const Validator& validate, const Search& search,
+                              const CancellationToken& token);
+
+    /**
+     * @brief Drop every entry
+     */
+    void Clear();
+
+    /**
+     * @brief Get the number of entries
+     */
+    size_t GetSize() const;
+
+    /**
+     * @brief Get the lookups served by a remembered path
+     */
+    uint64_t GetHitCount() const;
+
+    /**
+     * @brief Get the lookups that had to search
+     */
+    uint64_t GetMissCount() const;
+
+private:
+    struct Entry {
+        std::vector<int> path;      // Child indices from the window root
+        int controlType = 0;
+        std::wstring automationId;
+        uint64_t lastUse = 0;
+    };
+
+    using Key = std::pair<uint64_t, std::string>;
+
+    // Element at path, or nullptr if the tree no longer has one there
+    static AccessibleElementPtr Resolve(IAccessibleElement& window, const std::vector<int>& path,
+                                        const CancellationToken& token);
+
+    // Path of element from window (two calls per level); false if not under it
+    static bool PathOf(IAccessibleElement& window, AccessibleElementPtr element,
+                       std::vector<int>& path, const CancellationToken& token);
+
+    void Store(const Key& key, Entry entry);
+
+    mutable std::mutex m_mutex;
+    std::map<Key, Entry> m_entries;
+    size_t m_capacity;
+    uint64_t m_clock;
+    uint64_t m_hits;
+    uint64_t m_misses;
+};
+
+/**
+ * @brief One window's view of a path cache, as the element scans take it
+ *
+ * Default-constructed (no cache), Find always searches.
+ */
+struct ElementPathScope {
+    ElementPathCache* cache = nullptr;
+    uint64_t window = 0;        // Window key (the HWND value)
+
+    /**
+     * @brief ElementPathCache::Find for this window, or just search without a cache
+     */
+    AccessibleElementPtr Find(IAccessibleElement& root, const std::string& lookup,
+                              const ElementPathCache::Validator& validate,
+                              const ElementPathCache::Search& search,
+                              const CancellationToken& token) const {
+        return cache ? cache->Find(root, window, lookup, validate, search, token) : search();
+    }
+};
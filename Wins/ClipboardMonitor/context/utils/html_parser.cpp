@@ -41,7 +41,7 @@ bool HTMLParser::ParseCFHTML(const std::string& cfHtmlData, HTMLClipboardData& o
         if (line.find("SourceURL:") == 0) {
             std::string url = ExtractValue(line, "SourceURL:");
             output.sourceUrl = Utils::Utf8ToWide(url);
-            DEBUG_LOG("HTMLParser: Found SourceURL: " + url);
+            LOG_DEBUG("HTMLParser: Found SourceURL: {}", url);
         }
         else if (line.find("StartHTML:") == 0) {
             output.startHTML = ExtractIntValue(line, "StartHTML:");
@@ -0,0 +1,357 @@
+#include "json_reader.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+
+const std::string kEmptyString;
+const std::vector<JsonValue> kEmptyArray;
+const std::vector<JsonValue::Member> kEmptyMembers;
+
+void AppendUtf8(std::string& out, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+} // namespace
+
+bool JsonValue::AsBool(bool fallback) const {
+    return m_type == Type::Bool ? m_bool : fallback;
+}
+
+double JsonValue::AsNumber(double fallback) const {
+    return m_type == Type::Number ? m_number : fallback;
+}
+
+int JsonValue::AsInt(int fallback) const {
+    return m_type == Type::Number ? static_cast<int>(std::lround(m_number)) : fallback;
+}
+
+const std::string& JsonValue::AsString() const {
+    return m_type == Type::String ? m_string : kEmptyString;
+}
+
+const std::vector<JsonValue>& JsonValue::GetArray() const {
+    return m_type == Type::Array ? m_array : kEmptyArray;
+}
+
+const std::vector<JsonValue::Member>& JsonValue::GetMembers() const {
+    return m_type == Type::Object ? m_members : kEmptyMembers;
+}
+
+const JsonValue* JsonValue::Find(const std::string& key) const {
+    for (const auto& member : GetMembers()) {
+        if (member.first == key) {
+            return &member.second;
+        }
+    }
+    return nullptr;
+}
+
+std::string JsonValue::GetString(const std::string& key, const std::string& fallback) const {
+    const JsonValue* value = Find(key);
+    return value && value->IsString() ? value->m_string : fallback;
+}
+
+double JsonValue::GetNumber(const std::string& key, double fallback) const {
+    const JsonValue* value = Find(key);
+    return value ? value->AsNumber(fallback) : fallback;
+}
+
+// Recursive descent over the text; stops at the first error
+class JsonReader::Parser {
+public:
+    explicit Parser(const std::string& text) : m_text(text), m_pos(0) {
+        // Skip a UTF-8 BOM (Notepad writes one)
+        if (m_text.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+            m_pos = 3;
+        }
+    }
+
+    bool ParseDocument(JsonValue& root) {
+        if (!ParseValue(root, 0)) {
+            return false;
+        }
+        SkipWhitespace();
+        if (m_pos != m_text.size()) {
+            return Fail("trailing characters");
+        }
+        return true;
+    }
+
+    const std::string& GetError() const { return m_error; }
+
+private:
+    bool ParseValue(JsonValue& value, int depth) {
+        if (depth > kMaxDepth) {
+            return Fail("nesting too deep");
+        }
+
+        SkipWhitespace();
+        if (m_pos >= m_text.size()) {
+            return Fail("unexpected end of input");
+        }
+
+        switch (m_text[m_pos]) {
+            case '{':
+                return ParseObject(value, depth);
+            case '[':
+                return ParseArray(value, depth);
+            case '"':
+                value.m_type = JsonValue::Type::String;
+                return ParseString(value.m_string);
+            case 't':
+                value.m_type = JsonValue::Type::Bool;
+                value.m_bool = true;
+                return Expect("true");
+            case 'f':
+                value.m_type = JsonValue::Type::Bool;
+                value.m_bool = false;
+                return Expect("false");
+            case 'n':
+                value.m_type = JsonValue::Type::Null;
+                return Expect("null");
+            default:
+                return ParseNumber(value);
+        }
+    }
+
+    bool ParseObject(JsonValue& value, int depth) {
+        value.m_type = JsonValue::Type::Object;
+        ++m_pos;   // '{'
+
+        SkipWhitespace();
+        if (Consume('}')) {
+            return true;
+        }
+
+        while (true) {
+            SkipWhitespace();
+            if (m_pos >= m_text.size() || m_text[m_pos] != '"') {
+                return Fail("expected member name");
+            }
+
+            JsonValue::Member member;
+            if (!ParseString(member.first)) {
+                return false;
+            }
+            SkipWhitespace();
+            if (!Consume(':')) {
+                return Fail("expected ':'");
+            }
+            if (!ParseValue(member.second, depth + 1)) {
+                return false;
+            }
+            value.m_members.push_back(std::move(member));
+
+            SkipWhitespace();
+            if (Consume(',')) {
+                continue;
+            }
+            if (Consume('}')) {
+                return true;
+            }
+            return Fail("expected ',' or '}'");
+        }
+    }
+
+    bool ParseArray(JsonValue& value, int depth) {
+        value.m_type = JsonValue::Type::Array;
+        ++m_pos;   // '['
+
+        SkipWhitespace();
+        if (Consume(']')) {
+            return true;
+        }
+
+        while (true) {
+            value.m_array.emplace_back();
+            if (!ParseValue(value.m_array.back(), depth + 1)) {
+                return false;
+            }
+
+            SkipWhitespace();
+            if (Consume(',')) {
+                continue;
+            }
+            if (Consume(']')) {
+                return true;
+            }
+            return Fail("expected ',' or ']'");
+        }
+    }
+
+    bool ParseString(std::string& out) {
+        ++m_pos;   // '"'
+
+        while (m_pos < m_text.size()) {
+            char c = m_text[m_pos++];
+            if (c == '"') {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return Fail("control character in string");
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+
+            if (m_pos >= m_text.size()) {
+                break;
+            }
+            char escape = m_text[m_pos++];
+            switch (escape) {
+                case '"':  out += '"';  break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/';  break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u': {
+                    uint32_t codePoint = 0;
+                    if (!ParseHex4(codePoint)) {
+                        return false;
+                    }
+                    // Surrogate pair: a high surrogate must be followed by \uDC00-\uDFFF
+                    if (codePoint >= 0xD800 && codePoint <= 0xDBFF &&
+                        m_text.compare(m_pos, 2, "\\u") == 0) {
+                        size_t save = m_pos;
+                        m_pos += 2;
+                        uint32_t low = 0;
+                        if (!ParseHex4(low)) {
+                            return false;
+                        }
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        } else {
+                            m_pos = save;
+                        }
+                    }
+                    AppendUtf8(out, codePoint);
+                    break;
+                }
+                default:
+                    return Fail("invalid escape");
+            }
+        }
+        return Fail("unterminated string");
+    }
+
+    bool ParseHex4(uint32_t& value) {
+        if (m_pos + 4 > m_text.size()) {
+            return Fail("truncated \\u escape");
+        }
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = m_text[m_pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= static_cast<uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                value |= static_cast<uint32_t>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                value |= static_cast<uint32_t>(c - 'A' + 10);
+            } else {
+                return Fail("invalid \\u escape");
+            }
+        }
+        return true;
+    }
+
+    bool ParseNumber(JsonValue& value) {
+        size_t start = m_pos;
+        if (m_pos < m_text.size() && m_text[m_pos] == '-') {
+            ++m_pos;
+        }
+        while (m_pos < m_text.size()) {
+            char c = m_text[m_pos];
+            if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+                ++m_pos;
+            } else {
+                break;
+            }
+        }
+        if (m_pos == start) {
+            return Fail("unexpected character");
+        }
+
+        std::string number = m_text.substr(start, m_pos - start);
+        char* end = nullptr;
+        value.m_type = JsonValue::Type::Number;
+        value.m_number = std::strtod(number.c_str(), &end);
+        if (end != number.c_str() + number.size()) {
+            m_pos = start;
+            return Fail("invalid number");
+        }
+        return true;
+    }
+
+    bool Expect(const char* literal) {
+        std::string word(literal);
+        if (m_text.compare(m_pos, word.size(), word) != 0) {
+            return Fail("invalid literal");
+        }
+        m_pos += word.size();
+        return true;
+    }
+
+    bool Consume(char c) {
+        if (m_pos < m_text.size() && m_text[m_pos] == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    void SkipWhitespace() {
+        while (m_pos < m_text.size()) {
+            char c = m_text[m_pos];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                break;
+            }
+            ++m_pos;
+        }
+    }
+
+    bool Fail(const char* what) {
+        if (m_error.empty()) {
+            m_error = std::string(what) + " at offset " + std::to_string(m_pos);
+        }
+        return false;
+    }
+
+    const std::string& m_text;
+    size_t m_pos;
+    std::string m_error;
+};
+
+bool JsonReader::Parse(const std::string& text, JsonValue& root, std::string* error) {
+    root = JsonValue();
+
+    Parser parser(text);
+    if (!parser.ParseDocument(root)) {
+        if (error) {
+            *error = parser.GetError();
+        }
+        root = JsonValue();
+        return false;
+    }
+    return true;
+}
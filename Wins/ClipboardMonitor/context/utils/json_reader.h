@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Parsed JSON value (null, bool, number, string, array or object)
+ *
+ * Accessors never throw: asking for the wrong type gives the fallback (or
+ * an empty string/array/member list), so optional fields in files written
+ * by other programs can be read without checking every step.
+ */
+class JsonValue {
+public:
+    enum class Type {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    using Member = std::pair<std::string, JsonValue>;
+
+    Type GetType() const { return m_type; }
+    bool IsNull() const { return m_type == Type::Null; }
+    bool IsString() const { return m_type == Type::String; }
+    bool IsArray() const { return m_type == Type::Array; }
+    bool IsObject() const { return m_type == Type::Object; }
+
+    bool AsBool(bool fallback = false) const;
+    double AsNumber(double fallback = 0.0) const;
+    int AsInt(int fallback = 0) const;
+
+    /**
+     * @brief String value (UTF-8)
+     *
+     * @return The string, or an empty one if this is not a string
+     */
+    const std::string& AsString() const;
+
+    /**
+     * @brief Array elements (empty if this is not an array)
+     */
+    const std::vector<JsonValue>& GetArray() const;
+
+    /**
+     * @brief Object members in document order (empty if not an object)
+     */
+    const std::vector<Member>& GetMembers() const;
+
+    /**
+     * @brief Look up an object member
+     *
+     * @param key Member name
+     * @return The first member with that name, or nullptr if absent or
+     *         this is not an object
+     */
+    const JsonValue* Find(const std::string& key) const;
+
+    /**
+     * @brief String member of an object
+     *
+     * @param key Member name
+     * @param fallback Returned if the member is absent or not a string
+     */
+    std::string GetString(const std::string& key, const std::string& fallback = std::string()) const;
+
+    /**
+     * @brief Number member of an object
+     *
+     * @param key Member name
+     * @param fallback Returned if the member is absent or not a number
+     */
+    double GetNumber(const std::string& key, double fallback = 0.0) const;
+
+private:
+    friend class JsonReader;
+
+    Type m_type = Type::Null;
+    bool m_bool = false;
+    double m_number = 0.0;
+    std::string m_string;
+    std::vector<JsonValue> m_array;
+    std::vector<Member> m_members;
+};
+
+/**
+ * @brief Small JSON reader
+ *
+ * Parses a complete document (the browser extension's browser_context.json,
+ * config.json) into a JsonValue tree. Strings stay UTF-8; \uXXXX escapes,
+ * including surrogate pairs, are decoded to UTF-8. There is no writer: this
+ * app builds its JSON output with Utils::EscapeJson.
+ *
+ * Kept free of Windows headers so offline tools can use it too.
+ */
+class JsonReader {
+public:
+    /**
+     * @brief Parse a JSON document
+     *
+     * @param text Document text (UTF-8, optional BOM)
+     * @param root Output: parsed value
+     * @param error Output (optional): what went wrong and at which offset
+     * @return true if the whole text is one valid JSON value
+     */
+    static bool Parse(const std::string& text, JsonValue& root, std::string* error = nullptr);
+
+    // Nesting deeper than this is rejected instead of recursing further
+    static constexpr int kMaxDepth = 512;
+
+private:
+    class Parser;
+};
@@ -0,0 +1,430 @@
+#include "title_rules.h"
+#include "../../utils.h"
+#include "../../debug_log.h"
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+// Title layouts the adapters used to scan for by hand. Same format as the
+// "title_rules" object of config.json; parsed once at startup.
+const char kDefaultRules[] = R"({
+  "browser": {
+    "layouts": [
+      { "suffix": " - Google Chrome", "fields": ["page_title"] },
+      { "suffix": " - Microsoft Edge", "fields": ["page_title"] },
+      { "suffix": " - Mozilla Firefox", "fields": ["page_title"] },
+      { "suffix": " - Opera", "fields": ["page_title"] },
+      { "suffix": " - Brave", "fields": ["page_title"] },
+      { "suffix": " - Vivaldi", "fields": ["page_title"] },
+      { "suffix": " - Chromium", "fields": ["page_title"] },
+      { "suffix": " - Comet", "fields": ["page_title"] },
+      { "suffix": " - Atlas", "fields": ["page_title"] },
+      { "suffix": " - Arc", "fields": ["page_title"] },
+      { "suffix": " - 360 Secure Browser", "fields": ["page_title"] },
+      { "suffix": " - 360 Chrome", "fields": ["page_title"] },
+      { "suffix": " - QQ Browser", "fields": ["page_title"] },
+      { "suffix": " - Sogou Browser", "fields": ["page_title"] },
+      { "suffix": " - Liebao Browser", "fields": ["page_title"] },
+      { "suffix": " - 2345 Browser", "fields": ["page_title"] },
+      { "suffix": " - Maxthon", "fields": ["page_title"] },
+      { "suffix": " - Browser", "fields": ["page_title"] },
+      { "suffix": " - Web Browser", "fields": ["page_title"] },
+      { "fields": ["page_title"] }
+    ]
+  },
+  "vscode": {
+    "modified_markers": ["\u25CF ", "\u25CF"],
+    "layouts": [
+      { "infix": " - Antigravity - ", "fields": ["project", "file"] },
+      { "suffix": " - Visual Studio Code", "separator": " - ", "fields": ["file", "project"] },
+      { "suffix": " - Cursor", "separator": " - ", "fields": ["file", "project"] },
+      { "suffix": " - VSCodium", "separator": " - ", "fields": ["file", "project"] },
+      { "suffix": " - Code - Insiders", "separator": " - ", "fields": ["file", "project"] },
+      { "suffix": " - Antigravity", "separator": " - ", "fields": ["file", "project"] },
+      { "separator": " - ", "fields": ["file", "project"] }
+    ]
+  },
+  "notion": {
+    "trim": true,
+    "layouts": [
+      { "suffix": " - Notion", "fields": ["page_title"] },
+      { "fields": ["page_title"] }
+    ]
+  },
+  "wechat": {
+    "ignore": ["\u5FAE\u4FE1", "WeChat"],
+    "layouts": [
+      { "infix": " - \u5FAE\u4FE1", "fields": ["chat"] },
+      { "infix": " - WeChat", "fields": ["chat"] },
+      { "fields": ["chat"] }
+    ]
+  },
+  "generic": {
+    "modified_markers": ["\u25CF ", "*"],
+    "layouts": [
+      { "infix": " - ", "last": true, "fields": ["document", "app"] },
+      { "infix": " \u2014 ", "last": true, "fields": ["document", "app"] },
+      { "infix": " | ", "last": true, "fields": ["document", "app"] },
+      { "fields": ["document"] }
+    ]
+  }
+})";
+
+bool ReadStringArray(const JsonValue& value, const char* key,
+                     std::vector<std::wstring>& out, std::string& error) {
+    const JsonValue* array = value.Find(key);
+    if (!array) {
+        return true;
+    }
+    if (!array->IsArray()) {
+        error = std::string("\"") + key + "\" must be an array of strings";
+        return false;
+    }
+    for (const auto& item : array->GetArray()) {
+        if (!item.IsString() || item.AsString().empty()) {
+            error = std::string("\"") + key + "\" must hold non-empty strings";
+            return false;
+        }
+        out.push_back(Utils::Utf8ToWide(item.AsString()));
+    }
+    return true;
+}
+
+std::wstring Trim(const std::wstring& text) {
+    const wchar_t* whitespace = L" \t\r\n";
+    size_t first = text.find_first_not_of(whitespace);
+    if (first == std::wstring::npos) {
+        return std::wstring();
+    }
+    size_t last = text.find_last_not_of(whitespace);
+    return text.substr(first, last - first + 1);
+}
+
+} // namespace
+
+// ============================================================================
+// TitleAutomaton
+// ============================================================================
+
+int TitleAutomaton::Add(const std::wstring& pattern) {
+    auto it = m_ids.find(pattern);
+    if (it != m_ids.end()) {
+        return it->second;
+    }
+
+    int node = 0;
+    for (wchar_t c : pattern) {
+        int child = FindChild(node, c);
+        if (child < 0) {
+            child = static_cast<int>(m_nodes.size());
+            auto& next = m_nodes[node].next;
+            next.insert(std::upper_bound(next.begin(), next.end(), std::make_pair(c, -1)),
+                        std::make_pair(c, child));
+            m_nodes.emplace_back();
+        }
+        node = child;
+    }
+
+    int id = static_cast<int>(m_patterns.size());
+    m_patterns.push_back(pattern);
+    m_ids.emplace(pattern, id);
+    m_nodes[node].pattern = id;
+    return id;
+}
+
+void TitleAutomaton::Build() {
+    // Breadth-first, so every failure target is finished before it is used
+    std::deque<int> queue;
+    for (const auto& edge : m_nodes[0].next) {
+        m_nodes[edge.second].fail = 0;
+        queue.push_back(edge.second);
+    }
+
+    while (!queue.empty()) {
+        int node = queue.front();
+        queue.pop_front();
+
+        for (const auto& edge : m_nodes[node].next) {
+            int child = edge.second;
+            int fail = m_nodes[node].fail;
+            int target = FindChild(fail, edge.first);
+            while (target < 0 && fail != 0) {
+                fail = m_nodes[fail].fail;
+                target = FindChild(fail, edge.first);
+            }
+            target = (target >= 0 && target != child) ? target : 0;
+
+            m_nodes[child].fail = target;
+            m_nodes[child].output = m_nodes[target].pattern >= 0 ? target : m_nodes[target].output;
+            queue.push_back(child);
+        }
+    }
+}
+
+void TitleAutomaton::Scan(const std::wstring& text, std::vector<Match>& matches) const {
+    int state = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        int next = FindChild(state, text[i]);
+        while (next < 0 && state != 0) {
+            state = m_nodes[state].fail;
+            next = FindChild(state, text[i]);
+        }
+        state = next >= 0 ? next : 0;
+
+        int node = m_nodes[state].pattern >= 0 ? state : m_nodes[state].output;
+        while (node >= 0) {
+            int id = m_nodes[node].pattern;
+            matches.push_back({ id, i + 1 - m_patterns[id].size() });
+            node = m_nodes[node].output;
+        }
+    }
+}
+
+int TitleAutomaton::FindChild(int node, wchar_t c) const {
+    const auto& next = m_nodes[node].next;
+    auto it = std::lower_bound(next.begin(), next.end(), std::make_pair(c, -1));
+    return (it != next.end() && it->first == c) ? it->second : -1;
+}
+
+// ============================================================================
+// TitleRules
+// ============================================================================
+
+TitleRules& TitleRules::Instance() {
+    static TitleRules instance;
+    return instance;
+}
+
+TitleRules::TitleRules() {
+    JsonValue root;
+    std::string error;
+    if (!JsonReader::Parse(kDefaultRules, root, &error) || !Load(root, &error)) {
+        LOG_ERROR("TitleRules: Built-in rules invalid: {}", error);
+    }
+}
+
+bool TitleRules::Load(const JsonValue& rules, std::string* error) {
+    if (!rules.IsObject()) {
+        if (error) {
+            *error = "title rules must be an object of app name -> rule set";
+        }
+        return false;
+    }
+
+    bool valid = true;
+    for (const auto& member : rules.GetMembers()) {
+        App app;
+        std::string appError;
+        if (!ParseApp(member.second, app, appError)) {
+            if (valid && error) {
+                *error = member.first + ": " + appError;
+            }
+            valid = false;
+            continue;
+        }
+        m_apps[member.first] = std::move(app);
+    }
+
+    Compile();
+    return valid;
+}
+
+bool TitleRules::LoadConfig(const std::wstring& path) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        return true;    // No config.json: built-in rules only
+    }
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    JsonValue root;
+    std::string error;
+    if (!JsonReader::Parse(text, root, &error)) {
+        LOG_WARN("TitleRules: {} is not valid JSON: {}", path, error);
+        return false;
+    }
+
+    const JsonValue* rules = root.Find("title_rules");
+    if (!rules) {
+        return true;
+    }
+    if (!Load(*rules, &error)) {
+        LOG_WARN("TitleRules: Invalid title_rules in {}: {}", path, error);
+        return false;
+    }
+
+    LOG_INFO("TitleRules: Loaded {} app rule sets from config ({} patterns)",
+             rules->GetMembers().size(), GetPatternCount());
+    return true;
+}
+
+TitleFields TitleRules::Parse(const std::string& appName, const std::wstring& title) const {
+    TitleFields result;
+    auto appIt = m_apps.find(appName);
+    if (appIt == m_apps.end() || title.empty()) {
+        return result;
+    }
+    const App& app = appIt->second;
+
+    for (const auto& ignored : app.ignore) {
+        if (title == ignored) {
+            return result;
+        }
+    }
+
+    // One pass over the title finds every pattern of every app
+    std::vector<TitleAutomaton::Match> matches;
+    m_automaton.Scan(title, matches);
+
+    // Modified marker: a prefix, stripped before the layouts apply
+    size_t begin = 0;
+    for (int markerId : app.markerIds) {
+        bool found = std::any_of(matches.begin(), matches.end(),
+            [markerId](const TitleAutomaton::Match& m) { return m.pattern == markerId && m.start == 0; });
+        if (found) {
+            result.modified = true;
+            begin = m_automaton.GetPattern(markerId).size();
+            break;
+        }
+    }
+
+    auto assign = [&](const std::string& field, size_t from, size_t to) {
+        std::wstring value = title.substr(from, to - from);
+        result.fields[field] = app.trim ? Trim(value) : value;
+    };
+
+    for (const auto& layout : app.layouts) {
+        size_t end = title.size();
+
+        if (layout.kind == LayoutKind::Infix) {
+            // First (or last) occurrence after the marker
+            auto isInfix = [&](const TitleAutomaton::Match& m) {
+                return m.pattern == layout.patternId && m.start >= begin;
+            };
+            const TitleAutomaton::Match* found = nullptr;
+            if (layout.last) {
+                auto it = std::find_if(matches.rbegin(), matches.rend(), isInfix);
+                found = it != matches.rend() ? &*it : nullptr;
+            } else {
+                auto it = std::find_if(matches.begin(), matches.end(), isInfix);
+                found = it != matches.end() ? &*it : nullptr;
+            }
+            if (!found) {
+                continue;
+            }
+            assign(layout.fields[0], begin, found->start);
+            if (layout.fields.size() > 1) {
+                assign(layout.fields[1], found->start + layout.pattern.size(), end);
+            }
+            result.matched = true;
+            break;
+        }
+
+        if (layout.kind == LayoutKind::Suffix) {
+            // Last occurrence after the marker
+            auto it = std::find_if(matches.rbegin(), matches.rend(),
+                [&](const TitleAutomaton::Match& m) { return m.pattern == layout.patternId && m.start >= begin; });
+            if (it == matches.rend()) {
+                continue;
+            }
+            end = it->start;
+            result.matched = true;
+        }
+
+        // Split the body at the first separator inside it
+        auto sep = matches.end();
+        if (layout.separatorId >= 0 && layout.fields.size() > 1) {
+            size_t length = layout.separator.size();
+            sep = std::find_if(matches.begin(), matches.end(),
+                [&](const TitleAutomaton::Match& m) {
+                    return m.pattern == layout.separatorId && m.start >= begin && m.start + length <= end;
+                });
+        }
+        if (sep != matches.end()) {
+            assign(layout.fields[0], begin, sep->start);
+            assign(layout.fields[1], sep->start + layout.separator.size(), end);
+        } else {
+            assign(layout.fields[0], begin, end);
+        }
+        break;
+    }
+
+    return result;
+}
+
+bool TitleRules::ParseApp(const JsonValue& value, App& app, std::string& error) {
+    if (!value.IsObject()) {
+        error = "rule set must be an object";
+        return false;
+    }
+
+    if (!ReadStringArray(value, "modified_markers", app.markers, error) ||
+        !ReadStringArray(value, "ignore", app.ignore, error)) {
+        return false;
+    }
+    if (const JsonValue* trim = value.Find("trim")) {
+        app.trim = trim->AsBool(false);
+    }
+
+    const JsonValue* layouts = value.Find("layouts");
+    if (!layouts || !layouts->IsArray() || layouts->GetArray().empty()) {
+        error = "\"layouts\" must be a non-empty array";
+        return false;
+    }
+
+    for (const auto& item : layouts->GetArray()) {
+        Layout layout;
+        std::string suffix = item.GetString("suffix");
+        std::string infix = item.GetString("infix");
+        if (!suffix.empty() && !infix.empty()) {
+            error = "a layout has either \"suffix\" or \"infix\", not both";
+            return false;
+        }
+        if (!suffix.empty()) {
+            layout.kind = LayoutKind::Suffix;
+            layout.pattern = Utils::Utf8ToWide(suffix);
+        } else if (!infix.empty()) {
+            layout.kind = LayoutKind::Infix;
+            layout.pattern = Utils::Utf8ToWide(infix);
+        }
+        layout.separator = Utils::Utf8ToWide(item.GetString("separator"));
+        if (const JsonValue* last = item.Find("last")) {
+            layout.last = last->AsBool(false);
+        }
+
+        const JsonValue* fields = item.Find("fields");
+        if (fields) {
+            for (const auto& field : fields->GetArray()) {
+                if (field.IsString() && !field.AsString().empty()) {
+                    layout.fields.push_back(field.AsString());
+                }
+            }
+        }
+        if (layout.fields.empty() || layout.fields.size() > 2) {
+            error = "a layout needs one or two \"fields\" names";
+            return false;
+        }
+
+        app.layouts.push_back(std::move(layout));
+    }
+    return true;
+}
+
+void TitleRules::Compile() {
+    TitleAutomaton automaton;
+    for (auto& entry : m_apps) {
+        App& app = entry.second;
+        app.markerIds.clear();
+        for (const auto& marker : app.markers) {
+            app.markerIds.push_back(automaton.Add(marker));
+        }
+        for (auto& layout : app.layouts) {
+            layout.patternId = layout.pattern.empty() ? -1 : automaton.Add(layout.pattern);
+            layout.separatorId = layout.separator.empty() ? -1 : automaton.Add(layout.separator);
+        }
+    }
+    automaton.Build();
+    m_automaton = std::move(automaton);
+}
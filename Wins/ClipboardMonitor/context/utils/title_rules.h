@@ -0,0 +1,192 @@
+#pragma once
+
+#include "json_reader.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Multi-pattern matcher over window titles (Aho-Corasick)
+ *
+ * All patterns of all title rules go into one automaton, so a title is
+ * scanned once whatever the number of apps and rules.
+ */
+class TitleAutomaton {
+public:
+    struct Match {
+        int pattern;      // Id returned by Add
+        size_t start;     // Offset of the occurrence in the text
+    };
+
+    /**
+     * @brief Add a pattern (before Build)
+     *
+     * @param pattern Literal text, case-sensitive
+     * @return Pattern id; adding the same text again returns the same id
+     */
+    int Add(const std::wstring& pattern);
+
+    /**
+     * @brief Compute failure links; call once after the last Add
+     */
+    void Build();
+
+    /**
+     * @brief Find every occurrence of every pattern
+     *
+     * @param text Text to scan
+     * @param matches Output: occurrences in order of their end offset
+     */
+    void Scan(const std::wstring& text, std::vector<Match>& matches) const;
+
+    const std::wstring& GetPattern(int id) const { return m_patterns[id]; }
+    size_t GetPatternCount() const { return m_patterns.size(); }
+
+private:
+    struct Node {
+        std::vector<std::pair<wchar_t, int>> next;  // Sorted by character
+        int fail = 0;
+        int pattern = -1;     // Pattern ending here
+        int output = -1;      // Nearest node on the failure chain ending a pattern
+    };
+
+    int FindChild(int node, wchar_t c) const;
+
+    std::vector<Node> m_nodes = std::vector<Node>(1);
+    std::vector<std::wstring> m_patterns;
+    std::unordered_map<std::wstring, int> m_ids;
+};
+
+/**
+ * @brief Fields extracted from a window title
+ */
+struct TitleFields {
+    std::map<std::string, std::wstring> fields;  // e.g. {"file": ..., "project": ...}
+    bool modified = false;    // A modified marker was stripped
+    bool matched = false;     // A layout with a pattern matched (not the fallback)
+
+    std::wstring Get(const std::string& name) const {
+        auto it = fields.find(name);
+        return it != fields.end() ? it->second : std::wstring();
+    }
+};
+
+/**
+ * @brief Declarative window-title layouts per app
+ *
+ * Rule format (the "title_rules" object of config.json; see
+ * config_design.md):
+ *
+ *   "vscode": {
+ *     "modified_markers": ["● ", "●"],
+ *     "trim": false,
+ *     "ignore": [],
+ *     "layouts": [
+ *       { "infix": " - Antigravity - ", "fields": ["project", "file"] },
+ *       { "suffix": " - Visual Studio Code", "separator": " - ", "fields": ["file", "project"] },
+ *       { "separator": " - ", "fields": ["file", "project"] }
+ *     ]
+ *   }
+ *
+ * - modified_markers: prefixes stripped first (longest listed first); sets
+ *   TitleFields::modified
+ * - ignore: whole titles that carry no fields (e.g. WeChat's main window)
+ * - layouts, tried in order, the first that applies wins:
+ *   - "suffix": last occurrence; the text before it is the body
+ *   - "infix": first occurrence ("last": true for the last one); fields[0]
+ *     is the text before, fields[1] after
+ *   - neither: always applies to the whole title (fallback)
+ *   - "separator": splits the body at its first occurrence into fields[0]
+ *     and fields[1]; without one (or no occurrence) the body is fields[0]
+ * - trim: strip whitespace around every field
+ *
+ * Built-in rules cover browser, vscode, notion, wechat and "generic" (any
+ * other app: "Document - App" and similar); an app in
+ * config.json replaces the built-in rules of the same name. All patterns
+ * are compiled into one TitleAutomaton, so Parse is a single pass over the
+ * title plus a walk over that app's layouts.
+ */
+class TitleRules {
+public:
+    /**
+     * @brief Process-wide rules used by the adapters
+     *
+     * Load configuration at startup, before adapters run; Parse is safe
+     * from any thread afterwards.
+     */
+    static TitleRules& Instance();
+
+    /**
+     * @brief Create with the built-in rules
+     */
+    TitleRules();
+
+    /**
+     * @brief Add or replace app rules
+     *
+     * @param rules Object of app name -> rule set, as described above
+     * @param error Output (optional): first invalid app and why; valid
+     *              apps are still applied
+     * @return true if every app was valid
+     */
+    bool Load(const JsonValue& rules, std::string* error = nullptr);
+
+    /**
+     * @brief Apply the "title_rules" object of a config.json, if any
+     *
+     * @param path config.json path
+     * @return false if the file exists but is not valid
+     */
+    bool LoadConfig(const std::wstring& path);
+
+    /**
+     * @brief Extract fields from a window title
+     *
+     * @param app Rule set name (e.g. "vscode")
+     * @param title Window title
+     * @return Extracted fields; empty for an unknown app or ignored title
+     */
+    TitleFields Parse(const std::string& app, const std::wstring& title) const;
+
+    /**
+     * @brief Number of distinct patterns in the automaton
+     */
+    size_t GetPatternCount() const { return m_automaton.GetPatternCount(); }
+
+private:
+    enum class LayoutKind {
+        Fallback,
+        Suffix,
+        Infix
+    };
+
+    struct Layout {
+        LayoutKind kind = LayoutKind::Fallback;
+        std::wstring pattern;
+        std::wstring separator;
+        std::vector<std::string> fields;
+        bool last = false;    // Infix: split at the last occurrence
+        int patternId = -1;
+        int separatorId = -1;
+    };
+
+    struct App {
+        std::vector<std::wstring> markers;
+        std::vector<int> markerIds;
+        std::vector<std::wstring> ignore;
+        bool trim = false;
+        std::vector<Layout> layouts;
+    };
+
+    // Parse one app's rule set
+    static bool ParseApp(const JsonValue& value, App& app, std::string& error);
+
+    // Rebuild the automaton from every app's patterns
+    void Compile();
+
+    std::unordered_map<std::string, App> m_apps;
+    TitleAutomaton m_automaton;
+};
@@ -1,4 +1,5 @@
 #include "ui_automation_helper.h"
+#include "accessible_search.h"
 #include "../../debug_log.h"
 #include <algorithm>
 #include <cctype>
@@ -6,13 +7,378 @@
 // Link UI Automation library
 #pragma comment(lib, "uiautomationcore.lib")
 
-UIAutomationHelper::UIAutomationHelper()
+namespace {
+
+// Context of the current thread, set by UIAutomationThreadContext::Attach
+thread_local std::unique_ptr<UIAutomationThreadContext> t_threadContext;
+
+// Control types adapters search for on most fetches
+const CONTROLTYPEID kCommonControlTypes[] = {
+    UIA_TextControlTypeId,
+    UIA_EditControlTypeId,
+    UIA_DocumentControlTypeId,
+    UIA_HyperlinkControlTypeId,
+    UIA_ButtonControlTypeId,
+    UIA_ListControlTypeId,
+    UIA_ListItemControlTypeId,
+};
+
+IUIAutomationCondition* NewControlTypeCondition(IUIAutomation* automation,
+                                                CONTROLTYPEID controlTypeId) {
+    VARIANT varType;
+    varType.vt = VT_I4;
+    varType.lVal = controlTypeId;
+
+    IUIAutomationCondition* condition = nullptr;
+    HRESULT hr = automation->CreatePropertyCondition(UIA_ControlTypePropertyId, varType, &condition);
+    return SUCCEEDED(hr) ? condition : nullptr;
+}
+
+// Properties every search result carries (AccessibleProperties)
+const PROPERTYID kCachedProperties[] = {
+    UIA_NamePropertyId,
+    UIA_AutomationIdPropertyId,
+    UIA_ControlTypePropertyId,
+    UIA_BoundingRectanglePropertyId,
+};
+
+IUIAutomationCacheRequest* NewCacheRequest(IUIAutomation* automation,
+                                           IUIAutomationCondition* trueCondition,
+                                           AccessibleCache cache) {
+    IUIAutomationCacheRequest* request = nullptr;
+    if (cache == AccessibleCache::None || FAILED(automation->CreateCacheRequest(&request)) || !request) {
+        return nullptr;
+    }
+    for (PROPERTYID property : kCachedProperties) {
+        request->AddProperty(property);
+    }
+    if (cache == AccessibleCache::Children) {
+        // Raw view, like GetChildren without a cache (FindAll with the true condition)
+        request->put_TreeScope(static_cast<TreeScope>(TreeScope_Element | TreeScope_Children));
+        if (trueCondition) {
+            request->put_TreeFilter(trueCondition);
+        }
+    }
+    return request;
+}
+
+// IAccessibleElement over one IUIAutomationElement; borrows the helper
+class UIAutomationAccessibleElement : public IAccessibleElement {
+public:
+    // Takes ownership of element, fetched with the given cache request
+    UIAutomationAccessibleElement(UIAutomationHelper& helper, IUIAutomationElement* element,
+                                  AccessibleCache cache)
+        : m_helper(helper)
+        , m_element(element)
+        , m_bound(cache != AccessibleCache::None)
+        , m_childrenCached(cache == AccessibleCache::Children) {
+        if (m_bound) {
+            m_helper.ReadCachedProperties(element, m_properties);
+        }
+    }
+
+    const AccessibleProperties& GetProperties() override {
+        if (!m_bound && !m_helper.IsCancelled()) {
+            m_bound = true;
+            m_helper.ReadProperties(m_element.Get(), m_properties);
+        }
+        return m_properties;
+    }
+
+    std::wstring GetValue() override {
+        return m_helper.GetElementValue(m_element.Get());
+    }
+
+    // New reference to the wrapped element; caller must Release() it
+    IUIAutomationElement* GetElement() {
+        m_element->AddRef();
+        return m_element.Get();
+    }
+
+    std::vector<AccessibleElementPtr> GetChildren() override {
+        if (!m_childrenCached) {
+            return FindAll(AccessibleScope::Children, AccessibleQuery(), AccessibleCache::Properties);
+        }
+
+        // Fetched with this element; a null array means no children
+        std::vector<AccessibleElementPtr> results;
+        IUIAutomationElementArray* elements = nullptr;
+        if (SUCCEEDED(m_element->GetCachedChildren(&elements)) && elements) {
+            Wrap(elements, AccessibleCache::Properties, results);
+        }
+        return results;
+    }
+
+    AccessibleElementPtr GetParent() override {
+        IUIAutomationTreeWalker* walker = nullptr;
+        if (m_helper.IsCancelled() || !m_helper.GetAutomation() ||
+            FAILED(m_helper.GetAutomation()->get_RawViewWalker(&walker)) || !walker) {
+            return nullptr;
+        }
+
+        // Raw view, like GetChildren, so sibling indices agree
+        IUIAutomationCacheRequest* request = nullptr;
+        IUIAutomationElement* parent = nullptr;
+        HRESULT hr = m_helper.CreateCacheRequest(AccessibleCache::Properties, &request);
+        if (SUCCEEDED(hr)) {
+            hr = walker->GetParentElementBuildCache(m_element.Get(), request, &parent);
+            request->Release();
+        }
+        walker->Release();
+        if (FAILED(hr) || !parent) {
+            return nullptr;
+        }
+        return std::make_shared<UIAutomationAccessibleElement>(m_helper, parent, AccessibleCache::Properties);
+    }
+
+    std::vector<int> GetRuntimeId() override {
+        std::vector<int> id;
+        SAFEARRAY* ids = nullptr;
+        if (FAILED(m_element->GetRuntimeId(&ids)) || !ids) {
+            return id;
+        }
+
+        LONG lower = 0;
+        LONG upper = -1;
+        SafeArrayGetLBound(ids, 1, &lower);
+        SafeArrayGetUBound(ids, 1, &upper);
+        for (LONG i = lower; i <= upper; i++) {
+            int value = 0;
+            if (SUCCEEDED(SafeArrayGetElement(ids, &i, &value))) {
+                id.push_back(value);
+            }
+        }
+        SafeArrayDestroy(ids);
+        return id;
+    }
+
+    std::vector<AccessibleElementPtr> FindAll(AccessibleScope scope, const AccessibleQuery& query,
+                                              AccessibleCache cache) override {
+        std::vector<AccessibleElementPtr> results;
+        IUIAutomationCondition* condition = nullptr;
+        if (m_helper.IsCancelled() ||
+            FAILED(m_helper.CreateQueryCondition(query, &condition)) || !condition) {
+            return results;
+        }
+
+        IUIAutomationCacheRequest* request = nullptr;
+        if (cache != AccessibleCache::None && FAILED(m_helper.CreateCacheRequest(cache, &request))) {
+            cache = AccessibleCache::None;   // Properties are then read per element
+        }
+
+        IUIAutomationElementArray* elements = nullptr;
+        HRESULT hr = request
+            ? m_element->FindAllBuildCache(ToTreeScope(scope), condition, request, &elements)
+            : m_element->FindAll(ToTreeScope(scope), condition, &elements);
+        condition->Release();
+        if (request) {
+            request->Release();
+        }
+        if (SUCCEEDED(hr) && elements) {
+            Wrap(elements, cache, results);
+        }
+        return results;
+    }
+
+    AccessibleElementPtr FindFirst(AccessibleScope scope, const AccessibleQuery& query,
+                                   AccessibleCache cache) override {
+        IUIAutomationCondition* condition = nullptr;
+        if (m_helper.IsCancelled() ||
+            FAILED(m_helper.CreateQueryCondition(query, &condition)) || !condition) {
+            return nullptr;
+        }
+
+        IUIAutomationCacheRequest* request = nullptr;
+        if (cache != AccessibleCache::None && FAILED(m_helper.CreateCacheRequest(cache, &request))) {
+            cache = AccessibleCache::None;
+        }
+
+        IUIAutomationElement* element = nullptr;
+        HRESULT hr = request
+            ? m_element->FindFirstBuildCache(ToTreeScope(scope), condition, request, &element)
+            : m_element->FindFirst(ToTreeScope(scope), condition, &element);
+        condition->Release();
+        if (request) {
+            request->Release();
+        }
+        if (FAILED(hr) || !element) {
+            return nullptr;
+        }
+        return std::make_shared<UIAutomationAccessibleElement>(m_helper, element, cache);
+    }
+
+private:
+    static TreeScope ToTreeScope(AccessibleScope scope) {
+        return scope == AccessibleScope::Children ? TreeScope_Children : TreeScope_Descendants;
+    }
+
+    // Wraps and releases an element array
+    void Wrap(IUIAutomationElementArray* elements, AccessibleCache cache,
+              std::vector<AccessibleElementPtr>& results) {
+        int count = 0;
+        elements->get_Length(&count);
+        results.reserve(count);
+        for (int i = 0; i < count; i++) {
+            IUIAutomationElement* element = nullptr;
+            if (SUCCEEDED(elements->GetElement(i, &element)) && element) {
+                results.push_back(std::make_shared<UIAutomationAccessibleElement>(m_helper, element, cache));
+            }
+        }
+        elements->Release();
+    }
+
+    UIAutomationHelper& m_helper;
+    AutoElement m_element;
+    AccessibleProperties m_properties;
+    bool m_bound;             // Properties already fetched
+    bool m_childrenCached;    // Children fetched with this element
+};
+
+} // namespace
+
+UIAutomationThreadContext::UIAutomationThreadContext()
     : m_automation(nullptr)
+    , m_trueCondition(nullptr)
+    , m_propertiesRequest(nullptr)
+    , m_childrenRequest(nullptr)
     , m_comInitialized(false)
 {
 }
 
+UIAutomationThreadContext::~UIAutomationThreadContext() {
+    for (auto& entry : m_controlTypeConditions) {
+        if (entry.second) {
+            entry.second->Release();
+        }
+    }
+    m_controlTypeConditions.clear();
+
+    for (IUIAutomationCacheRequest** request : {&m_propertiesRequest, &m_childrenRequest}) {
+        if (*request) {
+            (*request)->Release();
+            *request = nullptr;
+        }
+    }
+
+    if (m_trueCondition) {
+        m_trueCondition->Release();
+        m_trueCondition = nullptr;
+    }
+
+    if (m_automation) {
+        m_automation->Release();
+        m_automation = nullptr;
+    }
+
+    if (m_comInitialized) {
+        CoUninitialize();
+    }
+}
+
+bool UIAutomationThreadContext::Attach() {
+    if (t_threadContext) {
+        return true;  // Already attached
+    }
+
+    std::unique_ptr<UIAutomationThreadContext> context(new UIAutomationThreadContext());
+    if (!context->Initialize()) {
+        return false;
+    }
+
+    t_threadContext = std::move(context);
+    return true;
+}
+
+void UIAutomationThreadContext::Detach() {
+    t_threadContext.reset();
+}
+
+UIAutomationThreadContext* UIAutomationThreadContext::Current() {
+    return t_threadContext.get();
+}
+
+bool UIAutomationThreadContext::Initialize() {
+    // Initialize COM (apartment-threaded for UI Automation)
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+    if (SUCCEEDED(hr)) {
+        m_comInitialized = true;
+    } else if (hr != RPC_E_CHANGED_MODE) {
+        LOG_WARN("UIAutomationThreadContext: CoInitializeEx failed");
+        return false;
+    }
+
+    hr = CoCreateInstance(
+        CLSID_CUIAutomation,
+        nullptr,
+        CLSCTX_INPROC_SERVER,
+        IID_IUIAutomation,
+        reinterpret_cast<void**>(&m_automation)
+    );
+
+    if (FAILED(hr) || !m_automation) {
+        LOG_WARN("UIAutomationThreadContext: CoCreateInstance failed");
+        m_automation = nullptr;
+        return false;   // Destructor uninitializes COM
+    }
+
+    // Pre-build the conditions and cache requests used on every fetch
+    m_automation->CreateTrueCondition(&m_trueCondition);
+    for (CONTROLTYPEID controlTypeId : kCommonControlTypes) {
+        m_controlTypeConditions[controlTypeId] = NewControlTypeCondition(m_automation, controlTypeId);
+    }
+    m_propertiesRequest = NewCacheRequest(m_automation, m_trueCondition, AccessibleCache::Properties);
+    m_childrenRequest = NewCacheRequest(m_automation, m_trueCondition, AccessibleCache::Children);
+
+    LOG_DEBUG("UIAutomationThreadContext: Attached to thread");
+    return true;
+}
+
+IUIAutomationCondition* UIAutomationThreadContext::GetControlTypeCondition(CONTROLTYPEID controlTypeId) {
+    auto it = m_controlTypeConditions.find(controlTypeId);
+    if (it != m_controlTypeConditions.end() && it->second) {
+        return it->second;
+    }
+
+    IUIAutomationCondition* condition = NewControlTypeCondition(m_automation, controlTypeId);
+    if (condition) {
+        m_controlTypeConditions[controlTypeId] = condition;
+    }
+    return condition;
+}
+
+IUIAutomationCacheRequest* UIAutomationThreadContext::GetCacheRequest(AccessibleCache cache) const {
+    switch (cache) {
+    case AccessibleCache::Properties:
+        return m_propertiesRequest;
+    case AccessibleCache::Children:
+        return m_childrenRequest;
+    default:
+        return nullptr;
+    }
+}
+
+UIAutomationHelper::UIAutomationHelper(const CancellationToken& token)
+    : m_automation(nullptr)
+    , m_threadContext(nullptr)
+    , m_propertiesRequest(nullptr)
+    , m_childrenRequest(nullptr)
+    , m_comInitialized(false)
+    , m_token(token)
+{
+}
+
 UIAutomationHelper::~UIAutomationHelper() {
+    for (IUIAutomationCacheRequest** request : {&m_propertiesRequest, &m_childrenRequest}) {
+        if (*request) {
+            (*request)->Release();
+            *request = nullptr;
+        }
+    }
+
+    if (m_threadContext) {
+        return;  // Borrowed - the thread context owns everything
+    }
+
     if (m_automation) {
         m_automation->Release();
         m_automation = nullptr;
@@ -28,6 +394,13 @@ bool UIAutomationHelper::Initialize() {
         return true;  // Already initialized
     }
 
+    // Executor workers keep one instance per thread
+    m_threadContext = UIAutomationThreadContext::Current();
+    if (m_threadContext) {
+        m_automation = m_threadContext->GetAutomation();
+        return true;
+    }
+
     // Initialize COM (apartment-threaded for UI Automation)
     HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
     if (SUCCEEDED(hr)) {
@@ -36,7 +409,7 @@ bool UIAutomationHelper::Initialize() {
         // COM already initialized in a different mode, continue anyway
         m_comInitialized = false;
     } else {
-        DEBUG_LOG("UIAutomationHelper: CoInitializeEx failed");
+        LOG_WARN("UIAutomationHelper: CoInitializeEx failed");
         return false;
     }
 
@@ -50,7 +423,7 @@ bool UIAutomationHelper::Initialize() {
     );
 
     if (FAILED(hr) || !m_automation) {
-        DEBUG_LOG("UIAutomationHelper: CoCreateInstance failed");
+        LOG_WARN("UIAutomationHelper: CoCreateInstance failed");
         if (m_comInitialized) {
             CoUninitialize();
             m_comInitialized = false;
@@ -58,16 +431,93 @@ bool UIAutomationHelper::Initialize() {
         return false;
     }
 
-    DEBUG_LOG("UIAutomationHelper: Initialized successfully");
+    LOG_DEBUG("UIAutomationHelper: Initialized successfully");
     return true;
 }
 
+HRESULT UIAutomationHelper::CreateControlTypeCondition(CONTROLTYPEID controlTypeId,
+                                                       IUIAutomationCondition** condition) {
+    if (!condition) {
+        return E_POINTER;
+    }
+    *condition = nullptr;
+    if (!m_automation) {
+        return E_FAIL;
+    }
+
+    if (m_threadContext) {
+        IUIAutomationCondition* shared = m_threadContext->GetControlTypeCondition(controlTypeId);
+        if (shared) {
+            shared->AddRef();
+            *condition = shared;
+            return S_OK;
+        }
+    }
+
+    *condition = NewControlTypeCondition(m_automation, controlTypeId);
+    return *condition ? S_OK : E_FAIL;
+}
+
+HRESULT UIAutomationHelper::CreateTrueCondition(IUIAutomationCondition** condition) {
+    if (!condition) {
+        return E_POINTER;
+    }
+    *condition = nullptr;
+    if (!m_automation) {
+        return E_FAIL;
+    }
+
+    if (m_threadContext && m_threadContext->GetTrueCondition()) {
+        *condition = m_threadContext->GetTrueCondition();
+        (*condition)->AddRef();
+        return S_OK;
+    }
+
+    return m_automation->CreateTrueCondition(condition);
+}
+
+HRESULT UIAutomationHelper::CreateCacheRequest(AccessibleCache cache,
+                                               IUIAutomationCacheRequest** request) {
+    if (!request) {
+        return E_POINTER;
+    }
+    *request = nullptr;
+    if (!m_automation) {
+        return E_FAIL;
+    }
+    if (cache == AccessibleCache::None) {
+        return E_INVALIDARG;
+    }
+
+    IUIAutomationCacheRequest* shared = m_threadContext ? m_threadContext->GetCacheRequest(cache) : nullptr;
+    if (!shared) {
+        IUIAutomationCacheRequest*& own =
+            cache == AccessibleCache::Children ? m_childrenRequest : m_propertiesRequest;
+        if (!own) {
+            IUIAutomationCondition* trueCondition = nullptr;
+            CreateTrueCondition(&trueCondition);
+            own = NewCacheRequest(m_automation, trueCondition, cache);
+            if (trueCondition) {
+                trueCondition->Release();
+            }
+        }
+        shared = own;
+    }
+    if (!shared) {
+        return E_FAIL;
+    }
+
+    shared->AddRef();
+    *request = shared;
+    return S_OK;
+}
+
 IUIAutomationElement* UIAutomationHelper::FindElementByControlType(
     HWND hwnd,
     const std::wstring& controlTypeName,
     const std::wstring& namePart)
 {
-    if (!m_automation || !hwnd) {
+    if (!m_automation || !hwnd || IsCancelled()) {
         return nullptr;
     }
 
@@ -85,13 +535,9 @@ IUIAutomationElement* UIAutomationHelper::FindElementByControlType(
         return nullptr;
     }
 
-    // Create condition for control type
-    VARIANT varType;
-    varType.vt = VT_I4;
-    varType.lVal = controlTypeId;
-
+    // Condition for control type
     IUIAutomationCondition* condition = nullptr;
-    hr = m_automation->CreatePropertyCondition(UIA_ControlTypePropertyId, varType, &condition);
+    hr = CreateControlTypeCondition(controlTypeId, &condition);
     if (FAILED(hr) || !condition) {
         root->Release();
         return nullptr;
@@ -104,9 +550,14 @@ IUIAutomationElement* UIAutomationHelper::FindElementByControlType(
         // No name filter - return first match
         hr = root->FindFirst(TreeScope_Descendants, condition, &result);
     } else {
-        // Search all matching control types and filter by name
+        // Search all matching control types, names fetched in the same call
+        IUIAutomationCacheRequest* request = nullptr;
+        hr = CreateCacheRequest(AccessibleCache::Properties, &request);
         IUIAutomationElementArray* elements = nullptr;
-        hr = root->FindAll(TreeScope_Descendants, condition, &elements);
+        if (SUCCEEDED(hr)) {
+            hr = root->FindAllBuildCache(TreeScope_Descendants, condition, request, &elements);
+            request->Release();
+        }
 
         if (SUCCEEDED(hr) && elements) {
             int count = 0;
@@ -116,11 +567,11 @@ IUIAutomationElement* UIAutomationHelper::FindElementByControlType(
             std::transform(lowerNamePart.begin(), lowerNamePart.end(),
                          lowerNamePart.begin(), ::towlower);
 
-            for (int i = 0; i < count; i++) {
+            for (int i = 0; i < count && !IsCancelled(); i++) {
                 IUIAutomationElement* elem = nullptr;
                 if (SUCCEEDED(elements->GetElement(i, &elem)) && elem) {
                     BSTR name = nullptr;
-                    if (SUCCEEDED(elem->get_CurrentName(&name)) && name) {
+                    if (SUCCEEDED(elem->get_CachedName(&name)) && name) {
                         std::wstring elemName = BstrToWstring(name);
                         std::transform(elemName.begin(), elemName.end(),
                                      elemName.begin(), ::towlower);
@@ -149,72 +600,42 @@ IUIAutomationElement* UIAutomationHelper::FindElementByName(
     HWND hwnd,
     const std::wstring& namePart)
 {
-    if (!m_automation || !hwnd || namePart.empty()) {
+    if (!m_automation || !hwnd || namePart.empty() || IsCancelled()) {
         return nullptr;
     }
 
-    // Get root element from window handle
-    IUIAutomationElement* root = nullptr;
-    HRESULT hr = m_automation->ElementFromHandle(hwnd, &root);
-    if (FAILED(hr) || !root) {
+    AccessibleElementPtr root = GetWindowElement(hwnd);
+    if (!root) {
         return nullptr;
     }
 
-    // Create a "true" condition (matches all elements)
-    IUIAutomationCondition* trueCondition = nullptr;
-    hr = m_automation->CreateTrueCondition(&trueCondition);
-    if (FAILED(hr) || !trueCondition) {
-        root->Release();
+    std::wstring lowerNamePart = namePart;
+    std::transform(lowerNamePart.begin(), lowerNamePart.end(),
+                 lowerNamePart.begin(), ::towlower);
+
+    // Budgeted breadth-first search; no condition can express a substring,
+    // so names are tested here, shallowest elements first
+    AccessibleSearchOptions options;
+    options.predicate = [&lowerNamePart](const AccessibleProperties& properties) {
+        std::wstring elemName = properties.name;
+        std::transform(elemName.begin(), elemName.end(),
+                     elemName.begin(), ::towlower);
+        return elemName.find(lowerNamePart) != std::wstring::npos;
+    };
+
+    AccessibleElementPtr found = AccessibleSearch::FindFirst(*root, options, m_token);
+    if (!found) {
         return nullptr;
     }
-
-    // Find all elements and filter by name
-    IUIAutomationElementArray* elements = nullptr;
-    hr = root->FindAll(TreeScope_Descendants, trueCondition, &elements);
-
-    IUIAutomationElement* result = nullptr;
-
-    if (SUCCEEDED(hr) && elements) {
-        int count = 0;
-        elements->get_Length(&count);
-
-        std::wstring lowerNamePart = namePart;
-        std::transform(lowerNamePart.begin(), lowerNamePart.end(),
-                     lowerNamePart.begin(), ::towlower);
-
-        for (int i = 0; i < count; i++) {
-            IUIAutomationElement* elem = nullptr;
-            if (SUCCEEDED(elements->GetElement(i, &elem)) && elem) {
-                BSTR name = nullptr;
-                if (SUCCEEDED(elem->get_CurrentName(&name)) && name) {
-                    std::wstring elemName = BstrToWstring(name);
-                    std::transform(elemName.begin(), elemName.end(),
-                                 elemName.begin(), ::towlower);
-
-                    if (elemName.find(lowerNamePart) != std::wstring::npos) {
-                        result = elem;
-                        break;
-                    }
-                }
-                if (!result) {
-                    elem->Release();
-                }
-            }
-        }
-        elements->Release();
-    }
-
-    trueCondition->Release();
-    root->Release();
-
-    return result;
+    // Elements from GetWindowElement are always this helper's wrappers
+    return static_cast<UIAutomationAccessibleElement&>(*found).GetElement();
 }
 
 IUIAutomationElement* UIAutomationHelper::FindElementByAutomationId(
     HWND hwnd,
     const std::wstring& automationId)
 {
-    if (!m_automation || !hwnd || automationId.empty()) {
+    if (!m_automation || !hwnd || automationId.empty() || IsCancelled()) {
         return nullptr;
     }
 
@@ -245,8 +666,152 @@ IUIAutomationElement* UIAutomationHelper::FindElementByAutomationId(
     return result;
 }
 
-std::wstring UIAutomationHelper::GetElementValue(IUIAutomationElement* element) {
+AccessibleElementPtr UIAutomationHelper::GetWindowElement(HWND hwnd) {
+    if (!m_automation || !hwnd || IsCancelled()) {
+        return nullptr;
+    }
+
+    // The root comes with its properties
+    IUIAutomationCacheRequest* request = nullptr;
+    HRESULT hr = CreateCacheRequest(AccessibleCache::Properties, &request);
+    if (FAILED(hr)) {
+        return nullptr;
+    }
+
+    IUIAutomationElement* root = nullptr;
+    hr = m_automation->ElementFromHandleBuildCache(hwnd, request, &root);
+    request->Release();
+    if (FAILED(hr) || !root) {
+        return nullptr;
+    }
+    return std::make_shared<UIAutomationAccessibleElement>(*this, root, AccessibleCache::Properties);
+}
+
+ElementPathCache& UIAutomationHelper::GetPathCache() {
+    static ElementPathCache cache;
+    return cache;
+}
+
+ElementPathScope UIAutomationHelper::GetPathScope(HWND hwnd) {
+    ElementPathScope scope;
+    scope.cache = &GetPathCache();
+    scope.window = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(hwnd));
+    return scope;
+}
+
+bool UIAutomationHelper::ReadProperties(IUIAutomationElement* element,
+                                        AccessibleProperties& properties) {
+    if (!element || !m_automation) {
+        return false;
+    }
+
+    IUIAutomationCacheRequest* request = nullptr;
+    HRESULT hr = CreateCacheRequest(AccessibleCache::Properties, &request);
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    IUIAutomationElement* cached = nullptr;
+    hr = element->BuildUpdatedCache(request, &cached);
+    request->Release();
+    if (FAILED(hr) || !cached) {
+        return false;
+    }
+
+    ReadCachedProperties(cached, properties);
+    cached->Release();
+    return true;
+}
+
+void UIAutomationHelper::ReadCachedProperties(IUIAutomationElement* element,
+                                              AccessibleProperties& properties) {
     if (!element) {
+        return;
+    }
+
+    BSTR text = nullptr;
+    if (SUCCEEDED(element->get_CachedName(&text))) {
+        properties.name = BstrToWstring(text);
+    }
+    text = nullptr;
+    if (SUCCEEDED(element->get_CachedAutomationId(&text))) {
+        properties.automationId = BstrToWstring(text);
+    }
+
+    CONTROLTYPEID controlType = 0;
+    if (SUCCEEDED(element->get_CachedControlType(&controlType))) {
+        properties.controlType = controlType;
+    }
+
+    RECT rect = {};
+    if (SUCCEEDED(element->get_CachedBoundingRectangle(&rect))) {
+        properties.rect.left = rect.left;
+        properties.rect.top = rect.top;
+        properties.rect.right = rect.right;
+        properties.rect.bottom = rect.bottom;
+    }
+}
+
+HRESULT UIAutomationHelper::CreateQueryCondition(const AccessibleQuery& query,
+                                                 IUIAutomationCondition** condition) {
+    if (!condition) {
+        return E_POINTER;
+    }
+    *condition = nullptr;
+    if (!m_automation) {
+        return E_FAIL;
+    }
+
+    IUIAutomationCondition* parts[3] = {};
+    int count = 0;
+    HRESULT hr = S_OK;
+
+    if (query.controlType != 0) {
+        hr = CreateControlTypeCondition(query.controlType, &parts[count]);
+        if (SUCCEEDED(hr)) {
+            count++;
+        }
+    }
+
+    const std::pair<PROPERTYID, const std::wstring*> strings[] = {
+        {UIA_AutomationIdPropertyId, &query.automationId},
+        {UIA_NamePropertyId, &query.name},
+    };
+    for (const auto& property : strings) {
+        if (FAILED(hr) || property.second->empty()) {
+            continue;
+        }
+        VARIANT value;
+        value.vt = VT_BSTR;
+        value.bstrVal = SysAllocString(property.second->c_str());
+        hr = m_automation->CreatePropertyCondition(property.first, value, &parts[count]);
+        SysFreeString(value.bstrVal);
+        if (SUCCEEDED(hr)) {
+            count++;
+        }
+    }
+
+    if (SUCCEEDED(hr)) {
+        if (count == 0) {
+            hr = CreateTrueCondition(condition);
+        } else if (count == 1) {
+            *condition = parts[0];
+            parts[0] = nullptr;
+        } else {
+            hr = m_automation->CreateAndConditionFromNativeArray(parts, count, condition);
+        }
+    }
+
+    for (IUIAutomationCondition* part : parts) {
+        if (part) {
+            part->Release();
+        }
+    }
+    return hr;
+}
+
+std::wstring UIAutomationHelper::GetElementValue(IUIAutomationElement* element) {
+    if (!element || IsCancelled()) {
         return L"";
     }
 
@@ -286,51 +851,8 @@ std::wstring UIAutomationHelper::GetElementText(IUIAutomationElement* element) {
 }
 
 CONTROLTYPEID UIAutomationHelper::GetControlTypeId(const std::wstring& typeName) {
-    // Map common control type names to IDs
-    std::wstring lower = typeName;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::towlower);
-
-    if (lower == L"button") return UIA_ButtonControlTypeId;
-    if (lower == L"calendar") return UIA_CalendarControlTypeId;
-    if (lower == L"checkbox") return UIA_CheckBoxControlTypeId;
-    if (lower == L"combobox") return UIA_ComboBoxControlTypeId;
-    if (lower == L"edit") return UIA_EditControlTypeId;
-    if (lower == L"hyperlink") return UIA_HyperlinkControlTypeId;
-    if (lower == L"image") return UIA_ImageControlTypeId;
-    if (lower == L"listitem") return UIA_ListItemControlTypeId;
-    if (lower == L"list") return UIA_ListControlTypeId;
-    if (lower == L"menu") return UIA_MenuControlTypeId;
-    if (lower == L"menubar") return UIA_MenuBarControlTypeId;
-    if (lower == L"menuitem") return UIA_MenuItemControlTypeId;
-    if (lower == L"progressbar") return UIA_ProgressBarControlTypeId;
-    if (lower == L"radiobutton") return UIA_RadioButtonControlTypeId;
-    if (lower == L"scrollbar") return UIA_ScrollBarControlTypeId;
-    if (lower == L"slider") return UIA_SliderControlTypeId;
-    if (lower == L"spinner") return UIA_SpinnerControlTypeId;
-    if (lower == L"statusbar") return UIA_StatusBarControlTypeId;
-    if (lower == L"tab") return UIA_TabControlTypeId;
-    if (lower == L"tabitem") return UIA_TabItemControlTypeId;
-    if (lower == L"text") return UIA_TextControlTypeId;
-    if (lower == L"toolbar") return UIA_ToolBarControlTypeId;
-    if (lower == L"tooltip") return UIA_ToolTipControlTypeId;
-    if (lower == L"tree") return UIA_TreeControlTypeId;
-    if (lower == L"treeitem") return UIA_TreeItemControlTypeId;
-    if (lower == L"custom") return UIA_CustomControlTypeId;
-    if (lower == L"group") return UIA_GroupControlTypeId;
-    if (lower == L"thumb") return UIA_ThumbControlTypeId;
-    if (lower == L"datagrid") return UIA_DataGridControlTypeId;
-    if (lower == L"dataitem") return UIA_DataItemControlTypeId;
-    if (lower == L"document") return UIA_DocumentControlTypeId;
-    if (lower == L"splitbutton") return UIA_SplitButtonControlTypeId;
-    if (lower == L"window") return UIA_WindowControlTypeId;
-    if (lower == L"pane") return UIA_PaneControlTypeId;
-    if (lower == L"header") return UIA_HeaderControlTypeId;
-    if (lower == L"headeritem") return UIA_HeaderItemControlTypeId;
-    if (lower == L"table") return UIA_TableControlTypeId;
-    if (lower == L"titlebar") return UIA_TitleBarControlTypeId;
-    if (lower == L"separator") return UIA_SeparatorControlTypeId;
-
-    return 0;  // Unknown type
+    // Same names as snapshots use ("Edit", "button", ...); 0 if unknown
+    return AccessibleControlType::FromName(typeName);
 }
 
 std::wstring UIAutomationHelper::BstrToWstring(BSTR bstr) {
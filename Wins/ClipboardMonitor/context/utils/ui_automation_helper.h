@@ -5,6 +5,95 @@
 #include <UIAutomation.h>
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include "../cancellation_token.h"
+#include "accessible_tree.h"
+#include "element_path_cache.h"
+
+/**
+ * @brief Per-thread UI Automation state
+ *
+ * Owns the thread's COM apartment, one IUIAutomation instance and the
+ * conditions and cache requests adapters build on every fetch. AsyncExecutor workers attach
+ * once at thread start (via ContextManager's worker hooks) and detach at
+ * exit; UIAutomationHelper instances on an attached thread borrow from it
+ * instead of running CoInitializeEx + CoCreateInstance per copy.
+ *
+ * Thread Safety:
+ * - One context per thread; Current() only ever returns the calling
+ *   thread's context, so no locking is needed
+ */
+class UIAutomationThreadContext {
+public:
+    /**
+     * @brief Attach a context to the calling thread
+     *
+     * Initializes COM (apartment-threaded), creates the IUIAutomation
+     * instance and pre-builds the common conditions and the cache
+     * requests. Idempotent.
+     *
+     * @return true if the thread now has a usable context
+     */
+    static bool Attach();
+
+    /**
+     * @brief Release the calling thread's context and uninitialize COM
+     */
+    static void Detach();
+
+    /**
+     * @brief Get the calling thread's context
+     *
+     * @return Context, or nullptr if the thread never attached
+     */
+    static UIAutomationThreadContext* Current();
+
+    ~UIAutomationThreadContext();
+
+    // Disable copy
+    UIAutomationThreadContext(const UIAutomationThreadContext&) = delete;
+    UIAutomationThreadContext& operator=(const UIAutomationThreadContext&) = delete;
+
+    /**
+     * @brief Get the thread's automation instance (owned by the context)
+     */
+    IUIAutomation* GetAutomation() const { return m_automation; }
+
+    /**
+     * @brief Get the condition matching every element (owned by the context)
+     */
+    IUIAutomationCondition* GetTrueCondition() const { return m_trueCondition; }
+
+    /**
+     * @brief Get a ControlType property condition (owned by the context)
+     *
+     * Common types are built at attach time; others on first use.
+     *
+     * @param controlTypeId Control type (e.g., UIA_TextControlTypeId)
+     * @return Condition, or nullptr if it could not be created
+     */
+    IUIAutomationCondition* GetControlTypeCondition(CONTROLTYPEID controlTypeId);
+
+    /**
+     * @brief Get the cache request for what a search fetches (owned by the context)
+     *
+     * @param cache Properties or Children
+     * @return Cache request, or nullptr for AccessibleCache::None
+     */
+    IUIAutomationCacheRequest* GetCacheRequest(AccessibleCache cache) const;
+
+private:
+    UIAutomationThreadContext();
+
+    bool Initialize();
+
+    IUIAutomation* m_automation;
+    IUIAutomationCondition* m_trueCondition;
+    std::unordered_map<CONTROLTYPEID, IUIAutomationCondition*> m_controlTypeConditions;
+    IUIAutomationCacheRequest* m_propertiesRequest;
+    IUIAutomationCacheRequest* m_childrenRequest;
+    bool m_comInitialized;
+};
 
 /**
  * @brief UI Automation Helper
@@ -13,11 +102,21 @@
  * This class encapsulates COM initialization and UI element discovery.
  *
  * Key Features:
- * - Automatic COM initialization and cleanup
+ * - Borrows the thread's UIAutomationThreadContext when attached (executor
+ *   workers); otherwise initializes COM and its own instance, and cleans up
  * - Element search by role, name, and automation ID
  * - Property extraction (text, value)
+ * - Batched property retrieval: searches fetch Name, AutomationId,
+ *   ControlType and bounds of every result in the same round trip
+ *   (FindAllBuildCache), and optionally their children
+ * - IAccessibleElement backend (GetWindowElement) for the adapters'
+ *   element scans, and the process-wide path cache of found elements
  * - RAII pattern for resource management
  *
+ * Cancellation:
+ * - Constructed with the fetch's CancellationToken; searches stop between
+ *   tree operations once it is cancelled and return nullptr / empty
+ *
  * Thread Safety:
  * - Each instance must be created in a COM-initialized thread
  * - Do NOT share instances across threads
@@ -28,15 +127,17 @@ public:
     /**
      * @brief Constructor
      *
-     * Initializes COM (if not already initialized) and creates UI Automation instance.
-     * Call Initialize() after construction to check if initialization succeeded.
+     * Nothing is created until Initialize().
+     *
+     * @param token Cancellation token of the current fetch (must outlive the helper)
      */
-    UIAutomationHelper();
+    explicit UIAutomationHelper(const CancellationToken& token = CancellationToken::None());
 
     /**
      * @brief Destructor
      *
-     * Releases all COM resources and uninitializes COM if it was initialized by this instance.
+     * Releases its own COM resources and uninitializes COM if it was initialized
+     * by this instance. Borrowed thread context resources are left alone.
      */
     ~UIAutomationHelper();
 
@@ -47,6 +148,9 @@ public:
     /**
      * @brief Initialize the helper
      *
+     * Uses the thread's UIAutomationThreadContext if there is one, otherwise
+     * initializes COM and creates a UI Automation instance for this helper.
+     *
      * @return true if UI Automation is ready to use, false otherwise
      */
     bool Initialize();
@@ -58,6 +162,20 @@ public:
      */
     bool IsInitialized() const { return m_automation != nullptr; }
 
+    /**
+     * @brief Check if the current fetch has been cancelled
+     *
+     * Adapters walking element arrays themselves should check this per element.
+     *
+     * @return true if the caller should stop and return what it has
+     */
+    bool IsCancelled() const { return m_token.IsCancelled(); }
+
+    /**
+     * @brief Get the current fetch's cancellation token (for element scans)
+     */
+    const CancellationToken& GetToken() const { return m_token; }
+
     /**
      * @brief Find element by control type name
      *
@@ -73,6 +191,11 @@ public:
     /**
      * @brief Find element by name (case-insensitive partial match)
      *
+     * Budgeted breadth-first search (AccessibleSearch), so the shallowest
+     * match wins and huge trees are not fetched whole. Not exhaustive: it
+     * gives up after 5000 elements or 200 ms and returns nullptr even if a
+     * deeper element would have matched.
+     *
      * @param hwnd Window handle to search in
      * @param namePart Part of the element name to search for
      * @return Element if found, nullptr otherwise
@@ -90,6 +213,76 @@ public:
     IUIAutomationElement* FindElementByAutomationId(HWND hwnd,
                                                      const std::wstring& automationId);
 
+    /**
+     * @brief Get a window's root as an accessibility-tree element
+     *
+     * Searches through the returned element (and every element found from
+     * it) honour this helper's cancellation token. Elements borrow the
+     * helper: drop them before it is destroyed.
+     *
+     * @param hwnd Window handle
+     * @return Root element, or nullptr if the window has none
+     */
+    AccessibleElementPtr GetWindowElement(HWND hwnd);
+
+    /**
+     * @brief Get the process-wide cache of element paths
+     *
+     * Shared by all helpers and threads (paths, not element handles).
+     */
+    static ElementPathCache& GetPathCache();
+
+    /**
+     * @brief Get a window's view of the path cache, for the element scans
+     *
+     * @param hwnd Window handle (the cache key)
+     */
+    static ElementPathScope GetPathScope(HWND hwnd);
+
+    /**
+     * @brief Read an element's Name, AutomationId, ControlType and bounds
+     *
+     * One round trip (BuildUpdatedCache) for all four properties.
+     *
+     * @param element UI element
+     * @param properties Output: the properties (left default on failure)
+     * @return true if the properties were read
+     */
+    bool ReadProperties(IUIAutomationElement* element, AccessibleProperties& properties);
+
+    /**
+     * @brief Read the properties cached with an element (no round trip)
+     *
+     * @param element Element returned with a Properties or Children cache request
+     * @param properties Output: the properties (fields not cached are left alone)
+     */
+    void ReadCachedProperties(IUIAutomationElement* element, AccessibleProperties& properties);
+
+    /**
+     * @brief Get the cache request for what a search fetches
+     *
+     * Properties: Name, AutomationId, ControlType and BoundingRectangle.
+     * Children: the same, for the element and its raw-view children.
+     * Served from the thread context when available.
+     *
+     * @param cache Properties or Children
+     * @param request Receives the request; caller must Release() it
+     * @return S_OK on success, or the failing HRESULT (E_INVALIDARG for None)
+     */
+    HRESULT CreateCacheRequest(AccessibleCache cache, IUIAutomationCacheRequest** request);
+
+    /**
+     * @brief Build the provider-side condition for a query
+     *
+     * ControlType, AutomationId and Name property conditions, ANDed; the
+     * true condition for an empty query.
+     *
+     * @param query Query to translate
+     * @param condition Receives the condition; caller must Release() it
+     * @return S_OK on success, or the failing HRESULT
+     */
+    HRESULT CreateQueryCondition(const AccessibleQuery& query, IUIAutomationCondition** condition);
+
     /**
      * @brief Get element's value (for input controls)
      *
@@ -113,6 +306,26 @@ public:
      */
     IUIAutomation* GetAutomation() { return m_automation; }
 
+    /**
+     * @brief Get a ControlType property condition
+     *
+     * Served from the thread context's pre-built conditions when available.
+     *
+     * @param controlTypeId Control type (e.g., UIA_TextControlTypeId)
+     * @param condition Receives the condition; caller must Release() it
+     * @return S_OK on success, or the failing HRESULT
+     */
+    HRESULT CreateControlTypeCondition(CONTROLTYPEID controlTypeId,
+                                       IUIAutomationCondition** condition);
+
+    /**
+     * @brief Get a condition matching every element
+     *
+     * @param condition Receives the condition; caller must Release() it
+     * @return S_OK on success, or the failing HRESULT
+     */
+    HRESULT CreateTrueCondition(IUIAutomationCondition** condition);
+
 private:
     /**
      * @brief Get control type ID from name
@@ -131,7 +344,11 @@ private:
     std::wstring BstrToWstring(BSTR bstr);
 
     IUIAutomation* m_automation;
+    UIAutomationThreadContext* m_threadContext;   // Non-null when borrowing
+    IUIAutomationCacheRequest* m_propertiesRequest;   // Own cache requests, built on first use
+    IUIAutomationCacheRequest* m_childrenRequest;
     bool m_comInitialized;
+    const CancellationToken& m_token;
 };
 
 /**
@@ -0,0 +1,62 @@
+#include "win_event_foreground_source.h"
+#include "../debug_log.h"
+
+WinEventForegroundSource* WinEventForegroundSource::s_active = nullptr;
+
+WinEventForegroundSource::WinEventForegroundSource()
+    : m_hook(nullptr)
+{
+}
+
+WinEventForegroundSource::~WinEventForegroundSource() {
+    Stop();
+}
+
+bool WinEventForegroundSource::Start(Callback callback) {
+    Stop();
+    if (s_active) {
+        LOG_WARN("Foreground hook already installed by another source");
+        return false;
+    }
+
+    m_callback = std::move(callback);
+    m_hook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND,
+                             nullptr, HookProc, 0, 0,
+                             WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+    if (!m_hook) {
+        LOG_ERROR("SetWinEventHook(EVENT_SYSTEM_FOREGROUND) failed: {}", GetLastError());
+        m_callback = nullptr;
+        return false;
+    }
+
+    s_active = this;
+    LOG_INFO("Foreground hook installed");
+    return true;
+}
+
+void WinEventForegroundSource::Stop() {
+    if (m_hook) {
+        UnhookWinEvent(m_hook);
+        m_hook = nullptr;
+    }
+    if (s_active == this) {
+        s_active = nullptr;
+    }
+    m_callback = nullptr;
+}
+
+void CALLBACK WinEventForegroundSource::HookProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+                                                 LONG idObject, LONG idChild,
+                                                 DWORD eventThread, DWORD eventTime) {
+    (void)hook;
+    (void)eventThread;
+    (void)eventTime;
+
+    if (event != EVENT_SYSTEM_FOREGROUND || idObject != OBJID_WINDOW ||
+        idChild != CHILDID_SELF || !hwnd) {
+        return;
+    }
+    if (s_active && s_active->m_callback) {
+        s_active->m_callback(hwnd);
+    }
+}
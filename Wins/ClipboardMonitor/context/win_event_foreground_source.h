@@ -0,0 +1,34 @@
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <windows.h>
+#include "foreground_source.h"
+
+// EVENT_SYSTEM_FOREGROUND through an out-of-context WinEvent hook.
+// Start it on a thread that pumps messages (events arrive through its
+// queue). One instance at a time: the hook procedure has no user data.
+class WinEventForegroundSource : public IForegroundSource {
+public:
+    WinEventForegroundSource();
+    ~WinEventForegroundSource() override;
+
+    // Disable copy
+    WinEventForegroundSource(const WinEventForegroundSource&) = delete;
+    WinEventForegroundSource& operator=(const WinEventForegroundSource&) = delete;
+
+    bool Start(Callback callback) override;
+    void Stop() override;
+
+private:
+    static void CALLBACK HookProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+                                  LONG idObject, LONG idChild,
+                                  DWORD eventThread, DWORD eventTime);
+
+    static WinEventForegroundSource* s_active;
+
+    HWINEVENTHOOK m_hook;
+    Callback m_callback;
+};
@@ -1,20 +1,116 @@
 #pragma once
 
 #include <string>
-#include <fstream>
 #include <mutex>
+#include <atomic>
+#include <cstdio>
+#include <type_traits>
 
-#ifndef WIN32_LEAN_AND_MEAN
-#define WIN32_LEAN_AND_MEAN
+#include "utils.h"
+#include "log_events.h"
+#include "binary_log.h"
+#include "log_writer.h"
+
+// Output format of the debug log
+enum class LogMode {
+    Text,    // debug.log, one formatted line per message
+    Binary   // debug.bin, event ID + raw arguments (decode with tools/log_decoder)
+};
+
+// Compile-time floor: calls below this level are compiled out entirely.
+// Override with /DGLIMPSE_LOG_MIN_LEVEL=2 to strip Trace and Debug from a build.
+#ifndef GLIMPSE_LOG_MIN_LEVEL
+#define GLIMPSE_LOG_MIN_LEVEL 0
 #endif
-#include <windows.h>
 
-// Forward declaration
-namespace Utils {
-    std::string GetTimestamp();
-    std::string WideToUtf8(const std::wstring& wstr);
-    std::wstring GetAppDataPath();
+// Deferred, type-safe "{}" formatting for log messages.
+// Placeholders may carry a field name ("{fetch_ms}"); it is ignored here and
+// only used by the structured event table. Only runs after the level check.
+namespace LogFormat {
+
+inline void AppendArg(std::string& out, const std::string& value) { out += value; }
+inline void AppendArg(std::string& out, const char* value) { out += value ? value : "(null)"; }
+inline void AppendArg(std::string& out, const std::wstring& value) { out += Utils::WideToUtf8(value); }
+inline void AppendArg(std::string& out, const wchar_t* value) {
+    if (value) out += Utils::WideToUtf8(value);
 }
+inline void AppendArg(std::string& out, bool value) { out += value ? "true" : "false"; }
+inline void AppendArg(std::string& out, char value) { out += value; }
+
+template<typename T>
+std::enable_if_t<std::is_integral_v<T>> AppendArg(std::string& out, T value) {
+    out += std::to_string(value);
+}
+
+template<typename T>
+std::enable_if_t<std::is_floating_point_v<T>> AppendArg(std::string& out, T value) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.2f", static_cast<double>(value));
+    out += buf;
+}
+
+template<typename T>
+std::enable_if_t<std::is_enum_v<T>> AppendArg(std::string& out, T value) {
+    out += std::to_string(static_cast<std::underlying_type_t<T>>(value));
+}
+
+template<typename T>
+void AppendArg(std::string& out, T* value) {
+    if constexpr (std::is_same_v<std::remove_cv_t<T>, char>) {
+        AppendArg(out, static_cast<const char*>(value));
+    } else if constexpr (std::is_same_v<std::remove_cv_t<T>, wchar_t>) {
+        AppendArg(out, static_cast<const wchar_t*>(value));
+    } else {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%p", static_cast<const void*>(value));
+        out += buf;
+    }
+}
+
+// Length of a "{}" or "{field_name}" placeholder at p, or 0 if there is none
+inline size_t PlaceholderLength(const char* p) {
+    if (*p != '{') return 0;
+    size_t i = 1;
+    while ((p[i] >= 'a' && p[i] <= 'z') || (p[i] >= '0' && p[i] <= '9') || p[i] == '_') {
+        ++i;
+    }
+    return p[i] == '}' ? i + 1 : 0;
+}
+
+// Copy fmt into out up to the next placeholder; returns the remainder
+inline const char* AppendUntilPlaceholder(std::string& out, const char* fmt) {
+    while (*fmt) {
+        if (size_t length = PlaceholderLength(fmt)) {
+            return fmt + length;
+        }
+        out += *fmt++;
+    }
+    return nullptr;
+}
+
+inline void FormatInto(std::string& out, const char* fmt) {
+    out += fmt;
+}
+
+template<typename First, typename... Rest>
+void FormatInto(std::string& out, const char* fmt, const First& first, const Rest&... rest) {
+    const char* remainder = AppendUntilPlaceholder(out, fmt);
+    if (!remainder) {
+        return;  // More arguments than placeholders
+    }
+    AppendArg(out, first);
+    FormatInto(out, remainder, rest...);
+}
+
+template<typename... Args>
+std::string Format(const char* fmt, const Args&... args) {
+    std::string out;
+    out.reserve(128);
+    FormatInto(out, fmt, args...);
+    return out;
+}
+
+} // namespace LogFormat
 
 class DebugLog {
 public:
@@ -22,54 +118,169 @@ public:
         static DebugLog instance;
         return instance;
     }
-    
-    void Initialize(const std::wstring& directory) {
+
+    // Runtime level check - a single relaxed load, safe to call from any thread
+    static bool IsEnabled(LogLevel level) {
+        return static_cast<int>(level) >= s_runtimeLevel.load(std::memory_order_relaxed);
+    }
+
+    static void SetLevel(LogLevel level) {
+        s_runtimeLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    static LogLevel GetLevel() {
+        return static_cast<LogLevel>(s_runtimeLevel.load(std::memory_order_relaxed));
+    }
+
+    // Parse "trace" / "debug" / "info" / "warn" / "error" / "off" (config.json log_level)
+    static LogLevel ParseLevel(const std::string& name, LogLevel fallback = LogLevel::Debug) {
+        if (name == "trace") return LogLevel::Trace;
+        if (name == "debug") return LogLevel::Debug;
+        if (name == "info")  return LogLevel::Info;
+        if (name == "warn" || name == "warning") return LogLevel::Warn;
+        if (name == "error") return LogLevel::Error;
+        if (name == "off")   return LogLevel::Off;
+        return fallback;
+    }
+
+    static const char* LevelTag(LogLevel level) {
+        return GetLogLevelTag(level);
+    }
+
+    // Both modes write through a memory-mapped file; a background thread
+    // flushes and rotates it (debug.log -> debug.1.log -> ...) per policy
+    void Initialize(const std::wstring& directory, LogMode mode = LogMode::Text,
+                    const LogRotationPolicy& rotation = LogRotationPolicy()) {
         std::lock_guard<std::recursive_mutex> lock(m_mutex);
-        std::wstring logPath = directory + L"\\debug.log";
-        m_file.open(logPath, std::ios::out | std::ios::app);
-        if (m_file.is_open()) {
+        if (mode == LogMode::Binary) {
+            if (m_binary.Open(directory + L"\\debug.bin", rotation)) {
+                m_binaryMode = true;
+                m_initialized = true;
+                WriteLog(LogLevel::Info, "=== ClipboardMonitor Started ===");
+                return;
+            }
+            // Fall back to the text log if debug.bin cannot be opened
+        }
+
+        if (m_text.Open(directory + L"\\debug.log", rotation, std::string(), true)) {
             m_initialized = true;
-            WriteLog("=== ClipboardMonitor Started ===");
+            WriteLog(LogLevel::Info, "=== ClipboardMonitor Started ===");
         }
     }
-    
+
     void Log(const std::string& message) {
-        std::lock_guard<std::recursive_mutex> lock(m_mutex);
-        WriteLog(message);
+        Log(LogLevel::Debug, message);
     }
-    
+
     void Log(const std::wstring& message) {
-        Log(Utils::WideToUtf8(message));
+        Log(LogLevel::Debug, Utils::WideToUtf8(message));
+    }
+
+    void Log(LogLevel level, const std::string& message) {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        WriteLog(level, message);
+    }
+
+    // Format and write; callers go through the LOG_* macros so that
+    // arguments are only evaluated when the level is enabled
+    template<typename... Args>
+    void Write(LogLevel level, const char* fmt, const Args&... args) {
+        Log(level, LogFormat::Format(fmt, args...));
     }
-    
+
+    // Structured event (see log_events.h). Binary mode stores the event ID and
+    // raw arguments without formatting; text mode renders the event's format.
+    template<typename... Args>
+    void WriteEvent(LogEventId id, const Args&... args) {
+        const LogEventInfo& info = GetLogEventInfo(id);
+        if (m_binaryMode) {
+            m_binary.Append(id, info.level, args...);
+            return;
+        }
+        Log(info.level, LogFormat::Format(info.format, args...));
+    }
+
     void Close() {
         std::lock_guard<std::recursive_mutex> lock(m_mutex);
-        if (m_file.is_open()) {
-            WriteLog("=== ClipboardMonitor Stopped ===");
-            m_file.close();
+        if (m_binaryMode) {
+            WriteLog(LogLevel::Info, "=== ClipboardMonitor Stopped ===");
+            m_binary.Close();
+            m_binaryMode = false;
+            m_initialized = false;
+            return;
+        }
+        if (m_text.IsOpen()) {
+            WriteLog(LogLevel::Info, "=== ClipboardMonitor Stopped ===");
+            m_text.Close();
             m_initialized = false;
         }
     }
-    
+
 private:
-    void WriteLog(const std::string& message) {
-        if (!m_initialized || !m_file.is_open()) return;
-        m_file << "[" << Utils::GetTimestamp() << "] " << message << std::endl;
-        m_file.flush();
-    }
-    
-    DebugLog() : m_initialized(false) {}
-    ~DebugLog() { 
-        if (m_file.is_open()) {
-            m_file << "[SHUTDOWN] ClipboardMonitor exiting" << std::endl;
-            m_file.close();
+    void WriteLog(LogLevel level, const std::string& message) {
+        if (m_binaryMode) {
+            m_binary.Append(LogEventId::Text, level, message);
+            return;
+        }
+        if (!m_initialized || !m_text.IsOpen()) return;
+
+        std::string line;
+        line.reserve(message.size() + 48);
+        line += "[";
+        line += Utils::GetTimestamp();
+        line += "] [";
+        line += LevelTag(level);
+        line += "] ";
+        line += message;
+        line += "\r\n";
+        m_text.Append(line);
+    }
+
+    DebugLog() : m_initialized(false), m_binaryMode(false) {}
+    ~DebugLog() {
+        if (m_text.IsOpen()) {
+            m_text.Append("[SHUTDOWN] ClipboardMonitor exiting\r\n");
+            m_text.Close();
         }
     }
-    
-    std::ofstream m_file;
+
+    AsyncLogWriter m_text;
+    BinaryLogWriter m_binary;
     std::recursive_mutex m_mutex;
     bool m_initialized;
+    std::atomic<bool> m_binaryMode;  // Set once in Initialize, read lock-free by WriteEvent
+
+    static inline std::atomic<int> s_runtimeLevel{static_cast<int>(LogLevel::Debug)};
 };
 
-#define DEBUG_LOG(msg) DebugLog::Instance().Log(msg)
+// True when a message at this level would be written; use to guard
+// log-only work such as enumerating clipboard formats
+#define LOG_ENABLED(level) \
+    (static_cast<int>(level) >= GLIMPSE_LOG_MIN_LEVEL && DebugLog::IsEnabled(level))
+
+// Leveled logging: LOG_INFO("Seq: {} -> {}", prev, cur)
+// Arguments are not evaluated unless the level is enabled.
+#define GLIMPSE_LOG(level, ...)                                   \
+    do {                                                          \
+        if (LOG_ENABLED(level)) {                                 \
+            DebugLog::Instance().Write(level, __VA_ARGS__);       \
+        }                                                         \
+    } while (0)
+
+#define LOG_TRACE(...) GLIMPSE_LOG(LogLevel::Trace, __VA_ARGS__)
+#define LOG_DEBUG(...) GLIMPSE_LOG(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...)  GLIMPSE_LOG(LogLevel::Info,  __VA_ARGS__)
+#define LOG_WARN(...)  GLIMPSE_LOG(LogLevel::Warn,  __VA_ARGS__)
+#define LOG_ERROR(...) GLIMPSE_LOG(LogLevel::Error, __VA_ARGS__)
+
+// Structured event at the level declared in log_events.h:
+// LOG_EVENT(SequenceChanged, prevSeq, curSeq)
+#define LOG_EVENT(event, ...)                                                     \
+    do {                                                                          \
+        if (LOG_ENABLED(GetLogEventLevel(LogEventId::event))) {                   \
+            DebugLog::Instance().WriteEvent(LogEventId::event, ##__VA_ARGS__);    \
+        }                                                                         \
+    } while (0)
 
+// Legacy single-message form, now lazy as well
+#define DEBUG_LOG(msg) LOG_DEBUG("{}", msg)
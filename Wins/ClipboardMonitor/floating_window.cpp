@@ -85,7 +85,7 @@ bool FloatingWindow::Initialize(HINSTANCE hInstance)
     if (!RegisterClassExW(&wc)) {
         DWORD err = GetLastError();
         if (err != ERROR_CLASS_ALREADY_EXISTS) {
-            DEBUG_LOG("FloatingWindow: Failed to register class, error=" + std::to_string(err));
+            LOG_WARN("FloatingWindow: Failed to register class, error={}", err);
             return false;
         }
     }
@@ -109,14 +109,14 @@ bool FloatingWindow::Initialize(HINSTANCE hInstance)
     );
 
     if (!m_hwnd) {
-        DEBUG_LOG("FloatingWindow: Failed to create window");
+        LOG_WARN("FloatingWindow: Failed to create window");
         return false;
     }
 
     // Create child controls
     CreateControls();
 
-    DEBUG_LOG("FloatingWindow: Initialized successfully");
+    LOG_DEBUG("FloatingWindow: Initialized successfully");
     return true;
 }
 
@@ -218,14 +218,14 @@ void FloatingWindow::ShowAt(int x, int y)
     SetFocus(m_editNote);
     m_visible = true;
 
-    DEBUG_LOG("FloatingWindow: Shown at " + std::to_string(x) + "," + std::to_string(y));
+    LOG_DEBUG("FloatingWindow: Shown at {},{}", x, y);
 }
 
 void FloatingWindow::Hide()
 {
     ShowWindow(m_hwnd, SW_HIDE);
     m_visible = false;
-    DEBUG_LOG("FloatingWindow: Hidden");
+    LOG_DEBUG("FloatingWindow: Hidden");
 }
 
 bool FloatingWindow::IsVisible() const
@@ -241,7 +241,7 @@ void FloatingWindow::SetCallback(AnnotationCallback callback)
 void FloatingWindow::OnReactionClick(const std::string& reaction)
 {
     m_selectedReaction = reaction;
-    DEBUG_LOG("FloatingWindow: Reaction selected: " + reaction);
+    LOG_DEBUG("FloatingWindow: Reaction selected: {}", reaction);
 }
 
 void FloatingWindow::OnSubmit()
@@ -251,7 +251,7 @@ void FloatingWindow::OnSubmit()
         return;
     }
     
-    DEBUG_LOG("FloatingWindow: Submit");
+    LOG_DEBUG("FloatingWindow: Submit");
 
     // Check if select all is checked
     bool selectAll = (SendMessage(m_chkSelectAll, BM_GETCHECK, 0, 0) == BST_CHECKED);
@@ -277,7 +277,7 @@ void FloatingWindow::OnSubmit()
 
 void FloatingWindow::OnCancel()
 {
-    DEBUG_LOG("FloatingWindow: Cancelled");
+    LOG_DEBUG("FloatingWindow: Cancelled");
 
     AnnotationData data;
     data.cancelled = true;
@@ -291,7 +291,7 @@ void FloatingWindow::OnCancel()
 
 void FloatingWindow::PerformSelectAll()
 {
-    DEBUG_LOG("FloatingWindow: Performing Select All (Ctrl+A)");
+    LOG_DEBUG("FloatingWindow: Performing Select All (Ctrl+A)");
 
     // Hide our window first to not interfere
     ShowWindow(m_hwnd, SW_HIDE);
@@ -327,7 +327,7 @@ void FloatingWindow::PerformSelectAll()
     SendInput(4, inputs, sizeof(INPUT));
     Sleep(100);
 
-    DEBUG_LOG("FloatingWindow: Select All completed");
+    LOG_DEBUG("FloatingWindow: Select All completed");
 }
 
 std::wstring FloatingWindow::GetNoteText()
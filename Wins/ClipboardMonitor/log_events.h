@@ -0,0 +1,131 @@
+#pragma once
+
+// Structured log events shared by the app (debug_log.h) and the offline
+// decoder (tools/log_decoder). Kept free of Windows headers so the decoder
+// builds anywhere.
+
+#include <cstdint>
+#include <cstddef>
+
+// Log severity, lowest to highest
+enum class LogLevel : int {
+    Trace = 0,
+    Debug = 1,
+    Info  = 2,
+    Warn  = 3,
+    Error = 4,
+    Off   = 5
+};
+
+constexpr const char* GetLogLevelTag(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace: return "TRACE";
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info:  return "INFO";
+        case LogLevel::Warn:  return "WARN";
+        case LogLevel::Error: return "ERROR";
+        default:              return "-";
+    }
+}
+
+// Static event IDs. Append new events at the end - IDs are persisted in
+// debug.bin and must stay stable across versions.
+enum class LogEventId : uint16_t {
+    Text = 0,            // Free-form message (everything not listed below)
+    SequenceChanged,
+    SourceInfo,
+    ClipboardContent,
+    ClipboardFormats,
+    ClipboardOpened,
+    AdapterCompleted,
+    ContextAttached,
+    ContextTimeout,
+    ContextCacheHit,
+    ContextQuick,
+    CircuitBreakerState,
+    ContextShed,
+    ContextPrefetch,
+    Count
+};
+
+// Event description: "{name}" placeholders are filled positionally when
+// rendering text and give the field names for machine-readable output.
+struct LogEventInfo {
+    LogEventId id;
+    const char* name;
+    LogLevel level;
+    const char* format;
+};
+
+inline constexpr LogEventInfo kLogEvents[] = {
+    {LogEventId::Text,             "Text",             LogLevel::Debug, "{message}"},
+    {LogEventId::SequenceChanged,  "SequenceChanged",  LogLevel::Debug, "Seq: {from} -> {to}"},
+    {LogEventId::SourceInfo,       "SourceInfo",       LogLevel::Debug, "Source: {process} | {title}"},
+    {LogEventId::ClipboardContent, "ClipboardContent", LogLevel::Debug, "OK: {type} | {preview}"},
+    {LogEventId::ClipboardFormats, "ClipboardFormats", LogLevel::Trace, "Available formats: {formats}(total: {count})"},
+    {LogEventId::ClipboardOpened,  "ClipboardOpened",  LogLevel::Debug, "Clipboard opened after {retry_ms}ms"},
+    {LogEventId::AdapterCompleted, "AdapterCompleted", LogLevel::Info,  "{adapter}: Completed in {fetch_ms}ms, success={success}"},
+    {LogEventId::ContextAttached,  "ContextAttached",  LogLevel::Debug, "Context: {adapter}, success={success}, time={fetch_ms}ms"},
+    {LogEventId::ContextTimeout,   "ContextTimeout",   LogLevel::Warn,  "Context fetch timeout"},
+    {LogEventId::ContextCacheHit,  "ContextCacheHit",  LogLevel::Debug, "Context cache {state}: {adapter}, age={age_ms}ms"},
+    {LogEventId::ContextQuick,     "ContextQuick",     LogLevel::Debug, "Quick context: {adapter}, success={success}, time={fetch_us}us"},
+    {LogEventId::CircuitBreakerState, "CircuitBreakerState", LogLevel::Info, "Circuit breaker {adapter}: {from} -> {to} ({failures}/{requests} failed)"},
+    {LogEventId::ContextShed,      "ContextShed",      LogLevel::Debug, "Deep context skipped: {adapter}, {reason}"},
+    {LogEventId::ContextPrefetch,  "ContextPrefetch",  LogLevel::Debug, "Prefetch {adapter}: {outcome}"},
+};
+
+static_assert(sizeof(kLogEvents) / sizeof(kLogEvents[0]) == static_cast<size_t>(LogEventId::Count),
+              "kLogEvents must list every LogEventId in order");
+
+constexpr const LogEventInfo& GetLogEventInfo(LogEventId id) {
+    return kLogEvents[static_cast<size_t>(id)];
+}
+
+constexpr LogLevel GetLogEventLevel(LogEventId id) {
+    return kLogEvents[static_cast<size_t>(id)].level;
+}
+
+// Binary log wire format (little-endian)
+//
+// File header:
+//   char[4]  magic "GLB1"
+//   uint16   version
+//   uint16   reserved
+//   int64    wall clock at open, microseconds since Unix epoch
+//   int32    local UTC offset at open, minutes
+//   int32    reserved
+//
+// Record:
+//   uint16   event id
+//   uint8    level
+//   uint8    argument count
+//   uint32   thread id
+//   uint64   nanoseconds since the header's wall clock
+//   args...  each: uint8 tag, then payload
+//
+// Argument payloads by tag:
+//   U64 / I64 / F64: 8 bytes
+//   Bool:            1 byte
+//   Str:             uint32 byte length + UTF-8 bytes
+//   WStr:            uint32 code unit count + UTF-16 code units (transcoded offline)
+//
+// The file is written through a memory-mapped view. After a crash it may hold
+// a run of zero bytes (unused mapping) before the next session header; an
+// all-zero record header is never valid, so readers skip the run.
+namespace BinaryLogFormat {
+
+constexpr char kMagic[4] = {'G', 'L', 'B', '1'};
+constexpr uint16_t kVersion = 1;
+constexpr size_t kHeaderSize = 24;
+constexpr size_t kRecordHeaderSize = 16;
+
+enum class ArgTag : uint8_t {
+    U64  = 1,
+    I64  = 2,
+    F64  = 3,
+    Bool = 4,
+    Str  = 5,
+    WStr = 6
+};
+
+} // namespace BinaryLogFormat
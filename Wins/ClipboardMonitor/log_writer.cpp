@@ -0,0 +1,550 @@
+#include "log_writer.h"
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#include "utils.h"
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// File growth step for the mapped view
+constexpr uint64_t kMapChunkBytes = 1024 * 1024;
+
+// Flush when this much is pending, or after the interval below
+constexpr size_t kFlushThresholdBytes = 64 * 1024;
+constexpr auto kFlushInterval = std::chrono::milliseconds(200);
+
+// After a failed rotation (e.g. a viewer holds the file open), wait before retrying
+constexpr auto kRotateRetryInterval = std::chrono::minutes(1);
+
+// While the file cannot be (re)opened, retry this often
+constexpr auto kReopenRetryInterval = std::chrono::seconds(5);
+
+#ifdef _WIN32
+
+std::chrono::system_clock::time_point FileTimeToTimePoint(const FILETIME& ft) {
+    // FILETIME counts 100ns intervals since 1601-01-01
+    constexpr uint64_t kUnixEpochTicks = 116444736000000000ULL;
+    uint64_t ticks = (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    if (ticks < kUnixEpochTicks) {
+        return std::chrono::system_clock::now();
+    }
+    auto sinceEpoch = std::chrono::microseconds((ticks - kUnixEpochTicks) / 10);
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(sinceEpoch));
+}
+
+// The log cannot record its own failures: tell an attached debugger
+// (or DebugView) instead
+void ReportFailure(const std::wstring& path, const std::wstring& what) {
+    std::wstring message = L"[ClipboardMonitor] " + path + L": " + what + L"\n";
+    OutputDebugStringW(message.c_str());
+}
+
+bool SetFileEnd(HANDLE file, uint64_t size) {
+    LARGE_INTEGER pos;
+    pos.QuadPart = static_cast<LONGLONG>(size);
+    return SetFilePointerEx(file, pos, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+}
+
+bool RemoveLogFile(const std::wstring& path) {
+    return DeleteFileW(path.c_str()) != FALSE;
+}
+
+bool RenameLogFile(const std::wstring& from, const std::wstring& to) {
+    return MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+}
+
+unsigned long LastErrorCode() {
+    return GetLastError();
+}
+
+#else
+
+void ReportFailure(const std::wstring& path, const std::wstring& what) {
+    std::fprintf(stderr, "[ClipboardMonitor] %s: %s\n",
+                 Utils::WideToUtf8(path).c_str(), Utils::WideToUtf8(what).c_str());
+}
+
+bool SetFileEnd(int file, uint64_t size) {
+    return ::ftruncate(file, static_cast<off_t>(size)) == 0;
+}
+
+bool RemoveLogFile(const std::wstring& path) {
+    return ::unlink(Utils::WideToUtf8(path).c_str()) == 0;
+}
+
+bool RenameLogFile(const std::wstring& from, const std::wstring& to) {
+    return ::rename(Utils::WideToUtf8(from).c_str(), Utils::WideToUtf8(to).c_str()) == 0;
+}
+
+unsigned long LastErrorCode() {
+    return static_cast<unsigned long>(errno);
+}
+
+#endif
+
+} // namespace
+
+// ============================================================================
+// MappedLogFile
+// ============================================================================
+
+MappedLogFile::MappedLogFile()
+    : m_trimZeroTail(false)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+#else
+    , m_file(-1)
+#endif
+    , m_view(nullptr)
+    , m_viewOffset(0)
+    , m_viewEnd(0)
+    , m_size(0)
+{
+}
+
+MappedLogFile::~MappedLogFile() {
+    Close();
+}
+
+#ifdef _WIN32
+
+bool MappedLogFile::IsOpen() const {
+    return m_file != INVALID_HANDLE_VALUE;
+}
+
+bool MappedLogFile::Open(const std::wstring& path, bool trimZeroTail) {
+    Close();
+    m_path = path;
+    m_trimZeroTail = trimZeroTail;
+
+    // FILE_SHARE_READ keeps the log viewable while the app is running
+    m_file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                         FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                         OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    bool created = GetLastError() != ERROR_ALREADY_EXISTS;
+
+    LARGE_INTEGER fileSize = {};
+    GetFileSizeEx(m_file, &fileSize);
+    m_size = static_cast<uint64_t>(fileSize.QuadPart);
+
+    if (m_trimZeroTail && m_size > 0) {
+        // Walk back over the zero-filled tail of a view that was never trimmed
+        char buf[4096];
+        while (m_size > 0) {
+            uint64_t chunk = (std::min<uint64_t>)(m_size, sizeof(buf));
+            LARGE_INTEGER pos;
+            pos.QuadPart = static_cast<LONGLONG>(m_size - chunk);
+            DWORD read = 0;
+            if (!SetFilePointerEx(m_file, pos, nullptr, FILE_BEGIN) ||
+                !ReadFile(m_file, buf, static_cast<DWORD>(chunk), &read, nullptr) || read != chunk) {
+                break;
+            }
+            size_t used = static_cast<size_t>(chunk);
+            while (used > 0 && buf[used - 1] == 0) {
+                --used;
+            }
+            m_size -= chunk - used;
+            if (used > 0) break;
+        }
+        SetFileEnd(m_file, m_size);
+    }
+
+    FILETIME creationTime = {};
+    if (created) {
+        // NTFS tunneling would hand a file recreated under a rotated name the
+        // old creation time, so stamp it explicitly
+        GetSystemTimeAsFileTime(&creationTime);
+        SetFileTime(m_file, &creationTime, nullptr, nullptr);
+        m_createdAt = std::chrono::system_clock::now();
+    } else if (GetFileTime(m_file, &creationTime, nullptr, nullptr)) {
+        m_createdAt = FileTimeToTimePoint(creationTime);
+    } else {
+        m_createdAt = std::chrono::system_clock::now();
+    }
+
+    return true;
+}
+
+void MappedLogFile::Close() {
+    if (m_file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    Unmap();
+    // Drop the unused part of the last mapped chunk
+    SetFileEnd(m_file, m_size);
+    CloseHandle(m_file);
+    m_file = INVALID_HANDLE_VALUE;
+}
+
+bool MappedLogFile::Remap(size_t needed) {
+    Unmap();
+
+    static const uint64_t granularity = [] {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<uint64_t>(info.dwAllocationGranularity);
+    }();
+
+    // Views must start on the allocation granularity
+    uint64_t offset = m_size - (m_size % granularity);
+    uint64_t viewSize = (m_size - offset) + (std::max<uint64_t>)(needed, kMapChunkBytes);
+    uint64_t mapEnd = offset + viewSize;
+
+    // Sizing the mapping past the end of file grows the file
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READWRITE,
+                                   static_cast<DWORD>(mapEnd >> 32), static_cast<DWORD>(mapEnd), nullptr);
+    if (!m_mapping) {
+        return false;
+    }
+
+    m_view = static_cast<char*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE,
+                                              static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset),
+                                              static_cast<SIZE_T>(viewSize)));
+    if (!m_view) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+        return false;
+    }
+
+    m_viewOffset = offset;
+    m_viewEnd = mapEnd;
+    return true;
+}
+
+void MappedLogFile::Unmap() {
+    if (m_view) {
+        UnmapViewOfFile(m_view);
+        m_view = nullptr;
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    m_viewOffset = 0;
+    m_viewEnd = 0;
+}
+
+#else
+
+bool MappedLogFile::IsOpen() const {
+    return m_file >= 0;
+}
+
+bool MappedLogFile::Open(const std::wstring& path, bool trimZeroTail) {
+    Close();
+    m_path = path;
+    m_trimZeroTail = trimZeroTail;
+
+    std::string narrowPath = Utils::WideToUtf8(path);
+    m_file = ::open(narrowPath.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    bool created = m_file >= 0;
+    if (!created && errno == EEXIST) {
+        m_file = ::open(narrowPath.c_str(), O_RDWR | O_CLOEXEC);
+    }
+    if (m_file < 0) {
+        return false;
+    }
+
+    struct stat info = {};
+    ::fstat(m_file, &info);
+    m_size = static_cast<uint64_t>(info.st_size);
+
+    if (m_trimZeroTail && m_size > 0) {
+        // Walk back over the zero-filled tail of a view that was never trimmed
+        char buf[4096];
+        while (m_size > 0) {
+            uint64_t chunk = (std::min<uint64_t>)(m_size, sizeof(buf));
+            ssize_t read = ::pread(m_file, buf, static_cast<size_t>(chunk), static_cast<off_t>(m_size - chunk));
+            if (read != static_cast<ssize_t>(chunk)) {
+                break;
+            }
+            size_t used = static_cast<size_t>(chunk);
+            while (used > 0 && buf[used - 1] == 0) {
+                --used;
+            }
+            m_size -= chunk - used;
+            if (used > 0) break;
+        }
+        SetFileEnd(m_file, m_size);
+    }
+
+    m_createdAt = created ? std::chrono::system_clock::now()
+                          : std::chrono::system_clock::from_time_t(info.st_mtime);
+    return true;
+}
+
+void MappedLogFile::Close() {
+    if (m_file < 0) {
+        return;
+    }
+
+    Unmap();
+    // Drop the unused part of the last mapped chunk
+    SetFileEnd(m_file, m_size);
+    ::close(m_file);
+    m_file = -1;
+}
+
+bool MappedLogFile::Remap(size_t needed) {
+    Unmap();
+
+    static const uint64_t granularity = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+
+    // Views must start on a page boundary
+    uint64_t offset = m_size - (m_size % granularity);
+    uint64_t viewSize = (m_size - offset) + (std::max<uint64_t>)(needed, kMapChunkBytes);
+    uint64_t mapEnd = offset + viewSize;
+
+    // Unlike a Windows mapping, mmap does not grow the file
+    if (!SetFileEnd(m_file, mapEnd)) {
+        return false;
+    }
+
+    void* view = ::mmap(nullptr, static_cast<size_t>(viewSize), PROT_READ | PROT_WRITE, MAP_SHARED,
+                        m_file, static_cast<off_t>(offset));
+    if (view == MAP_FAILED) {
+        return false;
+    }
+
+    m_view = static_cast<char*>(view);
+    m_viewOffset = offset;
+    m_viewEnd = mapEnd;
+    return true;
+}
+
+void MappedLogFile::Unmap() {
+    if (m_view) {
+        ::munmap(m_view, static_cast<size_t>(m_viewEnd - m_viewOffset));
+        m_view = nullptr;
+    }
+    m_viewOffset = 0;
+    m_viewEnd = 0;
+}
+
+#endif
+
+bool MappedLogFile::Reopen() {
+    if (m_path.empty()) {
+        return false;
+    }
+    std::wstring path = m_path;
+    return Open(path, m_trimZeroTail);
+}
+
+bool MappedLogFile::Append(const char* data, size_t length) {
+    if (!IsOpen()) {
+        return false;
+    }
+    if (length == 0) {
+        return true;
+    }
+
+    if (!m_view || m_size + length > m_viewEnd) {
+        if (!Remap(length)) {
+            return false;
+        }
+    }
+
+    std::memcpy(m_view + (m_size - m_viewOffset), data, length);
+    m_size += length;
+    return true;
+}
+
+bool MappedLogFile::ShouldRotate(const LogRotationPolicy& policy) const {
+    if (!IsOpen() || m_size == 0) {
+        return false;
+    }
+    if (policy.maxBytes > 0 && m_size >= policy.maxBytes) {
+        return true;
+    }
+    if (policy.maxAge.count() > 0 && std::chrono::system_clock::now() - m_createdAt >= policy.maxAge) {
+        return true;
+    }
+    return false;
+}
+
+bool MappedLogFile::Rotate(const LogRotationPolicy& policy) {
+    Close();
+
+    bool moved;
+    if (policy.maxFiles <= 0) {
+        moved = RemoveLogFile(m_path);
+    } else {
+        RemoveLogFile(RotatedPath(policy.maxFiles));
+        for (int i = policy.maxFiles - 1; i >= 1; --i) {
+            RenameLogFile(RotatedPath(i), RotatedPath(i + 1));
+        }
+        moved = RenameLogFile(m_path, RotatedPath(1));
+    }
+
+    // If the rename failed we reopen and keep appending to the same file
+    if (!Open(m_path, m_trimZeroTail)) {
+        return false;
+    }
+    return moved;
+}
+
+std::wstring MappedLogFile::RotatedPath(int index) const {
+    // debug.log -> debug.1.log
+    size_t slash = m_path.find_last_of(L"\\/");
+    size_t dot = m_path.find_last_of(L'.');
+    if (dot == std::wstring::npos || (slash != std::wstring::npos && dot < slash)) {
+        return m_path + L"." + std::to_wstring(index);
+    }
+    return m_path.substr(0, dot) + L"." + std::to_wstring(index) + m_path.substr(dot);
+}
+
+// ============================================================================
+// AsyncLogWriter
+// ============================================================================
+
+AsyncLogWriter::AsyncLogWriter()
+    : m_stop(false)
+    , m_open(false)
+{
+}
+
+AsyncLogWriter::~AsyncLogWriter() {
+    Close();
+}
+
+bool AsyncLogWriter::Open(const std::wstring& path, const LogRotationPolicy& policy,
+                          const std::string& fileHeader, bool trimZeroTail) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_open) {
+        return true;
+    }
+
+    if (!m_file.Open(path, trimZeroTail)) {
+        return false;
+    }
+
+    m_policy = policy;
+    m_fileHeader = fileHeader;
+
+    // Rotate a file left over from the previous session before writing to it
+    if (m_file.ShouldRotate(m_policy)) {
+        m_file.Rotate(m_policy);
+        if (!m_file.IsOpen()) {
+            return false;
+        }
+    }
+    m_file.Append(m_fileHeader.data(), m_fileHeader.size());
+
+    m_pending.reserve(kFlushThresholdBytes * 2);
+    m_stop = false;
+    m_open = true;
+    m_writerThread = std::thread([this] { WriterThread(); });
+    return true;
+}
+
+void AsyncLogWriter::Close() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_open) {
+            return;
+        }
+        // Stop accepting data; the writer thread drains what is pending
+        m_open = false;
+        m_stop = true;
+    }
+    m_condition.notify_one();
+
+    if (m_writerThread.joinable()) {
+        m_writerThread.join();
+    }
+
+    m_file.Close();
+}
+
+void AsyncLogWriter::Append(const char* data, size_t length) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_open) return;
+        m_pending.append(data, length);
+        wake = m_pending.size() >= kFlushThresholdBytes;
+    }
+
+    if (wake) {
+        m_condition.notify_one();
+    }
+}
+
+void AsyncLogWriter::WriterThread() {
+    std::string writing;
+    writing.reserve(kFlushThresholdBytes * 2);
+    auto nextRotateAttempt = std::chrono::steady_clock::now();
+    auto nextOpenAttempt = nextRotateAttempt;
+    uint64_t dropped = 0;       // Bytes lost since the file was last writable
+
+    while (true) {
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait_for(lock, kFlushInterval, [this] {
+                return m_stop || m_pending.size() >= kFlushThresholdBytes;
+            });
+            writing.swap(m_pending);
+            stopping = m_stop;
+        }
+
+        // No file (a rotation could not reopen it): try again every so often
+        auto now = std::chrono::steady_clock::now();
+        if (!m_file.IsOpen() && now >= nextOpenAttempt) {
+            if (m_file.Reopen()) {
+                m_file.Append(m_fileHeader.data(), m_fileHeader.size());
+                ReportFailure(m_file.Path(), L"reopened, " + std::to_wstring(dropped) +
+                                             L" bytes of log data lost");
+                dropped = 0;
+            } else {
+                ReportFailure(m_file.Path(), L"cannot open (error " + std::to_wstring(LastErrorCode()) +
+                                             L"), dropping log data");
+                nextOpenAttempt = now + kReopenRetryInterval;
+            }
+        }
+
+        // File I/O happens outside the lock so loggers never wait on it
+        if (!writing.empty()) {
+            if (!m_file.Append(writing.data(), writing.size())) {
+                dropped += writing.size();
+            }
+            writing.clear();
+        }
+
+        if (stopping) {
+            if (dropped > 0) {
+                ReportFailure(m_file.Path(), std::to_wstring(dropped) + L" bytes of log data lost");
+            }
+            return;
+        }
+
+        // Rotation runs here, between batches, never on a logging thread
+        if (now >= nextRotateAttempt && m_file.ShouldRotate(m_policy)) {
+            if (m_file.Rotate(m_policy)) {
+                m_file.Append(m_fileHeader.data(), m_fileHeader.size());
+            } else if (!m_file.IsOpen()) {
+                ReportFailure(m_file.Path(), L"cannot reopen after rotation (error " +
+                                             std::to_wstring(LastErrorCode()) + L"), retrying");
+                nextOpenAttempt = now + kReopenRetryInterval;
+            } else {
+                nextRotateAttempt = now + kRotateRetryInterval;
+            }
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// When the active log file is rotated out. Rotated files are renamed
+// debug.1.log, debug.2.log, ... (newest first); the oldest is deleted.
+struct LogRotationPolicy {
+    uint64_t maxBytes = 5 * 1024 * 1024;     // 0 = no size limit
+    std::chrono::seconds maxAge = std::chrono::hours(24 * 7);  // 0 = no age limit
+    int maxFiles = 3;                        // Rotated files kept besides the active one
+};
+
+// Append-only log file written through a memory-mapped view.
+//
+// Appends are a memcpy into the view; the file is grown in chunks and
+// trimmed to its logical size on Close. Not thread-safe - owned by the
+// AsyncLogWriter background thread. Off Windows (the unit tests) the view
+// is an mmap of the file, and a file left by an earlier session ages from
+// its last write, since there is no portable creation time.
+class MappedLogFile {
+public:
+    MappedLogFile();
+    ~MappedLogFile();
+
+    // Disable copy
+    MappedLogFile(const MappedLogFile&) = delete;
+    MappedLogFile& operator=(const MappedLogFile&) = delete;
+
+    // Open for append. trimZeroTail drops mapping padding left by a crash
+    // (only safe for text logs, where a NUL byte is never real data).
+    bool Open(const std::wstring& path, bool trimZeroTail);
+    void Close();
+
+    // Open the last opened path again (a failed Rotate leaves the file closed)
+    bool Reopen();
+
+    bool IsOpen() const;
+    uint64_t Size() const { return m_size; }
+    const std::wstring& Path() const { return m_path; }
+
+    bool Append(const char* data, size_t length);
+
+    // True when the policy says the file should be rotated out
+    bool ShouldRotate(const LogRotationPolicy& policy) const;
+
+    // Close, shift debug.log -> debug.1.log -> ..., reopen empty. If the
+    // reopen fails the file stays closed (IsOpen() is false) until Reopen
+    bool Rotate(const LogRotationPolicy& policy);
+
+private:
+    // Map a view that covers at least `needed` bytes past the logical end
+    bool Remap(size_t needed);
+    void Unmap();
+
+    std::wstring RotatedPath(int index) const;
+
+    std::wstring m_path;
+    bool m_trimZeroTail;
+#ifdef _WIN32
+    HANDLE m_file;
+    HANDLE m_mapping;
+#else
+    int m_file;                 // File descriptor, -1 when closed
+#endif
+    char* m_view;
+    uint64_t m_viewOffset;      // File offset of m_view (allocation-granularity aligned)
+    uint64_t m_viewEnd;         // File offset one past the mapped view
+    uint64_t m_size;            // Logical end of data
+    std::chrono::system_clock::time_point m_createdAt;
+};
+
+// Buffered log writer: callers append bytes under a short lock, a background
+// thread copies them into the mapped file and handles rotation, so logging
+// never waits on disk I/O or on a rename.
+//
+// If the file is lost (reopening it after a rotation failed) the thread
+// keeps retrying to open it; data written meanwhile is dropped. Failures
+// cannot go to the log itself, so they are reported with OutputDebugString
+// (stderr off Windows).
+class AsyncLogWriter {
+public:
+    AsyncLogWriter();
+    ~AsyncLogWriter();
+
+    // Disable copy
+    AsyncLogWriter(const AsyncLogWriter&) = delete;
+    AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+    // fileHeader is written at the start of this session and of every
+    // file created by rotation (the binary log needs one per file)
+    bool Open(const std::wstring& path, const LogRotationPolicy& policy,
+              const std::string& fileHeader, bool trimZeroTail);
+
+    // Flush pending data and stop the background thread
+    void Close();
+
+    bool IsOpen() const { return m_open; }
+
+    void Append(const char* data, size_t length);
+    void Append(const std::string& data) { Append(data.data(), data.size()); }
+
+private:
+    void WriterThread();
+
+    MappedLogFile m_file;
+    LogRotationPolicy m_policy;
+    std::string m_fileHeader;
+    std::string m_pending;        // Data waiting for the writer thread
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_writerThread;
+    bool m_stop;
+    std::atomic<bool> m_open;
+};
@@ -3,11 +3,16 @@
 #include "utils.h"
 #include "debug_log.h"
 #include "context/context_manager.h"
+#include "context/win_event_foreground_source.h"
 #include "context/adapters/browser_adapter.h"
 #include "context/adapters/wechat_adapter.h"
 #include "context/adapters/vscode_adapter.h"
 #include "context/adapters/notion_adapter.h"
+#include "context/adapters/generic_adapter.h"
+#include "context/utils/title_rules.h"
+#include "context/utils/ui_automation_helper.h"
 #include <shellapi.h>
+#include <mutex>
 
 // Global variables
 ClipboardMonitor g_monitor;
@@ -26,8 +31,10 @@ WNDPROC g_originalWndProc = nullptr;
 #define ID_TRAY_OPEN    1003
 #define ID_TRAY_ICON    1
 
-// Last clipboard entry
+// Last clipboard entry (set on the clipboard thread, patched from workers)
 static ClipboardEntry g_lastEntry;
+static uint64_t g_tempEntryId = 0;     // Entry last written for the FloatingTool
+static std::mutex g_lastEntryMutex;
 
 // Ctrl+C+C detection
 static HHOOK g_keyboardHook = nullptr;
@@ -44,6 +51,17 @@ void OpenHistoryFile();
 LRESULT CALLBACK TrayWindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam);
 
+// Value of "--name=value" on the command line, or empty if absent
+static std::wstring GetCommandLineOption(const std::wstring& cmdLine, const std::wstring& name) {
+    size_t pos = cmdLine.find(name);
+    if (pos == std::wstring::npos) {
+        return std::wstring();
+    }
+    size_t start = pos + name.size();
+    size_t end = cmdLine.find(L' ', start);
+    return cmdLine.substr(start, end == std::wstring::npos ? std::wstring::npos : end - start);
+}
+
 // Keyboard hook for Ctrl+C+C detection
 LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
     if (nCode == HC_ACTION && wParam == WM_KEYDOWN) {
@@ -57,12 +75,21 @@ LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
                 
                 if (g_lastCtrlCTime > 0 && (now - g_lastCtrlCTime) < 500) {
                     // Second Ctrl+C within 500ms - broadcast to C# FloatingTool
-                    DEBUG_LOG("Ctrl+C+C detected! Broadcasting to FloatingTool...");
+                    LOG_INFO("Ctrl+C+C detected! Broadcasting to FloatingTool...");
                     g_lastCtrlCTime = 0;
 
-                    // Write last entry to temp file for C# to read
-                    if (!g_lastEntry.content.empty()) {
-                        g_storage.WriteTempEntry(g_lastEntry);
+                    // The user is about to annotate: fetch this copy's context
+                    // ahead of regular captures (plain copies stay Normal)
+                    g_monitor.MarkNextCaptureInteractive();
+
+                    // Write last entry to temp file for C# to read; it is
+                    // rewritten if the entry's full context arrives later
+                    {
+                        std::lock_guard<std::mutex> lock(g_lastEntryMutex);
+                        if (!g_lastEntry.content.empty()) {
+                            g_storage.WriteTempEntry(g_lastEntry);
+                            g_tempEntryId = g_lastEntry.id;
+                        }
                     }
 
                     // Broadcast to all windows (C# FloatingTool will receive this)
@@ -82,7 +109,6 @@ LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam) {
 
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow) {
     (void)hPrevInstance;
-    (void)lpCmdLine;
     (void)nCmdShow;
     
     CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
@@ -90,9 +116,35 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
     // Register message for IPC with C# FloatingTool
     WM_GLIMPSEME_SHOW_FLOATING = RegisterWindowMessageW(L"WM_GLIMPSEME_SHOW_FLOATING");
 
+    // Runtime log level: --log-level=trace|debug|info|warn|error|off
+    std::wstring cmdLine = lpCmdLine ? lpCmdLine : L"";
+    std::wstring levelName = GetCommandLineOption(cmdLine, L"--log-level=");
+    if (!levelName.empty()) {
+        DebugLog::SetLevel(DebugLog::ParseLevel(Utils::WideToUtf8(levelName)));
+    }
+
+    // Binary structured log: --log-format=binary (writes debug.bin, see tools/log_decoder)
+    LogMode logMode = GetCommandLineOption(cmdLine, L"--log-format=") == L"binary"
+        ? LogMode::Binary : LogMode::Text;
+
+    // Log rotation: --log-max-size=<MB> --log-max-age=<hours> --log-max-files=<N> (0 disables a limit)
+    LogRotationPolicy rotation;
+    std::wstring maxSize = GetCommandLineOption(cmdLine, L"--log-max-size=");
+    if (!maxSize.empty()) {
+        rotation.maxBytes = static_cast<uint64_t>(_wtoi(maxSize.c_str())) * 1024 * 1024;
+    }
+    std::wstring maxAge = GetCommandLineOption(cmdLine, L"--log-max-age=");
+    if (!maxAge.empty()) {
+        rotation.maxAge = std::chrono::hours(_wtoi(maxAge.c_str()));
+    }
+    std::wstring maxFiles = GetCommandLineOption(cmdLine, L"--log-max-files=");
+    if (!maxFiles.empty()) {
+        rotation.maxFiles = _wtoi(maxFiles.c_str());
+    }
+
     std::wstring appDataPath = Utils::GetAppDataPath();
-    DebugLog::Instance().Initialize(appDataPath);
-    DEBUG_LOG("Starting GlimpseMe...");
+    DebugLog::Instance().Initialize(appDataPath, logMode, rotation);
+    LOG_INFO("Starting GlimpseMe...");
     
     if (!g_storage.Initialize(appDataPath)) {
         MessageBoxW(NULL, L"Failed to initialize storage!", L"GlimpseMe Error", MB_ICONERROR);
@@ -100,20 +152,62 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
     }
     DEBUG_LOG("Storage initialized");
 
-    g_contextManager = std::make_shared<ContextManager>();
+    // Window-title layouts per app; config.json may add or replace them
+    TitleRules::Instance().LoadConfig(appDataPath + L"\\config.json");
+
+    // Each worker keeps one COM apartment and IUIAutomation instance for its
+    // whole lifetime instead of creating them on every copy
+    AsyncExecutor::WorkerHooks workerHooks;
+    workerHooks.onStart = [](size_t) { UIAutomationThreadContext::Attach(); };
+    workerHooks.onStop = [](size_t) { UIAutomationThreadContext::Detach(); };
+
+    g_contextManager = std::make_shared<ContextManager>(0, std::move(workerHooks));
     if (!g_contextManager->Initialize()) {
         MessageBoxW(NULL, L"Failed to initialize context manager!", L"GlimpseMe Error", MB_ICONERROR);
         return 1;
     }
     DEBUG_LOG("ContextManager initialized");
 
-    // Register adapters
-    g_contextManager->RegisterAdapter(std::make_shared<BrowserAdapter>(5000));
-    g_contextManager->RegisterAdapter(std::make_shared<WeChatAdapter>(5000, 5));
-    g_contextManager->RegisterAdapter(std::make_shared<VSCodeAdapter>(5000));
-    g_contextManager->RegisterAdapter(std::make_shared<NotionAdapter>(5000));
+    // Adapter timeouts follow observed fetch times: percentile * headroom,
+    // clamped to [min, max] ms. --timeout-percentile=<0-100> --timeout-headroom=<x>
+    // --timeout-min=<ms> --timeout-max=<ms>
+    AdaptiveTimeoutPolicy timeoutPolicy;
+    std::wstring timeoutPercentile = GetCommandLineOption(cmdLine, L"--timeout-percentile=");
+    if (!timeoutPercentile.empty()) {
+        timeoutPolicy.percentile = _wtof(timeoutPercentile.c_str()) / 100.0;
+    }
+    std::wstring timeoutHeadroom = GetCommandLineOption(cmdLine, L"--timeout-headroom=");
+    if (!timeoutHeadroom.empty()) {
+        timeoutPolicy.headroom = _wtof(timeoutHeadroom.c_str());
+    }
+    std::wstring timeoutMin = GetCommandLineOption(cmdLine, L"--timeout-min=");
+    if (!timeoutMin.empty()) {
+        timeoutPolicy.floorMs = _wtoi(timeoutMin.c_str());
+    }
+    std::wstring timeoutMax = GetCommandLineOption(cmdLine, L"--timeout-max=");
+    if (!timeoutMax.empty()) {
+        timeoutPolicy.ceilingMs = _wtoi(timeoutMax.c_str());
+    }
+    g_contextManager->SetTimeoutPolicy(timeoutPolicy);
+
+    // Register adapters; these timeouts only apply until an adapter has
+    // enough samples (WeChat typically needs 0.7-2.4s, the others far less)
+    g_contextManager->RegisterAdapter(std::make_shared<BrowserAdapter>(1000));
+    g_contextManager->RegisterAdapter(std::make_shared<WeChatAdapter>(3000, 5));
+    g_contextManager->RegisterAdapter(std::make_shared<VSCodeAdapter>(1000));
+    g_contextManager->RegisterAdapter(std::make_shared<NotionAdapter>(2000));
+    // Every other process: title and executable only, on the clipboard thread
+    g_contextManager->SetGenericAdapter(std::make_shared<GenericAdapter>());
     DEBUG_LOG("Adapters registered");
 
+    // Executor metrics: --metrics-interval=<seconds> (0 disables), written to metrics.json
+    int metricsInterval = 60;
+    std::wstring metricsOption = GetCommandLineOption(cmdLine, L"--metrics-interval=");
+    if (!metricsOption.empty()) {
+        metricsInterval = _wtoi(metricsOption.c_str());
+    }
+    g_contextManager->StartMetricsDump(appDataPath + L"\\metrics.json", metricsInterval * 1000);
+
     if (!g_monitor.Initialize(hInstance)) {
         MessageBoxW(NULL, L"Failed to initialize clipboard monitor!", L"GlimpseMe Error", MB_ICONERROR);
         return 1;
@@ -122,11 +216,35 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
 
     g_monitor.SetContextManager(g_contextManager);
 
-    // Clipboard callback - store last entry
+    // Prefetch context when a window comes to the foreground and stays there:
+    // --prefetch-dwell=<ms> (negative disables) --prefetch-interval=<ms>
+    PrefetchPolicy prefetchPolicy;
+    std::wstring prefetchDwell = GetCommandLineOption(cmdLine, L"--prefetch-dwell=");
+    if (!prefetchDwell.empty()) {
+        prefetchPolicy.dwellMs = _wtoi(prefetchDwell.c_str());
+    }
+    std::wstring prefetchInterval = GetCommandLineOption(cmdLine, L"--prefetch-interval=");
+    if (!prefetchInterval.empty()) {
+        prefetchPolicy.minIntervalMs = _wtoi(prefetchInterval.c_str());
+    }
+    g_contextManager->SetPrefetchPolicy(prefetchPolicy);
+    if (prefetchPolicy.dwellMs >= 0) {
+        g_monitor.SetForegroundSource(std::make_unique<WinEventForegroundSource>());
+    }
+
+    // Clipboard callback - store last entry; a context patch of an older
+    // entry must not replace a newer one
     g_monitor.SetCallback([](const ClipboardEntry& entry) {
-        if (g_monitoring) {
+        if (!g_monitoring) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(g_lastEntryMutex);
+        if (entry.id >= g_lastEntry.id) {
             g_lastEntry = entry;
         }
+        if (entry.id == g_tempEntryId) {
+            g_storage.WriteTempEntry(entry);
+        }
     });
     
     CreateTrayIcon(g_monitor.GetWindowHandle(), hInstance);
@@ -136,7 +254,11 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
     
     // Keyboard hook for Ctrl+C+C
     g_keyboardHook = SetWindowsHookExW(WH_KEYBOARD_LL, LowLevelKeyboardProc, hInstance, 0);
-    DEBUG_LOG(g_keyboardHook ? "Keyboard hook installed" : "Hook failed!");
+    if (g_keyboardHook) {
+        LOG_INFO("Keyboard hook installed");
+    } else {
+        LOG_ERROR("Hook failed!");
+    }
     
     // Startup notification
     g_nid.uFlags = NIF_INFO;
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+// Window handle as <windows.h> declares it, so code that only passes
+// SourceInfo around (the context cache and its tests) does not need it
+struct HWND__;
+typedef struct HWND__* HWND;
+
+// Information about the source application
+struct SourceInfo {
+    std::wstring processName;      // e.g., "chrome.exe"
+    std::wstring processPath;      // Full path to executable
+    std::wstring windowTitle;      // Window title (context)
+    unsigned long processId = 0;   // Process ID (a DWORD)
+    HWND windowHandle = nullptr;   // Window handle
+};
@@ -78,6 +78,9 @@ std::string Storage::EntryToJson(const ClipboardEntry &entry) const {
          << "\",\n";
     json << "      \"success\": " << (ctx->success ? "true" : "false") << ",\n";
     json << "      \"fetch_time_ms\": " << ctx->fetchTimeMs;
+    if (ctx->partial) {
+      json << ",\n      \"partial\": true";
+    }
 
     // Add common fields
     if (!ctx->url.empty()) {
@@ -219,6 +222,32 @@ std::string Storage::EntryToJson(const ClipboardEntry &entry) const {
         }
         json << "      ]";
       }
+    } else if (ctx->adapterType == "generic") {
+      const GenericContext *genericCtx =
+          static_cast<const GenericContext *>(ctx.get());
+      if (!genericCtx->documentName.empty()) {
+        json << ",\n      \"document_name\": \""
+             << Utils::EscapeJson(Utils::WideToUtf8(genericCtx->documentName))
+             << "\"";
+      }
+      if (!genericCtx->appName.empty()) {
+        json << ",\n      \"app_name\": \""
+             << Utils::EscapeJson(Utils::WideToUtf8(genericCtx->appName))
+             << "\"";
+      }
+      if (!genericCtx->paths.empty()) {
+        json << ",\n      \"paths\": [\n";
+        for (size_t i = 0; i < genericCtx->paths.size(); i++) {
+          json << "        \""
+               << Utils::EscapeJson(Utils::WideToUtf8(genericCtx->paths[i]))
+               << "\"";
+          if (i < genericCtx->paths.size() - 1) {
+            json << ",";
+          }
+          json << "\n";
+        }
+        json << "      ]";
+      }
     }
 
     // Serialize metadata if present
@@ -0,0 +1,268 @@
+// AccessibleSearch: order, budgets, region pruning and cancellation
+
+#include "test_framework.h"
+#include "../context/utils/accessible_search.h"
+
+namespace {
+
+AccessibleRect Rect(long left, long top, long right, long bottom) {
+    AccessibleRect rect;
+    rect.left = left;
+    rect.top = top;
+    rect.right = right;
+    rect.bottom = bottom;
+    return rect;
+}
+
+int Add(AccessibleSnapshot& tree, int parent, int controlType, const std::wstring& name,
+        const AccessibleRect& rect = AccessibleRect()) {
+    AccessibleProperties properties;
+    properties.controlType = controlType;
+    properties.name = name;
+    properties.rect = rect;
+    return tree.AddNode(parent, properties);
+}
+
+std::vector<std::wstring> Names(const std::vector<AccessibleElementPtr>& elements) {
+    std::vector<std::wstring> names;
+    for (const AccessibleElementPtr& element : elements) {
+        names.push_back(element->GetProperties().name);
+    }
+    return names;
+}
+
+bool NameStartsWithMatch(const AccessibleProperties& properties) {
+    return properties.name.rfind(L"match", 0) == 0;
+}
+
+// Window 1000x1000 with a content pane of `count` Text elements over its
+// upper 900 px and a status bar (two Texts) along the bottom 50 px
+void BuildWindow(AccessibleSnapshot& tree, int count) {
+    int window = Add(tree, -1, AccessibleControlType::Window, L"window", Rect(0, 0, 1000, 1000));
+    int content = Add(tree, window, AccessibleControlType::Pane, L"content", Rect(0, 0, 1000, 900));
+    for (int i = 0; i < count; i++) {
+        int group = Add(tree, content, AccessibleControlType::Group, L"", Rect(0, 0, 1000, 20));
+        Add(tree, group, AccessibleControlType::Text, L"line " + std::to_wstring(i), Rect(0, 0, 1000, 20));
+    }
+    int status = Add(tree, window, AccessibleControlType::StatusBar, L"", Rect(0, 950, 1000, 1000));
+    Add(tree, status, AccessibleControlType::Text, L"match left", Rect(0, 950, 100, 1000));
+    Add(tree, status, AccessibleControlType::Text, L"match right", Rect(900, 950, 1000, 1000));
+}
+
+} // namespace
+
+TEST(WithoutRegionOrConditionsShallowestFirst) {
+    AccessibleSnapshot tree;
+    int root = Add(tree, -1, AccessibleControlType::Window, L"root");
+    int a = Add(tree, root, AccessibleControlType::Pane, L"a");
+    int a1 = Add(tree, a, AccessibleControlType::Pane, L"a1");
+    Add(tree, a1, AccessibleControlType::Text, L"match deep");
+    Add(tree, a, AccessibleControlType::Text, L"match middle");
+    Add(tree, root, AccessibleControlType::Text, L"match shallow");
+
+    AccessibleSearchOptions options;
+    options.predicate = NameStartsWithMatch;
+    options.maxResults = 10;
+    std::vector<AccessibleElementPtr> found =
+        AccessibleSearch::FindAll(*tree.GetRoot(), options, CancellationToken::None());
+    CHECK_EQ(Names(found), (std::vector<std::wstring>{L"match shallow", L"match middle", L"match deep"}));
+
+    // The root itself never matches
+    options.predicate = [](const AccessibleProperties& properties) { return properties.name == L"root"; };
+    CHECK(!AccessibleSearch::FindFirst(*tree.GetRoot(), options, CancellationToken::None()));
+}
+
+TEST(SubtreesInsideTheRegionGoFirst) {
+    // The region covers the top half: "inside" lies wholly in it, "crossing"
+    // straddles its edge. Both hold a Text; the crossing one is shallower.
+    AccessibleSnapshot tree;
+    int root = Add(tree, -1, AccessibleControlType::Window, L"root", Rect(0, 0, 100, 100));
+    int crossing = Add(tree, root, AccessibleControlType::Pane, L"crossing", Rect(0, 40, 100, 60));
+    Add(tree, crossing, AccessibleControlType::Text, L"shallow", Rect(0, 40, 100, 45));
+    int inside = Add(tree, root, AccessibleControlType::Pane, L"inside", Rect(0, 0, 100, 40));
+    int group = Add(tree, inside, AccessibleControlType::Group, L"", Rect(0, 0, 100, 40));
+    Add(tree, group, AccessibleControlType::Text, L"deep 1", Rect(0, 0, 100, 20));
+    Add(tree, inside, AccessibleControlType::Text, L"deep 2", Rect(0, 20, 100, 40));
+
+    AccessibleSearchOptions options;
+    options.query.controlType = AccessibleControlType::Text;
+    options.hasRegion = true;
+    options.region = Rect(0, 0, 100, 50);
+    options.maxResults = 10;
+    AccessibleSearchStats stats;
+    std::vector<AccessibleElementPtr> found =
+        AccessibleSearch::FindAll(*tree.GetRoot(), options, CancellationToken::None(), &stats);
+
+    // The inside subtree is one provider search, its matches in tree order;
+    // calls: root's children, "inside", "crossing"'s children, "shallow"
+    CHECK_EQ(Names(found), (std::vector<std::wstring>{L"deep 1", L"deep 2", L"shallow"}));
+    CHECK_EQ(stats.calls, size_t(4));
+    CHECK(!stats.exhausted);
+
+    options.maxResults = 1;
+    CHECK_EQ(AccessibleSearch::FindFirst(*tree.GetRoot(), options, CancellationToken::None())
+                 ->GetProperties().name, std::wstring(L"deep 1"));
+}
+
+TEST(RegionPrunesSubtreesOutsideIt) {
+    AccessibleSnapshot tree;
+    BuildWindow(tree, 5000);
+    AccessibleSearchOptions options;
+    options.query.controlType = AccessibleControlType::Text;
+    options.hasRegion = true;
+    options.region = AccessibleSearch::BottomStrip(tree.GetRoot()->GetProperties().rect, 48);
+    options.maxResults = 10;
+    AccessibleSearchStats stats;
+    std::vector<AccessibleElementPtr> found =
+        AccessibleSearch::FindAll(*tree.GetRoot(), options, CancellationToken::None(), &stats);
+
+    CHECK_EQ(Names(found), (std::vector<std::wstring>{L"match left", L"match right"}));
+    CHECK(!stats.exhausted);
+    CHECK(stats.nodes <= 4);
+    CHECK(stats.calls <= 2);
+    CHECK_EQ(tree.GetCallCount(), uint64_t(stats.calls));
+    CHECK(tree.GetVisitCount() <= 4);    // The content pane is never expanded
+}
+
+TEST(ElementsWithoutBoundsOnlyMatchWithoutRegion) {
+    AccessibleSnapshot tree;
+    int root = Add(tree, -1, AccessibleControlType::Window, L"root", Rect(0, 0, 100, 100));
+    int unbounded = Add(tree, root, AccessibleControlType::Pane, L"match unbounded");
+    Add(tree, unbounded, AccessibleControlType::Text, L"match bounded", Rect(0, 0, 10, 10));
+
+    AccessibleSearchOptions options;
+    options.predicate = NameStartsWithMatch;
+    options.hasRegion = true;
+    options.region = Rect(0, 0, 50, 50);
+    options.maxResults = 10;
+    CHECK_EQ(Names(AccessibleSearch::FindAll(*tree.GetRoot(), options, CancellationToken::None())),
+             (std::vector<std::wstring>{L"match bounded"}));
+
+    options.hasRegion = false;
+    CHECK_EQ(Names(AccessibleSearch::FindAll(*tree.GetRoot(), options, CancellationToken::None())),
+             (std::vector<std::wstring>{L"match unbounded", L"match bounded"}));
+}
+
+TEST(NodeBudgetStopsTheSearch) {
+    AccessibleSnapshot tree;
+    BuildWindow(tree, 5000);
+    AccessibleSearchOptions options;
+    options.predicate = [](const AccessibleProperties& properties) { return properties.name == L"absent"; };
+    options.maxNodes = 100;
+    AccessibleSearchStats stats;
+    CHECK(AccessibleSearch::FindAll(*tree.GetRoot(), options, CancellationToken::None(), &stats).empty());
+    CHECK(stats.exhausted);
+    CHECK_EQ(stats.nodes, size_t(100));
+
+    // The default budget does not reach the status bar behind 10000 elements
+    options = AccessibleSearchOptions();
+    options.predicate = NameStartsWithMatch;
+    CHECK(!AccessibleSearch::FindFirst(*tree.GetRoot(), options, CancellationToken::None(), &stats));
+    CHECK(stats.exhausted);
+    CHECK_EQ(stats.nodes, size_t(5000));
+}
+
+TEST(WithoutRegionTheProviderExaminesAtMostTheNodeBudget) {
+    // 8-way tree, 6 levels deep (37449 nodes); the only matches are leaves
+    const int fanOut = 8;
+    const int depth = 6;
+    AccessibleSnapshot tree;
+    std::vector<int> level{Add(tree, -1, AccessibleControlType::Window, L"root")};
+    for (int d = 1; d <= depth; d++) {
+        std::vector<int> next;
+        for (int parent : level) {
+            for (int i = 0; i < fanOut; i++) {
+                next.push_back(Add(tree, parent, d == depth ? AccessibleControlType::Text
+                                                            : AccessibleControlType::Group,
+                                   L"node"));
+            }
+        }
+        level = std::move(next);
+    }
+
+    // Query conditions, but no region to bound a pushed-down FindAll
+    AccessibleSearchOptions options;
+    options.query.controlType = AccessibleControlType::Text;
+    options.maxNodes = 1000;
+    AccessibleSearchStats stats;
+    tree.ResetCallCount();
+    CHECK(!AccessibleSearch::FindFirst(*tree.GetRoot(), options, CancellationToken::None(), &stats));
+    CHECK(stats.exhausted);
+    CHECK_EQ(stats.nodes, options.maxNodes);
+
+    // One GetChildren per expanded element; the last one fetches a whole
+    // sibling list, of which only part may have been examined
+    CHECK_EQ(tree.GetCallCount(), uint64_t(stats.calls));
+    CHECK(tree.GetVisitCount() <= options.maxNodes + fanOut);
+
+    // Given the budget to reach the leaves, the walk stops at maxResults
+    options.maxNodes = 100000;
+    options.maxResults = 3;
+    std::vector<AccessibleElementPtr> found =
+        AccessibleSearch::FindAll(*tree.GetRoot(), options, CancellationToken::None(), &stats);
+    CHECK_EQ(found.size(), size_t(3));
+    CHECK(!stats.exhausted);
+    CHECK(stats.nodes < tree.GetNodeCount());
+}
+
+TEST(TimeBudgetStopsTheSearch) {
+    AccessibleSnapshot tree;
+    BuildWindow(tree, 100);
+    AccessibleSearchOptions options;
+    options.predicate = NameStartsWithMatch;
+    options.maxTimeMs = 0;
+    AccessibleSearchStats stats;
+    CHECK(!AccessibleSearch::FindFirst(*tree.GetRoot(), options, CancellationToken::None(), &stats));
+    CHECK(stats.exhausted);
+    CHECK_EQ(stats.nodes, size_t(0));
+}
+
+TEST(MaxResultsEndsTheSearchEarly) {
+    AccessibleSnapshot tree;
+    BuildWindow(tree, 1000);
+    AccessibleSearchOptions options;
+    options.predicate = [](const AccessibleProperties& properties) {
+        return properties.name.rfind(L"line ", 0) == 0;
+    };
+    options.maxResults = 3;
+    AccessibleSearchStats stats;
+    CHECK_EQ(Names(AccessibleSearch::FindAll(*tree.GetRoot(), options, CancellationToken::None(), &stats)),
+             (std::vector<std::wstring>{L"line 0", L"line 1", L"line 2"}));
+    CHECK(!stats.exhausted);
+    CHECK(stats.nodes < 2010);
+
+    // maxResults 0 counts as 1
+    options.maxResults = 0;
+    CHECK_EQ(AccessibleSearch::FindAll(*tree.GetRoot(), options, CancellationToken::None()).size(), size_t(1));
+}
+
+TEST(CancellationStopsTheSearch) {
+    AccessibleSnapshot tree;
+    BuildWindow(tree, 1000);
+    AccessibleSearchOptions options;
+    options.predicate = NameStartsWithMatch;
+
+    // Cancelled before it starts: no provider call at all
+    CancellationToken cancelled;
+    cancelled.Cancel();
+    AccessibleSearchStats stats;
+    CHECK(!AccessibleSearch::FindFirst(*tree.GetRoot(), options, cancelled, &stats));
+    CHECK(stats.exhausted);
+    CHECK_EQ(stats.calls, size_t(0));
+    CHECK_EQ(tree.GetCallCount(), uint64_t(0));
+
+    // Cancelled midway (the timeout firing): stops at the next element
+    CancellationToken token;
+    size_t seen = 0;
+    options.predicate = [&](const AccessibleProperties&) {
+        if (++seen == 50) {
+            token.Cancel();
+        }
+        return false;
+    };
+    CHECK(AccessibleSearch::FindAll(*tree.GetRoot(), options, token, &stats).empty());
+    CHECK(stats.exhausted);
+    CHECK_EQ(stats.nodes, size_t(50));
+}
+
+int main() { return RunAllTests(); }
@@ -0,0 +1,266 @@
+// AccessibleSnapshot: JSON load/record round trip and provider call counting
+
+#include "test_framework.h"
+#include "../context/utils/accessible_tree.h"
+
+namespace {
+
+AccessibleRect Rect(long left, long top, long right, long bottom) {
+    AccessibleRect rect;
+    rect.left = left;
+    rect.top = top;
+    rect.right = right;
+    rect.bottom = bottom;
+    return rect;
+}
+
+int Add(AccessibleSnapshot& tree, int parent, int controlType, const std::wstring& name,
+        const AccessibleRect& rect = AccessibleRect(), const std::wstring& automationId = std::wstring(),
+        const std::wstring& value = std::wstring()) {
+    AccessibleProperties properties;
+    properties.controlType = controlType;
+    properties.name = name;
+    properties.automationId = automationId;
+    properties.rect = rect;
+    return tree.AddNode(parent, properties, value);
+}
+
+// Properties of every node, depth-first, as "type|name|id|rect|value;"
+std::wstring Dump(IAccessibleElement& element) {
+    const AccessibleProperties& properties = element.GetProperties();
+    std::wstring out = std::to_wstring(properties.controlType) + L"|" + properties.name + L"|" +
+                       properties.automationId + L"|" + std::to_wstring(properties.rect.left) + L"," +
+                       std::to_wstring(properties.rect.top) + L"," + std::to_wstring(properties.rect.right) +
+                       L"," + std::to_wstring(properties.rect.bottom) + L"|";
+    if (properties.controlType == AccessibleControlType::Edit) {
+        out += element.GetValue();
+    }
+    out += L"(";
+    for (const AccessibleElementPtr& child : element.GetChildren()) {
+        out += Dump(*child);
+    }
+    return out + L");";
+}
+
+// Record, load back, and record again
+bool RoundTrip(const AccessibleSnapshot& tree, AccessibleSnapshot& loaded, std::string& first,
+               std::string& second) {
+    first = AccessibleSnapshot::Record(*tree.GetRoot(), "test");
+    std::string error;
+    if (!AccessibleSnapshot::Load(first, loaded, &error)) {
+        std::fprintf(stderr, "Load failed: %s\n", error.c_str());
+        return false;
+    }
+    second = AccessibleSnapshot::Record(*loaded.GetRoot(), "test");
+    return true;
+}
+
+AccessibleSnapshot SampleTree() {
+    AccessibleSnapshot tree;
+    int window = Add(tree, -1, AccessibleControlType::Window, L"main.cpp - Visual Studio Code",
+                     Rect(0, 0, 1600, 1000));
+    int bar = Add(tree, window, AccessibleControlType::ToolBar, L"", Rect(0, 0, 1600, 40), L"toolbar");
+    Add(tree, bar, AccessibleControlType::Edit, L"Address", Rect(100, 5, 900, 35), L"address",
+        L"https://example.com/?q=\"a\\b\"");
+    Add(tree, bar, AccessibleControlType::Button, L"Tab\tand\nnewline\x01", Rect(-8, -8, 0, 0));
+    int list = Add(tree, window, AccessibleControlType::List, L"微信 messages", Rect(0, 40, 1600, 1000));
+    for (int i = 0; i < 3; i++) {
+        int item = Add(tree, list, AccessibleControlType::ListItem, L"Message " + std::to_wstring(i));
+        Add(tree, item, AccessibleControlType::Text, L"text " + std::to_wstring(i));
+    }
+    return tree;
+}
+
+} // namespace
+
+TEST(RoundTripKeepsStructureAndProperties) {
+    AccessibleSnapshot tree = SampleTree();
+    AccessibleSnapshot loaded;
+    std::string first;
+    std::string second;
+    REQUIRE(RoundTrip(tree, loaded, first, second));
+
+    CHECK_EQ(loaded.GetNodeCount(), tree.GetNodeCount());
+    CHECK_EQ(loaded.GetApp(), std::string("test"));
+    CHECK_EQ(Dump(*loaded.GetRoot()), Dump(*tree.GetRoot()));
+    CHECK_EQ(second, first);
+}
+
+TEST(RoundTripKeepsSurrogatePairs) {
+    // U+1F600 is a surrogate pair where wchar_t is 16 bits (Windows)
+    const std::wstring emoji = L"chat \U0001F600 你好";
+    AccessibleSnapshot tree;
+    int window = Add(tree, -1, AccessibleControlType::Window, emoji);
+    Add(tree, window, AccessibleControlType::Text, L"\U0001F468‍\U0001F469‍\U0001F467");
+
+    AccessibleSnapshot loaded;
+    std::string first;
+    std::string second;
+    REQUIRE(RoundTrip(tree, loaded, first, second));
+    CHECK_EQ(loaded.GetRoot()->GetProperties().name, emoji);
+    CHECK_EQ(Dump(*loaded.GetRoot()), Dump(*tree.GetRoot()));
+
+    // Written as UTF-8 (F0 9F 98 80), not as escaped surrogates
+    CHECK(first.find("\xF0\x9F\x98\x80") != std::string::npos);
+    CHECK(first.find("\\ud83d") == std::string::npos);
+
+    // JSON surrogate escapes load as the same character
+    AccessibleSnapshot escaped;
+    REQUIRE(AccessibleSnapshot::Load(
+        "{\"root\":{\"type\":\"Window\",\"name\":\"chat \\ud83d\\ude00 \\u4f60\\u597d\"}}", escaped));
+    CHECK_EQ(escaped.GetRoot()->GetProperties().name, emoji);
+}
+
+TEST(RoundTripKeepsLoneSurrogates) {
+    // UIA can hand out truncated text that ends in half a pair
+    std::wstring name = L"cut ";
+    name += static_cast<wchar_t>(0xD83D);
+    AccessibleSnapshot tree;
+    Add(tree, -1, AccessibleControlType::Window, name);
+
+    AccessibleSnapshot loaded;
+    std::string first;
+    std::string second;
+    REQUIRE(RoundTrip(tree, loaded, first, second));
+    CHECK(first.find("\\ud83d") != std::string::npos);
+    CHECK_EQ(loaded.GetRoot()->GetProperties().name, name);
+}
+
+TEST(RoundTripKeepsUnknownControlTypes) {
+    // Newer than the table (e.g. a future UIA control type), and none at all
+    AccessibleSnapshot tree;
+    int window = Add(tree, -1, AccessibleControlType::Window, L"Window");
+    Add(tree, window, 50099, L"Future");
+    Add(tree, window, 0, L"Untyped");
+
+    AccessibleSnapshot loaded;
+    std::string first;
+    std::string second;
+    REQUIRE(RoundTrip(tree, loaded, first, second));
+    std::vector<AccessibleElementPtr> children = loaded.GetRoot()->GetChildren();
+    REQUIRE(children.size() == 2);
+    CHECK_EQ(children[0]->GetProperties().controlType, 50099);
+    CHECK_EQ(children[1]->GetProperties().controlType, 0);
+    CHECK_EQ(second, first);
+}
+
+TEST(LoadAcceptsTypeNamesAndIds) {
+    AccessibleSnapshot tree;
+    REQUIRE(AccessibleSnapshot::Load(
+        "{\"app\":\"vscode\",\"root\":{\"type\":\"window\",\"children\":["
+        "{\"type\":\"StatusBar\"},{\"type\":50020,\"name\":\"Ln 1, Col 1\"}]}}", tree));
+    CHECK_EQ(tree.GetApp(), std::string("vscode"));
+    CHECK_EQ(tree.GetNodeCount(), size_t(3));
+    std::vector<AccessibleElementPtr> children = tree.GetRoot()->GetChildren();
+    REQUIRE(children.size() == 2);
+    CHECK_EQ(tree.GetRoot()->GetProperties().controlType, AccessibleControlType::Window);
+    CHECK_EQ(children[0]->GetProperties().controlType, AccessibleControlType::StatusBar);
+    CHECK_EQ(children[1]->GetProperties().controlType, AccessibleControlType::Text);
+}
+
+TEST(LoadRejectsBadDocuments) {
+    struct Case {
+        const char* text;
+        const char* error;
+    };
+    const Case cases[] = {
+        {"{\"app\":\"x\"}", "missing \"root\""},
+        {"{\"root\":[]}", "node is not an object"},
+        {"{\"root\":{\"type\":\"NoSuchType\"}}", "unknown control type: NoSuchType"},
+        {"{\"root\":{\"rect\":[1,2,3]}}", "rect needs [left, top, right, bottom]"},
+        {"{\"root\":{\"children\":[{\"type\":\"Text\"}, 5]}}", "node is not an object"},
+    };
+    for (const Case& c : cases) {
+        AccessibleSnapshot tree;
+        Add(tree, -1, AccessibleControlType::Window, L"kept");
+        std::string error;
+        CHECK(!AccessibleSnapshot::Load(c.text, tree, &error));
+        CHECK_EQ(error, std::string(c.error));
+        CHECK_EQ(tree.GetNodeCount(), size_t(1));    // Left as it was
+    }
+
+    AccessibleSnapshot tree;
+    std::string error;
+    CHECK(!AccessibleSnapshot::Load("{\"root\":", tree, &error));
+    CHECK(!error.empty());
+}
+
+TEST(RecordStopsAtMaxNodes) {
+    AccessibleSnapshot tree = SampleTree();
+    AccessibleSnapshot loaded;
+    REQUIRE(AccessibleSnapshot::Load(AccessibleSnapshot::Record(*tree.GetRoot(), "test", 4), loaded));
+    CHECK_EQ(loaded.GetNodeCount(), size_t(4));
+}
+
+TEST(CountsProviderCalls) {
+    AccessibleSnapshot tree = SampleTree();
+    AccessibleElementPtr root = tree.GetRoot();
+    CHECK_EQ(tree.GetCallCount(), uint64_t(0));
+
+    // The root comes with its properties; its children cost one call
+    root->GetProperties();
+    CHECK_EQ(tree.GetCallCount(), uint64_t(0));
+    std::vector<AccessibleElementPtr> children = root->GetChildren();
+    CHECK_EQ(tree.GetCallCount(), uint64_t(1));
+    children[0]->GetProperties();
+    CHECK_EQ(tree.GetCallCount(), uint64_t(1));
+
+    // A search is one call whatever it returns; unbound results pay per element once
+    AccessibleQuery texts;
+    texts.controlType = AccessibleControlType::Text;
+    std::vector<AccessibleElementPtr> found =
+        root->FindAll(AccessibleScope::Descendants, texts, AccessibleCache::None);
+    CHECK_EQ(found.size(), size_t(3));
+    CHECK_EQ(tree.GetCallCount(), uint64_t(2));
+    for (const AccessibleElementPtr& element : found) {
+        element->GetProperties();
+        element->GetProperties();
+    }
+    CHECK_EQ(tree.GetCallCount(), uint64_t(5));
+
+    // Bound results are free, and so are cached children
+    AccessibleQuery lists;
+    lists.controlType = AccessibleControlType::List;
+    AccessibleElementPtr list = root->FindFirst(AccessibleScope::Descendants, lists, AccessibleCache::Children);
+    REQUIRE(list);
+    CHECK_EQ(tree.GetCallCount(), uint64_t(6));
+    std::vector<AccessibleElementPtr> items = list->GetChildren();
+    CHECK_EQ(items.size(), size_t(3));
+    CHECK_EQ(items[2]->GetProperties().name, std::wstring(L"Message 2"));
+    CHECK_EQ(tree.GetCallCount(), uint64_t(6));
+
+    // Their children are not cached; parent and value are calls, identity is free
+    CHECK_EQ(items[2]->GetChildren().size(), size_t(1));
+    CHECK_EQ(tree.GetCallCount(), uint64_t(7));
+    AccessibleElementPtr parent = items[2]->GetParent();
+    REQUIRE(parent);
+    CHECK(parent->GetRuntimeId() == list->GetRuntimeId());
+    CHECK_EQ(tree.GetCallCount(), uint64_t(8));
+    CHECK(!root->GetParent());
+    CHECK_EQ(children[0]->GetChildren()[0]->GetValue(), std::wstring(L"https://example.com/?q=\"a\\b\""));
+    CHECK_EQ(tree.GetCallCount(), uint64_t(11));
+
+    tree.ResetCallCount();
+    CHECK_EQ(tree.GetCallCount(), uint64_t(0));
+    CHECK_EQ(tree.GetVisitCount(), uint64_t(0));
+}
+
+TEST(CountsElementsExamined) {
+    AccessibleSnapshot tree = SampleTree();
+    AccessibleElementPtr root = tree.GetRoot();
+
+    // A descendants search examines the whole subtree, whatever it returns
+    AccessibleQuery byId;
+    byId.automationId = L"nothing";
+    CHECK(!root->FindFirst(AccessibleScope::Descendants, byId, AccessibleCache::Properties));
+    CHECK_EQ(tree.GetVisitCount(), uint64_t(tree.GetNodeCount() - 1));
+
+    // Children come with the results that cache them
+    tree.ResetCallCount();
+    AccessibleQuery lists;
+    lists.controlType = AccessibleControlType::List;
+    root->FindAll(AccessibleScope::Children, lists, AccessibleCache::Children);
+    CHECK_EQ(tree.GetVisitCount(), uint64_t(2 + 3));
+}
+
+int main() { return RunAllTests(); }
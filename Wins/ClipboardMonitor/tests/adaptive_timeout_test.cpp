@@ -0,0 +1,118 @@
+// AdaptiveTimeout: the configured timeout until minSamples, then the
+// percentile with headroom clamped to [floorMs, ceilingMs], per process
+// before per adapter
+
+#include "test_framework.h"
+#include "../context/adaptive_timeout.h"
+#include "../context/context_adapter.h"
+
+namespace {
+
+class FakeAdapter : public IContextAdapter {
+public:
+    bool CanHandle(const std::wstring&, const std::wstring&) override { return true; }
+    std::shared_ptr<ContextData> GetContext(const SourceInfo&, const CancellationToken&) override {
+        return nullptr;
+    }
+    std::wstring GetAdapterName() const override { return L"FakeAdapter"; }
+};
+
+const int kConfiguredMs = 700;
+
+AdaptiveTimeoutPolicy Policy() {
+    AdaptiveTimeoutPolicy policy;
+    policy.percentile = 0.9;
+    policy.headroom = 2.0;
+    policy.floorMs = 100;
+    policy.ceilingMs = 1000;
+    policy.minSamples = 4;
+    return policy;
+}
+
+void RecordMany(AdaptiveTimeout& timeouts, const IContextAdapter* adapter,
+                const std::wstring& process, int elapsedMs, int count) {
+    for (int i = 0; i < count; i++) {
+        timeouts.Record(adapter, process, elapsedMs);
+    }
+}
+
+} // namespace
+
+TEST(ConfiguredTimeoutUntilMinSamples) {
+    FakeAdapter adapter;
+    AdaptiveTimeout timeouts;
+    timeouts.SetPolicy(Policy());
+    CHECK_EQ(timeouts.GetTimeout(&adapter, L"app.exe", kConfiguredMs), kConfiguredMs);
+
+    RecordMany(timeouts, &adapter, L"app.exe", 200, 3);
+    CHECK_EQ(timeouts.GetTimeout(&adapter, L"app.exe", kConfiguredMs), kConfiguredMs);
+
+    // The fourth sample: p90 of 200ms with 2x headroom
+    timeouts.Record(&adapter, L"app.exe", 200);
+    CHECK_EQ(timeouts.GetTimeout(&adapter, L"app.exe", kConfiguredMs), 400);
+}
+
+TEST(TimeoutIsClampedToFloorAndCeiling) {
+    FakeAdapter fast;
+    FakeAdapter slow;
+    AdaptiveTimeout timeouts;
+    timeouts.SetPolicy(Policy());
+
+    RecordMany(timeouts, &fast, L"app.exe", 10, 8);
+    CHECK_EQ(timeouts.GetTimeout(&fast, L"app.exe", kConfiguredMs), 100);
+
+    RecordMany(timeouts, &slow, L"app.exe", 3000, 8);
+    CHECK_EQ(timeouts.GetTimeout(&slow, L"app.exe", kConfiguredMs), 1000);
+
+    // Negative times count as zero, still clamped to the floor
+    FakeAdapter odd;
+    RecordMany(timeouts, &odd, L"app.exe", -50, 8);
+    CHECK_EQ(timeouts.GetTimeout(&odd, L"app.exe", kConfiguredMs), 100);
+}
+
+TEST(PercentileFollowsTheWindow) {
+    FakeAdapter adapter;
+    AdaptiveTimeout timeouts;
+    timeouts.SetPolicy(Policy());
+
+    // 9 fast fetches and 1 slow: p90 is still a fast one
+    RecordMany(timeouts, &adapter, L"app.exe", 100, 9);
+    timeouts.Record(&adapter, L"app.exe", 450);
+    CHECK_EQ(timeouts.GetTimeout(&adapter, L"app.exe", kConfiguredMs), 200);
+
+    // A second slow one moves p90 onto it
+    timeouts.Record(&adapter, L"app.exe", 450);
+    CHECK_EQ(timeouts.GetTimeout(&adapter, L"app.exe", kConfiguredMs), 900);
+
+    // Once the window has rolled past them, only the recent samples count
+    RecordMany(timeouts, &adapter, L"app.exe", 150, static_cast<int>(AdaptiveTimeout::kWindow));
+    CHECK_EQ(timeouts.GetTimeout(&adapter, L"app.exe", kConfiguredMs), 300);
+}
+
+TEST(ProcessWindowBeforeAdapterWindow) {
+    FakeAdapter adapter;
+    AdaptiveTimeout timeouts;
+    timeouts.SetPolicy(Policy());
+
+    RecordMany(timeouts, &adapter, L"Slow.exe", 400, 4);
+    RecordMany(timeouts, &adapter, L"fast.exe", 60, 4);
+    CHECK_EQ(timeouts.GetTimeout(&adapter, L"slow.exe", kConfiguredMs), 800);   // Names are case-insensitive
+    CHECK_EQ(timeouts.GetTimeout(&adapter, L"FAST.EXE", kConfiguredMs), 120);
+
+    // A process with too few samples of its own uses the adapter's window
+    timeouts.Record(&adapter, L"new.exe", 5);
+    CHECK_EQ(timeouts.GetTimeout(&adapter, L"new.exe", kConfiguredMs), 800);
+    CHECK_EQ(timeouts.GetTimeout(&adapter, L"unseen.exe", kConfiguredMs), 800);
+
+    // Another adapter knows nothing yet
+    FakeAdapter other;
+    CHECK_EQ(timeouts.GetTimeout(&other, L"slow.exe", kConfiguredMs), kConfiguredMs);
+
+    std::vector<AdaptiveTimeout::Snapshot> rows = timeouts.GetSnapshot();
+    REQUIRE(rows.size() == 4);
+    CHECK_EQ(rows[0].adapter, std::string("FakeAdapter"));
+    CHECK(rows[0].process.empty());
+    CHECK_EQ(rows[0].samples, size_t(9));
+}
+
+int main() { return RunAllTests(); }
@@ -0,0 +1,367 @@
+// AsyncExecutor: priority/deadline scheduling, work stealing, shutdown and worker
+// hooks (the per-thread COM setup of the adapters)
+
+#include "test_framework.h"
+#include "../context/async_executor.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Index of the worker whose onStart ran on this thread (-1: none)
+thread_local int t_startedIndex = -1;
+
+// What the hooks saw, per worker index
+struct HookLog {
+    std::mutex mutex;
+    std::map<size_t, int> starts;
+    std::map<size_t, int> stops;
+    std::map<size_t, std::thread::id> startThreads;
+    std::map<size_t, std::thread::id> stopThreads;
+    bool stopOffThread = false;     // onStop ran where its onStart did not
+
+    AsyncExecutor::WorkerHooks MakeHooks() {
+        AsyncExecutor::WorkerHooks hooks;
+        hooks.onStart = [this](size_t index) {
+            t_startedIndex = static_cast<int>(index);
+            std::lock_guard<std::mutex> lock(mutex);
+            starts[index]++;
+            startThreads[index] = std::this_thread::get_id();
+        };
+        hooks.onStop = [this](size_t index) {
+            std::lock_guard<std::mutex> lock(mutex);
+            stops[index]++;
+            stopThreads[index] = std::this_thread::get_id();
+            stopOffThread = stopOffThread || t_startedIndex != static_cast<int>(index);
+        };
+        return hooks;
+    }
+
+    int GetStops() {
+        std::lock_guard<std::mutex> lock(mutex);
+        int total = 0;
+        for (const auto& entry : stops) {
+            total += entry.second;
+        }
+        return total;
+    }
+};
+
+// Task that holds a worker until Release(), so the queues can be filled
+// behind it before anything else runs
+struct Gate {
+    std::mutex mutex;
+    std::condition_variable condition;
+    int entered = 0;
+    bool open = false;
+
+    void Hold() {
+        std::unique_lock<std::mutex> lock(mutex);
+        entered++;
+        condition.notify_all();
+        condition.wait(lock, [this] { return open; });
+    }
+
+    // Wait until `count` workers are held
+    void WaitEntered(int count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&] { return entered >= count; });
+    }
+
+    void Release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        open = true;
+        condition.notify_all();
+    }
+};
+
+// Order in which tasks ran, by label
+struct RunOrder {
+    std::mutex mutex;
+    std::vector<int> labels;
+
+    void Add(int label) {
+        std::lock_guard<std::mutex> lock(mutex);
+        labels.push_back(label);
+    }
+};
+
+TaskOptions WithPriority(TaskPriority priority) {
+    TaskOptions options;
+    options.priority = priority;
+    return options;
+}
+
+TaskOptions WithDeadline(TaskPriority priority, std::chrono::steady_clock::time_point deadline) {
+    TaskOptions options = WithPriority(priority);
+    options.deadline = deadline;
+    return options;
+}
+
+} // namespace
+
+TEST(EarliestDeadlineFirstWithinAClass) {
+    // One worker, so the run order is the dequeue order
+    AsyncExecutor executor(1);
+    Gate gate;
+    executor.Submit([&]() { gate.Hold(); });
+    gate.WaitEntered(1);
+
+    auto base = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    RunOrder order;
+    std::vector<TaskFuture<void>> results;
+    const int offsets[] = {5, 1, 4, 1, 3, 2, 0};
+    for (int i = 0; i < 7; i++) {
+        // Label: offset * 10 + submission index, to see FIFO among equal deadlines
+        int label = offsets[i] * 10 + i;
+        results.push_back(executor.SubmitWithOptions(
+            WithDeadline(TaskPriority::Normal, base + std::chrono::milliseconds(offsets[i])),
+            [&order, label]() { order.Add(label); }));
+    }
+    // No deadline sorts last
+    results.push_back(executor.SubmitWithOptions(WithPriority(TaskPriority::Normal), [&]() { order.Add(99); }));
+    gate.Release();
+    for (auto& result : results) {
+        result.get();
+    }
+    CHECK_EQ(order.labels, (std::vector<int>{6, 11, 13, 25, 34, 42, 50, 99}));
+}
+
+TEST(ExpiredTaskIsDroppedUnrun) {
+    AsyncExecutor executor(1);
+    Gate gate;
+    executor.Submit([&]() { gate.Hold(); });
+    gate.WaitEntered(1);
+
+    std::atomic<bool> ran{false};
+    TaskFuture<int> expired = executor.SubmitWithOptions(
+        WithDeadline(TaskPriority::Normal, std::chrono::steady_clock::now() + std::chrono::milliseconds(20)),
+        [&]() { ran = true; return 1; });
+    TaskFuture<int> live = executor.SubmitWithOptions(
+        WithDeadline(TaskPriority::Normal, std::chrono::steady_clock::now() + std::chrono::seconds(60)),
+        []() { return 2; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    gate.Release();
+
+    CHECK_EQ(live.get(), 2);
+    bool broken = false;
+    try {
+        expired.get();
+    } catch (const std::future_error& e) {
+        broken = e.code() == std::future_errc::broken_promise;
+    }
+    CHECK(broken);
+    CHECK(!ran);
+    CHECK_EQ(executor.GetDroppedCount(), size_t(1));
+    CHECK_EQ(executor.GetMetricsSnapshot().dropped, size_t(1));
+    CHECK_EQ(executor.GetQueueDepth(), size_t(0));
+}
+
+TEST(InteractiveOvertakesBackgroundBacklog) {
+    AsyncExecutor executor(1);
+    Gate gate;
+    executor.Submit([&]() { gate.Hold(); });
+    gate.WaitEntered(1);
+
+    RunOrder order;
+    std::vector<TaskFuture<void>> results;
+    for (int i = 0; i < 100; i++) {
+        results.push_back(executor.SubmitWithOptions(WithPriority(TaskPriority::Background),
+                                                     [&order, i]() { order.Add(i); }));
+    }
+    results.push_back(executor.SubmitWithOptions(WithPriority(TaskPriority::Normal), [&]() { order.Add(200); }));
+    results.push_back(executor.SubmitWithOptions(WithPriority(TaskPriority::Interactive), [&]() { order.Add(100); }));
+    gate.Release();
+    for (auto& result : results) {
+        result.get();
+    }
+    REQUIRE(order.labels.size() == 102);
+    CHECK_EQ(order.labels[0], 100);
+    CHECK_EQ(order.labels[1], 200);
+    CHECK_EQ(order.labels[2], 0);
+    CHECK_EQ(order.labels[101], 99);
+}
+
+TEST(BackgroundLeavesOneWorkerFree) {
+    const size_t threads = 4;
+    AsyncExecutor executor(threads);
+    std::atomic<int> active{0};
+    std::atomic<int> peak{0};
+    std::atomic<int> finished{0};
+    std::vector<TaskFuture<void>> background;
+    for (int i = 0; i < 30; i++) {
+        background.push_back(executor.SubmitWithOptions(WithPriority(TaskPriority::Background), [&]() {
+            int now = ++active;
+            int seen = peak.load();
+            while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            --active;
+            ++finished;
+        }));
+    }
+
+    // The free worker takes a Normal task while the backlog is still there
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    int finishedBefore = executor.Submit([&]() { return finished.load(); }).get();
+    CHECK(finishedBefore < 30);
+
+    for (auto& result : background) {
+        result.get();
+    }
+    CHECK_EQ(finished.load(), 30);
+    CHECK(peak.load() <= static_cast<int>(threads - 1));
+    CHECK(peak.load() >= 2);
+}
+
+TEST(IdleWorkersStealFromABusyWorker) {
+    AsyncExecutor executor(4);
+    const int children = 200;
+    std::mutex mutex;
+    std::condition_variable condition;
+    int done = 0;
+    std::map<std::thread::id, int> ranOn;
+
+    // Children posted from a worker go to its own deque; it stays busy until
+    // they have all run, so only stealing can run them
+    std::thread::id poster;
+    bool allDone = executor.Submit([&]() {
+        poster = std::this_thread::get_id();
+        for (int i = 0; i < children; i++) {
+            executor.Submit([&]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                ranOn[std::this_thread::get_id()]++;
+                done++;
+                condition.notify_all();
+            });
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        return condition.wait_for(lock, std::chrono::seconds(5), [&] { return done == children; });
+    }).get();
+
+    CHECK(allDone);
+    std::lock_guard<std::mutex> lock(mutex);
+    CHECK_EQ(done, children);
+    CHECK(ranOn.count(poster) == 0);
+    CHECK(!ranOn.empty());
+}
+
+TEST(PostsRacingShutdownRunOrAreRejected) {
+    for (int round = 0; round < 50; round++) {
+        AsyncExecutor executor(2);
+        std::atomic<int> accepted{0};
+        std::atomic<int> ran{0};
+        std::atomic<bool> go{false};
+        std::atomic<bool> rejectedIntact{true};
+        std::vector<std::thread> posters;
+        for (int t = 0; t < 3; t++) {
+            posters.emplace_back([&]() {
+                while (!go) {
+                    std::this_thread::yield();
+                }
+                while (true) {
+                    AsyncExecutor::Task task([&ran]() { ran++; });
+                    if (!executor.TryPost(task)) {
+                        // Rejected tasks are left untouched
+                        rejectedIntact = rejectedIntact && static_cast<bool>(task);
+                        break;
+                    }
+                    accepted++;
+                }
+            });
+        }
+        go = true;
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+        executor.Shutdown();
+        for (auto& poster : posters) {
+            poster.join();
+        }
+
+        // Every accepted task ran before Shutdown returned
+        CHECK(rejectedIntact);
+        CHECK_EQ(ran.load(), accepted.load());
+        CHECK_EQ(executor.GetQueueDepth(), size_t(0));
+    }
+}
+
+TEST(HooksRunOncePerWorkerOnItsThread) {
+    const size_t threads = 4;
+    HookLog log;
+    AsyncExecutor executor(threads, log.MakeHooks());
+    REQUIRE(executor.GetThreadCount() == threads);
+
+    // Every task runs on a thread its worker's onStart has prepared
+    std::vector<TaskFuture<int>> results;
+    for (int i = 0; i < 200; i++) {
+        results.push_back(executor.Submit([]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            return t_startedIndex;
+        }));
+    }
+    for (auto& result : results) {
+        int index = result.get();
+        CHECK(index >= 0 && index < static_cast<int>(threads));
+    }
+    CHECK_EQ(log.GetStops(), 0);
+
+    executor.Shutdown();
+
+    std::lock_guard<std::mutex> lock(log.mutex);
+    CHECK_EQ(log.starts.size(), threads);
+    CHECK_EQ(log.stops.size(), threads);
+    std::vector<std::thread::id> seen;
+    for (size_t index = 0; index < threads; index++) {
+        CHECK_EQ(log.starts[index], 1);
+        CHECK_EQ(log.stops[index], 1);
+        CHECK(log.startThreads[index] == log.stopThreads[index]);
+        CHECK(log.startThreads[index] != std::this_thread::get_id());
+        CHECK(std::find(seen.begin(), seen.end(), log.startThreads[index]) == seen.end());
+        seen.push_back(log.startThreads[index]);
+    }
+    CHECK(!log.stopOffThread);
+}
+
+TEST(OnStopRunsAtShutdownAfterQueuedTasks) {
+    HookLog log;
+    std::atomic<int> ran[2] = {0, 0};       // Tasks run, per worker
+    int ranBeforeStop[2] = {-1, -1};        // The same, as each onStop saw it
+    AsyncExecutor::WorkerHooks hooks = log.MakeHooks();
+    auto onStop = hooks.onStop;
+    hooks.onStop = [&, onStop](size_t index) {
+        ranBeforeStop[index] = ran[index].load();
+        onStop(index);
+    };
+    {
+        AsyncExecutor executor(2, hooks);
+        for (int i = 0; i < 100; i++) {
+            executor.Submit([&]() {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                ran[t_startedIndex]++;
+            });
+        }
+        // Destructor shuts down: queued tasks drain, then each worker stops
+    }
+
+    CHECK_EQ(ran[0].load() + ran[1].load(), 100);
+    CHECK_EQ(ranBeforeStop[0], ran[0].load());
+    CHECK_EQ(ranBeforeStop[1], ran[1].load());
+    CHECK_EQ(log.GetStops(), 2);
+    std::lock_guard<std::mutex> lock(log.mutex);
+    CHECK_EQ(log.starts[0], 1);
+    CHECK_EQ(log.starts[1], 1);
+    CHECK(!log.stopOffThread);
+}
+
+TEST(NoHooksIsFine) {
+    AsyncExecutor executor(2);
+    CHECK_EQ(executor.Submit([]() { return 42; }).get(), 42);
+    executor.Shutdown();
+}
+
+int main() { return RunAllTests(); }
@@ -0,0 +1,176 @@
+// BinaryLogWriter -> log_decoder round trip: every argument type, sessions
+// after a zero tail, and a truncated record
+
+#include "test_framework.h"
+#include "../binary_log.h"
+#include "../tools/log_decoder/binary_log_reader.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Fresh directory per test, removed afterwards
+struct TempDir {
+    fs::path path;
+
+    explicit TempDir(const std::string& name) {
+        path = fs::temp_directory_path() / ("binary_log_test_" + name);
+        fs::remove_all(path);
+        fs::create_directories(path);
+    }
+    ~TempDir() {
+        std::error_code error;
+        fs::remove_all(path, error);
+    }
+
+    std::wstring File() const { return (path / "debug.bin").wstring(); }
+    std::vector<char> Read() const {
+        std::ifstream file(path / "debug.bin", std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    void Write(const std::vector<char>& data) const {
+        std::ofstream file(path / "debug.bin", std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+};
+
+struct Decoded {
+    std::vector<LogDecoder::Record> records;
+    std::vector<std::string> lines;
+    std::vector<int64_t> sessions;      // Session wall clock per record
+    bool complete = false;
+    std::string error;
+};
+
+Decoded DecodeAll(std::vector<char> data) {
+    Decoded result;
+    result.complete = LogDecoder::Decode(std::move(data),
+        [&](const LogDecoder::SessionHeader& header, const LogDecoder::Record& record) {
+            result.records.push_back(record);
+            result.lines.push_back(LogDecoder::RenderText(header, record));
+            result.sessions.push_back(header.wallMicros);
+        },
+        result.error);
+    return result;
+}
+
+bool EndsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// One record of each argument type
+void WriteSession(const std::wstring& path) {
+    BinaryLogWriter writer;
+    REQUIRE(writer.Open(path));
+    writer.Append(LogEventId::SequenceChanged, LogLevel::Debug, 41u, 42);
+    // "é" (BMP) and U+1F600 (a surrogate pair on Windows)
+    writer.Append(LogEventId::SourceInfo, LogLevel::Debug,
+                  std::wstring(L"café.exe"), std::wstring(L"Title \U0001F600"));
+    writer.Append(LogEventId::AdapterCompleted, LogLevel::Info, "BrowserAdapter", 12.5, true);
+    writer.Append(LogEventId::ContextAttached, LogLevel::Debug, "NotionAdapter", false, -3.25);
+    writer.Close();
+}
+
+} // namespace
+
+TEST(EveryArgumentTypeRoundTrips) {
+    TempDir dir("types");
+    WriteSession(dir.File());
+
+    Decoded decoded = DecodeAll(dir.Read());
+    CHECK(decoded.complete);
+    CHECK(decoded.error.empty());
+    REQUIRE(decoded.records.size() == 4);
+
+    const LogDecoder::Record& sequence = decoded.records[0];
+    CHECK_EQ(sequence.eventId, static_cast<uint16_t>(LogEventId::SequenceChanged));
+    CHECK_EQ(sequence.level, static_cast<uint8_t>(LogLevel::Debug));
+    REQUIRE(sequence.args.size() == 2);
+    CHECK(sequence.args[0].kind == LogDecoder::ArgKind::Unsigned);
+    CHECK_EQ(sequence.args[0].u, uint64_t(41));
+    CHECK(sequence.args[1].kind == LogDecoder::ArgKind::Signed);
+    CHECK_EQ(sequence.args[1].i, int64_t(42));
+
+    const LogDecoder::Record& source = decoded.records[1];
+    REQUIRE(source.args.size() == 2);
+    CHECK(source.args[0].kind == LogDecoder::ArgKind::String);
+    CHECK_EQ(source.args[0].s, std::string("caf\xC3\xA9.exe"));
+    CHECK_EQ(source.args[1].s, std::string("Title \xF0\x9F\x98\x80"));
+
+    const LogDecoder::Record& adapter = decoded.records[2];
+    REQUIRE(adapter.args.size() == 3);
+    CHECK_EQ(adapter.args[0].s, std::string("BrowserAdapter"));
+    CHECK(adapter.args[1].kind == LogDecoder::ArgKind::Double);
+    CHECK_EQ(adapter.args[1].d, 12.5);
+    CHECK(adapter.args[2].kind == LogDecoder::ArgKind::Bool);
+    CHECK(adapter.args[2].b);
+    CHECK(!decoded.records[3].args[1].b);
+    CHECK_EQ(decoded.records[3].args[2].d, -3.25);
+
+    // Text output matches what debug.log would have said
+    CHECK(EndsWith(decoded.lines[0], "] [DEBUG] Seq: 41 -> 42"));
+    CHECK(EndsWith(decoded.lines[1], "] [DEBUG] Source: caf\xC3\xA9.exe | Title \xF0\x9F\x98\x80"));
+    CHECK(EndsWith(decoded.lines[2], "] [INFO] BrowserAdapter: Completed in 12.50ms, success=true"));
+    CHECK(EndsWith(decoded.lines[3], "] [DEBUG] Context: NotionAdapter, success=false, time=-3.25ms"));
+    CHECK(decoded.lines[0].front() == '[');
+
+    // Elapsed time only moves forward within a session
+    for (size_t i = 1; i < decoded.records.size(); i++) {
+        CHECK(decoded.records[i].elapsedNs >= decoded.records[i - 1].elapsedNs);
+    }
+}
+
+TEST(ZeroTailIsSkippedAndTheNextSessionDecodes) {
+    TempDir dir("tail");
+    WriteSession(dir.File());
+
+    // What an unclean shutdown leaves behind in the mapped file
+    std::vector<char> data = dir.Read();
+    data.insert(data.end(), 4096, '\0');
+    dir.Write(data);
+
+    // The next session appends after the zeros with its own header
+    WriteSession(dir.File());
+
+    Decoded decoded = DecodeAll(dir.Read());
+    CHECK(decoded.complete);
+    REQUIRE(decoded.records.size() == 8);
+    CHECK_EQ(decoded.records[4].eventId, static_cast<uint16_t>(LogEventId::SequenceChanged));
+    CHECK(decoded.sessions[4] >= decoded.sessions[3]);
+    CHECK(EndsWith(decoded.lines[6], "] [INFO] BrowserAdapter: Completed in 12.50ms, success=true"));
+
+    // A file that ends in zeros is complete, not truncated
+    data = dir.Read();
+    data.insert(data.end(), 3, '\0');
+    Decoded padded = DecodeAll(data);
+    CHECK(padded.complete);
+    CHECK_EQ(padded.records.size(), size_t(8));
+}
+
+TEST(TruncatedRecordIsReportedAfterTheRecordsBeforeIt) {
+    TempDir dir("truncated");
+    WriteSession(dir.File());
+    std::vector<char> data = dir.Read();
+
+    // Cut into the last record's arguments
+    data.resize(data.size() - 4);
+    Decoded decoded = DecodeAll(data);
+    CHECK(!decoded.complete);
+    CHECK_EQ(decoded.records.size(), size_t(3));
+    CHECK(decoded.error.rfind("Truncated record at offset ", 0) == 0);
+
+    // A file without a header is not a debug.bin
+    std::vector<char> text = {'h', 'e', 'l', 'l', 'o'};
+    Decoded notBinary = DecodeAll(text);
+    CHECK(!notBinary.complete);
+    CHECK_EQ(notBinary.error, std::string("Not a debug.bin file (missing header)"));
+    CHECK(notBinary.records.empty());
+}
+
+int main() { return RunAllTests(); }
@@ -0,0 +1,169 @@
+// CircuitBreaker: opens on the failure rate once minRequests outcomes are
+// in, lets one probe through at a time, and counts only that probe's outcome
+
+#include "test_framework.h"
+#include "../context/circuit_breaker.h"
+#include <thread>
+
+namespace {
+
+using Ticket = CircuitBreaker::Ticket;
+using State = CircuitBreaker::State;
+
+const int kOpenMs = 50;
+
+CircuitBreakerPolicy Policy() {
+    CircuitBreakerPolicy policy;
+    policy.window = 10;
+    policy.minRequests = 4;
+    policy.failureRate = 0.5;
+    policy.openMs = kOpenMs;
+    return policy;
+}
+
+// Closed-state fetches: allowed, not probes
+void RecordOutcomes(CircuitBreaker& breaker, std::initializer_list<bool> outcomes) {
+    for (bool success : outcomes) {
+        Ticket ticket = 1234;
+        REQUIRE(breaker.Allow(ticket));
+        CHECK_EQ(ticket, CircuitBreaker::kNotProbe);
+        breaker.Record(ticket, success);
+    }
+}
+
+// Trip the breaker and wait out the open period
+void OpenAndWait(CircuitBreaker& breaker) {
+    RecordOutcomes(breaker, {false, false, false, false});
+    REQUIRE(breaker.GetStats().state == State::Open);
+    std::this_thread::sleep_for(std::chrono::milliseconds(kOpenMs + 20));
+}
+
+} // namespace
+
+TEST(OpensOnTheFailureRateOnceMinRequestsAreIn) {
+    CircuitBreaker breaker("adapter", Policy());
+
+    // Three failures out of three: too few to judge
+    RecordOutcomes(breaker, {false, false, false});
+    CHECK(breaker.GetStats().state == State::Closed);
+    CHECK_EQ(breaker.GetStats().failures, size_t(3));
+
+    // The fourth outcome brings 3/4 over the rate, even as a success
+    RecordOutcomes(breaker, {true});
+    CircuitBreaker::Stats stats = breaker.GetStats();
+    CHECK(stats.state == State::Open);
+    CHECK_EQ(stats.requests, size_t(4));
+    CHECK_EQ(stats.opened, uint64_t(1));
+
+    // Refused while open
+    Ticket ticket = CircuitBreaker::kNotProbe;
+    CHECK(!breaker.Allow(ticket));
+    CHECK(!breaker.Allow(ticket));
+    CHECK_EQ(breaker.GetStats().rejected, uint64_t(2));
+}
+
+TEST(StaysClosedBelowTheRate) {
+    CircuitBreaker breaker("adapter", Policy());
+    for (int i = 0; i < 5; i++) {
+        RecordOutcomes(breaker, {true, false, true});
+    }
+    CHECK(breaker.GetStats().state == State::Closed);
+
+    // The window rolls: only the last 10 outcomes count
+    CircuitBreaker::Stats stats = breaker.GetStats();
+    CHECK_EQ(stats.requests, size_t(10));
+    CHECK(stats.failures < 5);
+}
+
+TEST(OneProbeAtATimeAndItsSuccessCloses) {
+    CircuitBreaker breaker("adapter", Policy());
+    OpenAndWait(breaker);
+
+    Ticket probe = CircuitBreaker::kNotProbe;
+    REQUIRE(breaker.Allow(probe));
+    CHECK(probe != CircuitBreaker::kNotProbe);
+    CHECK(breaker.GetStats().state == State::HalfOpen);
+
+    Ticket other = CircuitBreaker::kNotProbe;
+    CHECK(!breaker.Allow(other));
+    CHECK(!breaker.Allow(other));
+
+    breaker.Record(probe, true);
+    CircuitBreaker::Stats stats = breaker.GetStats();
+    CHECK(stats.state == State::Closed);
+    CHECK_EQ(stats.requests, size_t(0));      // The failures that opened it are history
+    CHECK_EQ(stats.failures, size_t(0));
+    RecordOutcomes(breaker, {true});          // Ordinary fetches again
+}
+
+TEST(ProbeFailureOpensAgain) {
+    CircuitBreaker breaker("adapter", Policy());
+    OpenAndWait(breaker);
+
+    Ticket probe = CircuitBreaker::kNotProbe;
+    REQUIRE(breaker.Allow(probe));
+    breaker.Record(probe, false);
+    CHECK(breaker.GetStats().state == State::Open);
+    CHECK_EQ(breaker.GetStats().opened, uint64_t(2));
+
+    // A full open period again before the next probe
+    Ticket ticket = CircuitBreaker::kNotProbe;
+    CHECK(!breaker.Allow(ticket));
+    std::this_thread::sleep_for(std::chrono::milliseconds(kOpenMs + 20));
+    CHECK(breaker.Allow(ticket));
+    CHECK(ticket != probe);
+}
+
+TEST(OnlyTheProbeOutcomeEndsHalfOpen) {
+    CircuitBreaker breaker("adapter", Policy());
+
+    // A slow fetch allowed while closed, still running when it opens
+    Ticket slow = 1234;
+    REQUIRE(breaker.Allow(slow));
+    OpenAndWait(breaker);
+
+    Ticket probe = CircuitBreaker::kNotProbe;
+    REQUIRE(breaker.Allow(probe));
+
+    // Its outcome neither closes the breaker nor frees the probe slot
+    breaker.Record(slow, true);
+    CHECK(breaker.GetStats().state == State::HalfOpen);
+    Ticket other = CircuitBreaker::kNotProbe;
+    CHECK(!breaker.Allow(other));
+    breaker.Record(slow, false);
+    CHECK(breaker.GetStats().state == State::HalfOpen);
+
+    breaker.Record(probe, true);
+    CHECK(breaker.GetStats().state == State::Closed);
+
+    // A repeated probe outcome after that is history too
+    breaker.Record(probe, false);
+    CHECK_EQ(breaker.GetStats().requests, size_t(0));
+}
+
+TEST(ReleasedProbeLetsTheNextOneThrough) {
+    CircuitBreaker breaker("adapter", Policy());
+    OpenAndWait(breaker);
+
+    // The probe joined a fetch already in flight instead of running
+    Ticket released = CircuitBreaker::kNotProbe;
+    REQUIRE(breaker.Allow(released));
+    breaker.Release(released);
+    CHECK(breaker.GetStats().state == State::HalfOpen);
+
+    Ticket probe = CircuitBreaker::kNotProbe;
+    REQUIRE(breaker.Allow(probe));
+    CHECK(probe != released);
+
+    // The released ticket no longer counts
+    breaker.Record(released, false);
+    CHECK(breaker.GetStats().state == State::HalfOpen);
+    breaker.Release(released);
+    Ticket other = CircuitBreaker::kNotProbe;
+    CHECK(!breaker.Allow(other));
+
+    breaker.Record(probe, false);
+    CHECK(breaker.GetStats().state == State::Open);
+}
+
+int main() { return RunAllTests(); }
@@ -0,0 +1,178 @@
+// ContextCache: fresh -> stale -> miss by age, one refresh per stale entry,
+// the LRU bound, and window identity (a title change is a new key)
+
+#include "test_framework.h"
+#include "../context/context_cache.h"
+#include "../context/context_data.h"
+#include "../source_info.h"
+#include <memory>
+#include <thread>
+
+namespace {
+
+const int kTtlMs = 100;
+const int kMaxStaleMs = 200;
+
+// The cache only uses the adapter's address as a partition key
+struct FakeAdapter {};
+FakeAdapter g_browser;
+FakeAdapter g_editor;
+const IContextAdapter* Browser() { return reinterpret_cast<const IContextAdapter*>(&g_browser); }
+const IContextAdapter* Editor() { return reinterpret_cast<const IContextAdapter*>(&g_editor); }
+
+ContextCachePolicy Policy(size_t maxEntries = 16) {
+    ContextCachePolicy policy;
+    policy.ttlMs = kTtlMs;
+    policy.maxStaleMs = kMaxStaleMs;
+    policy.maxEntries = maxEntries;
+    return policy;
+}
+
+SourceInfo Window(uintptr_t handle, const std::wstring& title) {
+    SourceInfo source;
+    source.processName = L"chrome.exe";
+    source.windowTitle = title;
+    source.processId = 42;
+    source.windowHandle = reinterpret_cast<HWND>(handle);
+    return source;
+}
+
+std::shared_ptr<const ContextData> Context(const std::wstring& url, bool success = true) {
+    auto data = std::make_shared<ContextData>();
+    data->adapterType = "browser";
+    data->url = url;
+    data->success = success;
+    return data;
+}
+
+void SleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+} // namespace
+
+TEST(EntriesGoFromFreshToStaleToMiss) {
+    ContextCache cache;
+    cache.SetPolicy(Browser(), Policy());
+    ContextCache::Key key = ContextCache::MakeKey(Window(0x100, L"Docs - Chrome"));
+
+    CHECK(cache.Find(Browser(), key).state == ContextCache::State::Miss);
+    cache.Store(Browser(), key, Context(L"https://example.com"));
+
+    ContextCache::Lookup fresh = cache.Find(Browser(), key);
+    CHECK(fresh.state == ContextCache::State::Fresh);
+    REQUIRE(fresh.data != nullptr);
+    CHECK_EQ(fresh.data->url, std::wstring(L"https://example.com"));
+    CHECK(!fresh.refresh);
+    CHECK(cache.IsFresh(Browser(), key));
+
+    // Past the TTL: still served, no longer fresh
+    SleepMs(kTtlMs + 50);
+    ContextCache::Lookup stale = cache.Find(Browser(), key);
+    CHECK(stale.state == ContextCache::State::Stale);
+    CHECK(stale.data == fresh.data);
+    CHECK(stale.ageMs > kTtlMs);
+    CHECK(!cache.IsFresh(Browser(), key));
+
+    // Past the stale window: dropped
+    SleepMs(kMaxStaleMs);
+    ContextCache::Lookup gone = cache.Find(Browser(), key);
+    CHECK(gone.state == ContextCache::State::Miss);
+    CHECK(gone.data == nullptr);
+
+    ContextCache::Stats stats = cache.GetStats();
+    CHECK_EQ(stats.hits, uint64_t(1));
+    CHECK_EQ(stats.staleHits, uint64_t(1));
+    CHECK_EQ(stats.misses, uint64_t(2));
+    CHECK_EQ(stats.entries, size_t(0));
+}
+
+TEST(OnlyTheFirstStaleHitRefreshes) {
+    ContextCache cache;
+    cache.SetPolicy(Browser(), Policy());
+    ContextCache::Key key = ContextCache::MakeKey(Window(0x100, L"Docs - Chrome"));
+    cache.Store(Browser(), key, Context(L"https://old.example.com"));
+    SleepMs(kTtlMs + 50);
+
+    CHECK(cache.Find(Browser(), key).refresh);
+    CHECK(!cache.Find(Browser(), key).refresh);
+    CHECK(!cache.Find(Browser(), key).refresh);
+    CHECK_EQ(cache.GetStats().refreshes, uint64_t(1));
+
+    // A failed refresh keeps the stale entry and lets the next hit retry
+    cache.Store(Browser(), key, Context(L"", false));
+    ContextCache::Lookup retry = cache.Find(Browser(), key);
+    CHECK(retry.state == ContextCache::State::Stale);
+    CHECK(retry.refresh);
+    CHECK_EQ(retry.data->url, std::wstring(L"https://old.example.com"));
+
+    // A successful one makes it fresh again
+    cache.Store(Browser(), key, Context(L"https://new.example.com"));
+    ContextCache::Lookup refreshed = cache.Find(Browser(), key);
+    CHECK(refreshed.state == ContextCache::State::Fresh);
+    CHECK_EQ(refreshed.data->url, std::wstring(L"https://new.example.com"));
+    CHECK_EQ(cache.GetStats().refreshes, uint64_t(2));
+}
+
+TEST(LeastRecentlyUsedIsEvicted) {
+    ContextCache cache;
+    cache.SetPolicy(Browser(), Policy(2));
+    ContextCache::Key first = ContextCache::MakeKey(Window(0x100, L"First"));
+    ContextCache::Key second = ContextCache::MakeKey(Window(0x200, L"Second"));
+    ContextCache::Key third = ContextCache::MakeKey(Window(0x300, L"Third"));
+
+    cache.Store(Browser(), first, Context(L"1"));
+    cache.Store(Browser(), second, Context(L"2"));
+    CHECK(cache.Find(Browser(), first).data != nullptr);     // first is now the most recent
+    cache.Store(Browser(), third, Context(L"3"));
+
+    CHECK(cache.Find(Browser(), second).state == ContextCache::State::Miss);
+    CHECK(cache.Find(Browser(), first).state == ContextCache::State::Fresh);
+    CHECK(cache.Find(Browser(), third).state == ContextCache::State::Fresh);
+    CHECK_EQ(cache.GetStats().evictions, uint64_t(1));
+    CHECK_EQ(cache.GetStats().entries, size_t(2));
+
+    // Shrinking the bound trims the oldest entries
+    cache.SetPolicy(Browser(), Policy(1));
+    CHECK_EQ(cache.GetStats().entries, size_t(1));
+    CHECK(cache.Find(Browser(), third).state == ContextCache::State::Fresh);
+}
+
+TEST(TitleChangeIsANewWindow) {
+    ContextCache cache;
+    cache.SetPolicy(Browser(), Policy());
+    cache.SetPolicy(Editor(), Policy());
+    SourceInfo source = Window(0x100, L"Docs - Chrome");
+    ContextCache::Key key = ContextCache::MakeKey(source);
+    cache.Store(Browser(), key, Context(L"https://docs.example.com"));
+
+    // Same window, same title: same key
+    CHECK(ContextCache::MakeKey(source) == key);
+    CHECK(cache.Find(Browser(), ContextCache::MakeKey(source)).state == ContextCache::State::Fresh);
+
+    // New tab in the same window
+    source.windowTitle = L"Mail - Chrome";
+    CHECK(cache.Find(Browser(), ContextCache::MakeKey(source)).state == ContextCache::State::Miss);
+
+    // Another window or process with the old title
+    CHECK(cache.Find(Browser(), ContextCache::MakeKey(Window(0x200, L"Docs - Chrome"))).state ==
+          ContextCache::State::Miss);
+    SourceInfo otherProcess = Window(0x100, L"Docs - Chrome");
+    otherProcess.processId = 43;
+    CHECK(cache.Find(Browser(), ContextCache::MakeKey(otherProcess)).state == ContextCache::State::Miss);
+
+    // Partitions are per adapter
+    CHECK(cache.Find(Editor(), key).state == ContextCache::State::Miss);
+}
+
+TEST(ZeroTtlDisablesCaching) {
+    ContextCache cache;
+    ContextCachePolicy off;
+    cache.SetPolicy(Browser(), off);
+    ContextCache::Key key = ContextCache::MakeKey(Window(0x100, L"Docs"));
+    cache.Store(Browser(), key, Context(L"https://example.com"));
+    CHECK(cache.Find(Browser(), key).state == ContextCache::State::Miss);
+    CHECK_EQ(cache.GetStats().entries, size_t(0));
+}
+
+int main() { return RunAllTests(); }
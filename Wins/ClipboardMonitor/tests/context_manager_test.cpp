@@ -0,0 +1,394 @@
+// ContextManager scheduling: single-flight fetches, load shedding, and
+// prefetching driven by foreground changes (ManualForegroundSource)
+
+#include "test_framework.h"
+#include "../context/context_manager.h"
+#include "../context/foreground_source.h"
+#include "../source_info.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Adapter whose deep fetch holds its worker until released
+class GatedAdapter : public IContextAdapter {
+public:
+    bool CanHandle(const std::wstring& processName, const std::wstring&) override {
+        return processName == L"gated.exe";
+    }
+
+    std::shared_ptr<ContextData> GetContext(const SourceInfo&, const CancellationToken& token) override {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_started++;
+        m_changed.notify_all();
+        m_changed.wait(lock, [&]() { return m_released || token.IsCancelled(); });
+
+        auto contextData = std::make_shared<ContextData>();
+        contextData->adapterType = "gated";
+        contextData->success = true;
+        return contextData;
+    }
+
+    std::shared_ptr<ContextData> GetQuickContext(const SourceInfo& source) override {
+        auto contextData = std::make_shared<ContextData>();
+        contextData->adapterType = "gated";
+        contextData->title = source.windowTitle;
+        contextData->success = true;
+        return contextData;
+    }
+
+    int GetTimeout() const override { return 10000; }
+
+    std::wstring GetAdapterName() const override { return L"Gated"; }
+
+    void WaitStarted(int count) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [&]() { return m_started >= count; });
+    }
+
+    int GetStarted() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_started;
+    }
+
+    void Release() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_released = true;
+        m_changed.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    int m_started = 0;
+    bool m_released = false;
+};
+
+SourceInfo MakeSource(int window) {
+    SourceInfo source;
+    source.processName = L"gated.exe";
+    source.windowTitle = L"Window " + std::to_wstring(window);
+    source.processId = 100;
+    source.windowHandle = reinterpret_cast<HWND>(static_cast<intptr_t>(window));
+    return source;
+}
+
+// Outcomes of captures started without waiting (as the clipboard thread does)
+class Captures {
+public:
+    void Start(ContextManager& manager, const SourceInfo& source, TaskPriority priority) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending++;
+        }
+        Spawn(Capture(manager, source, priority));
+    }
+
+    std::vector<std::shared_ptr<const ContextData>> WaitAll() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [&]() { return m_pending == 0; });
+        return m_results;
+    }
+
+private:
+    CoTask<void> Capture(ContextManager& manager, SourceInfo source, TaskPriority priority) {
+        std::shared_ptr<const ContextData> contextData = co_await manager.GetContext(source, priority);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_results.push_back(std::move(contextData));
+        m_pending--;
+        m_changed.notify_all();
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    int m_pending = 0;
+    std::vector<std::shared_ptr<const ContextData>> m_results;
+};
+
+bool IsShed(const std::shared_ptr<const ContextData>& contextData) {
+    return contextData && contextData->GetMetadata(L"deep_skipped") == L"executor_busy";
+}
+
+// Adapter whose results are cached (so it can be prefetched); records the
+// windows it fetched
+class CachingAdapter : public IContextAdapter {
+public:
+    explicit CachingAdapter(int ttlMs) : m_ttlMs(ttlMs) {}
+
+    bool CanHandle(const std::wstring& processName, const std::wstring&) override {
+        return processName == L"cached.exe";
+    }
+
+    std::shared_ptr<ContextData> GetContext(const SourceInfo& source, const CancellationToken&) override {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_fetched.push_back(source.windowTitle);
+        }
+        auto contextData = std::make_shared<ContextData>();
+        contextData->adapterType = "cached";
+        contextData->title = source.windowTitle;
+        contextData->success = true;
+        return contextData;
+    }
+
+    ContextCachePolicy GetCachePolicy() const override {
+        ContextCachePolicy policy;
+        policy.ttlMs = m_ttlMs;
+        return policy;
+    }
+
+    std::wstring GetAdapterName() const override { return L"Caching"; }
+
+    std::vector<std::wstring> GetFetched() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_fetched;
+    }
+
+private:
+    int m_ttlMs;
+    std::mutex m_mutex;
+    std::vector<std::wstring> m_fetched;
+};
+
+HWND Window(int window) {
+    return reinterpret_cast<HWND>(static_cast<intptr_t>(window));
+}
+
+// What ClipboardMonitor reads from a window, for the caching adapter
+SourceInfo MakeCachedSource(HWND hwnd) {
+    SourceInfo source;
+    source.processName = L"cached.exe";
+    source.windowTitle = L"Window " + std::to_wstring(reinterpret_cast<intptr_t>(hwnd));
+    source.processId = 200;
+    source.windowHandle = hwnd;
+    return source;
+}
+
+// Manager with the caching adapter, prefetching on every change the source raises
+struct PrefetchFixture {
+    ContextManager manager{2};
+    std::shared_ptr<CachingAdapter> adapter;
+    ManualForegroundSource foreground;
+
+    PrefetchFixture(int dwellMs, int minIntervalMs, int ttlMs = 60000)
+        : adapter(std::make_shared<CachingAdapter>(ttlMs)) {
+        manager.Initialize();
+        PrefetchPolicy policy;
+        policy.dwellMs = dwellMs;
+        policy.minIntervalMs = minIntervalMs;
+        manager.SetPrefetchPolicy(policy);
+        manager.RegisterAdapter(adapter);
+        foreground.Start([this](HWND hwnd) { manager.Prefetch(MakeCachedSource(hwnd)); });
+    }
+
+    // A copy from the window, waited for
+    std::shared_ptr<const ContextData> Copy(int window) {
+        Captures captures;
+        captures.Start(manager, MakeCachedSource(Window(window)), TaskPriority::Normal);
+        std::vector<std::shared_ptr<const ContextData>> results = captures.WaitAll();
+        return results.empty() ? nullptr : results.front();
+    }
+};
+
+// Poll until done() holds; false after timeoutMs
+bool WaitFor(const std::function<bool()>& done, int timeoutMs = 5000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(ConcurrentRequestsForOneWindowRunTheAdapterOnce) {
+    ContextManager manager(2);
+    REQUIRE(manager.Initialize());
+    auto adapter = std::make_shared<GatedAdapter>();
+    manager.RegisterAdapter(adapter);
+
+    // Two copies of the same window at once (e.g. the two halves of a
+    // Ctrl+C+C); a free worker is there for a second fetch if one started
+    Captures captures;
+    std::thread first([&]() { captures.Start(manager, MakeSource(1), TaskPriority::Normal); });
+    std::thread second([&]() { captures.Start(manager, MakeSource(1), TaskPriority::Interactive); });
+    first.join();
+    second.join();
+    adapter->WaitStarted(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK_EQ(adapter->GetStarted(), 1);
+    CHECK_EQ(manager.GetCoalescedFetches(), uint64_t(1));
+
+    adapter->Release();
+    std::vector<std::shared_ptr<const ContextData>> results = captures.WaitAll();
+    REQUIRE(results.size() == 2);
+    REQUIRE(results[0] && results[1]);
+    CHECK(results[0]->success);
+    CHECK(results[0] == results[1]);      // Both waited for the same fetch
+    CHECK_EQ(adapter->GetStarted(), 1);
+}
+
+TEST(PlainCopyBurstIsShedOverThreshold) {
+    ContextManager manager(1);
+    REQUIRE(manager.Initialize());
+    manager.SetLoadSheddingThreshold(2);
+    auto adapter = std::make_shared<GatedAdapter>();
+    manager.RegisterAdapter(adapter);
+
+    // A burst of plain Ctrl+C copies (Normal priority) from different windows:
+    // the first holds the only worker, the next two queue behind it
+    Captures captures;
+    captures.Start(manager, MakeSource(1), TaskPriority::Normal);
+    adapter->WaitStarted(1);
+    captures.Start(manager, MakeSource(2), TaskPriority::Normal);
+    captures.Start(manager, MakeSource(3), TaskPriority::Normal);
+    CHECK_EQ(manager.GetExecutorMetrics().queueDepth, size_t(2));
+    CHECK_EQ(manager.GetShedCount(), uint64_t(0));
+
+    // Queue at the threshold: the rest of the burst gets the title-only context
+    for (int window = 4; window <= 6; window++) {
+        captures.Start(manager, MakeSource(window), TaskPriority::Normal);
+    }
+    CHECK_EQ(manager.GetShedCount(), uint64_t(3));
+    CHECK_EQ(manager.GetExecutorMetrics().queueDepth, size_t(2));
+
+    // A Ctrl+C+C capture still goes deep
+    captures.Start(manager, MakeSource(7), TaskPriority::Interactive);
+    CHECK_EQ(manager.GetShedCount(), uint64_t(3));
+    CHECK_EQ(manager.GetExecutorMetrics().queueDepth, size_t(3));
+
+    adapter->Release();
+    std::vector<std::shared_ptr<const ContextData>> results = captures.WaitAll();
+    REQUIRE(results.size() == 7);
+    int shed = 0;
+    for (const auto& contextData : results) {
+        REQUIRE(contextData);
+        if (IsShed(contextData)) {
+            shed++;
+            CHECK(contextData->partial);
+            CHECK(contextData->title.find(L"Window ") == 0);
+        } else {
+            CHECK(contextData->success);
+            CHECK(!contextData->partial);
+        }
+    }
+    CHECK_EQ(shed, 3);
+    CHECK_EQ(adapter->GetStarted(), 4);
+}
+
+TEST(SheddingDisabledAtZeroThreshold) {
+    ContextManager manager(1);
+    REQUIRE(manager.Initialize());
+    manager.SetLoadSheddingThreshold(0);
+    auto adapter = std::make_shared<GatedAdapter>();
+    manager.RegisterAdapter(adapter);
+
+    Captures captures;
+    captures.Start(manager, MakeSource(1), TaskPriority::Normal);
+    adapter->WaitStarted(1);
+    for (int window = 2; window <= 10; window++) {
+        captures.Start(manager, MakeSource(window), TaskPriority::Normal);
+    }
+    CHECK_EQ(manager.GetShedCount(), uint64_t(0));
+    CHECK_EQ(manager.GetExecutorMetrics().queueDepth, size_t(9));
+
+    adapter->Release();
+    CHECK_EQ(captures.WaitAll().size(), size_t(10));
+    CHECK_EQ(adapter->GetStarted(), 10);
+}
+
+TEST(PrefetchWaitsForTheDwellTime) {
+    PrefetchFixture fixture(150, 0);
+    fixture.foreground.Raise(Window(1));
+
+    // Nothing before the window has stayed in front for the dwell time
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(fixture.adapter->GetFetched().empty());
+    CHECK_EQ(fixture.manager.GetPrefetchStats().issued, uint64_t(0));
+
+    REQUIRE(WaitFor([&]() { return fixture.adapter->GetFetched().size() == 1; }));
+    ContextManager::PrefetchStats stats = fixture.manager.GetPrefetchStats();
+    CHECK_EQ(stats.issued, uint64_t(1));
+    CHECK_EQ(stats.pending, size_t(1));
+    CHECK_EQ(stats.skipped, uint64_t(0));
+
+    // The copy is served by the prefetched result
+    REQUIRE(WaitFor([&]() { return fixture.manager.GetCacheStats().entries == 1; }));
+    std::shared_ptr<const ContextData> copied = fixture.Copy(1);
+    REQUIRE(copied);
+    CHECK_EQ(copied->title, std::wstring(L"Window 1"));
+    CHECK_EQ(fixture.adapter->GetFetched().size(), size_t(1));
+    stats = fixture.manager.GetPrefetchStats();
+    CHECK_EQ(stats.hits, uint64_t(1));
+    CHECK_EQ(stats.pending, size_t(0));
+    CHECK_EQ(stats.wasted, uint64_t(0));
+}
+
+TEST(NegativeDwellDisablesPrefetch) {
+    PrefetchFixture fixture(-1, 0);
+    fixture.foreground.Raise(Window(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(fixture.adapter->GetFetched().empty());
+    ContextManager::PrefetchStats stats = fixture.manager.GetPrefetchStats();
+    CHECK_EQ(stats.issued + stats.skipped, uint64_t(0));
+}
+
+TEST(LaterFocusChangeSupersedesPendingPrefetch) {
+    PrefetchFixture fixture(100, 0);
+    fixture.foreground.Raise(Window(1));
+    fixture.foreground.Raise(Window(2));
+    fixture.foreground.Raise(Window(3));
+
+    // Only the window focus stayed on is fetched; the others moved on
+    REQUIRE(WaitFor([&]() { return fixture.manager.GetPrefetchStats().skipped == 2; }));
+    REQUIRE(WaitFor([&]() { return fixture.adapter->GetFetched().size() == 1; }));
+    CHECK_EQ(fixture.adapter->GetFetched(), (std::vector<std::wstring>{L"Window 3"}));
+    CHECK_EQ(fixture.manager.GetPrefetchStats().issued, uint64_t(1));
+}
+
+TEST(PrefetchesAreRateLimited) {
+    PrefetchFixture fixture(0, 60000);
+    fixture.foreground.Raise(Window(1));
+    REQUIRE(WaitFor([&]() { return fixture.manager.GetCacheStats().entries == 1; }));
+
+    // Within the interval: not prefetched, whatever the window
+    fixture.foreground.Raise(Window(2));
+    REQUIRE(WaitFor([&]() { return fixture.manager.GetPrefetchStats().skipped == 1; }));
+    // Back to a warm window: nothing to do either
+    fixture.foreground.Raise(Window(1));
+    REQUIRE(WaitFor([&]() { return fixture.manager.GetPrefetchStats().skipped == 2; }));
+
+    CHECK_EQ(fixture.adapter->GetFetched(), (std::vector<std::wstring>{L"Window 1"}));
+    CHECK_EQ(fixture.manager.GetPrefetchStats().issued, uint64_t(1));
+}
+
+TEST(PrefetchNoCopyUsedIsWasted) {
+    // Results expire after 300 ms
+    PrefetchFixture fixture(0, 0, 300);
+    fixture.foreground.Raise(Window(1));
+    REQUIRE(WaitFor([&]() { return fixture.manager.GetCacheStats().entries == 1; }));
+    fixture.foreground.Raise(Window(2));
+    REQUIRE(WaitFor([&]() { return fixture.manager.GetCacheStats().entries == 2; }));
+    CHECK_EQ(fixture.manager.GetPrefetchStats().pending, size_t(2));
+
+    // Copied from in time: a hit
+    REQUIRE(fixture.Copy(2));
+    // Copied from after the result expired: fetched again, the prefetch was wasted
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    REQUIRE(fixture.Copy(1));
+
+    ContextManager::PrefetchStats stats = fixture.manager.GetPrefetchStats();
+    CHECK_EQ(stats.issued, uint64_t(2));
+    CHECK_EQ(stats.hits, uint64_t(1));
+    CHECK_EQ(stats.wasted, uint64_t(1));
+    CHECK_EQ(stats.pending, size_t(0));
+    CHECK_EQ(fixture.adapter->GetFetched().size(), size_t(3));
+}
+
+int main() { return RunAllTests(); }
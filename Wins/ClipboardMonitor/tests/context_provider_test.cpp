@@ -0,0 +1,118 @@
+// ContextMerge: completion on the required fields, confidence wins,
+// partial results once every provider has reported
+
+#include "test_framework.h"
+#include "../context/context_provider.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+ContextProvider MakeProvider(const std::string& name, double confidence) {
+    return ContextProvider(name, confidence, [](const SourceInfo&, const CancellationToken&, ContextFields&) {});
+}
+
+} // namespace
+
+TEST(CompletesWhenTheRequiredFieldsFill) {
+    ContextProvider html = MakeProvider("html", 0.9);
+    ContextProvider extension = MakeProvider("extension", 0.8);
+    ContextProvider uia = MakeProvider("uia", 0.5);
+    ContextMerge merge({"url", "page_title"}, 3);
+
+    CHECK(!merge.Add(uia, {{"page_title", L"Title (uia)"}}));
+    CHECK(!merge.HasRequired());
+
+    // The second provider fills the last required field: this call completes
+    CHECK(merge.Add(extension, {{"url", L"https://example.com"}, {"selector", L"#main"}}));
+    CHECK(merge.HasRequired());
+    CHECK_EQ(merge.GetReportedCount(), size_t(2));
+
+    // Late results are ignored, even from a more confident provider
+    CHECK(!merge.Add(html, {{"url", L"https://late.example.com"}}));
+    CHECK_EQ(merge.Get("url"), std::wstring(L"https://example.com"));
+    CHECK_EQ(merge.GetSource("url"), std::string("extension"));
+    CHECK_EQ(merge.Get("page_title"), std::wstring(L"Title (uia)"));
+    CHECK_EQ(merge.Get("selector"), std::wstring(L"#main"));
+    CHECK_EQ(merge.GetReportedCount(), size_t(2));
+}
+
+TEST(HigherConfidenceWins) {
+    ContextProvider low = MakeProvider("low", 0.3);
+    ContextProvider high = MakeProvider("high", 0.9);
+    ContextProvider tie = MakeProvider("tie", 0.9);
+    ContextMerge merge({"url"}, 4);
+
+    // Not required fields do not complete the merge
+    CHECK(!merge.Add(high, {{"page_title", L"high title"}}));
+    CHECK(!merge.Add(low, {{"page_title", L"low title"}, {"url", L""}}));
+    CHECK_EQ(merge.Get("page_title"), std::wstring(L"high title"));
+    CHECK_EQ(merge.GetSource("page_title"), std::string("high"));
+
+    // An empty value is no value
+    CHECK(merge.Get("url").empty());
+    CHECK(merge.GetSource("url").empty());
+    CHECK(!merge.HasRequired());
+
+    // On a tie the first value stays
+    CHECK(!merge.Add(tie, {{"page_title", L"tie title"}}));
+    CHECK_EQ(merge.GetSource("page_title"), std::string("high"));
+
+    CHECK(merge.Add(low, {{"url", L"https://low.example.com"}}));
+    CHECK_EQ(merge.GetSource("url"), std::string("low"));
+}
+
+TEST(CompletesWithPartialResultsOnceAllHaveReported) {
+    ContextProvider first = MakeProvider("first", 0.5);
+    ContextProvider second = MakeProvider("second", 0.5);
+    ContextMerge merge({"url", "page_title"}, 2);
+
+    CHECK(!merge.Add(first, {{"page_title", L"Title"}}));
+    CHECK(merge.Add(second, ContextFields()));
+    CHECK(!merge.HasRequired());
+    CHECK_EQ(merge.Get("page_title"), std::wstring(L"Title"));
+    CHECK(merge.Get("url").empty());
+    CHECK_EQ(merge.GetReportedCount(), size_t(2));
+
+    // Without required fields only the last report completes it
+    ContextMerge all({}, 2);
+    CHECK(!all.Add(first, {{"url", L"https://example.com"}}));
+    CHECK(all.Add(second, {{"page_title", L"Title"}}));
+    CHECK(all.HasRequired());
+    CHECK_EQ(all.Get("url"), std::wstring(L"https://example.com"));
+}
+
+TEST(ExactlyOneConcurrentAddCompletes) {
+    const int providers = 8;
+    for (int round = 0; round < 100; round++) {
+        std::vector<ContextProvider> sources;
+        for (int i = 0; i < providers; i++) {
+            sources.push_back(MakeProvider("p" + std::to_string(i), 0.1 * i));
+        }
+        ContextMerge merge({"url"}, providers);
+        std::atomic<int> completions{0};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < providers; i++) {
+            threads.emplace_back([&, i]() {
+                ContextFields fields;
+                if (i % 2) {
+                    fields["url"] = L"url " + std::to_wstring(i);
+                }
+                if (merge.Add(sources[i], std::move(fields))) {
+                    completions++;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        CHECK_EQ(completions.load(), 1);
+        CHECK(merge.HasRequired());
+
+        // Whoever completed it, the value is the best seen up to then
+        CHECK(!merge.GetSource("url").empty());
+    }
+}
+
+int main() { return RunAllTests(); }
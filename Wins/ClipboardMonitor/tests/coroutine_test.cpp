@@ -0,0 +1,246 @@
+// Coroutine combinators on a real executor: WithTimeout, WhenAll, WhenAny,
+// SharedResult and Spawn
+
+#include "test_framework.h"
+#include "../context/coroutine.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Counts live instances, to see when a coroutine frame holding one is freed
+struct Tracker {
+    static std::atomic<int> live;
+    Tracker() { live++; }
+    Tracker(const Tracker&) { live++; }
+    ~Tracker() { live--; }
+};
+std::atomic<int> Tracker::live{0};
+
+// value after sleeping ms on a worker
+CoTask<int> Delayed(AsyncExecutor& executor, int value, int ms) {
+    co_return co_await executor.Run(TaskOptions(), [value, ms]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        return value;
+    });
+}
+
+CoTask<int> Failing(AsyncExecutor& executor, int ms) {
+    co_await executor.Run(TaskOptions(), [ms]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    });
+    throw std::runtime_error("failed");
+}
+
+// Start task and deliver its result through a std::future
+template<typename T>
+CoTask<void> Deliver(CoTask<T> task, std::promise<T>& done) {
+    try {
+        done.set_value(co_await task);
+    } catch (...) {
+        done.set_exception(std::current_exception());
+    }
+}
+
+template<typename T>
+T Await(CoTask<T> task) {
+    std::promise<T> done;
+    std::future<T> result = done.get_future();
+    Spawn(Deliver(std::move(task), done));
+    return result.get();
+}
+
+} // namespace
+
+TEST(WithTimeoutReturnsTheValueBeforeTheDeadline) {
+    AsyncExecutor executor(2);
+    std::optional<int> value = Await(WithTimeout(executor, Delayed(executor, 5, 0), 1000));
+    REQUIRE(value.has_value());
+    CHECK_EQ(*value, 5);
+
+    // Exceptions before the deadline propagate
+    bool threw = false;
+    try {
+        Await(WithTimeout(executor, Failing(executor, 0), 1000));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+TEST(WithTimeoutGivesUpAtTheDeadline) {
+    AsyncExecutor executor(2);
+    auto start = Clock::now();
+    std::optional<int> value = Await(WithTimeout(executor, Delayed(executor, 5, 300), 20));
+    auto waited = Clock::now() - start;
+    CHECK(!value.has_value());
+    CHECK(waited >= std::chrono::milliseconds(20));
+    CHECK(waited < std::chrono::milliseconds(250));
+}
+
+TEST(LateCompletionAfterTimeoutTouchesNoFreedFrame) {
+    AsyncExecutor executor(2);
+    std::atomic<bool> finished{false};
+
+    // The inner coroutine owns a Tracker and outlives the timed-out waiter
+    auto inner = [&]() -> CoTask<int> {
+        Tracker tracker;
+        int value = co_await executor.Run(TaskOptions(), []() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            return 1;
+        });
+        finished = true;
+        co_return value;
+    };
+    CHECK(!Await(WithTimeout(executor, inner(), 10)).has_value());
+
+    // The waiter's frames are gone; the inner frame is still running
+    CHECK(!finished);
+    CHECK_EQ(Tracker::live.load(), 1);
+
+    // Its result is dropped and its frame freed once, by the runner
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (Tracker::live.load() != 0 && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK(finished);
+    CHECK_EQ(Tracker::live.load(), 0);
+}
+
+TEST(WhenAllKeepsInputOrder) {
+    AsyncExecutor executor(4);
+    std::vector<CoTask<int>> tasks;
+    for (int i = 0; i < 5; i++) {
+        // Later inputs finish first
+        tasks.push_back(Delayed(executor, i * 10, (5 - i) * 10));
+    }
+    CHECK_EQ(Await(WhenAll(std::move(tasks))), (std::vector<int>{0, 10, 20, 30, 40}));
+
+    CHECK(Await(WhenAll(std::vector<CoTask<int>>())).empty());
+
+    // One failure is rethrown once all have finished
+    std::vector<CoTask<int>> mixed;
+    mixed.push_back(Delayed(executor, 1, 0));
+    mixed.push_back(Failing(executor, 0));
+    mixed.push_back(Delayed(executor, 3, 50));
+    bool threw = false;
+    try {
+        Await(WhenAll(std::move(mixed)));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+TEST(WhenAnyReturnsTheFirstFinisher) {
+    AsyncExecutor executor(4);
+    std::vector<CoTask<int>> tasks;
+    tasks.push_back(Delayed(executor, 100, 300));
+    tasks.push_back(Delayed(executor, 200, 10));
+    tasks.push_back(Delayed(executor, 300, 300));
+    std::pair<size_t, int> first = Await(WhenAny(std::move(tasks)));
+    CHECK_EQ(first.first, size_t(1));
+    CHECK_EQ(first.second, 200);
+
+    // A synchronous winner still reports its own index
+    std::vector<CoTask<int>> ready;
+    ready.push_back(Delayed(executor, 1, 300));
+    ready.push_back([]() -> CoTask<int> { co_return 2; }());
+    CHECK_EQ(Await(WhenAny(std::move(ready))).first, size_t(1));
+
+    // The losers run on; let them finish before the executor goes
+    std::this_thread::sleep_for(std::chrono::milliseconds(350));
+}
+
+TEST(SharedResultResumesEveryWaiterOnce) {
+    AsyncExecutor executor(4);
+    SharedResult<int> shared(executor);
+    const int early = 20;
+    const int late = 5;
+    std::vector<std::atomic<int>> resumes(early + late);
+    std::vector<int> values(early + late, 0);
+    std::atomic<int> done{0};
+
+    auto waiter = [&](int index) -> CoTask<void> {
+        int value = co_await shared.Wait();
+        values[index] = value;
+        resumes[index]++;
+        done++;
+    };
+
+    for (int i = 0; i < early; i++) {
+        Spawn(waiter(i));
+    }
+    CHECK_EQ(done.load(), 0);
+
+    shared.Set(42);
+    shared.Set(7);      // Ignored: the result is one-shot
+
+    // Waiters attaching after Set complete at once, on this thread
+    for (int i = early; i < early + late; i++) {
+        Spawn(waiter(i));
+    }
+    CHECK(done.load() >= late);
+
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (done.load() < early + late && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK_EQ(done.load(), early + late);
+    for (int i = 0; i < early + late; i++) {
+        CHECK_EQ(resumes[i].load(), 1);
+        CHECK_EQ(values[i], 42);
+    }
+}
+
+TEST(SharedResultExceptionReachesEveryWaiter) {
+    AsyncExecutor executor(2);
+    SharedResult<int> shared(executor);
+    std::atomic<int> failed{0};
+    auto waiter = [&]() -> CoTask<void> {
+        try {
+            co_await shared.Wait();
+        } catch (const std::runtime_error&) {
+            failed++;
+        }
+    };
+    for (int i = 0; i < 5; i++) {
+        Spawn(waiter());
+    }
+    shared.SetException(std::make_exception_ptr(std::runtime_error("fetch failed")));
+    Spawn(waiter());
+
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (failed.load() < 6 && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK_EQ(failed.load(), 6);
+}
+
+TEST(SpawnedTaskFreesItsFrame) {
+    AsyncExecutor executor(2);
+    std::atomic<bool> ran{false};
+    auto task = [&]() -> CoTask<void> {
+        Tracker tracker;
+        co_await executor.Schedule();
+        ran = true;
+        throw std::runtime_error("dropped");
+    };
+    Spawn(task());
+
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (Tracker::live.load() != 0 && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(ran);
+    CHECK_EQ(Tracker::live.load(), 0);
+}
+
+int main() { return RunAllTests(); }
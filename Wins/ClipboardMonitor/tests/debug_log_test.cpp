@@ -0,0 +1,88 @@
+// Leveled logging: LOG_* / LOG_EVENT arguments are only evaluated when the
+// level is enabled (runtime level and compile-time floor), and "{}" formatting
+
+// Compile Trace out of this file, as /DGLIMPSE_LOG_MIN_LEVEL=1 would
+#define GLIMPSE_LOG_MIN_LEVEL 1
+
+#include "test_framework.h"
+#include "../debug_log.h"
+
+namespace {
+
+int g_evaluated = 0;
+
+// A log argument that records being evaluated
+int Counted(int value) {
+    g_evaluated++;
+    return value;
+}
+
+// Restores the runtime level after each test
+struct LevelScope {
+    LogLevel saved = DebugLog::GetLevel();
+    explicit LevelScope(LogLevel level) {
+        DebugLog::SetLevel(level);
+        g_evaluated = 0;
+    }
+    ~LevelScope() { DebugLog::SetLevel(saved); }
+};
+
+} // namespace
+
+TEST(ArgumentsBelowTheRuntimeLevelAreNotEvaluated) {
+    LevelScope scope(LogLevel::Warn);
+    LOG_DEBUG("debug {}", Counted(1));
+    LOG_INFO("info {} {}", Counted(2), Counted(3));
+    LOG_EVENT(SequenceChanged, Counted(4), Counted(5));     // Debug
+    LOG_EVENT(AdapterCompleted, "adapter", Counted(6), true);   // Info
+    DEBUG_LOG(Counted(7));
+    CHECK_EQ(g_evaluated, 0);
+    CHECK(!LOG_ENABLED(LogLevel::Info));
+
+    // At or above it they are evaluated, once each
+    LOG_WARN("warn {}", Counted(8));
+    LOG_ERROR("error {} {}", Counted(9), Counted(10));
+    LOG_EVENT(ContextTimeout);
+    CHECK_EQ(g_evaluated, 3);
+    CHECK(LOG_ENABLED(LogLevel::Warn));
+}
+
+TEST(OffDisablesEveryLevel) {
+    LevelScope scope(LogLevel::Off);
+    LOG_ERROR("error {}", Counted(1));
+    LOG_EVENT(ContextTimeout);
+    CHECK_EQ(g_evaluated, 0);
+    CHECK(!LOG_ENABLED(LogLevel::Error));
+}
+
+TEST(CompileTimeFloorWinsOverTheRuntimeLevel) {
+    LevelScope scope(LogLevel::Trace);
+    CHECK(DebugLog::IsEnabled(LogLevel::Trace));
+    CHECK(!LOG_ENABLED(LogLevel::Trace));
+    LOG_TRACE("trace {}", Counted(1));
+    LOG_EVENT(ClipboardFormats, "CF_TEXT", Counted(2));     // Trace
+    CHECK_EQ(g_evaluated, 0);
+
+    LOG_DEBUG("debug {}", Counted(3));
+    CHECK_EQ(g_evaluated, 1);
+}
+
+TEST(ParseLevelNames) {
+    CHECK(DebugLog::ParseLevel("trace") == LogLevel::Trace);
+    CHECK(DebugLog::ParseLevel("warning") == LogLevel::Warn);
+    CHECK(DebugLog::ParseLevel("off") == LogLevel::Off);
+    CHECK(DebugLog::ParseLevel("verbose", LogLevel::Info) == LogLevel::Info);
+}
+
+TEST(FormatFillsPlaceholdersInOrder) {
+    CHECK_EQ(LogFormat::Format("Seq: {from} -> {to}", 1, 2u), std::string("Seq: 1 -> 2"));
+    CHECK_EQ(LogFormat::Format("{} | {} | {}", std::wstring(L"chrome.exe"), true, 1.5),
+             std::string("chrome.exe | true | 1.50"));
+    CHECK_EQ(LogFormat::Format("no args {}"), std::string("no args {}"));
+    CHECK_EQ(LogFormat::Format("{} only", "one", "extra"), std::string("one only"));
+    CHECK_EQ(LogFormat::Format("{Not A Field} {}", 7), std::string("{Not A Field} 7"));
+    const char* null = nullptr;
+    CHECK_EQ(LogFormat::Format("{}", null), std::string("(null)"));
+}
+
+int main() { return RunAllTests(); }
@@ -0,0 +1,216 @@
+// ElementPathCache: hits, misses, stale entries and LRU eviction
+
+#include "test_framework.h"
+#include "../context/utils/element_path_cache.h"
+
+namespace {
+
+int Add(AccessibleSnapshot& tree, int parent, int controlType, const std::wstring& name,
+        const std::wstring& automationId = std::wstring()) {
+    AccessibleProperties properties;
+    properties.controlType = controlType;
+    properties.name = name;
+    properties.automationId = automationId;
+    return tree.AddNode(parent, properties);
+}
+
+// Window with `filler` panes ahead of a List "target" three levels down
+void BuildWindow(AccessibleSnapshot& tree, int filler) {
+    int window = Add(tree, -1, AccessibleControlType::Window, L"window");
+    for (int i = 0; i < filler; i++) {
+        int pane = Add(tree, window, AccessibleControlType::Pane, L"");
+        int group = Add(tree, pane, AccessibleControlType::Group, L"");
+        Add(tree, group, AccessibleControlType::Text, L"filler " + std::to_wstring(i));
+        Add(tree, group, AccessibleControlType::Text, L"");
+    }
+    int main = Add(tree, window, AccessibleControlType::Pane, L"main");
+    int group = Add(tree, main, AccessibleControlType::Group, L"");
+    Add(tree, group, AccessibleControlType::Text, L"title");
+    Add(tree, group, AccessibleControlType::List, L"target", L"list");
+}
+
+// Full search for the List, counting its runs
+struct CountingSearch {
+    IAccessibleElement* window = nullptr;
+    int runs = 0;
+
+    ElementPathCache::Search Get() {
+        return [this]() {
+            runs++;
+            AccessibleQuery query;
+            query.controlType = AccessibleControlType::List;
+            return window->FindFirst(AccessibleScope::Descendants, query, AccessibleCache::Properties);
+        };
+    }
+};
+
+bool IsTarget(const AccessibleProperties& properties) {
+    return properties.name == L"target";
+}
+
+} // namespace
+
+TEST(MissSearchesAndRemembers) {
+    AccessibleSnapshot tree;
+    BuildWindow(tree, 100);
+    AccessibleElementPtr window = tree.GetRoot();
+    CountingSearch search{window.get()};
+    ElementPathCache cache;
+
+    AccessibleElementPtr found =
+        cache.Find(*window, 1, "test.list", IsTarget, search.Get(), CancellationToken::None());
+    REQUIRE(found);
+    CHECK_EQ(found->GetProperties().name, std::wstring(L"target"));
+    CHECK_EQ(search.runs, 1);
+    CHECK_EQ(cache.GetSize(), size_t(1));
+    CHECK_EQ(cache.GetMissCount(), uint64_t(1));
+    CHECK_EQ(cache.GetHitCount(), uint64_t(0));
+}
+
+TEST(HitFollowsThePathWithoutSearching) {
+    AccessibleSnapshot tree;
+    BuildWindow(tree, 1000);
+    AccessibleElementPtr window = tree.GetRoot();
+    CountingSearch search{window.get()};
+    ElementPathCache cache;
+    AccessibleElementPtr first =
+        cache.Find(*window, 1, "test.list", IsTarget, search.Get(), CancellationToken::None());
+    REQUIRE(first);
+    uint64_t searchVisits = tree.GetVisitCount();
+
+    tree.ResetCallCount();
+    AccessibleElementPtr second =
+        cache.Find(*window, 1, "test.list", IsTarget, search.Get(), CancellationToken::None());
+    REQUIRE(second);
+    CHECK(second->GetRuntimeId() == first->GetRuntimeId());
+    CHECK_EQ(search.runs, 1);
+    CHECK_EQ(cache.GetHitCount(), uint64_t(1));
+    CHECK_EQ(cache.GetMissCount(), uint64_t(1));
+
+    // Three levels: two calls (every other level comes cached); the provider
+    // examines the window's children and grandchildren, not whole subtrees
+    CHECK_EQ(tree.GetCallCount(), uint64_t(2));
+    CHECK(tree.GetVisitCount() < searchVisits / 2);
+
+    // Another lookup or window has its own entry
+    cache.Find(*window, 1, "test.other", IsTarget, search.Get(), CancellationToken::None());
+    cache.Find(*window, 2, "test.list", IsTarget, search.Get(), CancellationToken::None());
+    CHECK_EQ(search.runs, 3);
+    CHECK_EQ(cache.GetSize(), size_t(3));
+}
+
+TEST(FailedValidationSearchesAgain) {
+    AccessibleSnapshot tree;
+    BuildWindow(tree, 10);
+    AccessibleElementPtr window = tree.GetRoot();
+    CountingSearch search{window.get()};
+    ElementPathCache cache;
+    cache.Find(*window, 1, "test.list", IsTarget, search.Get(), CancellationToken::None());
+
+    // The element is still there but no longer what the caller wants
+    auto never = [](const AccessibleProperties&) { return false; };
+    CHECK(cache.Find(*window, 1, "test.list", never, search.Get(), CancellationToken::None()));
+    CHECK_EQ(search.runs, 2);
+    CHECK_EQ(cache.GetHitCount(), uint64_t(0));
+    CHECK_EQ(cache.GetMissCount(), uint64_t(2));
+    CHECK_EQ(cache.GetSize(), size_t(1));
+}
+
+TEST(StaleEntryIsErasedWhenTheSearchFindsNothing) {
+    AccessibleSnapshot before;
+    BuildWindow(before, 10);
+    CountingSearch search{before.GetRoot().get()};
+    ElementPathCache cache;
+    REQUIRE(cache.Find(*before.GetRoot(), 1, "test.list", IsTarget, search.Get(), CancellationToken::None()));
+    CHECK_EQ(cache.GetSize(), size_t(1));
+
+    // The window key now belongs to a window without the list
+    AccessibleSnapshot after;
+    int window = Add(after, -1, AccessibleControlType::Window, L"window");
+    Add(after, window, AccessibleControlType::Text, L"empty");
+    search.window = after.GetRoot().get();
+    CHECK(!cache.Find(*after.GetRoot(), 1, "test.list", IsTarget, search.Get(), CancellationToken::None()));
+    CHECK_EQ(search.runs, 2);
+    CHECK_EQ(cache.GetSize(), size_t(0));
+
+    // Found again once the list is back
+    AccessibleSnapshot again;
+    BuildWindow(again, 3);
+    search.window = again.GetRoot().get();
+    CHECK(cache.Find(*again.GetRoot(), 1, "test.list", IsTarget, search.Get(), CancellationToken::None()));
+    CHECK(cache.Find(*again.GetRoot(), 1, "test.list", IsTarget, search.Get(), CancellationToken::None()));
+    CHECK_EQ(search.runs, 3);
+    CHECK_EQ(cache.GetHitCount(), uint64_t(1));
+}
+
+TEST(DifferentElementAtThePathIsAMiss) {
+    AccessibleSnapshot before;
+    BuildWindow(before, 10);
+    CountingSearch search{before.GetRoot().get()};
+    ElementPathCache cache;
+    cache.Find(*before.GetRoot(), 1, "test.list", nullptr, search.Get(), CancellationToken::None());
+
+    // One more pane ahead of it: the path now leads to a filler Text
+    AccessibleSnapshot after;
+    BuildWindow(after, 11);
+    search.window = after.GetRoot().get();
+    AccessibleElementPtr found =
+        cache.Find(*after.GetRoot(), 1, "test.list", nullptr, search.Get(), CancellationToken::None());
+    REQUIRE(found);
+    CHECK_EQ(found->GetProperties().controlType, AccessibleControlType::List);
+    CHECK_EQ(search.runs, 2);
+    CHECK_EQ(cache.GetHitCount(), uint64_t(0));
+}
+
+TEST(LeastRecentlyUsedEntryIsDropped) {
+    AccessibleSnapshot tree;
+    BuildWindow(tree, 5);
+    AccessibleElementPtr window = tree.GetRoot();
+    CountingSearch search{window.get()};
+    ElementPathCache cache(2);
+    const CancellationToken& token = CancellationToken::None();
+
+    cache.Find(*window, 1, "test.list", IsTarget, search.Get(), token);
+    cache.Find(*window, 2, "test.list", IsTarget, search.Get(), token);
+    cache.Find(*window, 1, "test.list", IsTarget, search.Get(), token);     // Hit: 1 is now newer than 2
+    CHECK_EQ(search.runs, 2);
+
+    cache.Find(*window, 3, "test.list", IsTarget, search.Get(), token);     // Drops 2
+    CHECK_EQ(cache.GetSize(), size_t(2));
+    CHECK_EQ(search.runs, 3);
+
+    cache.Find(*window, 1, "test.list", IsTarget, search.Get(), token);
+    cache.Find(*window, 3, "test.list", IsTarget, search.Get(), token);
+    CHECK_EQ(search.runs, 3);
+    cache.Find(*window, 2, "test.list", IsTarget, search.Get(), token);     // Searched again
+    CHECK_EQ(search.runs, 4);
+    CHECK_EQ(cache.GetSize(), size_t(2));
+
+    cache.Clear();
+    CHECK_EQ(cache.GetSize(), size_t(0));
+}
+
+TEST(CancelledLookupDoesNothing) {
+    AccessibleSnapshot tree;
+    BuildWindow(tree, 5);
+    CountingSearch search{tree.GetRoot().get()};
+    ElementPathCache cache;
+    CancellationToken token;
+    token.Cancel();
+    CHECK(!cache.Find(*tree.GetRoot(), 1, "test.list", IsTarget, search.Get(), token));
+    CHECK_EQ(search.runs, 0);
+    CHECK_EQ(cache.GetSize(), size_t(0));
+    CHECK_EQ(tree.GetCallCount(), uint64_t(0));
+}
+
+TEST(ScopeWithoutCacheAlwaysSearches) {
+    AccessibleSnapshot tree;
+    BuildWindow(tree, 5);
+    CountingSearch search{tree.GetRoot().get()};
+    ElementPathScope scope;
+    CHECK(scope.Find(*tree.GetRoot(), "test.list", IsTarget, search.Get(), CancellationToken::None()));
+    CHECK(scope.Find(*tree.GetRoot(), "test.list", IsTarget, search.Get(), CancellationToken::None()));
+    CHECK_EQ(search.runs, 2);
+}
+
+int main() { return RunAllTests(); }
@@ -0,0 +1,199 @@
+// Element scans of the adapters: results and provider calls on synthetic trees
+
+#include "test_framework.h"
+#include "../context/adapters/element_scans.h"
+
+namespace {
+
+AccessibleRect Rect(long left, long top, long right, long bottom) {
+    AccessibleRect rect;
+    rect.left = left;
+    rect.top = top;
+    rect.right = right;
+    rect.bottom = bottom;
+    return rect;
+}
+
+int Add(AccessibleSnapshot& tree, int parent, int controlType, const std::wstring& name,
+        const AccessibleRect& rect, const std::wstring& value = std::wstring()) {
+    AccessibleProperties properties;
+    properties.controlType = controlType;
+    properties.name = name;
+    properties.rect = rect;
+    return tree.AddNode(parent, properties, value);
+}
+
+// VS Code window: editor lines (a Group holding a Text each), status bar last
+// in tree order as in VS Code. Holds lines + 7 status Text elements.
+void BuildVSCode(AccessibleSnapshot& tree, int lines) {
+    int window = Add(tree, -1, AccessibleControlType::Window, L"main.cpp - app - Visual Studio Code",
+                     Rect(0, 0, 1600, 1000));
+    int editor = Add(tree, window, AccessibleControlType::Document, L"main.cpp", Rect(350, 35, 1600, 975));
+    for (int i = 0; i < lines; i++) {
+        long top = 35 + (i * 20) % 920;
+        int line = Add(tree, editor, AccessibleControlType::Group, L"", Rect(350, top, 1600, top + 20));
+        Add(tree, line, AccessibleControlType::Text, L"int x" + std::to_wstring(i) + L" = 0;",
+            Rect(350, top, 1600, top + 20));
+    }
+
+    int status = Add(tree, window, AccessibleControlType::StatusBar, L"", Rect(0, 975, 1600, 1000));
+    for (const wchar_t* text : {L"main", L"0 errors, 0 warnings", L"C:\\src\\app\\main.cpp",
+                                L"Ln 42, Col 15", L"Spaces: 4", L"UTF-8", L"C++"}) {
+        int item = Add(tree, status, AccessibleControlType::Button, L"", Rect(0, 975, 100, 1000));
+        Add(tree, item, AccessibleControlType::Text, text, Rect(0, 975, 100, 1000));
+    }
+}
+
+// WeChat window: header, conversation list, message list (items of a Group + Text)
+void BuildWeChat(AccessibleSnapshot& tree, int conversations, int messages) {
+    int window = Add(tree, -1, AccessibleControlType::Window, L"\u5FAE\u4FE1", Rect(0, 0, 1200, 800));
+    Add(tree, window, AccessibleControlType::Text, L"\u5FAE\u4FE1", Rect(0, 0, 60, 30));
+    int header = Add(tree, window, AccessibleControlType::Pane, L"", Rect(310, 0, 1200, 60));
+    Add(tree, header, AccessibleControlType::Text, L"Project group(12)", Rect(330, 20, 600, 40));
+
+    int sessions = Add(tree, window, AccessibleControlType::List, L"Conversations", Rect(60, 60, 310, 800));
+    for (int i = 0; i < conversations; i++) {
+        Add(tree, sessions, AccessibleControlType::ListItem, L"Contact " + std::to_wstring(i),
+            Rect(60, 60, 310, 84));
+    }
+    int list = Add(tree, window, AccessibleControlType::List, L"Messages", Rect(310, 60, 1200, 650));
+    for (int i = 0; i < messages; i++) {
+        // Unnamed items carry their text in descendants
+        int item = Add(tree, list, AccessibleControlType::ListItem,
+                       i % 2 ? L"Message " + std::to_wstring(i) : L"", Rect(310, 60, 1200, 84));
+        int group = Add(tree, item, AccessibleControlType::Group, L"", Rect(310, 60, 1200, 84));
+        Add(tree, group, AccessibleControlType::Text, L"Message " + std::to_wstring(i), Rect(310, 60, 1200, 84));
+    }
+}
+
+void BuildNotion(AccessibleSnapshot& tree, int blocks) {
+    int window = Add(tree, -1, AccessibleControlType::Window, L"Roadmap - Notion", Rect(0, 0, 1400, 900));
+    int topbar = Add(tree, window, AccessibleControlType::Pane, L"", Rect(240, 0, 1400, 45));
+    Add(tree, topbar, AccessibleControlType::Hyperlink, L"Back", Rect(240, 10, 270, 35));
+    for (const wchar_t* crumb : {L"Acme Workspace", L"Projects", L"Roadmap"}) {
+        Add(tree, topbar, AccessibleControlType::Hyperlink, crumb, Rect(280, 10, 600, 35));
+    }
+    Add(tree, topbar, AccessibleControlType::Hyperlink, L"Share", Rect(1300, 10, 1350, 35));
+    int page = Add(tree, window, AccessibleControlType::Document, L"Roadmap", Rect(240, 45, 1400, 900));
+    for (int i = 0; i < blocks; i++) {
+        Add(tree, page, AccessibleControlType::Text, L"Block " + std::to_wstring(i), Rect(240, 45, 1400, 70));
+    }
+}
+
+} // namespace
+
+TEST(PerElementReadsCostOneCallEach) {
+    // What the status bar scan used to do: every Text element, names read one by one
+    AccessibleSnapshot tree;
+    BuildVSCode(tree, 5000);
+    AccessibleQuery texts;
+    texts.controlType = AccessibleControlType::Text;
+    std::wstring path;
+    for (const AccessibleElementPtr& element :
+         tree.GetRoot()->FindAll(AccessibleScope::Descendants, texts, AccessibleCache::None)) {
+        if (element->GetProperties().name.find(L":\\") != std::wstring::npos) {
+            path = element->GetProperties().name;
+            break;
+        }
+    }
+    CHECK_EQ(path, std::wstring(L"C:\\src\\app\\main.cpp"));
+    CHECK_EQ(tree.GetCallCount(), uint64_t(1 + 5000 + 3));
+
+    // The same search with the names fetched along: one call
+    tree.ResetCallCount();
+    std::vector<AccessibleElementPtr> found =
+        tree.GetRoot()->FindAll(AccessibleScope::Descendants, texts, AccessibleCache::Properties);
+    for (const AccessibleElementPtr& element : found) {
+        element->GetProperties();
+    }
+    CHECK_EQ(found.size(), size_t(5000 + 7));
+    CHECK_EQ(tree.GetCallCount(), uint64_t(1));
+}
+
+TEST(VSCodeStatusBarScansDoNotGrowWithTheTree) {
+    uint64_t calls[2] = {0, 0};
+    uint64_t visits[2] = {0, 0};
+    const int sizes[2] = {100, 5000};
+    for (int i = 0; i < 2; i++) {
+        AccessibleSnapshot tree;
+        BuildVSCode(tree, sizes[i]);
+        AccessibleElementPtr window = tree.GetRoot();
+
+        CHECK_EQ(VSCodeScan::FindFilePath(*window, CancellationToken::None()),
+                 std::wstring(L"C:\\src\\app\\main.cpp"));
+        int line = 0;
+        int column = 0;
+        VSCodeScan::FindCursorPosition(*window, CancellationToken::None(), line, column);
+        CHECK_EQ(line, 42);
+        CHECK_EQ(column, 15);
+        calls[i] = tree.GetCallCount();
+        visits[i] = tree.GetVisitCount();
+    }
+
+    // Two calls per scan; the editor subtree is outside the strip and never expanded
+    CHECK(calls[0] <= 4);
+    CHECK_EQ(calls[1], calls[0]);
+    CHECK_EQ(visits[1], visits[0]);
+    CHECK(visits[1] < 50);
+}
+
+TEST(WeChatMessageListIsOneCall) {
+    AccessibleSnapshot tree;
+    BuildWeChat(tree, 200, 1000);
+    AccessibleElementPtr window = tree.GetRoot();
+
+    std::vector<AccessibleElementPtr> items;
+    AccessibleElementPtr list = WeChatScan::FindMessageList(*window, CancellationToken::None(), &items);
+    REQUIRE(list);
+    CHECK_EQ(list->GetProperties().name, std::wstring(L"Messages"));
+    CHECK_EQ(items.size(), size_t(1000));
+    CHECK_EQ(tree.GetCallCount(), uint64_t(1));
+
+    // Named items cost nothing more; unnamed ones one search each
+    tree.ResetCallCount();
+    std::vector<std::wstring> messages = WeChatScan::FindRecentMessages(*window, 4, CancellationToken::None());
+    CHECK_EQ(messages, (std::vector<std::wstring>{L"Message 996", L"Message 997", L"Message 998",
+                                                  L"Message 999"}));
+    CHECK_EQ(tree.GetCallCount(), uint64_t(1 + 2));
+}
+
+TEST(WeChatChatNameSkipsAppLabels) {
+    uint64_t calls[2] = {0, 0};
+    const int sizes[2] = {10, 2000};
+    for (int i = 0; i < 2; i++) {
+        AccessibleSnapshot tree;
+        BuildWeChat(tree, sizes[i], sizes[i]);
+        CHECK_EQ(WeChatScan::FindChatName(*tree.GetRoot(), CancellationToken::None()),
+                 std::wstring(L"Project group(12)"));
+        calls[i] = tree.GetCallCount();
+    }
+    // The window's children, then one search per header element; not the lists
+    CHECK_EQ(calls[0], uint64_t(3));
+    CHECK_EQ(calls[1], calls[0]);
+}
+
+TEST(NotionBreadcrumbsAreOneCall) {
+    AccessibleSnapshot tree;
+    BuildNotion(tree, 3000);
+    CHECK_EQ(NotionScan::FindBreadcrumbs(*tree.GetRoot(), CancellationToken::None()),
+             (std::vector<std::wstring>{L"Acme Workspace", L"Projects", L"Roadmap"}));
+    CHECK_EQ(tree.GetCallCount(), uint64_t(1));
+}
+
+TEST(CancelledScansReturnNothing) {
+    CancellationToken token;
+    token.Cancel();
+
+    AccessibleSnapshot vscode;
+    BuildVSCode(vscode, 100);
+    CHECK_EQ(VSCodeScan::FindFilePath(*vscode.GetRoot(), token), std::wstring());
+    AccessibleSnapshot wechat;
+    BuildWeChat(wechat, 10, 10);
+    CHECK(WeChatScan::FindRecentMessages(*wechat.GetRoot(), 10, token).empty());
+    AccessibleSnapshot notion;
+    BuildNotion(notion, 10);
+    CHECK(NotionScan::FindBreadcrumbs(*notion.GetRoot(), token).empty());
+    CHECK_EQ(wechat.GetCallCount() + notion.GetCallCount(), uint64_t(0));
+}
+
+int main() { return RunAllTests(); }
@@ -0,0 +1,148 @@
+// LatencyHistogram: bucket mapping, and percentiles against the bucket error
+// bound at bucket edges and in the overflow bucket
+
+#include "test_framework.h"
+#include "../context/latency_histogram.h"
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const size_t kLastBucket = LatencyHistogram::kBucketCount - 1;
+
+// A value is reported as its bucket's midpoint: at most half a bucket, which
+// is at most 1/32 of the value
+bool WithinBucketError(double reported, uint64_t value) {
+    return std::fabs(reported - static_cast<double>(value)) <= value / 32.0 + 0.5;
+}
+
+} // namespace
+
+TEST(BucketsAreExactBelowSubBuckets) {
+    for (uint64_t value = 0; value < LatencyHistogram::kSubBuckets; value++) {
+        size_t index = LatencyHistogram::BucketIndex(value);
+        CHECK_EQ(index, static_cast<size_t>(value));
+        CHECK_EQ(LatencyHistogram::BucketLow(index), value);
+        CHECK_EQ(LatencyHistogram::BucketHigh(index), value);
+    }
+}
+
+TEST(BucketsTileTheRangeWithoutGaps) {
+    CHECK_EQ(LatencyHistogram::BucketLow(0), uint64_t(0));
+    for (size_t index = 0; index < LatencyHistogram::kBucketCount; index++) {
+        uint64_t low = LatencyHistogram::BucketLow(index);
+        uint64_t high = LatencyHistogram::BucketHigh(index);
+        REQUIRE(low <= high);
+        CHECK_EQ(LatencyHistogram::BucketIndex(low), index);
+        CHECK_EQ(LatencyHistogram::BucketIndex(high), index);
+        if (index + 1 < LatencyHistogram::kBucketCount) {
+            CHECK_EQ(LatencyHistogram::BucketLow(index + 1), high + 1);
+        }
+        if (index >= LatencyHistogram::kSubBuckets) {
+            // Log-linear: a bucket is at most 1/16 of its lower edge wide
+            CHECK((high - low + 1) * 16 <= low);
+        }
+    }
+    CHECK_EQ(LatencyHistogram::BucketHigh(kLastBucket), LatencyHistogram::kMaxValue);
+
+    // Larger values clamp into the last bucket
+    CHECK_EQ(LatencyHistogram::BucketIndex(LatencyHistogram::kMaxValue + 1), kLastBucket);
+    CHECK_EQ(LatencyHistogram::BucketIndex(UINT64_MAX), kLastBucket);
+}
+
+TEST(EmptyHistogramSummarizesToZeros) {
+    LatencyHistogram histogram;
+    LatencyHistogram::Summary summary = histogram.Summarize();
+    CHECK_EQ(summary.count, uint64_t(0));
+    CHECK_EQ(summary.p50Us, 0.0);
+    CHECK_EQ(summary.p99Us, 0.0);
+    CHECK_EQ(summary.maxUs, 0.0);
+}
+
+TEST(PercentilesAtBucketEdgesStayWithinTheBound) {
+    // Each value alone, at both edges of a spread of buckets
+    for (size_t index = 0; index < LatencyHistogram::kBucketCount; index += 7) {
+        for (uint64_t value : {LatencyHistogram::BucketLow(index), LatencyHistogram::BucketHigh(index)}) {
+            LatencyHistogram histogram;
+            histogram.Record(value);
+            LatencyHistogram::Summary summary = histogram.Summarize();
+            CHECK(WithinBucketError(summary.p50Us, value));
+            CHECK(WithinBucketError(summary.p99Us, value));
+            CHECK(summary.p99Us <= static_cast<double>(value));    // Never above the max
+            CHECK_EQ(summary.maxUs, static_cast<double>(value));
+        }
+    }
+
+    // A p50 and p99 that fall on the high edge of one bucket and the low edge
+    // of the next
+    size_t index = LatencyHistogram::BucketIndex(5000);
+    uint64_t high = LatencyHistogram::BucketHigh(index);
+    uint64_t next = LatencyHistogram::BucketLow(index + 1);
+    LatencyHistogram histogram;
+    for (int i = 0; i < 50; i++) histogram.Record(high);
+    for (int i = 0; i < 49; i++) histogram.Record(next);
+    histogram.Record(next * 4);
+    LatencyHistogram::Summary summary = histogram.Summarize();
+    CHECK_EQ(summary.count, uint64_t(100));
+    CHECK(WithinBucketError(summary.p50Us, high));
+    CHECK(summary.p50Us < static_cast<double>(next));
+    CHECK(WithinBucketError(summary.p90Us, next));
+    CHECK(summary.p90Us >= static_cast<double>(next));
+    CHECK(WithinBucketError(summary.p99Us, next));
+}
+
+TEST(PercentilesOfAUniformSpread) {
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 10000; value++) {
+        histogram.Record(value);
+    }
+    LatencyHistogram::Summary summary = histogram.Summarize();
+    CHECK_EQ(summary.count, uint64_t(10000));
+    CHECK(std::fabs(summary.meanUs - 5000.5) < 1e-6);
+    CHECK(WithinBucketError(summary.p50Us, 5000));
+    CHECK(WithinBucketError(summary.p90Us, 9000));
+    CHECK(WithinBucketError(summary.p99Us, 9900));
+    CHECK_EQ(summary.maxUs, 10000.0);
+}
+
+TEST(OverflowValuesLandInTheLastBucket) {
+    LatencyHistogram histogram;
+    for (int i = 0; i < 98; i++) {
+        histogram.Record(100);
+    }
+    uint64_t huge = LatencyHistogram::kMaxValue * 10;
+    histogram.Record(LatencyHistogram::kMaxValue + 1);
+    histogram.Record(huge);
+
+    std::vector<uint64_t> counts = histogram.Snapshot();
+    CHECK_EQ(counts[kLastBucket], uint64_t(2));
+
+    // The percentile is bounded by the clamped range; the max is exact
+    LatencyHistogram::Summary summary = histogram.Summarize();
+    CHECK(WithinBucketError(summary.p50Us, 100));
+    CHECK(WithinBucketError(summary.p99Us, LatencyHistogram::kMaxValue));
+    CHECK(summary.p99Us >= static_cast<double>(LatencyHistogram::BucketLow(kLastBucket)));
+    CHECK(summary.p99Us <= static_cast<double>(LatencyHistogram::kMaxValue));
+    CHECK_EQ(summary.maxUs, static_cast<double>(huge));
+}
+
+TEST(ConcurrentRecordsAreAllCounted) {
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&histogram, t]() {
+            for (uint64_t i = 0; i < 10000; i++) {
+                histogram.Record(i * (t + 1));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    LatencyHistogram::Summary summary = histogram.Summarize();
+    CHECK_EQ(summary.count, uint64_t(40000));
+    CHECK_EQ(summary.maxUs, 9999.0 * 4);
+}
+
+int main() { return RunAllTests(); }
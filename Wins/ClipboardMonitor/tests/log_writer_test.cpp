@@ -0,0 +1,191 @@
+// MappedLogFile/AsyncLogWriter: appends through the mapped view, zero tail
+// trimming, and rotation by size and by age (rename, reopen, header)
+
+#include "test_framework.h"
+#include "../log_writer.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Fresh directory per test, removed afterwards
+struct TempDir {
+    fs::path path;
+
+    explicit TempDir(const std::string& name) {
+        path = fs::temp_directory_path() / ("log_writer_test_" + name);
+        fs::remove_all(path);
+        fs::create_directories(path);
+    }
+    ~TempDir() {
+        std::error_code error;
+        fs::remove_all(path, error);
+    }
+
+    std::wstring File(const std::string& name) const { return (path / name).wstring(); }
+    bool Exists(const std::string& name) const { return fs::exists(path / name); }
+    std::string Read(const std::string& name) const {
+        std::ifstream file(path / name, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+};
+
+LogRotationPolicy Policy(uint64_t maxBytes, std::chrono::seconds maxAge, int maxFiles) {
+    LogRotationPolicy policy;
+    policy.maxBytes = maxBytes;
+    policy.maxAge = maxAge;
+    policy.maxFiles = maxFiles;
+    return policy;
+}
+
+bool WaitFor(const TempDir& dir, const std::string& name, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!dir.Exists(name)) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(AppendsLandInTheFileTrimmedToSize) {
+    TempDir dir("append");
+    MappedLogFile file;
+    REQUIRE(file.Open(dir.File("debug.log"), true));
+    CHECK(file.IsOpen());
+    CHECK_EQ(file.Size(), uint64_t(0));
+
+    // Past the first mapped chunk, so the view is remapped
+    std::string big(3 * 1024 * 1024 / 2, 'x');
+    CHECK(file.Append("first\n", 6));
+    CHECK(file.Append(big.data(), big.size()));
+    CHECK(file.Append("last\n", 5));
+    CHECK_EQ(file.Size(), uint64_t(6 + big.size() + 5));
+    file.Close();
+    CHECK(!file.IsOpen());
+    CHECK(!file.Append("closed", 6));
+
+    std::string content = dir.Read("debug.log");
+    CHECK_EQ(content.size(), size_t(6 + big.size() + 5));
+    CHECK(content == "first\n" + big + "last\n");
+
+    // Reopening appends after the existing data
+    REQUIRE(file.Reopen());
+    CHECK_EQ(file.Size(), uint64_t(content.size()));
+    CHECK(file.Append("again\n", 6));
+    file.Close();
+    CHECK_EQ(dir.Read("debug.log"), content + "again\n");
+}
+
+TEST(ZeroTailIsTrimmedOnlyWhenAsked) {
+    TempDir dir("tail");
+    {
+        std::ofstream out(dir.path / "debug.log", std::ios::binary);
+        out << "data";
+        out << std::string(10000, '\0');
+    }
+
+    MappedLogFile binary;
+    REQUIRE(binary.Open(dir.File("debug.log"), false));
+    CHECK_EQ(binary.Size(), uint64_t(10004));
+    binary.Close();
+
+    MappedLogFile text;
+    REQUIRE(text.Open(dir.File("debug.log"), true));
+    CHECK_EQ(text.Size(), uint64_t(4));
+    CHECK(text.Append("more", 4));
+    text.Close();
+    CHECK_EQ(dir.Read("debug.log"), std::string("datamore"));
+}
+
+TEST(RotationBySizeShiftsTheFiles) {
+    TempDir dir("size");
+    LogRotationPolicy policy = Policy(100, std::chrono::seconds(0), 2);
+    MappedLogFile file;
+    REQUIRE(file.Open(dir.File("debug.log"), true));
+    CHECK(!file.ShouldRotate(policy));      // Empty files never rotate
+
+    for (char generation : {'a', 'b', 'c'}) {
+        std::string data(99, generation);
+        CHECK(file.Append(data.data(), data.size()));
+        CHECK(!file.ShouldRotate(policy));
+        CHECK(file.Append("\n", 1));
+        CHECK(file.ShouldRotate(policy));
+        CHECK(file.Rotate(policy));
+        CHECK(file.IsOpen());
+        CHECK_EQ(file.Size(), uint64_t(0));
+    }
+    file.Close();
+
+    // Newest first; the oldest ('a') fell off the end
+    CHECK_EQ(dir.Read("debug.log"), std::string());
+    CHECK_EQ(dir.Read("debug.1.log"), std::string(99, 'c') + "\n");
+    CHECK_EQ(dir.Read("debug.2.log"), std::string(99, 'b') + "\n");
+    CHECK(!dir.Exists("debug.3.log"));
+
+    // maxFiles 0 keeps no rotated files
+    LogRotationPolicy none = Policy(10, std::chrono::seconds(0), 0);
+    REQUIRE(file.Open(dir.File("trace.log"), true));
+    CHECK(file.Append("0123456789", 10));
+    CHECK(file.Rotate(none));
+    file.Close();
+    CHECK(!dir.Exists("trace.1.log"));
+    CHECK_EQ(dir.Read("trace.log"), std::string());
+}
+
+TEST(RotationByAge) {
+    TempDir dir("age");
+    LogRotationPolicy policy = Policy(0, std::chrono::seconds(1), 1);
+    MappedLogFile file;
+    REQUIRE(file.Open(dir.File("debug.log"), true));
+    CHECK(file.Append("old\n", 4));
+    CHECK(!file.ShouldRotate(policy));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    CHECK(file.ShouldRotate(policy));
+    CHECK(file.Rotate(policy));
+
+    // The file created by the rotation starts a new age
+    CHECK(file.Append("new\n", 4));
+    CHECK(!file.ShouldRotate(policy));
+    file.Close();
+    CHECK_EQ(dir.Read("debug.1.log"), std::string("old\n"));
+    CHECK_EQ(dir.Read("debug.log"), std::string("new\n"));
+}
+
+TEST(WriterRotatesBetweenBatchesAndRewritesTheHeader) {
+    TempDir dir("writer");
+    const std::string header = "HEADER\n";
+    LogRotationPolicy policy = Policy(1000, std::chrono::seconds(0), 3);
+    AsyncLogWriter writer;
+    REQUIRE(writer.Open(dir.File("debug.log"), policy, header, true));
+    CHECK(writer.IsOpen());
+
+    std::string batch(1500, 'x');
+    writer.Append(batch);
+    REQUIRE(WaitFor(dir, "debug.1.log", 5000));
+    writer.Append("after\n");
+    writer.Close();
+    CHECK(!writer.IsOpen());
+
+    CHECK_EQ(dir.Read("debug.1.log"), header + batch);
+    CHECK_EQ(dir.Read("debug.log"), header + "after\n");
+
+    // A file left over past the limit is rotated before the session writes
+    AsyncLogWriter next;
+    REQUIRE(next.Open(dir.File("debug.log"), Policy(10, std::chrono::seconds(0), 3), header, true));
+    next.Close();
+    CHECK_EQ(dir.Read("debug.2.log"), header + batch);
+    CHECK_EQ(dir.Read("debug.1.log"), header + "after\n");
+    CHECK_EQ(dir.Read("debug.log"), header);
+}
+
+int main() { return RunAllTests(); }
@@ -0,0 +1,284 @@
+// TaskPromise/TaskFuture: results, exceptions, broken promises and pooled
+// states; TaskFunction: inline and heap storage of move-only callables
+
+#include "test_framework.h"
+#include "../context/task_function.h"
+#include "../context/task_future.h"
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+std::atomic<size_t> g_allocations{0};
+
+// Counts live instances and how many of them were destroyed while still
+// owning their value (not moved from)
+struct Probe {
+    static std::atomic<int> live;
+    static std::atomic<int> ownerDestroyed;
+    bool owner = true;
+
+    Probe() { live++; }
+    Probe(Probe&& other) noexcept : owner(other.owner) {
+        other.owner = false;
+        live++;
+    }
+    Probe(const Probe&) = delete;
+    ~Probe() {
+        if (owner) ownerDestroyed++;
+        live--;
+    }
+
+    static void Reset() {
+        live = 0;
+        ownerDestroyed = 0;
+    }
+};
+std::atomic<int> Probe::live{0};
+std::atomic<int> Probe::ownerDestroyed{0};
+
+// Move-only callable that does not fit inline
+struct BigTask {
+    std::unique_ptr<int> value;
+    char padding[TaskFunction::kInlineSize];
+    int* out;
+    void operator()() { *out = *value; }
+};
+
+} // namespace
+
+// Count every heap allocation in the process
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+TEST(GetReturnsTheValueSetOnAnotherThread) {
+    TaskPromise<std::string> promise;
+    TaskFuture<std::string> future = promise.GetFuture();
+    CHECK(future.valid());
+    CHECK(future.wait_for(std::chrono::milliseconds(0)) == std::future_status::timeout);
+
+    std::thread setter([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        promise.SetValue("done");
+    });
+    CHECK_EQ(future.get(), std::string("done"));
+    CHECK(!future.valid());
+    setter.join();
+
+    // A second GetFuture or SetValue is an error
+    TaskPromise<int> once;
+    TaskFuture<int> first = once.GetFuture();
+    bool threw = false;
+    try {
+        once.GetFuture();
+    } catch (const std::future_error& e) {
+        threw = e.code() == std::future_errc::future_already_retrieved;
+    }
+    CHECK(threw);
+    once.SetValue(1);
+    threw = false;
+    try {
+        once.SetValue(2);
+    } catch (const std::future_error& e) {
+        threw = e.code() == std::future_errc::promise_already_satisfied;
+    }
+    CHECK(threw);
+    CHECK_EQ(first.get(), 1);
+}
+
+TEST(UnfulfilledPromiseGivesBrokenPromise) {
+    TaskFuture<int> future;
+    {
+        TaskPromise<int> promise;
+        future = promise.GetFuture();
+    }
+    bool broken = false;
+    try {
+        future.get();
+    } catch (const std::future_error& e) {
+        broken = e.code() == std::future_errc::broken_promise;
+    }
+    CHECK(broken);
+
+    // Also when the promise dies inside a task that never ran
+    TaskFuture<void> dropped;
+    {
+        TaskPromise<void> promise;
+        dropped = promise.GetFuture();
+        TaskFunction task([p = std::move(promise)]() mutable { p.SetValue(true); });
+    }
+    broken = false;
+    try {
+        dropped.get();
+    } catch (const std::future_error& e) {
+        broken = e.code() == std::future_errc::broken_promise;
+    }
+    CHECK(broken);
+}
+
+TEST(ExceptionsPropagateThroughGet) {
+    TaskPromise<int> promise;
+    TaskFuture<int> future = promise.GetFuture();
+    auto func = []() -> int { throw std::runtime_error("task failed"); };
+    promise.SetFrom(func);
+
+    std::string message;
+    try {
+        future.get();
+    } catch (const std::runtime_error& e) {
+        message = e.what();
+    }
+    CHECK_EQ(message, std::string("task failed"));
+
+    TaskPromise<void> voidPromise;
+    TaskFuture<void> voidFuture = voidPromise.GetFuture();
+    auto voidFunc = []() { throw std::logic_error("void failed"); };
+    voidPromise.SetFrom(voidFunc);
+    bool threw = false;
+    try {
+        voidFuture.get();
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+TEST(PooledStatesAreReusedAndReset) {
+    Probe::Reset();
+
+    // Warm the free list
+    for (int i = 0; i < 4; i++) {
+        TaskPromise<Probe> promise;
+        TaskFuture<Probe> future = promise.GetFuture();
+        promise.SetValue();
+        future.get();
+    }
+    CHECK_EQ(Probe::live.load(), 0);
+
+    // A reused state neither allocates nor keeps the last value or exception
+    std::exception_ptr failure = std::make_exception_ptr(std::runtime_error("failed"));
+    size_t before = g_allocations.load();
+    for (int i = 0; i < 100; i++) {
+        TaskPromise<Probe> promise;
+        TaskFuture<Probe> future = promise.GetFuture();
+        if (i % 2) {
+            CHECK(future.wait_for(std::chrono::milliseconds(0)) == std::future_status::timeout);
+            promise.SetValue();
+            Probe value = future.get();
+            CHECK(value.owner);
+        } else {
+            promise.SetException(failure);
+            bool threw = false;
+            try {
+                future.get();
+            } catch (const std::runtime_error&) {
+                threw = true;
+            }
+            CHECK(threw);
+        }
+    }
+    CHECK_EQ(g_allocations.load(), before);
+    CHECK_EQ(Probe::live.load(), 0);
+
+    // The stored value is destroyed when the last reference goes, even if
+    // nobody takes it
+    {
+        TaskPromise<Probe> promise;
+        TaskFuture<Probe> future = promise.GetFuture();
+        promise.SetValue();
+        CHECK_EQ(Probe::live.load(), 1);
+    }
+    CHECK_EQ(Probe::live.load(), 0);
+}
+
+TEST(SmallCallablesAreStoredInline) {
+    int out = 0;
+    auto shared = std::make_shared<int>(7);
+    size_t before = g_allocations.load();
+    TaskFunction task([shared, &out]() { out = *shared; });
+    TaskFunction moved(std::move(task));
+    CHECK(!task);
+    moved();
+    CHECK_EQ(g_allocations.load(), before);
+    CHECK_EQ(out, 7);
+}
+
+TEST(LargeCallablesUseTheHeap) {
+    int out = 0;
+    BigTask big{std::make_unique<int>(42), {}, &out};
+    static_assert(sizeof(BigTask) > TaskFunction::kInlineSize);
+
+    size_t before = g_allocations.load();
+    TaskFunction task(std::move(big));
+    CHECK_EQ(g_allocations.load(), before + 1);
+
+    // Moving hands over the pointer without copying the callable
+    TaskFunction moved(std::move(task));
+    TaskFunction assigned;
+    assigned = std::move(moved);
+    CHECK_EQ(g_allocations.load(), before + 1);
+    CHECK(!task);
+    CHECK(!moved);
+    assigned();
+    CHECK_EQ(out, 42);
+}
+
+TEST(MoveOnlyCapturesAreDestroyedExactlyOnce) {
+    // Inline
+    Probe::Reset();
+    {
+        int calls = 0;
+        TaskFunction task([probe = Probe(), &calls]() { calls++; });
+        TaskFunction second(std::move(task));
+        TaskFunction third;
+        third = std::move(second);
+        third();
+        CHECK_EQ(calls, 1);
+        CHECK_EQ(Probe::ownerDestroyed.load(), 0);
+    }
+    CHECK_EQ(Probe::ownerDestroyed.load(), 1);
+    CHECK_EQ(Probe::live.load(), 0);
+
+    // Heap
+    Probe::Reset();
+    {
+        char padding[TaskFunction::kInlineSize] = {};
+        TaskFunction task([probe = Probe(), padding]() { (void)padding; });
+        TaskFunction second(std::move(task));
+        second();
+        second = nullptr;
+        CHECK_EQ(Probe::ownerDestroyed.load(), 1);
+    }
+    CHECK_EQ(Probe::ownerDestroyed.load(), 1);
+    CHECK_EQ(Probe::live.load(), 0);
+
+    // A promise captured by a task that is destroyed unrun breaks once
+    TaskFuture<int> future;
+    {
+        TaskPromise<int> promise;
+        future = promise.GetFuture();
+        TaskFunction task([p = std::move(promise)]() mutable { p.SetValue(1); });
+        TaskFunction moved(std::move(task));
+    }
+    CHECK(future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready);
+}
+
+int main() { return RunAllTests(); }
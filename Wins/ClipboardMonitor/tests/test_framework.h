@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Minimal unit test harness (one executable per test file, run by ctest)
+//
+//   TEST(Name) { ... }       Define and register a test case
+//   CHECK(condition)         Record a failure and go on
+//   CHECK_EQ(actual, expected)
+//   REQUIRE(condition)       Record a failure and leave the test case
+//
+// End each test file with: int main() { return RunAllTests(); }
+
+namespace test_detail {
+
+struct TestCase {
+    const char* name;
+    std::function<void()> body;
+};
+
+// Thrown by REQUIRE to leave the current test case
+struct Abort {};
+
+inline std::vector<TestCase>& Registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+inline int& Failures() {
+    static int failures = 0;
+    return failures;
+}
+
+struct Registrar {
+    Registrar(const char* name, std::function<void()> body) {
+        Registry().push_back({name, std::move(body)});
+    }
+};
+
+inline void Fail(const char* file, int line, const std::string& message) {
+    Failures()++;
+    std::fprintf(stderr, "%s:%d: FAILED: %s\n", file, line, message.c_str());
+}
+
+template<typename T>
+struct IsVector : std::false_type {};
+
+template<typename T>
+struct IsVector<std::vector<T>> : std::true_type {};
+
+// Printable form of a checked value (wide strings as UTF-16 code units)
+template<typename T>
+std::string Describe(const T& value) {
+    if constexpr (IsVector<T>::value) {
+        std::string out = "{";
+        for (size_t i = 0; i < value.size(); i++) {
+            out += (i ? ", " : "") + Describe(value[i]);
+        }
+        return out + "}";
+    } else if constexpr (std::is_same_v<T, std::wstring>) {
+        std::string out;
+        for (wchar_t c : value) {
+            if (c >= 0x20 && c < 0x7F) {
+                out += static_cast<char>(c);
+            } else {
+                char escape[16];
+                std::snprintf(escape, sizeof(escape), "\\u%04X", static_cast<unsigned>(c));
+                out += escape;
+            }
+        }
+        return "L\"" + out + "\"";
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return "\"" + value + "\"";
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return value ? "true" : "false";
+    } else if constexpr (std::is_enum_v<T>) {
+        return std::to_string(static_cast<long long>(value));
+    } else {
+        std::ostringstream out;
+        out << value;
+        return out.str();
+    }
+}
+
+template<typename A, typename E>
+void CheckEqual(const A& actual, const E& expected, const char* text, const char* file, int line) {
+    if (!(actual == expected)) {
+        using ActualType = std::conditional_t<std::is_convertible_v<A, std::wstring> &&
+                                              !std::is_same_v<A, std::nullptr_t>, std::wstring, A>;
+        using ExpectedType = std::conditional_t<std::is_convertible_v<E, std::wstring> &&
+                                                !std::is_same_v<E, std::nullptr_t>, std::wstring, E>;
+        Fail(file, line, std::string(text) + ": got " + Describe<ActualType>(actual) +
+                         ", expected " + Describe<ExpectedType>(expected));
+    }
+}
+
+} // namespace test_detail
+
+#define TEST_CONCAT_(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_(a, b)
+
+#define TEST(name)                                                                   \
+    static void TEST_CONCAT(Test_, name)();                                          \
+    static test_detail::Registrar TEST_CONCAT(registrar_, name)(#name, TEST_CONCAT(Test_, name)); \
+    static void TEST_CONCAT(Test_, name)()
+
+#define CHECK(condition)                                                             \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            test_detail::Fail(__FILE__, __LINE__, #condition);                       \
+        }                                                                            \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                   \
+    test_detail::CheckEqual((actual), (expected), #actual " == " #expected, __FILE__, __LINE__)
+
+#define REQUIRE(condition)                                                           \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            test_detail::Fail(__FILE__, __LINE__, #condition);                       \
+            throw test_detail::Abort();                                              \
+        }                                                                            \
+    } while (0)
+
+// Run every registered test case; returns the process exit code
+inline int RunAllTests() {
+    int failed = 0;
+    for (const test_detail::TestCase& test : test_detail::Registry()) {
+        int before = test_detail::Failures();
+        try {
+            test.body();
+        } catch (const test_detail::Abort&) {
+        } catch (const std::exception& e) {
+            test_detail::Fail(__FILE__, __LINE__, std::string("exception: ") + e.what());
+        }
+        bool passed = test_detail::Failures() == before;
+        std::printf("[%s] %s\n", passed ? "PASS" : "FAIL", test.name);
+        failed += passed ? 0 : 1;
+    }
+    std::printf("%zu tests, %d failed\n", test_detail::Registry().size(), failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+// TimerQueue: deadline order, cancellation, stale IDs, and the shared timer
+// thread behind AsyncExecutor::SubmitWithTimeout
+
+#include "test_framework.h"
+#include "../context/async_executor.h"
+#include "../context/timer_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <filesystem>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Labels of fired timers, in firing order, and the threads they fired on
+struct FireLog {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<int> labels;
+    std::set<std::thread::id> threads;
+
+    void Add(int label) {
+        std::lock_guard<std::mutex> lock(mutex);
+        labels.push_back(label);
+        threads.insert(std::this_thread::get_id());
+        condition.notify_all();
+    }
+
+    bool WaitFor(size_t count, int timeoutMs) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return condition.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                  [&] { return labels.size() >= count; });
+    }
+
+    size_t Size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return labels.size();
+    }
+};
+
+// Threads in this process, or 0 where that cannot be read
+size_t ProcessThreadCount() {
+#ifdef __linux__
+    size_t count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc/self/task")) {
+        (void)entry;
+        count++;
+    }
+    return count;
+#else
+    return 0;
+#endif
+}
+
+} // namespace
+
+TEST(ThousandsOfTimersFireInDeadlineOrder) {
+    const int count = 4000;
+    const int groups = 10;
+    const int stepMs = 20;      // Far more than scheduling all of them takes
+    TimerQueue timers;
+    FireLog log;
+
+    // Label i has delay stepMs * (1 + i % groups); odd labels are cancelled
+    std::vector<TimerQueue::TimerId> ids;
+    auto start = Clock::now();
+    for (int i = 0; i < count; i++) {
+        ids.push_back(timers.Schedule(std::chrono::milliseconds(stepMs * (1 + i % groups)),
+                                      [&log, i]() { log.Add(i); }));
+    }
+    REQUIRE(Clock::now() - start < std::chrono::milliseconds(stepMs));
+    CHECK_EQ(timers.PendingCount(), size_t(count));
+
+    for (int i = 1; i < count; i += 2) {
+        CHECK(timers.Cancel(ids[i]));
+    }
+    CHECK_EQ(timers.PendingCount(), size_t(count / 2));
+
+    REQUIRE(log.WaitFor(count / 2, 5000));
+    std::this_thread::sleep_for(std::chrono::milliseconds(stepMs));
+    std::lock_guard<std::mutex> lock(log.mutex);
+    CHECK_EQ(log.labels.size(), size_t(count / 2));
+    bool onlyEven = std::all_of(log.labels.begin(), log.labels.end(), [](int i) { return i % 2 == 0; });
+    CHECK(onlyEven);
+    std::set<int> distinct(log.labels.begin(), log.labels.end());
+    CHECK_EQ(distinct.size(), size_t(count / 2));
+
+    // Delay groups fire in order; within a group, in scheduling order
+    bool ordered = true;
+    for (size_t k = 1; k < log.labels.size(); k++) {
+        int previous = log.labels[k - 1];
+        int current = log.labels[k];
+        int previousGroup = previous % groups;
+        int currentGroup = current % groups;
+        ordered = ordered && (previousGroup < currentGroup ||
+                              (previousGroup == currentGroup && previous < current));
+    }
+    CHECK(ordered);
+    CHECK_EQ(log.threads.size(), size_t(1));
+    CHECK_EQ(timers.PendingCount(), size_t(0));
+}
+
+TEST(CancellingFiredOrStaleIdsDoesNothing) {
+    TimerQueue timers;
+    FireLog log;
+
+    TimerQueue::TimerId fired = timers.Schedule(std::chrono::milliseconds(0), [&]() { log.Add(1); });
+    REQUIRE(log.WaitFor(1, 1000));
+    CHECK(!timers.Cancel(fired));
+
+    // A cancelled timer's slot is reused with a new generation; the old ID
+    // must not cancel the new timer
+    TimerQueue::TimerId cancelled = timers.Schedule(std::chrono::milliseconds(50), [&]() { log.Add(2); });
+    CHECK(timers.Cancel(cancelled));
+    CHECK(!timers.Cancel(cancelled));
+    TimerQueue::TimerId reused = timers.Schedule(std::chrono::milliseconds(20), [&]() { log.Add(3); });
+    CHECK(reused != cancelled);
+    CHECK_EQ(static_cast<uint32_t>(reused), static_cast<uint32_t>(cancelled));
+    CHECK(!timers.Cancel(cancelled));
+    CHECK(!timers.Cancel(fired));
+    CHECK(!timers.Cancel(TimerQueue::kInvalidTimer));
+    CHECK(!timers.Cancel((uint64_t(1) << 32) | 12345));
+    CHECK_EQ(timers.PendingCount(), size_t(1));
+
+    REQUIRE(log.WaitFor(2, 1000));
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    std::lock_guard<std::mutex> lock(log.mutex);
+    CHECK_EQ(log.labels, (std::vector<int>{1, 3}));
+}
+
+TEST(ShutdownDiscardsPendingTimers) {
+    TimerQueue timers;
+    FireLog log;
+    timers.Schedule(std::chrono::milliseconds(30), [&]() { log.Add(1); });
+    timers.Shutdown();
+    CHECK_EQ(timers.Schedule(std::chrono::milliseconds(0), [&]() { log.Add(2); }), TimerQueue::kInvalidTimer);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK_EQ(log.Size(), size_t(0));
+}
+
+TEST(SubmitWithTimeoutSharesOneTimerThread) {
+    AsyncExecutor executor(2);
+    size_t baseline = ProcessThreadCount();
+
+    // Hold both workers so every submission times out
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool open = false;
+    auto hold = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&] { return open; });
+    };
+
+    const int submissions = 500;
+    FireLog timeouts;
+    for (int i = 0; i < submissions; i++) {
+        executor.SubmitWithTimeout(hold, 30, [&timeouts, i]() { timeouts.Add(i); });
+    }
+    CHECK_EQ(ProcessThreadCount(), baseline);
+    REQUIRE(timeouts.WaitFor(submissions, 5000));
+    CHECK_EQ(ProcessThreadCount(), baseline);
+    {
+        std::lock_guard<std::mutex> lock(timeouts.mutex);
+        CHECK_EQ(timeouts.threads.size(), size_t(1));
+        CHECK(timeouts.threads.count(std::this_thread::get_id()) == 0);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        open = true;
+    }
+    condition.notify_all();
+
+    // A task that finishes in time cancels its timeout
+    FireLog late;
+    std::atomic<int> done{0};
+    for (int i = 0; i < 100; i++) {
+        executor.SubmitWithTimeout([&]() { done++; }, 50, [&late, i]() { late.Add(i); });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    CHECK_EQ(done.load(), 100);
+    CHECK_EQ(late.Size(), size_t(0));
+    CHECK_EQ(ProcessThreadCount(), baseline);
+}
+
+int main() { return RunAllTests(); }
@@ -0,0 +1,205 @@
+// TitleRules: the built-in title layouts, config rules and the automaton
+// Windows-only (title_rules.cpp logs through debug_log.h)
+
+#include "test_framework.h"
+#include "../context/utils/title_rules.h"
+
+namespace {
+
+struct Case {
+    const char* app;
+    std::wstring title;
+    std::wstring expected;    // Fields as "name=value|...", "*" first if modified, "?" if no layout matched
+};
+
+// Same form as Case::expected, prefixed with the title so failures show it
+std::wstring Describe(const std::wstring& title, const TitleFields& parsed) {
+    std::wstring out;
+    if (parsed.modified) {
+        out += L"*";
+    }
+    if (!parsed.matched && !parsed.fields.empty()) {
+        out += L"?";
+    }
+    for (const auto& field : parsed.fields) {
+        if (&field != &*parsed.fields.begin()) {
+            out += L"|";
+        }
+        out += std::wstring(field.first.begin(), field.first.end()) + L"=" + field.second;
+    }
+    return title + L" -> " + out;
+}
+
+void CheckCases(const TitleRules& rules, const std::vector<Case>& cases) {
+    for (const Case& c : cases) {
+        CHECK_EQ(Describe(c.title, rules.Parse(c.app, c.title)), c.title + L" -> " + c.expected);
+    }
+}
+
+bool LoadRules(TitleRules& rules, const char* json, std::string* error = nullptr) {
+    JsonValue value;
+    return JsonReader::Parse(json, value, error) && rules.Load(value, error);
+}
+
+} // namespace
+
+TEST(VSCodeTitles) {
+    TitleRules rules;
+    CheckCases(rules, {
+        {"vscode", L"main.cpp - app - Visual Studio Code", L"file=main.cpp|project=app"},
+        {"vscode", L"main.cpp - Visual Studio Code", L"file=main.cpp"},
+        {"vscode", L"main.cpp - my - app - Visual Studio Code", L"file=main.cpp|project=my - app"},
+
+        // Modified marker, with and without its trailing space
+        {"vscode", L"● main.cpp - app - Visual Studio Code", L"*file=main.cpp|project=app"},
+        {"vscode", L"●main.cpp - app - Visual Studio Code", L"*file=main.cpp|project=app"},
+        {"vscode", L"main.cpp ● - app - Visual Studio Code", L"file=main.cpp ●|project=app"},
+
+        // Antigravity: "Project - Antigravity - file" (infix), else a plain suffix
+        {"vscode", L"app - Antigravity - main.cpp", L"file=main.cpp|project=app"},
+        {"vscode", L"● app - Antigravity - main.cpp", L"*file=main.cpp|project=app"},
+        {"vscode", L"app - Antigravity - src - main.cpp", L"file=src - main.cpp|project=app"},
+        {"vscode", L"main.cpp - app - Antigravity", L"file=main.cpp|project=app"},
+
+        // Other editors of the family
+        {"vscode", L"main.cpp - app - Code - Insiders", L"file=main.cpp|project=app"},
+        {"vscode", L"main.cpp - Code - Insiders", L"file=main.cpp"},
+        {"vscode", L"main.cpp - app - Cursor", L"file=main.cpp|project=app"},
+        {"vscode", L"main.cpp - app - VSCodium", L"file=main.cpp|project=app"},
+
+        // No editor suffix: split the whole title
+        {"vscode", L"main.cpp - app", L"?file=main.cpp|project=app"},
+        {"vscode", L"Welcome", L"?file=Welcome"},
+        {"vscode", L"●", L"*?file="},
+    });
+}
+
+TEST(BrowserTitlesForEverySuffix) {
+    const wchar_t* const browsers[] = {
+        L"Google Chrome", L"Microsoft Edge", L"Mozilla Firefox", L"Opera", L"Brave", L"Vivaldi",
+        L"Chromium", L"Comet", L"Atlas", L"Arc", L"360 Secure Browser", L"360 Chrome", L"QQ Browser",
+        L"Sogou Browser", L"Liebao Browser", L"2345 Browser", L"Maxthon", L"Browser", L"Web Browser",
+    };
+    CHECK_EQ(sizeof(browsers) / sizeof(browsers[0]), size_t(19));
+
+    TitleRules rules;
+    std::vector<Case> cases;
+    for (const wchar_t* browser : browsers) {
+        cases.push_back({"browser", L"Example Domain - " + std::wstring(browser), L"page_title=Example Domain"});
+        cases.push_back({"browser", L"A - B - " + std::wstring(browser), L"page_title=A - B"});
+    }
+    CheckCases(rules, cases);
+
+    CheckCases(rules, {
+        // The longer names win over " - Browser"
+        {"browser", L"Docs - QQ Browser", L"page_title=Docs"},
+        // The last occurrence is the suffix
+        {"browser", L"Chrome tips - Google Chrome - Google Chrome", L"page_title=Chrome tips - Google Chrome"},
+        {"browser", L"New Tab", L"?page_title=New Tab"},
+        {"browser", L"Page - Safari", L"?page_title=Page - Safari"},
+    });
+}
+
+TEST(NotionTitlesAreTrimmed) {
+    TitleRules rules;
+    CheckCases(rules, {
+        {"notion", L"Roadmap - Notion", L"page_title=Roadmap"},
+        {"notion", L"  Roadmap \t - Notion", L"page_title=Roadmap"},
+        {"notion", L"Q3 - Plans - Notion", L"page_title=Q3 - Plans"},
+        {"notion", L"  Inbox  ", L"?page_title=Inbox"},
+    });
+}
+
+TEST(WeChatTitles) {
+    TitleRules rules;
+    CheckCases(rules, {
+        {"wechat", L"张三 - 微信", L"chat=张三"},
+        {"wechat", L"Project group(12) - WeChat", L"chat=Project group(12)"},
+
+        // Cut at the first " - 微信", as the adapter always did
+        {"wechat", L"A - 微信 - 微信", L"chat=A"},
+        {"wechat", L"A - 微信支付", L"chat=A"},
+        {"wechat", L"A - WeChat - 微信", L"chat=A - WeChat"},
+
+        {"wechat", L"张三", L"?chat=张三"},
+    });
+
+    // The main window carries no chat
+    for (const wchar_t* title : {L"微信", L"WeChat", L""}) {
+        TitleFields parsed = rules.Parse("wechat", title);
+        CHECK(parsed.fields.empty());
+        CHECK(!parsed.matched);
+    }
+}
+
+TEST(GenericTitles) {
+    TitleRules rules;
+    CheckCases(rules, {
+        {"generic", L"Report.docx - Word", L"app=Word|document=Report.docx"},
+        {"generic", L"a - b - App", L"app=App|document=a - b"},
+        {"generic", L"*notes.txt - Notepad", L"*app=Notepad|document=notes.txt"},
+        {"generic", L"Title — App", L"app=App|document=Title"},
+        {"generic", L"Inbox | Mail", L"app=Mail|document=Inbox"},
+        {"generic", L"Calculator", L"?document=Calculator"},
+    });
+    CHECK(rules.Parse("unknown", L"Report.docx - Word").fields.empty());
+}
+
+TEST(ConfigRulesAddAndReplaceApps) {
+    TitleRules rules;
+    REQUIRE(LoadRules(rules, R"({
+        "obsidian": { "layouts": [
+            { "suffix": " - Obsidian", "separator": " - ", "fields": ["note", "vault"] } ] },
+        "wechat": { "layouts": [ { "suffix": " | Chat", "fields": ["chat"] } ] }
+    })"));
+    CheckCases(rules, {
+        {"obsidian", L"Ideas - Notes - Obsidian", L"note=Ideas|vault=Notes"},
+        {"wechat", L"Team | Chat", L"chat=Team"},
+        {"wechat", L"张三 - 微信", L""},
+        {"vscode", L"main.cpp - app - Visual Studio Code", L"file=main.cpp|project=app"},
+    });
+}
+
+TEST(InvalidConfigRulesAreReported) {
+    struct Invalid {
+        const char* json;
+        const char* error;
+    };
+    const Invalid cases[] = {
+        {R"({"x": []})", "x: rule set must be an object"},
+        {R"({"x": {"layouts": []}})", "x: \"layouts\" must be a non-empty array"},
+        {R"({"x": {"layouts": [{"suffix": "a", "infix": "b", "fields": ["f"]}]}})",
+         "x: a layout has either \"suffix\" or \"infix\", not both"},
+        {R"({"x": {"layouts": [{"suffix": "a"}]}})", "x: a layout needs one or two \"fields\" names"},
+        {R"({"x": {"ignore": [""], "layouts": [{"fields": ["f"]}]}})", "x: \"ignore\" must hold non-empty strings"},
+    };
+    for (const Invalid& c : cases) {
+        TitleRules rules;
+        std::string error;
+        CHECK(!LoadRules(rules, c.json, &error));
+        CHECK_EQ(error, std::string(c.error));
+        // The built-in rules are left in place
+        CHECK_EQ(rules.Parse("browser", L"Page - Arc").Get("page_title"), std::wstring(L"Page"));
+    }
+}
+
+TEST(AutomatonFindsOverlappingPatterns) {
+    TitleAutomaton automaton;
+    int he = automaton.Add(L"he");
+    int she = automaton.Add(L"she");
+    int hers = automaton.Add(L"hers");
+    CHECK_EQ(automaton.Add(L"she"), she);
+    automaton.Build();
+
+    std::vector<TitleAutomaton::Match> matches;
+    automaton.Scan(L"ushers", matches);
+    REQUIRE(matches.size() == 3);
+    CHECK_EQ(matches[0].pattern, she);
+    CHECK_EQ(matches[0].start, size_t(1));
+    CHECK_EQ(matches[1].pattern, he);
+    CHECK_EQ(matches[1].start, size_t(2));
+    CHECK_EQ(matches[2].pattern, hers);
+    CHECK_EQ(matches[2].start, size_t(2));
+}
+
+int main() { return RunAllTests(); }
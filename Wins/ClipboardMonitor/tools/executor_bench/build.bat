@@ -0,0 +1,24 @@
+@echo off
+REM Build executor_bench.exe (AsyncExecutor submit throughput/latency)
+REM Run from Developer Command Prompt for VS 2022
+
+cd /d "%~dp0"
+
+echo Building executor_bench.exe...
+
+cl.exe /EHsc /std:c++20 /W4 /O2 ^
+    /Fe:executor_bench.exe ^
+    executor_bench.cpp ^
+    ..\..\context\async_executor.cpp ^
+    ..\..\context\timer_queue.cpp ^
+    ..\..\context\latency_histogram.cpp ^
+    ..\..\context\executor_metrics.cpp
+
+if %ERRORLEVEL% EQU 0 (
+    echo Build successful!
+    echo Usage: executor_bench.exe [--threads=N] [--tasks=N]
+) else (
+    echo Build failed!
+)
+
+pause
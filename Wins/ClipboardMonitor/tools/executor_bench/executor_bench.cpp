@@ -0,0 +1,157 @@
+// Microbenchmark for AsyncExecutor task submission
+//
+// Usage:
+//   executor_bench [--threads=N] [--tasks=N]
+//
+// Compares Submit (inline task storage + pooled future state) against the
+// previous scheme of std::bind + shared_ptr<std::packaged_task> + std::future
+// run on the same pool. Reports throughput, submit-to-run latency and heap
+// allocations per task.
+
+#include "../../context/async_executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double tasksPerSecond = 0.0;
+    double allocationsPerTask = 0.0;
+    double latencyP50Us = 0.0;
+    double latencyP99Us = 0.0;
+};
+
+// Previous submission path, kept here only for comparison
+template<typename Func>
+std::future<std::invoke_result_t<Func>> LegacySubmit(AsyncExecutor& executor, Func&& func) {
+    using ReturnType = std::invoke_result_t<Func>;
+    auto task = std::make_shared<std::packaged_task<ReturnType()>>(std::bind(std::forward<Func>(func)));
+    std::future<ReturnType> result = task->get_future();
+    std::function<void()> wrapped = [task]() { (*task)(); };
+    executor.Submit([wrapped = std::move(wrapped)]() { wrapped(); });
+    return result;
+}
+
+template<typename SubmitFn>
+Result Run(AsyncExecutor& executor, size_t taskCount, SubmitFn submit) {
+    Result result;
+    constexpr size_t kBatch = 256;
+
+    // Warm up pools and queue capacity
+    for (size_t i = 0; i < kBatch * 4; ++i) {
+        submit(executor, Clock::time_point()).get();
+    }
+
+    // Throughput: keep a batch in flight, wait for it, repeat
+    using FutureType = decltype(submit(executor, Clock::time_point()));
+    std::vector<FutureType> futures;
+    futures.reserve(kBatch);
+
+    uint64_t allocationsBefore = g_allocations.load();
+    auto start = Clock::now();
+    for (size_t done = 0; done < taskCount; done += kBatch) {
+        for (size_t i = 0; i < kBatch; ++i) {
+            futures.push_back(submit(executor, Clock::time_point()));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+        futures.clear();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    uint64_t allocations = g_allocations.load() - allocationsBefore;
+
+    size_t rounded = (taskCount + kBatch - 1) / kBatch * kBatch;
+    result.tasksPerSecond = rounded / seconds;
+    result.allocationsPerTask = static_cast<double>(allocations) / rounded;
+
+    // Latency: one task at a time, time from submit until it starts running
+    std::vector<double> latencies;
+    size_t samples = (std::min<size_t>)(taskCount, 20000);
+    latencies.reserve(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        int64_t ns = submit(executor, Clock::now()).get();
+        latencies.push_back(ns / 1000.0);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    result.latencyP50Us = latencies[latencies.size() / 2];
+    result.latencyP99Us = latencies[latencies.size() * 99 / 100];
+    return result;
+}
+
+void Print(const char* name, const Result& result) {
+    std::printf("%-10s %12.0f tasks/s  %6.2f allocs/task  p50 %7.2f us  p99 %7.2f us\n",
+                name, result.tasksPerSecond, result.allocationsPerTask,
+                result.latencyP50Us, result.latencyP99Us);
+}
+
+size_t ParseOption(int argc, char* argv[], const char* name, size_t fallback) {
+    size_t length = std::strlen(name);
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], name, length) == 0) {
+            return static_cast<size_t>(std::strtoull(argv[i] + length, nullptr, 10));
+        }
+    }
+    return fallback;
+}
+
+} // namespace
+
+// Count every heap allocation in the process
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char* argv[]) {
+    size_t threads = ParseOption(argc, argv, "--threads=", AsyncExecutor::DefaultThreadCount());
+    size_t tasks = ParseOption(argc, argv, "--tasks=", 1000000);
+
+    std::printf("threads=%zu tasks=%zu\n", threads, tasks);
+
+    AsyncExecutor executor(threads);
+
+    // Each task reports how long it waited to start (0 when not timed)
+    auto task = [](Clock::time_point submitted) -> int64_t {
+        if (submitted == Clock::time_point()) {
+            return 0;
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - submitted).count();
+    };
+
+    Result legacy = Run(executor, tasks, [&](AsyncExecutor& ex, Clock::time_point submitted) {
+        return LegacySubmit(ex, [task, submitted]() { return task(submitted); });
+    });
+    Result current = Run(executor, tasks, [&](AsyncExecutor& ex, Clock::time_point submitted) {
+        return ex.Submit([task, submitted]() { return task(submitted); });
+    });
+
+    Print("legacy", legacy);
+    Print("Submit", current);
+    return 0;
+}
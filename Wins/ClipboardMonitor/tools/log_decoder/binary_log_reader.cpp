@@ -0,0 +1,344 @@
+#include "binary_log_reader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+
+namespace LogDecoder {
+
+namespace {
+
+class Reader {
+public:
+    explicit Reader(std::vector<char> data) : m_data(std::move(data)) {}
+
+    bool AtEnd() const { return m_pos >= m_data.size(); }
+    size_t Position() const { return m_pos; }
+
+    bool PeekMagic() const {
+        return m_data.size() - m_pos >= sizeof(BinaryLogFormat::kMagic) &&
+               std::memcmp(&m_data[m_pos], BinaryLogFormat::kMagic, sizeof(BinaryLogFormat::kMagic)) == 0;
+    }
+
+    template<typename T>
+    bool Read(T& value) {
+        if (m_data.size() - m_pos < sizeof(T)) return false;
+        std::memcpy(&value, &m_data[m_pos], sizeof(T));
+        m_pos += sizeof(T);
+        return true;
+    }
+
+    bool ReadBytes(size_t count, std::string& out) {
+        if (m_data.size() - m_pos < count) return false;
+        out.assign(&m_data[m_pos], count);
+        m_pos += count;
+        return true;
+    }
+
+    // Skip zero padding left in the mapped file by an unclean shutdown.
+    // A real record header always has a non-zero level or argument count.
+    bool SkipZeroPadding() {
+        size_t probe = (std::min)(m_data.size() - m_pos, BinaryLogFormat::kRecordHeaderSize);
+        for (size_t i = 0; i < probe; ++i) {
+            if (m_data[m_pos + i] != 0) return false;
+        }
+        while (m_pos < m_data.size() && m_data[m_pos] == 0) {
+            ++m_pos;
+        }
+        return true;
+    }
+
+    bool Skip(size_t count) {
+        if (m_data.size() - m_pos < count) return false;
+        m_pos += count;
+        return true;
+    }
+
+private:
+    std::vector<char> m_data;
+    size_t m_pos = 0;
+};
+
+void AppendUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// The app writes wchar_t, which is UTF-16 on Windows
+std::string Utf16ToUtf8(const std::vector<uint16_t>& units) {
+    std::string out;
+    out.reserve(units.size());
+    for (size_t i = 0; i < units.size(); ++i) {
+        uint32_t cp = units[i];
+        if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < units.size() &&
+            units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (units[i + 1] - 0xDC00);
+            ++i;
+        } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+            cp = 0xFFFD;  // Unpaired surrogate
+        }
+        AppendUtf8(out, cp);
+    }
+    return out;
+}
+
+bool ReadHeader(Reader& reader, SessionHeader& header, uint16_t& version) {
+    uint16_t reserved16 = 0;
+    int32_t reserved32 = 0;
+    if (!reader.Skip(sizeof(BinaryLogFormat::kMagic)) ||
+        !reader.Read(version) || !reader.Read(reserved16) ||
+        !reader.Read(header.wallMicros) || !reader.Read(header.utcOffsetMinutes) ||
+        !reader.Read(reserved32)) {
+        return false;
+    }
+    return true;
+}
+
+bool ReadArg(Reader& reader, DecodedArg& arg) {
+    uint8_t rawTag = 0;
+    if (!reader.Read(rawTag)) return false;
+
+    switch (static_cast<BinaryLogFormat::ArgTag>(rawTag)) {
+        case BinaryLogFormat::ArgTag::U64:
+            arg.kind = ArgKind::Unsigned;
+            return reader.Read(arg.u);
+        case BinaryLogFormat::ArgTag::I64:
+            arg.kind = ArgKind::Signed;
+            return reader.Read(arg.i);
+        case BinaryLogFormat::ArgTag::F64:
+            arg.kind = ArgKind::Double;
+            return reader.Read(arg.d);
+        case BinaryLogFormat::ArgTag::Bool: {
+            uint8_t value = 0;
+            arg.kind = ArgKind::Bool;
+            if (!reader.Read(value)) return false;
+            arg.b = value != 0;
+            return true;
+        }
+        case BinaryLogFormat::ArgTag::Str: {
+            uint32_t length = 0;
+            arg.kind = ArgKind::String;
+            return reader.Read(length) && reader.ReadBytes(length, arg.s);
+        }
+        case BinaryLogFormat::ArgTag::WStr: {
+            uint32_t count = 0;
+            arg.kind = ArgKind::String;
+            if (!reader.Read(count)) return false;
+            std::vector<uint16_t> units(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                if (!reader.Read(units[i])) return false;
+            }
+            arg.s = Utf16ToUtf8(units);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReadRecord(Reader& reader, Record& record) {
+    uint8_t argCount = 0;
+    if (!reader.Read(record.eventId) || !reader.Read(record.level) ||
+        !reader.Read(argCount) || !reader.Read(record.threadId) ||
+        !reader.Read(record.elapsedNs)) {
+        return false;
+    }
+    record.args.assign(argCount, DecodedArg());
+    for (auto& arg : record.args) {
+        if (!ReadArg(reader, arg)) return false;
+    }
+    return true;
+}
+
+// Same layout as Utils::GetTimestamp: 2025-01-01T12:00:00.123+08:00
+std::string FormatTimestamp(const SessionHeader& header, uint64_t elapsedNs) {
+    int64_t micros = header.wallMicros + static_cast<int64_t>(elapsedNs / 1000);
+    int64_t localSeconds = micros / 1000000 + header.utcOffsetMinutes * 60;
+    int millis = static_cast<int>((micros / 1000) % 1000);
+
+    std::time_t t = static_cast<std::time_t>(localSeconds);
+    std::tm tm_buf = {};
+#ifdef _WIN32
+    gmtime_s(&tm_buf, &t);
+#else
+    gmtime_r(&t, &tm_buf);
+#endif
+
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &tm_buf);
+
+    int offset = header.utcOffsetMinutes;
+    char sign = offset < 0 ? '-' : '+';
+    if (offset < 0) offset = -offset;
+
+    char result[64];
+    std::snprintf(result, sizeof(result), "%s.%03d%c%02d:%02d", date, millis, sign, offset / 60, offset % 60);
+    return result;
+}
+
+std::string ArgToText(const DecodedArg& arg) {
+    switch (arg.kind) {
+        case ArgKind::Unsigned: return std::to_string(arg.u);
+        case ArgKind::Signed:   return std::to_string(arg.i);
+        case ArgKind::Bool:     return arg.b ? "true" : "false";
+        case ArgKind::Double: {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.2f", arg.d);
+            return buf;
+        }
+        default:                return arg.s;
+    }
+}
+
+std::string EscapeJson(const std::string& str) {
+    std::string out;
+    for (char c : str) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+std::string ArgToJson(const DecodedArg& arg) {
+    if (arg.kind == ArgKind::String) {
+        return "\"" + EscapeJson(arg.s) + "\"";
+    }
+    return ArgToText(arg);
+}
+
+// Walk the event's format, calling onText for literal runs and
+// onField(name, index) for each placeholder
+template<typename TextFn, typename FieldFn>
+void WalkFormat(const char* fmt, TextFn onText, FieldFn onField) {
+    size_t fieldIndex = 0;
+    const char* p = fmt;
+    while (*p) {
+        if (*p == '{') {
+            const char* end = std::strchr(p, '}');
+            if (end) {
+                onField(std::string(p + 1, end), fieldIndex++);
+                p = end + 1;
+                continue;
+            }
+        }
+        onText(*p++);
+    }
+}
+
+} // namespace
+
+bool Decode(std::vector<char> data,
+            const std::function<void(const SessionHeader&, const Record&)>& onRecord,
+            std::string& error) {
+    Reader reader(std::move(data));
+    SessionHeader header;
+    bool haveHeader = false;
+
+    while (!reader.AtEnd()) {
+        // Each app start appends a new session header
+        if (reader.PeekMagic()) {
+            uint16_t version = 0;
+            if (!ReadHeader(reader, header, version)) {
+                error = "Truncated header at offset " + std::to_string(reader.Position());
+                return false;
+            }
+            if (version != BinaryLogFormat::kVersion) {
+                error = "Unsupported debug.bin version " + std::to_string(version);
+                return false;
+            }
+            haveHeader = true;
+            continue;
+        }
+        if (!haveHeader) {
+            error = "Not a debug.bin file (missing header)";
+            return false;
+        }
+        if (reader.SkipZeroPadding()) {
+            continue;
+        }
+
+        size_t recordStart = reader.Position();
+        Record record;
+        if (!ReadRecord(reader, record)) {
+            error = "Truncated record at offset " + std::to_string(recordStart);
+            return false;
+        }
+        onRecord(header, record);
+    }
+    return true;
+}
+
+const LogEventInfo* FindEvent(uint16_t id) {
+    if (id >= static_cast<uint16_t>(LogEventId::Count)) return nullptr;
+    return &kLogEvents[id];
+}
+
+
+std::string RenderText(const SessionHeader& header, const Record& record) {
+    std::string message;
+    const LogEventInfo* info = FindEvent(record.eventId);
+    if (info) {
+        WalkFormat(info->format,
+            [&](char c) { message += c; },
+            [&](const std::string&, size_t index) {
+                if (index < record.args.size()) message += ArgToText(record.args[index]);
+            });
+    } else {
+        message = "<unknown event " + std::to_string(record.eventId) + ">";
+    }
+
+    return "[" + FormatTimestamp(header, record.elapsedNs) + "] [" +
+           GetLogLevelTag(static_cast<LogLevel>(record.level)) + "] " + message;
+}
+
+std::string RenderJson(const SessionHeader& header, const Record& record) {
+    const LogEventInfo* info = FindEvent(record.eventId);
+    std::ostringstream json;
+    json << "{\"ts\":\"" << FormatTimestamp(header, record.elapsedNs) << "\"";
+    json << ",\"t_ns\":" << record.elapsedNs;
+    json << ",\"level\":\"" << GetLogLevelTag(static_cast<LogLevel>(record.level)) << "\"";
+    json << ",\"thread\":" << record.threadId;
+    json << ",\"event\":\"" << (info ? info->name : "Unknown") << "\"";
+
+    if (info) {
+        WalkFormat(info->format,
+            [](char) {},
+            [&](const std::string& name, size_t index) {
+                if (index < record.args.size()) {
+                    std::string field = name.empty() ? "arg" + std::to_string(index) : name;
+                    json << ",\"" << field << "\":" << ArgToJson(record.args[index]);
+                }
+            });
+    }
+    json << "}";
+    return json.str();
+}
+
+} // namespace LogDecoder
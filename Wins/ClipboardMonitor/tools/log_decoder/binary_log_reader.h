@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../../log_events.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Parsing and rendering of the binary structured log (debug.bin), shared by
+// log_decoder and the unit tests. Portable: no Windows headers.
+namespace LogDecoder {
+
+struct SessionHeader {
+    int64_t wallMicros = 0;      // Wall clock at session start
+    int32_t utcOffsetMinutes = 0;
+};
+
+enum class ArgKind { Unsigned, Signed, Double, Bool, String };
+
+struct DecodedArg {
+    ArgKind kind = ArgKind::String;
+    uint64_t u = 0;
+    int64_t i = 0;
+    double d = 0.0;
+    bool b = false;
+    std::string s;               // UTF-8
+};
+
+struct Record {
+    uint16_t eventId = 0;
+    uint8_t level = 0;
+    uint32_t threadId = 0;
+    uint64_t elapsedNs = 0;
+    std::vector<DecodedArg> args;
+};
+
+// Decode a whole file: session headers (one per app start or rotated
+// file), records, and the zero padding a crash leaves behind. Calls
+// onRecord for each record in order, with the session it belongs to.
+// Returns: false, with error set, on a bad header or a truncated record;
+// the records before it have been delivered
+bool Decode(std::vector<char> data,
+            const std::function<void(const SessionHeader&, const Record&)>& onRecord,
+            std::string& error);
+
+// Event table entry for a raw ID, or nullptr for IDs this build does not know
+const LogEventInfo* FindEvent(uint16_t id);
+
+// One line, as debug.log would have it
+std::string RenderText(const SessionHeader& header, const Record& record);
+
+// One JSON object with the event's named fields
+std::string RenderJson(const SessionHeader& header, const Record& record);
+
+} // namespace LogDecoder
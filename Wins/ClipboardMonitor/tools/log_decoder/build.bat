@@ -0,0 +1,20 @@
+@echo off
+REM Build log_decoder.exe (renders debug.bin as text or JSON lines)
+REM Run from Developer Command Prompt for VS 2022
+
+cd /d "%~dp0"
+
+echo Building log_decoder.exe...
+
+cl.exe /EHsc /std:c++17 /W4 /O2 ^
+    /Fe:log_decoder.exe ^
+    log_decoder.cpp binary_log_reader.cpp
+
+if %ERRORLEVEL% EQU 0 (
+    echo Build successful!
+    echo Usage: log_decoder.exe [--jsonl] [--event=Name] "%%APPDATA%%\ClipboardMonitor\debug.bin"
+) else (
+    echo Build failed!
+)
+
+pause
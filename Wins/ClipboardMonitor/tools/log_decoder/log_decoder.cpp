@@ -0,0 +1,72 @@
+// Offline decoder for the binary structured log (debug.bin)
+//
+// Usage:
+//   log_decoder [--jsonl] [--event=Name] debug.bin
+//
+// Default output matches debug.log line for line. --jsonl emits one JSON
+// object per record with the event's named fields, for timing analysis.
+
+#include "binary_log_reader.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+void PrintUsage() {
+    std::cerr << "Usage: log_decoder [--jsonl] [--event=Name] <debug.bin>\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool jsonl = false;
+    std::string eventFilter;
+    std::string path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--jsonl") {
+            jsonl = true;
+        } else if (arg.rfind("--event=", 0) == 0) {
+            eventFilter = arg.substr(8);
+        } else if (arg == "--help" || arg == "-h") {
+            PrintUsage();
+            return 0;
+        } else {
+            path = arg;
+        }
+    }
+
+    if (path.empty()) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open " << path << "\n";
+        return 1;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::string error;
+    bool complete = LogDecoder::Decode(std::move(data),
+        [&](const LogDecoder::SessionHeader& header, const LogDecoder::Record& record) {
+            if (!eventFilter.empty()) {
+                const LogEventInfo* info = LogDecoder::FindEvent(record.eventId);
+                if (!info || eventFilter != info->name) return;
+            }
+            std::cout << (jsonl ? LogDecoder::RenderJson(header, record)
+                                : LogDecoder::RenderText(header, record)) << "\n";
+        },
+        error);
+    if (!complete) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,29 @@
+@echo off
+REM Build tree_bench.exe (element scans on synthetic, recorded or live accessibility trees)
+REM Run from Developer Command Prompt for VS 2022
+
+cd /d "%~dp0"
+
+echo Building tree_bench.exe...
+
+cl.exe /EHsc /std:c++20 /W4 /O2 /DUNICODE /D_UNICODE /utf-8 ^
+    /Fe:tree_bench.exe ^
+    tree_bench.cpp ^
+    ..\..\context\adapters\element_scans.cpp ^
+    ..\..\context\utils\accessible_tree.cpp ^
+    ..\..\context\utils\accessible_search.cpp ^
+    ..\..\context\utils\element_path_cache.cpp ^
+    ..\..\context\utils\json_reader.cpp ^
+    ..\..\context\utils\ui_automation_helper.cpp ^
+    ..\..\binary_log.cpp ^
+    ..\..\log_writer.cpp ^
+    /link ole32.lib oleaut32.lib uiautomationcore.lib user32.lib
+
+if %ERRORLEVEL% EQU 0 (
+    echo Build successful!
+    echo Usage: tree_bench.exe [--app=NAME] [--nodes=N] [--runs=N] [--snapshot=FILE] [--record=TITLE --app=NAME --out=FILE]
+) else (
+    echo Build failed!
+)
+
+pause
@@ -0,0 +1,408 @@
+// Benchmark for the adapters' element scans (context/adapters/element_scans.h)
+//
+// Usage:
+//   tree_bench [--app=NAME] [--nodes=N] [--runs=N] [--out=FILE]
+//   tree_bench --snapshot=FILE [--runs=N]
+//   tree_bench --record=TITLE --app=NAME --out=FILE        (Windows only)
+//
+// NAME is browser, wechat, vscode or notion; anything else is an error.
+//
+// Runs every scan of an app against an in-memory accessibility tree and
+// reports time per run, the provider calls (UI Automation round trips) the
+// same scan would make on a live window and the elements the provider would
+// examine to serve them. "+paths" scans go through an element path cache,
+// as the adapters do: the first run searches, the others follow the
+// remembered path.
+//
+// Trees are synthetic (WeChat, VS Code, Notion and Chrome-like layouts of
+// about N nodes; --out writes one as a snapshot) or recorded: --record dumps
+// the UI Automation tree of the first top-level window whose title contains
+// TITLE, and --snapshot replays a dump. The scan logic does not depend on
+// Windows, so everything but --record builds and runs anywhere, e.g.:
+//   g++ -std=c++20 -O2 -o tree_bench tree_bench.cpp
+//       ../../context/adapters/element_scans.cpp
+//       ../../context/utils/accessible_tree.cpp ../../context/utils/accessible_search.cpp
+//       ../../context/utils/element_path_cache.cpp ../../context/utils/json_reader.cpp
+
+#include "../../context/adapters/element_scans.h"
+#include "../../context/utils/accessible_tree.h"
+
+#ifdef _WIN32
+#include "../../context/utils/ui_automation_helper.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Names of the synthetic layouts, also the snapshot "app" tags the scans use
+const char* const kApps[] = {"browser", "wechat", "vscode", "notion"};
+
+struct Scan {
+    const char* app;
+    const char* name;
+    std::function<std::wstring(IAccessibleElement&)> run;
+};
+
+std::wstring JoinMessages(const std::vector<std::wstring>& items) {
+    std::wstring result = std::to_wstring(items.size()) + L" item(s)";
+    if (!items.empty()) {
+        result += L", last: " + items.back();
+    }
+    return result;
+}
+
+std::vector<Scan> GetScans(const ElementPathScope& paths) {
+    const CancellationToken& token = CancellationToken::None();
+    return {
+        {"browser", "address_bar", [&token](IAccessibleElement& window) {
+            return BrowserScan::FindAddressBarUrl(window, L"", token);
+        }},
+        {"wechat", "chat_name", [&token](IAccessibleElement& window) {
+            return WeChatScan::FindChatName(window, token);
+        }},
+        {"wechat", "recent_messages", [&token](IAccessibleElement& window) {
+            return JoinMessages(WeChatScan::FindRecentMessages(window, 10, token));
+        }},
+        {"wechat", "recent_messages+paths", [&token, paths](IAccessibleElement& window) {
+            return JoinMessages(WeChatScan::FindRecentMessages(window, 10, token, paths));
+        }},
+        {"vscode", "file_path", [&token](IAccessibleElement& window) {
+            return VSCodeScan::FindFilePath(window, token);
+        }},
+        {"vscode", "cursor", [&token](IAccessibleElement& window) {
+            int line = 0;
+            int column = 0;
+            VSCodeScan::FindCursorPosition(window, token, line, column);
+            return L"Ln " + std::to_wstring(line) + L", Col " + std::to_wstring(column);
+        }},
+        {"notion", "breadcrumbs", [&token](IAccessibleElement& window) {
+            return JoinMessages(NotionScan::FindBreadcrumbs(window, token));
+        }},
+    };
+}
+
+// ============================================================================
+// Synthetic trees
+// ============================================================================
+
+AccessibleRect Rect(long left, long top, long right, long bottom) {
+    AccessibleRect rect;
+    rect.left = left;
+    rect.top = top;
+    rect.right = right;
+    rect.bottom = bottom;
+    return rect;
+}
+
+int Add(AccessibleSnapshot& tree, int parent, int controlType, const std::wstring& name,
+        const AccessibleRect& rect, const std::wstring& value = std::wstring()) {
+    AccessibleProperties properties;
+    properties.controlType = controlType;
+    properties.name = name;
+    properties.rect = rect;
+    return tree.AddNode(parent, properties, value);
+}
+
+// Items of `itemType` stacked in rect, each with a small subtree, until
+// `budget` nodes are used. Returns the nodes added.
+size_t AddItems(AccessibleSnapshot& tree, int parent, int itemType, const AccessibleRect& rect,
+                size_t budget, const std::wstring& label, bool namedItems) {
+    size_t used = 0;
+    for (int i = 0; used < budget; i++) {
+        long top = rect.top + (i * 24) % std::max<long>(rect.Height(), 24);
+        AccessibleRect itemRect = Rect(rect.left, top, rect.right, top + 24);
+        std::wstring name = label + L" " + std::to_wstring(i);
+
+        int item = Add(tree, parent, itemType, namedItems ? name : L"", itemRect);
+        int group = Add(tree, item, AccessibleControlType::Group, L"", itemRect);
+        Add(tree, group, AccessibleControlType::Text, name, itemRect);
+        Add(tree, group, AccessibleControlType::Text, L"", itemRect);
+        used += 4;
+    }
+    return used;
+}
+
+void BuildBrowser(AccessibleSnapshot& tree, size_t nodes) {
+    int window = Add(tree, -1, AccessibleControlType::Window, L"Example Domain - Google Chrome",
+                     Rect(0, 0, 1400, 900));
+    int toolbar = Add(tree, window, AccessibleControlType::Pane, L"", Rect(0, 0, 1400, 80));
+    for (const wchar_t* name : {L"Back", L"Forward", L"Reload"}) {
+        Add(tree, toolbar, AccessibleControlType::Button, name, Rect(0, 40, 40, 80));
+    }
+    Add(tree, toolbar, AccessibleControlType::Edit, L"Address and search bar", Rect(120, 44, 1200, 76),
+        L"https://example.com/docs/page");
+    int document = Add(tree, window, AccessibleControlType::Document, L"Example Domain",
+                       Rect(0, 80, 1400, 900));
+    AddItems(tree, document, AccessibleControlType::Group, Rect(0, 80, 1400, 900),
+             nodes > tree.GetNodeCount() ? nodes - tree.GetNodeCount() : 0, L"Paragraph", false);
+}
+
+void BuildWeChat(AccessibleSnapshot& tree, size_t nodes) {
+    int window = Add(tree, -1, AccessibleControlType::Window, L"\u5FAE\u4FE1", Rect(0, 0, 1200, 800));
+    int nav = Add(tree, window, AccessibleControlType::Pane, L"", Rect(0, 0, 60, 800));
+    Add(tree, nav, AccessibleControlType::Text, L"\u5FAE\u4FE1", Rect(0, 0, 60, 30));
+    for (const wchar_t* name : {L"Chats", L"Contacts", L"Favorites", L"Files", L"Settings"}) {
+        Add(tree, nav, AccessibleControlType::Button, name, Rect(0, 60, 60, 120));
+    }
+
+    int header = Add(tree, window, AccessibleControlType::Pane, L"", Rect(310, 0, 1200, 60));
+    Add(tree, header, AccessibleControlType::Text, L"Project group(12)", Rect(330, 20, 600, 40));
+
+    size_t remaining = nodes > tree.GetNodeCount() + 2 ? nodes - tree.GetNodeCount() - 2 : 0;
+    int sessions = Add(tree, window, AccessibleControlType::List, L"Conversations", Rect(60, 60, 310, 800));
+    AddItems(tree, sessions, AccessibleControlType::ListItem, Rect(60, 60, 310, 800),
+             remaining * 2 / 5, L"Contact", true);
+    int messages = Add(tree, window, AccessibleControlType::List, L"Messages", Rect(310, 60, 1200, 650));
+    AddItems(tree, messages, AccessibleControlType::ListItem, Rect(310, 60, 1200, 650),
+             remaining - remaining * 2 / 5, L"Message", true);
+}
+
+void BuildVSCode(AccessibleSnapshot& tree, size_t nodes) {
+    int window = Add(tree, -1, AccessibleControlType::Window, L"main.cpp - app - Visual Studio Code",
+                     Rect(0, 0, 1600, 1000));
+    int activity = Add(tree, window, AccessibleControlType::ToolBar, L"Activity Bar", Rect(0, 35, 50, 975));
+    for (const wchar_t* name : {L"Explorer", L"Search", L"Source Control", L"Run", L"Extensions"}) {
+        Add(tree, activity, AccessibleControlType::Button, name, Rect(0, 35, 50, 85));
+    }
+
+    size_t remaining = nodes > tree.GetNodeCount() + 12 ? nodes - tree.GetNodeCount() - 12 : 0;
+    int explorer = Add(tree, window, AccessibleControlType::Tree, L"Files Explorer", Rect(50, 35, 350, 975));
+    AddItems(tree, explorer, AccessibleControlType::TreeItem, Rect(50, 35, 350, 975),
+             remaining / 5, L"file", true);
+    int editor = Add(tree, window, AccessibleControlType::Document, L"main.cpp", Rect(350, 35, 1600, 975));
+    AddItems(tree, editor, AccessibleControlType::Group, Rect(350, 35, 1600, 975),
+             remaining - remaining / 5, L"line", false);
+
+    // Status bar last in tree order, as in VS Code
+    int status = Add(tree, window, AccessibleControlType::StatusBar, L"", Rect(0, 975, 1600, 1000));
+    for (const wchar_t* text : {L"main", L"0 errors, 0 warnings", L"C:\\src\\app\\main.cpp",
+                                L"Ln 42, Col 15", L"Spaces: 4", L"UTF-8", L"C++"}) {
+        int item = Add(tree, status, AccessibleControlType::Button, L"", Rect(0, 975, 100, 1000));
+        Add(tree, item, AccessibleControlType::Text, text, Rect(0, 975, 100, 1000));
+    }
+}
+
+void BuildNotion(AccessibleSnapshot& tree, size_t nodes) {
+    int window = Add(tree, -1, AccessibleControlType::Window, L"Roadmap - Notion", Rect(0, 0, 1400, 900));
+    size_t remaining = nodes > 12 ? nodes - 12 : 0;
+    int sidebar = Add(tree, window, AccessibleControlType::Tree, L"Sidebar", Rect(0, 0, 240, 900));
+    AddItems(tree, sidebar, AccessibleControlType::TreeItem, Rect(0, 0, 240, 900),
+             remaining / 4, L"Page", true);
+
+    int topbar = Add(tree, window, AccessibleControlType::Pane, L"", Rect(240, 0, 1400, 45));
+    Add(tree, topbar, AccessibleControlType::Hyperlink, L"Back", Rect(240, 10, 270, 35));
+    for (const wchar_t* crumb : {L"Acme Workspace", L"Projects", L"Roadmap"}) {
+        Add(tree, topbar, AccessibleControlType::Hyperlink, crumb, Rect(280, 10, 600, 35));
+    }
+    Add(tree, topbar, AccessibleControlType::Button, L"Share", Rect(1300, 10, 1350, 35));
+
+    int page = Add(tree, window, AccessibleControlType::Document, L"Roadmap", Rect(240, 45, 1400, 900));
+    AddItems(tree, page, AccessibleControlType::Group, Rect(240, 45, 1400, 900),
+             remaining - remaining / 4, L"Block", false);
+}
+
+bool BuildSynthetic(const std::string& app, size_t nodes, AccessibleSnapshot& tree) {
+    if (app == "browser") {
+        BuildBrowser(tree, nodes);
+    } else if (app == "wechat") {
+        BuildWeChat(tree, nodes);
+    } else if (app == "vscode") {
+        BuildVSCode(tree, nodes);
+    } else if (app == "notion") {
+        BuildNotion(tree, nodes);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Runs
+// ============================================================================
+
+void RunScans(const std::string& app, AccessibleSnapshot& tree, size_t runs) {
+    std::printf("%s: %zu nodes\n", app.c_str(), tree.GetNodeCount());
+
+    // One window per tree; entries of a previous tree fail validation
+    ElementPathCache cache;
+    ElementPathScope paths;
+    paths.cache = &cache;
+    paths.window = 1;
+
+    for (const Scan& scan : GetScans(paths)) {
+        if (app != scan.app) {
+            continue;
+        }
+
+        std::vector<double> times;
+        times.reserve(runs);
+        std::wstring result;
+        tree.ResetCallCount();
+        for (size_t i = 0; i < runs; ++i) {
+            AccessibleElementPtr root = tree.GetRoot();
+            auto start = Clock::now();
+            result = scan.run(*root);
+            times.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+        std::sort(times.begin(), times.end());
+
+        std::printf("  %-22s p50 %9.1f us  p99 %9.1f us  %6.1f calls/run  %9.1f visits/run  -> %ls\n",
+                    scan.name, times[times.size() / 2], times[times.size() * 99 / 100],
+                    static_cast<double>(tree.GetCallCount()) / runs,
+                    static_cast<double>(tree.GetVisitCount()) / runs, result.c_str());
+    }
+}
+
+std::string ParseString(int argc, char* argv[], const char* name) {
+    size_t length = std::strlen(name);
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], name, length) == 0) {
+            return argv[i] + length;
+        }
+    }
+    return std::string();
+}
+
+size_t ParseOption(int argc, char* argv[], const char* name, size_t fallback) {
+    std::string value = ParseString(argc, argv, name);
+    return value.empty() ? fallback : static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10));
+}
+
+bool IsKnownApp(const std::string& app) {
+    return std::find(std::begin(kApps), std::end(kApps), app) != std::end(kApps);
+}
+
+// Reject an app no scan set or layout exists for, listing the ones that do
+bool CheckApp(const std::string& app) {
+    if (IsKnownApp(app)) {
+        return true;
+    }
+    std::fprintf(stderr, "Unknown app \"%s\"; expected one of:", app.c_str());
+    for (const char* name : kApps) {
+        std::fprintf(stderr, " %s", name);
+    }
+    std::fprintf(stderr, "\n");
+    return false;
+}
+
+bool WriteFile(const std::string& path, const std::string& text) {
+    std::ofstream file(path, std::ios::binary);
+    file << text;
+    return static_cast<bool>(file);
+}
+
+#ifdef _WIN32
+struct WindowSearch {
+    std::wstring title;
+    HWND found = nullptr;
+};
+
+BOOL CALLBACK FindWindowByTitle(HWND hwnd, LPARAM lParam) {
+    auto* search = reinterpret_cast<WindowSearch*>(lParam);
+    wchar_t buffer[512] = {0};
+    GetWindowTextW(hwnd, buffer, 512);
+    if (IsWindowVisible(hwnd) && std::wstring(buffer).find(search->title) != std::wstring::npos) {
+        search->found = hwnd;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+int Record(const std::string& title, const std::string& app, const std::string& out) {
+    WindowSearch search;
+    search.title.assign(title.begin(), title.end());
+    EnumWindows(FindWindowByTitle, reinterpret_cast<LPARAM>(&search));
+    if (!search.found) {
+        std::fprintf(stderr, "No visible window title contains \"%s\"\n", title.c_str());
+        return 1;
+    }
+
+    UIAutomationHelper helper;
+    AccessibleElementPtr root = helper.Initialize() ? helper.GetWindowElement(search.found) : nullptr;
+    if (!root) {
+        std::fprintf(stderr, "UI Automation could not open the window\n");
+        return 1;
+    }
+
+    std::string snapshot = AccessibleSnapshot::Record(*root, app);
+    if (!WriteFile(out, snapshot)) {
+        std::fprintf(stderr, "Cannot write %s\n", out.c_str());
+        return 1;
+    }
+    std::printf("Recorded %zu bytes to %s\n", snapshot.size(), out.c_str());
+    return 0;
+}
+#endif
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string app = ParseString(argc, argv, "--app=");
+    std::string out = ParseString(argc, argv, "--out=");
+    std::string snapshotPath = ParseString(argc, argv, "--snapshot=");
+    std::string recordTitle = ParseString(argc, argv, "--record=");
+    size_t nodes = ParseOption(argc, argv, "--nodes=", 10000);
+    size_t runs = std::max<size_t>(ParseOption(argc, argv, "--runs=", 50), 1);
+
+    if (!recordTitle.empty()) {
+#ifdef _WIN32
+        if (app.empty() || out.empty()) {
+            std::fprintf(stderr, "--record needs --app and --out\n");
+            return 1;
+        }
+        if (!CheckApp(app)) {
+            return 1;
+        }
+        return Record(recordTitle, app, out);
+#else
+        std::fprintf(stderr, "--record needs Windows (UI Automation)\n");
+        return 1;
+#endif
+    }
+
+    if (!snapshotPath.empty()) {
+        std::ifstream file(snapshotPath, std::ios::binary);
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        AccessibleSnapshot tree;
+        std::string error;
+        if (!file || !AccessibleSnapshot::Load(text, tree, &error)) {
+            std::fprintf(stderr, "Cannot load %s: %s\n", snapshotPath.c_str(), error.c_str());
+            return 1;
+        }
+        if (!CheckApp(app.empty() ? tree.GetApp() : app)) {
+            return 1;
+        }
+        RunScans(app.empty() ? tree.GetApp() : app, tree, runs);
+        return 0;
+    }
+
+    if (!app.empty() && !CheckApp(app)) {
+        return 1;
+    }
+
+    std::printf("runs=%zu\n", runs);
+    for (const char* name : kApps) {
+        if (!app.empty() && app != name) {
+            continue;
+        }
+        AccessibleSnapshot tree;
+        BuildSynthetic(name, nodes, tree);
+        if (!out.empty() && !app.empty()) {
+            WriteFile(out, AccessibleSnapshot::Record(*tree.GetRoot(), name, nodes * 2));
+        }
+        RunScans(name, tree, runs);
+    }
+    return 0;
+}
@@ -1,17 +1,22 @@
 #pragma once
 
+#ifdef _WIN32
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
 #endif
 
 #include <windows.h>
+#include <psapi.h>
+#include <shlobj.h>
+#endif
+
 #include <string>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
+#include <cstdint>
+#include <ctime>
 #include <cwctype>
-#include <psapi.h>
-#include <shlobj.h>
 
 namespace Utils {
 
@@ -19,20 +24,85 @@ namespace Utils {
 inline std::string WideToUtf8(const std::wstring& wstr) {
     if (wstr.empty()) return std::string();
     
+#ifdef _WIN32
     int size = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.size(), nullptr, 0, nullptr, nullptr);
     std::string result(size, 0);
     WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.size(), &result[0], size, nullptr, nullptr);
     return result;
+#else
+    // wchar_t holds UTF-32 elsewhere (the unit test builds)
+    std::string result;
+    result.reserve(wstr.size());
+    for (wchar_t wc : wstr) {
+        uint32_t c = static_cast<uint32_t>(wc);
+        if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+            c = 0xFFFD;
+        }
+        if (c < 0x80) {
+            result += static_cast<char>(c);
+        } else if (c < 0x800) {
+            result += static_cast<char>(0xC0 | (c >> 6));
+            result += static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            result += static_cast<char>(0xE0 | (c >> 12));
+            result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+            result += static_cast<char>(0xF0 | (c >> 18));
+            result += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+    return result;
+#endif
 }
 
 // Convert UTF-8 to wide string
 inline std::wstring Utf8ToWide(const std::string& str) {
     if (str.empty()) return std::wstring();
     
+#ifdef _WIN32
     int size = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), nullptr, 0);
     std::wstring result(size, 0);
     MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), &result[0], size);
     return result;
+#else
+    // Invalid sequences become U+FFFD, as MultiByteToWideChar does
+    std::wstring result;
+    result.reserve(str.size());
+    size_t i = 0;
+    while (i < str.size()) {
+        unsigned char lead = static_cast<unsigned char>(str[i]);
+        size_t length = 0;      // 0: not a lead byte
+        uint32_t c = 0;
+        if (lead < 0x80) {
+            length = 1;
+            c = lead;
+        } else if ((lead & 0xE0) == 0xC0) {
+            length = 2;
+            c = lead & 0x1F;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3;
+            c = lead & 0x0F;
+        } else if ((lead & 0xF8) == 0xF0) {
+            length = 4;
+            c = lead & 0x07;
+        }
+        size_t used = 1;
+        while (length > 1 && used < length && i + used < str.size() &&
+               (static_cast<unsigned char>(str[i + used]) & 0xC0) == 0x80) {
+            c = (c << 6) | (static_cast<unsigned char>(str[i + used]) & 0x3F);
+            ++used;
+        }
+        static const uint32_t kMinimum[] = {0, 0, 0x80, 0x800, 0x10000};
+        bool valid = length > 0 && used == length && c >= kMinimum[length] && c <= 0x10FFFF &&
+                     (c < 0xD800 || c > 0xDFFF);
+        result += valid ? static_cast<wchar_t>(c) : L'\xFFFD';
+        i += used;
+    }
+    return result;
+#endif
 }
 
 // Get current timestamp in ISO 8601 format
@@ -43,7 +113,11 @@ inline std::string GetTimestamp() {
         now.time_since_epoch()) % 1000;
     
     std::tm tm_buf;
+#ifdef _WIN32
     localtime_s(&tm_buf, &time);
+#else
+    localtime_r(&time, &tm_buf);
+#endif
     
     std::ostringstream oss;
     oss << std::put_time(&tm_buf, "%Y-%m-%dT%H:%M:%S");
@@ -85,6 +159,7 @@ inline std::string EscapeJson(const std::string& str) {
     return oss.str();
 }
 
+#ifdef _WIN32
 // Get AppData path
 inline std::wstring GetAppDataPath() {
     wchar_t path[MAX_PATH];
@@ -102,6 +177,7 @@ inline bool EnsureDirectoryExists(const std::wstring& path) {
     }
     return (attrs & FILE_ATTRIBUTE_DIRECTORY) != 0;
 }
+#endif
 
 // Truncate string for preview
 inline std::string TruncateForPreview(const std::string& str, size_t maxLen = 100) {